@@ -0,0 +1,177 @@
+#include "cache/module_cache.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "cache/module_serializer.h"
+
+namespace Cobold {
+namespace {
+// Bump whenever the encoding of `ModuleWriter` (or the AST) changes.
+constexpr uint32_t kFormatVersion = 4;
+constexpr char kMagic[4] = {'C', 'B', 'L', 'D'};
+
+struct EntryHeader {
+  char magic[4];
+  uint32_t version;
+  uint64_t content_hash;
+  uint64_t fingerprint;
+};
+
+// Read-only mapping of a cache entry, unmapped when going out of scope.
+class MappedEntry {
+public:
+  explicit MappedEntry(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return;
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+      void *mapping =
+          mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping != MAP_FAILED) {
+        data_ = static_cast<const char *>(mapping);
+        size_ = file_stat.st_size;
+      }
+    }
+    close(fd);
+  }
+  ~MappedEntry() {
+    if (data_ != nullptr)
+      munmap(const_cast<char *>(data_), size_);
+  }
+
+  std::string_view contents() const { return std::string_view(data_, size_); }
+
+private:
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+};
+} // namespace
+
+// `ModuleCache` ========================================================
+std::optional<CachedModule> ModuleCache::Lookup(const SourceBuffer &source) {
+  const uint64_t content_hash = ContentHash(source.contents());
+  MappedEntry entry(EntryPath(content_hash));
+  std::string_view contents = entry.contents();
+  if (contents.size() < sizeof(EntryHeader))
+    return std::nullopt;
+
+  EntryHeader header;
+  std::memcpy(&header, contents.data(), sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kFormatVersion || header.content_hash != content_hash)
+    return std::nullopt;
+
+  absl::StatusOr<SourceFile> file =
+      ModuleReader::Read(contents.substr(sizeof(header)), source);
+  if (!file.ok())
+    return std::nullopt; // treat corrupt entries as misses
+
+  absl::MutexLock lock(&mutex_);
+  entries_[content_hash] = header.fingerprint;
+  return CachedModule{*std::move(file), header.fingerprint};
+}
+
+absl::Status ModuleCache::Update(SourceManager *sources,
+                                 const std::vector<SourceFile> &modules) {
+  const uint64_t fingerprint = SignatureFingerprint(modules);
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+  if (error) {
+    return absl::InternalError(absl::StrCat(
+        "Could not create cache directory: ", directory_, ": ", error.message()));
+  }
+
+  for (const SourceFile &file : modules) {
+    // Modules with unparsed bodies would be incomplete when read back.
+    if (!file.annotated() || !file.parsed())
+      continue;
+    absl::StatusOr<const SourceBuffer *> source = sources->Load(file.filename());
+    if (!source.ok())
+      return source.status();
+    const uint64_t content_hash = ContentHash((*source)->contents());
+    {
+      absl::MutexLock lock(&mutex_);
+      auto it = entries_.find(content_hash);
+      if (it != entries_.end() && it->second == fingerprint)
+        continue;
+      entries_[content_hash] = fingerprint;
+    }
+
+    EntryHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.content_hash = content_hash;
+    header.fingerprint = fingerprint;
+    const std::string payload = ModuleWriter::Write(file);
+
+    // Write to a temporary file first, such that concurrent compilations
+    // never observe a partially written entry.
+    const std::string path = EntryPath(content_hash);
+    const std::string temp_path = absl::StrCat(path, ".", getpid(), ".tmp");
+    {
+      std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+      out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      out.write(payload.data(), payload.size());
+      if (!out) {
+        std::remove(temp_path.c_str());
+        return absl::InternalError(
+            absl::StrCat("Could not write cache entry: ", temp_path));
+      }
+    }
+    std::filesystem::rename(temp_path, path, error);
+    if (error) {
+      std::remove(temp_path.c_str());
+      return absl::InternalError(absl::StrCat(
+          "Could not write cache entry: ", path, ": ", error.message()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+uint64_t
+ModuleCache::SignatureFingerprint(const std::vector<SourceFile> &modules) {
+  std::vector<std::string> signatures;
+  for (const SourceFile &file : modules) {
+    for (const auto &fn : file.functions()) {
+      std::vector<std::string> arg_types;
+      arg_types.reserve(fn->arguments().size());
+      for (const auto &argument : fn->arguments()) {
+        arg_types.push_back(argument.type->DebugString());
+      }
+      signatures.push_back(absl::StrCat(fn->name().str(), "(",
+                                        absl::StrJoin(arg_types, ","), ")->",
+                                        fn->return_type()->DebugString()));
+    }
+  }
+  std::sort(signatures.begin(), signatures.end());
+  return ContentHash(absl::StrJoin(signatures, "\n"));
+}
+
+uint64_t ModuleCache::ContentHash(std::string_view contents) {
+  // 64-bit FNV-1a, i.e., stable across runs and platforms.
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const char c : contents) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+std::string ModuleCache::EntryPath(uint64_t content_hash) const {
+  return absl::StrFormat("%s/%016x.cbc", directory_, content_hash);
+}
+// `ModuleCache` ========================================================
+} // namespace Cobold
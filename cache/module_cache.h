@@ -0,0 +1,61 @@
+#ifndef COBOLD_CACHE_MODULE_CACHE
+#define COBOLD_CACHE_MODULE_CACHE
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "parser/source_file.h"
+#include "parser/source_manager.h"
+
+namespace Cobold {
+struct CachedModule {
+  SourceFile file; // already annotated
+  // `SignatureFingerprint` of the program the module was annotated in.
+  uint64_t fingerprint;
+};
+
+// On-disk cache of parsed and annotated modules. Entries are keyed by a hash
+// of the module's contents and mapped back into memory on a hit. The result
+// of type inference also depends on the signatures of all other functions in
+// the program, hence every entry records the fingerprint of those signatures
+// and is only valid if it matches the current program.
+class ModuleCache {
+public:
+  explicit ModuleCache(std::string directory)
+      : directory_(std::move(directory)) {}
+
+  ModuleCache(const ModuleCache &) = delete;
+  ModuleCache &operator=(const ModuleCache &) = delete;
+
+  // Returns the cached module for the contents of `source`, if any.
+  // Thread-safe.
+  std::optional<CachedModule> Lookup(const SourceBuffer &source);
+
+  // Writes all (annotated) `modules` that are not cached (for the current
+  // fingerprint) yet. The buffers are loaded through `sources`.
+  absl::Status Update(SourceManager *sources,
+                      const std::vector<SourceFile> &modules);
+
+  // Order independent hash of the signatures of all functions in `modules`.
+  static uint64_t SignatureFingerprint(const std::vector<SourceFile> &modules);
+
+private:
+  static uint64_t ContentHash(std::string_view contents);
+  std::string EntryPath(uint64_t content_hash) const;
+
+  std::string directory_;
+
+  absl::Mutex mutex_;
+  // Fingerprints of the entries that were found by `Lookup`.
+  absl::flat_hash_map<uint64_t, uint64_t> entries_ ABSL_GUARDED_BY(mutex_);
+};
+} // namespace Cobold
+
+#endif /* COBOLD_CACHE_MODULE_CACHE */
@@ -0,0 +1,744 @@
+#include "cache/module_serializer.h"
+
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "core/ast_arena.h"
+
+namespace Cobold {
+namespace {
+// Tag of an absent (optional) expression, e.g., the bound of `[1..]`.
+constexpr uint8_t kNullExpression = 0xFF;
+
+// Tags of the `ConstantExpression::data_type` alternatives.
+enum class ConstantTag : uint8_t { Dash, Bool, Integer, Floating, String, Char };
+} // namespace
+
+// `ModuleWriter` =======================================================
+std::string ModuleWriter::Write(const SourceFile &file) {
+  ModuleWriter writer;
+  writer.WriteVarint(file.imports().size());
+  for (const std::string &import : file.imports()) {
+    writer.WriteString(import);
+  }
+  writer.WriteVarint(file.functions().size());
+  for (const auto &fn : file.functions()) {
+    writer.WriteFunction(fn.get());
+  }
+
+  // The type table precedes the AST, such that it can be read first.
+  std::string result;
+  writer.target_ = &result;
+  writer.WriteVarint(writer.type_indices_.size());
+  result.append(writer.types_);
+  result.append(writer.out_);
+  return result;
+}
+
+void ModuleWriter::WriteFunction(const Function *fn) {
+  WriteByte(fn->external());
+  WriteSymbol(fn->name());
+  WriteLocation(fn->location());
+  WriteVarint(fn->arguments().size());
+  for (const auto &argument : fn->arguments()) {
+    WriteSymbol(argument.name);
+    WriteType(argument.type);
+  }
+  WriteType(fn->return_type());
+  if (fn->external()) {
+    WriteString(fn->As<ExternFunction>()->specifier());
+  } else {
+    WriteCompound(&fn->As<DefinedFunction>()->body());
+  }
+}
+
+void ModuleWriter::WriteCompound(const CompoundStatement *stmt) {
+  WriteVarint(stmt->statements().size());
+  for (const auto &statement : stmt->statements()) {
+    Visit(statement.get());
+  }
+}
+
+void ModuleWriter::WriteLocation(const SourceLocation &location) {
+  // Offset into the file, shifted past the generated/complex locations.
+  if (location.IsGenerated()) {
+    WriteVarint(0);
+  } else if (location.IsComplex()) {
+    WriteVarint(1);
+  } else {
+    if (source_ == nullptr ||
+        location.raw() - source_->base() > source_->size()) {
+      source_ = location.buffer();
+    }
+    WriteVarint(location.raw() - source_->base() + 2);
+  }
+}
+
+void ModuleWriter::WriteType(const Type *type) { WriteVarint(TypeIndex(type)); }
+
+void ModuleWriter::WriteString(std::string_view value) {
+  WriteVarint(value.size());
+  target_->append(value.data(), value.size());
+}
+
+void ModuleWriter::WriteVarint(uint64_t value) {
+  while (value >= 0x80) {
+    WriteByte(static_cast<uint8_t>(value) | 0x80);
+    value >>= 7;
+  }
+  WriteByte(static_cast<uint8_t>(value));
+}
+
+void ModuleWriter::WriteSigned(int64_t value) {
+  // ZigZag encoding, such that small negative values stay small.
+  WriteVarint((static_cast<uint64_t>(value) << 1) ^
+              static_cast<uint64_t>(value >> 63));
+}
+
+void ModuleWriter::WriteByte(uint8_t value) {
+  target_->push_back(static_cast<char>(value));
+}
+
+uint64_t ModuleWriter::TypeIndex(const Type *type) {
+  if (type == nullptr)
+    return 0;
+  auto it = type_indices_.find(type);
+  if (it != type_indices_.end())
+    return it->second;
+  std::string *target = target_;
+  target_ = &types_;
+  TypeVisitor::Visit(type); // appends the underlying types first
+  target_ = target;
+  const uint64_t index = type_indices_.size() + 1;
+  type_indices_[type] = index;
+  return index;
+}
+
+void ModuleWriter::DispatchReturn(const ReturnStatement *stmt) {
+  WriteByte(static_cast<uint8_t>(StatementType::Return));
+  Visit(stmt->expression());
+}
+
+void ModuleWriter::DispatchDeinit(const DeinitStatement *stmt) {
+  WriteByte(static_cast<uint8_t>(StatementType::Deinit));
+  Visit(stmt->expression());
+}
+
+void ModuleWriter::DispatchAssignment(const AssignmentStatement *stmt) {
+  WriteByte(static_cast<uint8_t>(StatementType::Assignment));
+  Visit(stmt->lhs());
+  WriteByte(static_cast<uint8_t>(stmt->assgn_type()));
+  WriteType(stmt->operation_type());
+  Visit(stmt->rhs());
+}
+
+void ModuleWriter::DispatchCompound(const CompoundStatement *stmt) {
+  WriteByte(static_cast<uint8_t>(StatementType::Compound));
+  WriteCompound(stmt);
+}
+
+void ModuleWriter::DispatchExpression(const ExpressionStatement *stmt) {
+  WriteByte(static_cast<uint8_t>(StatementType::Expression));
+  Visit(stmt->expression());
+}
+
+void ModuleWriter::DispatchIf(const IfStatement *stmt) {
+  WriteByte(static_cast<uint8_t>(StatementType::If));
+  WriteVarint(stmt->branches().size());
+  for (const IfBranch &branch : stmt->branches()) {
+    Visit(branch.condition.get());
+    WriteCompound(branch.body.get());
+  }
+}
+
+void ModuleWriter::DispatchFor(const ForStatement *stmt) {
+  WriteByte(static_cast<uint8_t>(StatementType::For));
+  WriteSymbol(stmt->identifier());
+  WriteType(stmt->decl_type());
+  Visit(stmt->expression());
+  WriteCompound(stmt->body().get());
+}
+
+void ModuleWriter::DispatchWhile(const WhileStatement *stmt) {
+  WriteByte(static_cast<uint8_t>(StatementType::While));
+  Visit(stmt->condition());
+  WriteCompound(stmt->body().get());
+}
+
+void ModuleWriter::DispatchDeclaration(const DeclarationStatement *stmt) {
+  WriteByte(static_cast<uint8_t>(StatementType::Declaration));
+  WriteByte(stmt->is_const());
+  WriteSymbol(stmt->identifier());
+  WriteType(stmt->decl_type());
+  Visit(stmt->expression());
+}
+
+void ModuleWriter::DispatchBreak(const BreakStatement *stmt) {
+  WriteByte(static_cast<uint8_t>(StatementType::Break));
+}
+
+void ModuleWriter::DispatchContinue(const ContinueStatement *stmt) {
+  WriteByte(static_cast<uint8_t>(StatementType::Continue));
+}
+
+void ModuleWriter::DispatchEmpty() { WriteByte(kNullExpression); }
+
+void ModuleWriter::DispatchTernary(const TernaryExpression *expr) {
+  WriteByte(static_cast<uint8_t>(ExpressionType::Ternary));
+  WriteLocation(expr->location());
+  WriteType(expr->expr_type());
+  Visit(expr->condition());
+  Visit(expr->true_case());
+  Visit(expr->false_case());
+}
+
+void ModuleWriter::DispatchBinary(const BinaryExpression *expr) {
+  WriteByte(static_cast<uint8_t>(ExpressionType::Binary));
+  WriteLocation(expr->location());
+  WriteType(expr->expr_type());
+  WriteByte(static_cast<uint8_t>(expr->op_type()));
+  Visit(expr->lhs());
+  Visit(expr->rhs());
+}
+
+void ModuleWriter::DispatchUnary(const UnaryExpression *expr) {
+  WriteByte(static_cast<uint8_t>(ExpressionType::Unary));
+  WriteLocation(expr->location());
+  WriteType(expr->expr_type());
+  WriteByte(static_cast<uint8_t>(expr->op_type()));
+  Visit(expr->expression());
+}
+
+void ModuleWriter::DispatchCall(const CallExpression *expr) {
+  WriteByte(static_cast<uint8_t>(ExpressionType::Call));
+  WriteLocation(expr->location());
+  WriteType(expr->expr_type());
+  WriteSymbol(expr->identifier());
+  WriteVarint(expr->args().size());
+  for (const auto &arg : expr->args()) {
+    Visit(arg.get());
+  }
+}
+
+void ModuleWriter::DispatchRange(const RangeExpression *expr) {
+  WriteByte(static_cast<uint8_t>(ExpressionType::Range));
+  WriteLocation(expr->location());
+  WriteType(expr->expr_type());
+  Visit(expr->lhs());
+  Visit(expr->rhs());
+}
+
+void ModuleWriter::DispatchArray(const ArrayExpression *expr) {
+  WriteByte(static_cast<uint8_t>(ExpressionType::Array));
+  WriteLocation(expr->location());
+  WriteType(expr->expr_type());
+  WriteVarint(expr->elements().size());
+  for (const auto &element : expr->elements()) {
+    Visit(element.get());
+  }
+}
+
+void ModuleWriter::DispatchCast(const CastExpression *expr) {
+  WriteByte(static_cast<uint8_t>(ExpressionType::Cast));
+  WriteLocation(expr->location());
+  WriteType(expr->expr_type());
+  WriteType(expr->cast_type());
+  Visit(expr->expression());
+}
+
+void ModuleWriter::DispatchConstant(const ConstantExpression *expr) {
+  WriteByte(static_cast<uint8_t>(ExpressionType::Constant));
+  WriteLocation(expr->location());
+  WriteType(expr->expr_type());
+  const ConstantExpression::data_type &data = expr->data();
+  if (std::holds_alternative<DashTypeTag>(data)) {
+    WriteByte(static_cast<uint8_t>(ConstantTag::Dash));
+  } else if (std::holds_alternative<bool>(data)) {
+    WriteByte(static_cast<uint8_t>(ConstantTag::Bool));
+    WriteByte(std::get<bool>(data));
+  } else if (std::holds_alternative<int64_t>(data)) {
+    WriteByte(static_cast<uint8_t>(ConstantTag::Integer));
+    WriteSigned(std::get<int64_t>(data));
+  } else if (std::holds_alternative<double>(data)) {
+    WriteByte(static_cast<uint8_t>(ConstantTag::Floating));
+    uint64_t bits;
+    const double value = std::get<double>(data);
+    std::memcpy(&bits, &value, sizeof(bits));
+    WriteVarint(bits);
+  } else if (std::holds_alternative<Symbol>(data)) {
+    WriteByte(static_cast<uint8_t>(ConstantTag::String));
+    WriteSymbol(std::get<Symbol>(data));
+  } else {
+    WriteByte(static_cast<uint8_t>(ConstantTag::Char));
+    WriteByte(std::get<char>(data));
+  }
+}
+
+void ModuleWriter::DispatchIdentifier(const IdentifierExpression *expr) {
+  WriteByte(static_cast<uint8_t>(ExpressionType::Identifier));
+  WriteLocation(expr->location());
+  WriteType(expr->expr_type());
+  WriteSymbol(expr->identifier());
+}
+
+void ModuleWriter::DispatchMemberAccess(const MemberAccessExpression *expr) {
+  WriteByte(static_cast<uint8_t>(ExpressionType::MemberAccess));
+  WriteLocation(expr->location());
+  WriteType(expr->expr_type());
+  WriteByte(expr->direct());
+  WriteSymbol(expr->identifier());
+  Visit(expr->expression());
+}
+
+void ModuleWriter::DispatchArrayAccess(const ArrayAccessExpression *expr) {
+  WriteByte(static_cast<uint8_t>(ExpressionType::ArrayAccess));
+  WriteLocation(expr->location());
+  WriteType(expr->expr_type());
+  Visit(expr->expression());
+  Visit(expr->index());
+}
+
+void ModuleWriter::DispatchCallOp(const CallOpExpression *expr) {
+  WriteByte(static_cast<uint8_t>(ExpressionType::CallOp));
+  WriteLocation(expr->location());
+  WriteType(expr->expr_type());
+  Visit(expr->expression());
+  WriteVarint(expr->args().size());
+  for (const auto &arg : expr->args()) {
+    Visit(arg.get());
+  }
+}
+
+void ModuleWriter::DispatchMalloc(const MallocExpression *expr) {
+  WriteByte(static_cast<uint8_t>(ExpressionType::Malloc));
+  WriteLocation(expr->location());
+  WriteType(expr->expr_type());
+  WriteType(expr->decl_type());
+  Visit(expr->expression());
+}
+
+void ModuleWriter::DispatchSizeof(const SizeofExpression *expr) {
+  WriteByte(static_cast<uint8_t>(ExpressionType::Sizeof));
+  WriteLocation(expr->location());
+  WriteType(expr->expr_type());
+  WriteType(expr->decl_type());
+}
+
+void ModuleWriter::DispatchNil(const NilType *type) {
+  WriteByte(static_cast<uint8_t>(TypeClass::Nil));
+}
+
+void ModuleWriter::DispatchDash(const DashType *type) {
+  WriteByte(static_cast<uint8_t>(TypeClass::Dash));
+}
+
+void ModuleWriter::DispatchBool(const BoolType *type) {
+  WriteByte(static_cast<uint8_t>(TypeClass::Bool));
+}
+
+void ModuleWriter::DispatchChar(const CharType *type) {
+  WriteByte(static_cast<uint8_t>(TypeClass::Char));
+}
+
+void ModuleWriter::DispatchIntegral(const IntegralType *type) {
+  WriteByte(static_cast<uint8_t>(TypeClass::Integral));
+  WriteVarint(type->size());
+}
+
+void ModuleWriter::DispatchFloating(const FloatingType *type) {
+  WriteByte(static_cast<uint8_t>(TypeClass::Floating));
+  WriteVarint(type->size());
+}
+
+void ModuleWriter::DispatchString(const StringType *type) {
+  WriteByte(static_cast<uint8_t>(TypeClass::String));
+}
+
+void ModuleWriter::DispatchArray(const ArrayType *type) {
+  const uint64_t underlying = TypeIndex(type->underlying_type());
+  WriteByte(static_cast<uint8_t>(TypeClass::Array));
+  WriteVarint(underlying);
+}
+
+void ModuleWriter::DispatchRange(const RangeType *type) {
+  const uint64_t underlying = TypeIndex(type->underlying_type());
+  WriteByte(static_cast<uint8_t>(TypeClass::Range));
+  WriteVarint(underlying);
+}
+
+void ModuleWriter::DispatchPointer(const PointerType *type) {
+  const uint64_t underlying = TypeIndex(type->underlying_type());
+  WriteByte(static_cast<uint8_t>(TypeClass::Pointer));
+  WriteVarint(underlying);
+}
+// `ModuleWriter` =======================================================
+
+// `ModuleReader` =======================================================
+absl::StatusOr<SourceFile> ModuleReader::Read(std::string_view data,
+                                              const SourceBuffer &source) {
+  ModuleReader reader(data, source);
+  SourceFile file(source.filename());
+  file.arena_ = std::make_unique<AstArena>();
+  AstArena::Scope scope(file.arena_.get());
+  if (!reader.ReadTypeTable())
+    return absl::DataLossError("Corrupt type table in cached module");
+
+  const uint64_t num_imports = reader.ReadCount();
+  for (uint64_t i = 0; reader.ok_ && i < num_imports; ++i) {
+    file.imports_.push_back(reader.ReadString());
+  }
+  const uint64_t num_functions = reader.ReadCount();
+  for (uint64_t i = 0; reader.ok_ && i < num_functions; ++i) {
+    std::unique_ptr<Function> fn = reader.ReadFunction();
+    if (fn != nullptr)
+      file.functions_.push_back(std::move(fn));
+  }
+  if (!reader.ok_ || reader.position_ != data.size()) {
+    return absl::DataLossError(
+        absl::StrCat("Corrupt cached module for ", source.filename()));
+  }
+  file.annotated_ = true;
+  return file;
+}
+
+bool ModuleReader::ReadTypeTable() {
+  const uint64_t num_types = ReadCount();
+  for (uint64_t i = 0; ok_ && i < num_types; ++i) {
+    const Type *type = nullptr;
+    switch (static_cast<TypeClass>(ReadByte())) {
+    case TypeClass::Nil:
+      type = NilType::Get();
+      break;
+    case TypeClass::Dash:
+      type = DashType::Get();
+      break;
+    case TypeClass::Bool:
+      type = BoolType::Get();
+      break;
+    case TypeClass::Char:
+      type = CharType::Get();
+      break;
+    case TypeClass::Integral:
+      type = IntegralType::OfSize(ReadVarint());
+      break;
+    case TypeClass::Floating:
+      type = FloatingType::OfSize(ReadVarint());
+      break;
+    case TypeClass::String:
+      type = StringType::Get();
+      break;
+    case TypeClass::Array:
+      type = Type::ArrayOf(ReadType());
+      break;
+    case TypeClass::Range:
+      type = RangeType::Of(ReadType());
+      break;
+    case TypeClass::Pointer:
+      type = Type::PointerTo(ReadType());
+      break;
+    }
+    if (type == nullptr)
+      Fail();
+    types_.push_back(type);
+  }
+  return ok_;
+}
+
+std::unique_ptr<Function> ModuleReader::ReadFunction() {
+  const bool external = ReadByte();
+  const Symbol name = ReadSymbol();
+  const SourceLocation location = ReadLocation();
+  std::vector<FunctionArgument> arguments(ReadCount());
+  for (FunctionArgument &argument : arguments) {
+    if (!ok_)
+      return nullptr;
+    argument.name = ReadSymbol();
+    argument.type = ReadType();
+  }
+  const Type *return_type = ReadType();
+  if (external) {
+    return std::make_unique<ExternFunction>(
+        name, std::move(arguments), return_type, ReadString(), location);
+  }
+  std::unique_ptr<CompoundStatement> body = ReadCompound();
+  if (body == nullptr)
+    return nullptr;
+  return std::make_unique<DefinedFunction>(
+      name, std::move(arguments), return_type, std::move(*body), location);
+}
+
+std::unique_ptr<CompoundStatement> ModuleReader::ReadCompound() {
+  const uint64_t num_statements = ReadCount();
+  std::vector<std::unique_ptr<Statement>> statements;
+  for (uint64_t i = 0; ok_ && i < num_statements; ++i) {
+    statements.push_back(ReadStatement());
+  }
+  if (!ok_)
+    return nullptr;
+  return std::make_unique<CompoundStatement>(std::move(statements));
+}
+
+std::unique_ptr<Statement> ModuleReader::ReadStatement() {
+  if (!ok_)
+    return nullptr;
+  switch (static_cast<StatementType>(ReadByte())) {
+  case StatementType::Return:
+    return std::make_unique<ReturnStatement>(ReadExpression());
+  case StatementType::Deinit:
+    return std::make_unique<DeinitStatement>(ReadExpression());
+  case StatementType::Assignment: {
+    std::unique_ptr<Expression> lhs = ReadExpression();
+    const auto assign_type = static_cast<AssignmentType>(ReadByte());
+    const Type *operation_type = ReadType();
+    auto stmt = std::make_unique<AssignmentStatement>(
+        std::move(lhs), assign_type, ReadExpression());
+    stmt->operation_type_ = operation_type;
+    return stmt;
+  }
+  case StatementType::Compound:
+    return ReadCompound();
+  case StatementType::Expression:
+    return std::make_unique<ExpressionStatement>(ReadExpression());
+  case StatementType::If: {
+    std::vector<IfBranch> branches(ReadCount());
+    for (IfBranch &branch : branches) {
+      if (!ok_)
+        return nullptr;
+      branch.condition = ReadExpression();
+      branch.body = ReadCompound();
+    }
+    return std::make_unique<IfStatement>(std::move(branches));
+  }
+  case StatementType::For: {
+    const Symbol identifier = ReadSymbol();
+    const Type *decl_type = ReadType();
+    std::unique_ptr<Expression> expression = ReadExpression();
+    return std::make_unique<ForStatement>(identifier, decl_type,
+                                          std::move(expression),
+                                          ReadCompound());
+  }
+  case StatementType::While: {
+    std::unique_ptr<Expression> condition = ReadExpression();
+    return std::make_unique<WhileStatement>(std::move(condition),
+                                            ReadCompound());
+  }
+  case StatementType::Declaration: {
+    const bool is_const = ReadByte();
+    const Symbol identifier = ReadSymbol();
+    const Type *decl_type = ReadType();
+    return std::make_unique<DeclarationStatement>(is_const, identifier,
+                                                  decl_type, ReadExpression());
+  }
+  case StatementType::Break:
+    return std::make_unique<BreakStatement>();
+  case StatementType::Continue:
+    return std::make_unique<ContinueStatement>();
+  }
+  Fail();
+  return nullptr;
+}
+
+std::unique_ptr<Expression> ModuleReader::ReadExpression() {
+  if (!ok_)
+    return nullptr;
+  const uint8_t tag = ReadByte();
+  if (tag == kNullExpression)
+    return nullptr;
+  const SourceLocation location = ReadLocation();
+  const Type *expr_type = ReadType();
+
+  std::unique_ptr<Expression> expr;
+  switch (static_cast<ExpressionType>(tag)) {
+  case ExpressionType::Ternary: {
+    std::unique_ptr<Expression> condition = ReadExpression();
+    std::unique_ptr<Expression> true_case = ReadExpression();
+    expr = std::make_unique<TernaryExpression>(location, std::move(condition),
+                                               std::move(true_case),
+                                               ReadExpression());
+    break;
+  }
+  case ExpressionType::Binary: {
+    const auto op_type = static_cast<BinaryExpressionType>(ReadByte());
+    std::unique_ptr<Expression> lhs = ReadExpression();
+    expr = std::make_unique<BinaryExpression>(location, std::move(lhs), op_type,
+                                              ReadExpression());
+    break;
+  }
+  case ExpressionType::Unary: {
+    const auto op_type = static_cast<UnaryExpressionType>(ReadByte());
+    expr = std::make_unique<UnaryExpression>(location, op_type,
+                                             ReadExpression());
+    break;
+  }
+  case ExpressionType::Call: {
+    const Symbol identifier = ReadSymbol();
+    expr = std::make_unique<CallExpression>(location, identifier,
+                                            ReadExpressions());
+    break;
+  }
+  case ExpressionType::Range: {
+    std::unique_ptr<Expression> lhs = ReadExpression();
+    expr = std::make_unique<RangeExpression>(location, std::move(lhs),
+                                             ReadExpression());
+    break;
+  }
+  case ExpressionType::Array:
+    expr = std::make_unique<ArrayExpression>(location, ReadExpressions());
+    break;
+  case ExpressionType::Cast: {
+    const Type *cast_type = ReadType();
+    expr = std::make_unique<CastExpression>(location, cast_type,
+                                            ReadExpression());
+    break;
+  }
+  case ExpressionType::Constant: {
+    ConstantExpression::data_type data;
+    switch (static_cast<ConstantTag>(ReadByte())) {
+    case ConstantTag::Dash:
+      data = DashTypeTag{};
+      break;
+    case ConstantTag::Bool:
+      data = static_cast<bool>(ReadByte());
+      break;
+    case ConstantTag::Integer:
+      data = ReadSigned();
+      break;
+    case ConstantTag::Floating: {
+      const uint64_t bits = ReadVarint();
+      double value;
+      std::memcpy(&value, &bits, sizeof(value));
+      data = value;
+      break;
+    }
+    case ConstantTag::String:
+      data = ReadSymbol();
+      break;
+    case ConstantTag::Char:
+      data = static_cast<char>(ReadByte());
+      break;
+    default:
+      Fail();
+    }
+    expr = std::make_unique<ConstantExpression>(location, std::move(data));
+    break;
+  }
+  case ExpressionType::Identifier:
+    expr = std::make_unique<IdentifierExpression>(location, ReadSymbol());
+    break;
+  case ExpressionType::MemberAccess: {
+    const bool direct = ReadByte();
+    const Symbol identifier = ReadSymbol();
+    expr = std::make_unique<MemberAccessExpression>(location, ReadExpression(),
+                                                    direct, identifier);
+    break;
+  }
+  case ExpressionType::ArrayAccess: {
+    std::unique_ptr<Expression> array = ReadExpression();
+    expr = std::make_unique<ArrayAccessExpression>(location, std::move(array),
+                                                   ReadExpression());
+    break;
+  }
+  case ExpressionType::CallOp: {
+    std::unique_ptr<Expression> callee = ReadExpression();
+    expr = std::make_unique<CallOpExpression>(location, std::move(callee),
+                                              ReadExpressions());
+    break;
+  }
+  case ExpressionType::Malloc: {
+    const Type *decl_type = ReadType();
+    expr = std::make_unique<MallocExpression>(location, decl_type,
+                                              ReadExpression());
+    break;
+  }
+  case ExpressionType::Sizeof:
+    expr = std::make_unique<SizeofExpression>(location, ReadType());
+    break;
+  default:
+    Fail();
+    return nullptr;
+  }
+  expr->set_expr_type(expr_type);
+  return expr;
+}
+
+std::vector<std::unique_ptr<Expression>> ModuleReader::ReadExpressions() {
+  const uint64_t num_expressions = ReadCount();
+  std::vector<std::unique_ptr<Expression>> expressions;
+  for (uint64_t i = 0; ok_ && i < num_expressions; ++i) {
+    expressions.push_back(ReadExpression());
+  }
+  return expressions;
+}
+
+SourceLocation ModuleReader::ReadLocation() {
+  const uint64_t location = ReadVarint();
+  if (location == 0)
+    return SourceLocation::Generated();
+  if (location == 1)
+    return SourceLocation::Complex();
+  if (location - 2 > source_.size()) {
+    Fail();
+    return SourceLocation::Generated();
+  }
+  return SourceLocation::AtOffset(source_, location - 2);
+}
+
+const Type *ModuleReader::ReadType() {
+  const uint64_t index = ReadVarint();
+  if (index > types_.size()) {
+    Fail();
+    return nullptr;
+  }
+  return index == 0 ? nullptr : types_[index - 1];
+}
+
+std::string ModuleReader::ReadString() {
+  const uint64_t size = ReadVarint();
+  if (!ok_ || size > data_.size() - position_) {
+    Fail();
+    return "";
+  }
+  std::string value(data_.substr(position_, size));
+  position_ += size;
+  return value;
+}
+
+uint64_t ModuleReader::ReadVarint() {
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    const uint8_t byte = ReadByte();
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0)
+      return value;
+  }
+  Fail();
+  return 0;
+}
+
+uint64_t ModuleReader::ReadCount() {
+  // Every element takes at least one byte, which bounds corrupt counts.
+  const uint64_t count = ReadVarint();
+  if (count > data_.size() - position_) {
+    Fail();
+    return 0;
+  }
+  return count;
+}
+
+int64_t ModuleReader::ReadSigned() {
+  const uint64_t value = ReadVarint();
+  return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+uint8_t ModuleReader::ReadByte() {
+  if (!ok_ || position_ >= data_.size()) {
+    Fail();
+    return 0;
+  }
+  return static_cast<uint8_t>(data_[position_++]);
+}
+// `ModuleReader` =======================================================
+} // namespace Cobold
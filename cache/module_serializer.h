@@ -0,0 +1,145 @@
+#ifndef COBOLD_CACHE_MODULE_SERIALIZER
+#define COBOLD_CACHE_MODULE_SERIALIZER
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "core/expression.h"
+#include "core/function.h"
+#include "core/statement.h"
+#include "core/symbol.h"
+#include "core/type.h"
+#include "parser/source_file.h"
+#include "parser/source_location.h"
+#include "parser/source_manager.h"
+#include "visitor/expression_visitor.h"
+#include "visitor/statement_visitor.h"
+#include "visitor/type_visitor.h"
+
+namespace Cobold {
+// Compact binary encoding of an (annotated) `SourceFile`. Integers are
+// LEB128 varints, strings are length prefixed. Every distinct `Type` is
+// written once into a type table (underlying types first) and referenced by
+// index from the AST. Source locations are stored as line/column and bound
+// to the source buffer again when the module is read.
+class ModuleWriter : private ExpressionVisitor<true, void>,
+                     private StatementVisitor<true>,
+                     private TypeVisitor<void> {
+public:
+  static std::string Write(const SourceFile &file);
+
+private:
+  ModuleWriter() = default;
+
+  void WriteFunction(const Function *fn);
+  void WriteCompound(const CompoundStatement *stmt);
+  void WriteLocation(const SourceLocation &location);
+  void WriteType(const Type *type);
+  void WriteString(std::string_view value);
+  // Symbols are stored as their string, their ids are only valid in-process.
+  void WriteSymbol(Symbol symbol) { WriteString(symbol.str()); }
+  void WriteVarint(uint64_t value);
+  void WriteSigned(int64_t value);
+  void WriteByte(uint8_t value);
+
+  // Returns the (1-based) index of `type` in the type table (0 for nullptr).
+  uint64_t TypeIndex(const Type *type);
+
+  // Statements
+  void DispatchReturn(const ReturnStatement *stmt) override;
+  void DispatchDeinit(const DeinitStatement *stmt) override;
+  void DispatchAssignment(const AssignmentStatement *stmt) override;
+  void DispatchCompound(const CompoundStatement *stmt) override;
+  void DispatchExpression(const ExpressionStatement *stmt) override;
+  void DispatchIf(const IfStatement *stmt) override;
+  void DispatchFor(const ForStatement *stmt) override;
+  void DispatchWhile(const WhileStatement *stmt) override;
+  void DispatchDeclaration(const DeclarationStatement *stmt) override;
+  void DispatchBreak(const BreakStatement *stmt) override;
+  void DispatchContinue(const ContinueStatement *stmt) override;
+
+  // Expressions
+  void DispatchEmpty() override;
+  void DispatchTernary(const TernaryExpression *expr) override;
+  void DispatchBinary(const BinaryExpression *expr) override;
+  void DispatchUnary(const UnaryExpression *expr) override;
+  void DispatchCall(const CallExpression *expr) override;
+  void DispatchRange(const RangeExpression *expr) override;
+  void DispatchArray(const ArrayExpression *expr) override;
+  void DispatchCast(const CastExpression *expr) override;
+  void DispatchConstant(const ConstantExpression *expr) override;
+  void DispatchIdentifier(const IdentifierExpression *expr) override;
+  void DispatchMemberAccess(const MemberAccessExpression *expr) override;
+  void DispatchArrayAccess(const ArrayAccessExpression *expr) override;
+  void DispatchCallOp(const CallOpExpression *expr) override;
+  void DispatchMalloc(const MallocExpression *expr) override;
+  void DispatchSizeof(const SizeofExpression *expr) override;
+
+  // Types (entries of the type table)
+  void DispatchNil(const NilType *type) override;
+  void DispatchDash(const DashType *type) override;
+  void DispatchBool(const BoolType *type) override;
+  void DispatchChar(const CharType *type) override;
+  void DispatchIntegral(const IntegralType *type) override;
+  void DispatchFloating(const FloatingType *type) override;
+  void DispatchString(const StringType *type) override;
+  void DispatchArray(const ArrayType *type) override;
+  void DispatchRange(const RangeType *type) override;
+  void DispatchPointer(const PointerType *type) override;
+
+  using ExpressionVisitor<true, void>::Visit;
+  using StatementVisitor<true>::Visit;
+  using TypeVisitor<void>::Visit;
+
+  std::string out_;   // the encoded AST
+  std::string types_; // the encoded type table
+  std::string *target_ = &out_;
+  absl::flat_hash_map<const Type *, uint64_t> type_indices_;
+  // The buffer of the last written location (saves looking it up per node).
+  const SourceBuffer *source_ = nullptr;
+};
+
+class ModuleReader {
+public:
+  // Reads a module written by `ModuleWriter`. `source` is the buffer the
+  // module was originally parsed from.
+  static absl::StatusOr<SourceFile> Read(std::string_view data,
+                                         const SourceBuffer &source);
+
+private:
+  ModuleReader(std::string_view data, const SourceBuffer &source)
+      : data_(data), source_(source) {}
+
+  bool ReadTypeTable();
+  std::unique_ptr<Function> ReadFunction();
+  std::unique_ptr<Statement> ReadStatement();
+  std::unique_ptr<CompoundStatement> ReadCompound();
+  std::unique_ptr<Expression> ReadExpression();
+  std::vector<std::unique_ptr<Expression>> ReadExpressions();
+  SourceLocation ReadLocation();
+  const Type *ReadType();
+  std::string ReadString();
+  Symbol ReadSymbol() { return Symbol::Intern(ReadString()); }
+  uint64_t ReadVarint();
+  uint64_t ReadCount(); // number of elements that follow
+  int64_t ReadSigned();
+  uint8_t ReadByte();
+
+  // Marks the input as corrupt, all subsequent reads return defaults.
+  void Fail() { ok_ = false; }
+
+  std::string_view data_;
+  size_t position_ = 0;
+  bool ok_ = true;
+
+  const SourceBuffer &source_;
+  std::vector<const Type *> types_;
+};
+} // namespace Cobold
+
+#endif /* COBOLD_CACHE_MODULE_SERIALIZER */
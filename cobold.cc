@@ -1,14 +1,87 @@
 #include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/status/statusor.h"
-#include "codegen/llvm_codegen.h"
-#include "codegen/llvm_type_visitor.h"
-#include "core/type.h"
-#include "parser/parser.h"
+#include "absl/strings/match.h"
+#include "codegen/optimization_level.h"
+#include "parser/internal/options.h"
+#include "session/compilation_session.h"
 
 int main(int argc, char **argv) {
-  const std::string filename = "test/simple.cb";
-  absl::StatusOr<Cobold::SourceFile> source = Cobold::Parser::Parse(filename);
-  std::cout << source.value().DebugString() << std::endl;
-  auto _ = Cobold::LLVMCodeGen::Generate(source.value());
-}
\ No newline at end of file
+  std::string filename = "test/simple.cb";
+  bool print_parser_limits = false;
+  Cobold::CompilationOptions session_options;
+  Cobold::ModuleLoaderOptions &options = session_options.loader_options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--profile-parser") {
+      options.parser_options.profile = true;
+      // Keep the reports of the individual modules apart.
+      options.num_threads = 1;
+    } else if (arg == "--streaming-parser") {
+      options.parser_options.streaming = true;
+    } else if (arg == "--print-parser-limits") {
+      print_parser_limits = true;
+    } else if (arg == "--lazy-bodies") {
+      options.parser_options.lazy_bodies = true;
+    } else if (arg == "--hand-written-parser") {
+      options.parser_options.hand_written = true;
+    } else if (arg == "--parallel-parser") {
+      options.parser_options.parallel_chunk_size =
+          Cobold::kDefaultParallelChunkSize;
+    } else if (absl::StartsWith(arg, "-O")) {
+      absl::StatusOr<Cobold::OptimizationLevel> level =
+          Cobold::ParseOptimizationLevel(arg.substr(2));
+      if (!level.ok()) {
+        std::cout << level.status().message() << std::endl;
+        return -1;
+      }
+      session_options.optimization_level = *level;
+    } else if (absl::StartsWith(arg, "--cache-dir=")) {
+      session_options.cache_directory =
+          arg.substr(std::string("--cache-dir=").size());
+    } else {
+      filename = arg;
+    }
+  }
+  Cobold::ParserLimitCounters limit_counters;
+  if (print_parser_limits)
+    options.parser_options.limit_counters = &limit_counters;
+  Cobold::CompilationSession session(std::move(session_options));
+  absl::StatusOr<std::vector<Cobold::SourceFile>> modules =
+      session.Load(filename);
+  if (print_parser_limits) {
+    const Cobold::ParserOptions &limits =
+        session.options().loader_options.parser_options;
+    std::cout << "parser limits: recursion depth "
+              << limit_counters.recursion_depth << "/"
+              << limits.max_recursion_depth << ", expression size "
+              << limit_counters.expression_size << "/"
+              << limits.expression_size_codepoint_limit << ", errors "
+              << limit_counters.errors << "/" << limits.error_recovery_limit
+              << ", error recovery lookahead "
+              << limit_counters.error_recovery_lookahead << "/"
+              << limits.error_recovery_token_lookahead_limit << std::endl;
+  }
+  if (!modules.ok()) {
+    std::cout << modules.status().message() << std::endl;
+    return -1;
+  }
+  if (absl::Status status = session.Analyze(*modules); !status.ok()) {
+    std::cout << status.message() << std::endl;
+    return -1;
+  }
+  for (const std::string &warning : session.warnings()) {
+    std::cout << "warning: " << warning << std::endl;
+  }
+  for (const Cobold::SourceFile &module : *modules) {
+    std::cout << module.DebugString() << std::endl;
+  }
+  if (absl::Status status = session.Generate(*modules); !status.ok()) {
+    std::cout << status.message() << std::endl;
+    return -1;
+  }
+}
@@ -3,11 +3,15 @@
 namespace Cobold {
 // `CoboldBuildContext` =================================================
 // `BuildContext` =======================================================
-llvm::Constant *BuildContext::AddStringConstant(std::string &value) {
+llvm::Constant *BuildContext::AddStringConstant(Symbol symbol) {
+  auto it = string_constants_.find(symbol);
+  if (it != string_constants_.end())
+    return it->second;
+  const std::string &value = symbol.str();
   llvm::Constant *ret = module_->getOrInsertGlobal(
       /*name=*/"",
       llvm::ArrayType::get(llvm::Type::getIntNTy(*context_, 8), value.size()),
-      [this, value]() {
+      [this, &value]() {
         std::vector<llvm::Constant *> chars;
         chars.reserve(value.size());
         for (const char c : value) {
@@ -23,6 +27,7 @@ llvm::Constant *BuildContext::AddStringConstant(std::string &value) {
             llvm::GlobalVariable::InternalLinkage, init, value);
         return v;
       });
+  string_constants_[symbol] = ret;
   return ret;
 }
 // `BuildContext` =======================================================
@@ -1,19 +1,23 @@
 #ifndef COBOLD_CODEGEN_COBOLD_BUILD_CONTEXT
 #define COBOLD_CODEGEN_COBOLD_BUILD_CONTEXT
 
+#include <cassert>
 #include <memory>
 #include <stack>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "core/symbol.h"
 
 #include "llvm/IR/GlobalVariable.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
-#include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 
 namespace Cobold {
+class Function;
+
 struct LoopInstructionBlock {
   llvm::BasicBlock *break_bb, *continue_bb;
 };
@@ -21,70 +25,59 @@ struct LoopInstructionBlock {
 class BuildContext {
 public:
   BuildContext() {}
-  BuildContext(std::unique_ptr<llvm::LLVMContext> &&context,
+  // `context` (owned by the `CompilationSession`) needs to outlive the
+  // build context.
+  BuildContext(llvm::LLVMContext *context,
                std::unique_ptr<llvm::Module> &&module,
-               std::unique_ptr<llvm::IRBuilder<>> &&builder,
-               std::unique_ptr<llvm::legacy::FunctionPassManager>
-                   &&function_pass_manager)
-      : context_(std::move(context)), module_(std::move(module)),
-        builder_(std::move(builder)),
-        function_pass_manager_(std::move(function_pass_manager)) {}
+               std::unique_ptr<llvm::IRBuilder<>> &&builder)
+      : context_(context), module_(std::move(module)),
+        builder_(std::move(builder)) {}
 
   llvm::LLVMContext &operator*() { return *context_; }
 
-  llvm::Constant *AddStringConstant(std::string &value);
+  // Returns the (single) global holding the characters of `value`.
+  llvm::Constant *AddStringConstant(Symbol value);
 
-  llvm::LLVMContext *llvm_context() { return context_.get(); }
+  llvm::LLVMContext *llvm_context() { return context_; }
   llvm::Module *llvm_module() { return module_.get(); }
   llvm::IRBuilder<> *llvm_builder() { return builder_.get(); }
-  llvm::legacy::FunctionPassManager *function_pass_manager() {
-    return function_pass_manager_.get();
-  }
 
   std::stack<LoopInstructionBlock> &loop_instruction_stack() {
     return loop_instruction_stack_;
   }
 
-  bool HasNamedVar(const std::string &identifier) {
-    return named_vars_.contains(identifier);
-  }
-  llvm::AllocaInst *AllocaForNamedVar(const std::string &identifier) {
-    return named_vars_[identifier];
+  // The variables of the function being generated are indexed by their slot
+  // (see `NameResolver`).
+  void BeginFunction(int num_slots) { slots_.assign(num_slots, nullptr); }
+  llvm::AllocaInst *AllocaForSlot(int slot) {
+    assert(slot >= 0 && slot < slots_.size() && slots_[slot] != nullptr);
+    return slots_[slot];
   }
-  bool PutNamedVar(const std::string &identifier, llvm::AllocaInst *alloca) {
-    if (!HasNamedVar(identifier)) {
-      named_vars_[identifier] = alloca;
-      return true;
-    }
-    return false;
+  void PutSlot(int slot, llvm::AllocaInst *alloca) {
+    assert(slot >= 0 && slot < slots_.size() && slots_[slot] == nullptr);
+    slots_[slot] = alloca;
   }
 
-  bool HasFunction(const std::string &name) {
-    return functions_.contains(name);
+  bool HasFunction(const Function *function) {
+    return functions_.contains(function);
   }
-  llvm::Function *FunctionForName(const std::string &name) {
-    return functions_[name];
+  llvm::Function *FunctionFor(const Function *function) {
+    auto it = functions_.find(function);
+    assert(it != functions_.end());
+    return it->second;
   }
-  bool PutFunction(const std::string &name, llvm::Function *function) {
-    if (!HasFunction(name)) {
-      functions_[name] = function;
-      return true;
-    }
-    return false;
+  bool PutFunction(const Function *function, llvm::Function *llvm_function) {
+    return functions_.emplace(function, llvm_function).second;
   }
 
 private:
-  std::unique_ptr<llvm::LLVMContext> context_;
+  llvm::LLVMContext *context_ = nullptr;
   std::unique_ptr<llvm::Module> module_;
   std::unique_ptr<llvm::IRBuilder<>> builder_;
 
-  // Pass Managers
-  std::unique_ptr<llvm::legacy::FunctionPassManager> function_pass_manager_;
-
-  absl::flat_hash_map<std::string, llvm::Function *> functions_;
-
-  // TODO(jlscheerer) Move this outside and into a separate class
-  absl::flat_hash_map<std::string, llvm::AllocaInst *> named_vars_;
+  absl::flat_hash_map<const Function *, llvm::Function *> functions_;
+  std::vector<llvm::AllocaInst *> slots_;
+  absl::flat_hash_map<Symbol, llvm::Constant *> string_constants_;
 
   std::stack<LoopInstructionBlock> loop_instruction_stack_;
 };
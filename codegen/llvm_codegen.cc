@@ -1,5 +1,6 @@
 #include "codegen/llvm_codegen.h"
 
+#include <cassert>
 #include <cstdlib>
 #include <memory>
 #include <mutex>
@@ -25,53 +26,69 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
 #include "llvm/IR/Type.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/MC/TargetRegistry.h"
+#include "llvm/Passes/OptimizationLevel.h"
+#include "llvm/Passes/PassBuilder.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
-#include "llvm/Transforms/InstCombine/InstCombine.h"
-#include "llvm/Transforms/Scalar.h"
-#include "llvm/Transforms/Scalar/GVN.h"
-#include "llvm/Transforms/Utils.h"
 
 namespace Cobold {
+namespace {
+llvm::OptimizationLevel PipelineLevel(OptimizationLevel level) {
+  switch (level) {
+  case OptimizationLevel::O0:
+    return llvm::OptimizationLevel::O0;
+  case OptimizationLevel::O1:
+    return llvm::OptimizationLevel::O1;
+  case OptimizationLevel::O2:
+    return llvm::OptimizationLevel::O2;
+  case OptimizationLevel::O3:
+    return llvm::OptimizationLevel::O3;
+  case OptimizationLevel::Os:
+    return llvm::OptimizationLevel::Os;
+  }
+  assert(false);
+}
+
+llvm::CodeGenOpt::Level CodeGenLevel(OptimizationLevel level) {
+  switch (level) {
+  case OptimizationLevel::O0:
+    return llvm::CodeGenOpt::None;
+  case OptimizationLevel::O1:
+    return llvm::CodeGenOpt::Less;
+  case OptimizationLevel::O2:
+  case OptimizationLevel::Os:
+    return llvm::CodeGenOpt::Default;
+  case OptimizationLevel::O3:
+    return llvm::CodeGenOpt::Aggressive;
+  }
+  assert(false);
+}
+} // namespace
+
 // `LLVMCodeGen` ========================================================
-absl::Status LLVMCodeGen::Generate(const SourceFile &file) {
-  LLVMCodeGen codegen;
-  codegen.GenerateLLVM(file);
-  return codegen.Build("output");
+absl::Status LLVMCodeGen::Generate(llvm::LLVMContext *context,
+                                   const std::vector<SourceFile> &modules,
+                                   const std::string &output,
+                                   OptimizationLevel level) {
+  LLVMCodeGen codegen(context);
+  codegen.GenerateLLVM(modules);
+  return codegen.Build(output, level);
 }
 
-LLVMCodeGen::LLVMCodeGen() {
-  auto llvm_context = std::make_unique<llvm::LLVMContext>();
+LLVMCodeGen::LLVMCodeGen(llvm::LLVMContext *llvm_context) {
   auto llvm_module =
       std::make_unique<llvm::Module>("Cobold::Module", *llvm_context);
   auto llvm_builder = std::make_unique<llvm::IRBuilder<>>(*llvm_context);
-
-  // Some optimizations on the functions.
-  // Create a new pass manager attached to it.
-  auto function_pass_manager =
-      std::make_unique<llvm::legacy::FunctionPassManager>(llvm_module.get());
-  // Promote allocas to registers.
-  function_pass_manager->add(llvm::createPromoteMemoryToRegisterPass());
-  // Do simple "peephole" optimizations and bit-twiddling optzns.
-  function_pass_manager->add(llvm::createInstructionCombiningPass());
-  // Reassociate expressions.
-  function_pass_manager->add(llvm::createReassociatePass());
-  // Eliminate Common SubExpressions.
-  function_pass_manager->add(llvm::createGVNPass());
-  // Simplify the control flow graph (deleting unreachable blocks, etc).
-  function_pass_manager->add(llvm::createCFGSimplificationPass());
-  function_pass_manager->doInitialization();
-
-  context_ =
-      BuildContext(std::move(llvm_context), std::move(llvm_module),
-                   std::move(llvm_builder), std::move(function_pass_manager));
+  context_ = BuildContext(llvm_context, std::move(llvm_module),
+                          std::move(llvm_builder));
 
   CreateBuiltinTypes();
 }
@@ -85,8 +102,11 @@ void LLVMCodeGen::CreateBuiltinTypes() {
       "string", /*isPacked=*/false);
 }
 
-void LLVMCodeGen::GenerateLLVM(const SourceFile &file) {
-  AddFunctionDeclarations(file);
+void LLVMCodeGen::GenerateLLVM(const std::vector<SourceFile> &modules) {
+  // Declare all functions first, such that calls across modules resolve.
+  for (const SourceFile &file : modules) {
+    AddFunctionDeclarations(file);
+  }
 
   // Generate the entry point for the module: int main(int argc, char **argv)
   std::vector<llvm::Type *> args{
@@ -104,78 +124,156 @@ void LLVMCodeGen::GenerateLLVM(const SourceFile &file) {
   context_.llvm_builder()->SetInsertPoint(basic_block);
 
   // Call the user provided "fn Main()"
+  assert(main_ != nullptr);
   llvm::Value *ret_value =
-      context_.llvm_builder()->CreateCall(context_.FunctionForName("Main"), {});
+      context_.llvm_builder()->CreateCall(context_.FunctionFor(main_), {});
 
   context_.llvm_builder()->CreateRet(ret_value);
   llvm::verifyFunction(*function);
 
-  AddFunctionDefinitions(file);
+  for (const SourceFile &file : modules) {
+    AddFunctionDefinitions(file);
+  }
 }
 
 void LLVMCodeGen::AddFunctionDeclarations(const SourceFile &file) {
   for (const std::unique_ptr<Function> &fn : file.functions()) {
-    // TODO(jlscheerer) Handle overloading functions.
-    std::vector<llvm::Type *> args;
-    args.reserve(fn->arguments().size());
-    for (const auto &argument : fn->arguments()) {
-      args.push_back(LLVMTypeVisitor::Translate(&context_, argument.type));
-    }
-    llvm::Type *return_type =
-        LLVMTypeVisitor::Translate(&context_, fn->return_type());
-    llvm::FunctionType *function_type =
-        llvm::FunctionType::get(return_type, args, false);
-
-    // llvm::Function::ExternalLinkage for external functions...
-    llvm::Function *function;
-    if (fn->external()) {
-      function =
-          llvm::Function::Create(function_type, llvm::Function::ExternalLinkage,
-                                 fn->name(), context_.llvm_module());
-    } else {
-      function =
-          llvm::Function::Create(function_type, llvm::Function::PrivateLinkage,
-                                 fn->name(), context_.llvm_module());
-    }
-    context_.PutFunction(fn->name(), function);
+    // Private functions without a body are invalid, unparsed bodies are
+    // unreachable anyway (see `BodyLoader`).
+    if (!fn->external() && !fn->As<DefinedFunction>()->parsed())
+      continue;
+    DeclareFunction(fn.get(), fn->external()
+                                  ? llvm::Function::ExternalLinkage
+                                  : llvm::Function::PrivateLinkage);
   }
 }
 
+void LLVMCodeGen::DeclareFunction(const Function *fn,
+                                  llvm::GlobalValue::LinkageTypes linkage) {
+  // TODO(jlscheerer) Handle overloading functions.
+  std::vector<llvm::Type *> args;
+  args.reserve(fn->arguments().size());
+  for (const auto &argument : fn->arguments()) {
+    args.push_back(LLVMTypeVisitor::Translate(&context_, argument.type));
+  }
+  llvm::Type *return_type =
+      LLVMTypeVisitor::Translate(&context_, fn->return_type());
+  llvm::FunctionType *function_type =
+      llvm::FunctionType::get(return_type, args, false);
+
+  llvm::Function *function = llvm::Function::Create(
+      function_type, linkage, fn->name().str(), context_.llvm_module());
+  context_.PutFunction(fn, function);
+  if (fn->name() == Symbol::Intern("Main"))
+    main_ = fn;
+}
+
 void LLVMCodeGen::AddFunctionDefinitions(const SourceFile &file) {
   for (const std::unique_ptr<Function> &fn : file.functions()) {
-    if (!fn->external()) {
-      llvm::Function *function = context_.FunctionForName(fn->name());
-      llvm::BasicBlock *basic_block =
-          llvm::BasicBlock::Create(*context_, "entry", function);
-      context_.llvm_builder()->SetInsertPoint(basic_block);
-
-      int index = 0; // we need to iterate over the declared and llvms args.
-      for (auto &argument : function->args()) {
-        const auto &decl_arg = fn->arguments()[index++];
-        llvm::AllocaInst *alloca = LLVMStatementVisitor::CreateEntryBlockAlloca(
-            function, decl_arg.name,
-            LLVMTypeVisitor::Translate(&context_, decl_arg.type));
-        context_.llvm_builder()->CreateStore(&argument, alloca);
-        // TODO(jlscheerer) Improve this...
-        context_.PutNamedVar(decl_arg.name, alloca);
-      }
-
-      LLVMStatementVisitor::Translate(&context_,
-                                      &fn->As<DefinedFunction>()->body());
-      llvm::verifyFunction(*function);
-
-      context_.function_pass_manager()->run(*function);
+    if (!fn->external() && fn->As<DefinedFunction>()->parsed())
+      DefineFunction(fn->As<DefinedFunction>());
+  }
+}
+
+void LLVMCodeGen::DefineFunction(const DefinedFunction *fn) {
+  llvm::Function *function = context_.FunctionFor(fn);
+  llvm::BasicBlock *basic_block =
+      llvm::BasicBlock::Create(*context_, "entry", function);
+  context_.llvm_builder()->SetInsertPoint(basic_block);
+  context_.BeginFunction(fn->num_slots());
+
+  // The arguments occupy the first slots.
+  int index = 0; // we need to iterate over the declared and llvms args.
+  for (auto &argument : function->args()) {
+    const auto &decl_arg = fn->arguments()[index];
+    llvm::AllocaInst *alloca = LLVMStatementVisitor::CreateEntryBlockAlloca(
+        function, decl_arg.name.str(),
+        LLVMTypeVisitor::Translate(&context_, decl_arg.type));
+    context_.llvm_builder()->CreateStore(&argument, alloca);
+    context_.PutSlot(index++, alloca);
+  }
+
+  LLVMStatementVisitor::Translate(&context_, &fn->body());
+  llvm::verifyFunction(*function);
+}
+
+std::string
+LLVMCodeGen::GenerateFunctionIR(llvm::LLVMContext *context,
+                                const DefinedFunction *function,
+                                const std::vector<const Function *> &callees,
+                                OptimizationLevel level) {
+  LLVMCodeGen codegen(context);
+  codegen.DeclareFunction(function, llvm::Function::ExternalLinkage);
+  llvm::Function *self = codegen.context_.FunctionFor(function);
+  for (const Function *callee : callees) {
+    // Recursive calls may be bound to a stand-in for `function` itself.
+    if (callee->name() == function->name()) {
+      codegen.context_.PutFunction(callee, self);
+    } else {
+      codegen.DeclareFunction(callee, llvm::Function::ExternalLinkage);
+    }
+  }
+  codegen.DefineFunction(function);
+  codegen.Optimize(level, /*target_machine=*/nullptr);
+  std::string ir;
+  llvm::raw_string_ostream stream(ir);
+  codegen.context_.llvm_module()->print(stream, /*AAW=*/nullptr);
+  stream.flush();
+  return ir;
+}
+
+void LLVMCodeGen::Optimize(OptimizationLevel level,
+                           llvm::TargetMachine *target_machine) {
+  // The IR is straight from the AST (every variable is an alloca etc.), but
+  // `O0` is meant to compile fast.
+  if (level == OptimizationLevel::O0)
+    return;
+  llvm::Module *module = context_.llvm_module();
+  if (level == OptimizationLevel::Os) {
+    for (llvm::Function &function : *module) {
+      if (!function.isDeclaration())
+        function.addFnAttr(llvm::Attribute::OptimizeForSize);
     }
   }
+
+  llvm::PipelineTuningOptions tuning;
+  const bool vectorize =
+      level == OptimizationLevel::O2 || level == OptimizationLevel::O3;
+  tuning.LoopVectorization = vectorize;
+  tuning.SLPVectorization = vectorize;
+  tuning.LoopInterleaving = vectorize;
+  llvm::PassBuilder builder(target_machine, tuning);
+
+  llvm::LoopAnalysisManager loop_analyses;
+  llvm::FunctionAnalysisManager function_analyses;
+  llvm::CGSCCAnalysisManager cgscc_analyses;
+  llvm::ModuleAnalysisManager module_analyses;
+  builder.registerModuleAnalyses(module_analyses);
+  builder.registerCGSCCAnalyses(cgscc_analyses);
+  builder.registerFunctionAnalyses(function_analyses);
+  builder.registerLoopAnalyses(loop_analyses);
+  builder.crossRegisterProxies(loop_analyses, function_analyses,
+                               cgscc_analyses, module_analyses);
+
+  // Includes the inliner (and the other interprocedural passes), which the
+  // per-function passes used before could not run.
+  llvm::ModulePassManager passes =
+      builder.buildPerModuleDefaultPipeline(PipelineLevel(level));
+  passes.run(*module, module_analyses);
 }
 
-absl::Status LLVMCodeGen::Emit(const std::string &filename) {
-  // Initialize the target registry etc.
-  llvm::InitializeAllTargetInfos();
-  llvm::InitializeAllTargets();
-  llvm::InitializeAllTargetMCs();
-  llvm::InitializeAllAsmParsers();
-  llvm::InitializeAllAsmPrinters();
+absl::Status LLVMCodeGen::Emit(const std::string &filename,
+                               OptimizationLevel level) {
+  // Initialize the target registry etc. (once per process, the registry is
+  // shared by all sessions).
+  static std::once_flag targets_initialized;
+  std::call_once(targets_initialized, []() {
+    llvm::InitializeAllTargetInfos();
+    llvm::InitializeAllTargets();
+    llvm::InitializeAllTargetMCs();
+    llvm::InitializeAllAsmParsers();
+    llvm::InitializeAllAsmPrinters();
+  });
 
   auto target_triple = llvm::sys::getDefaultTargetTriple();
   context_.llvm_module()->setTargetTriple(target_triple);
@@ -189,12 +287,17 @@ absl::Status LLVMCodeGen::Emit(const std::string &filename) {
   constexpr char features[] = "";
 
   llvm::TargetOptions options;
+  // FastISel is LLVM's default at `O0` already, made explicit here.
+  options.EnableFastISel = level == OptimizationLevel::O0;
   auto rm = llvm::Optional<llvm::Reloc::Model>();
-  auto target_machine =
-      target->createTargetMachine(target_triple, CPU, features, options, rm);
+  auto target_machine = target->createTargetMachine(
+      target_triple, CPU, features, options, rm, llvm::None,
+      CodeGenLevel(level));
   context_.llvm_module()->setDataLayout(target_machine->createDataLayout());
 
-  // TODO(jlscheerer) Add Function Pass Manager for Optimizations
+  // The pipeline needs the data layout and the target (e.g., for the cost
+  // model of the vectorizers).
+  Optimize(level, target_machine);
 
   std::error_code error_code;
   llvm::raw_fd_ostream out_file(filename, error_code, llvm::sys::fs::OF_None);
@@ -216,8 +319,9 @@ absl::Status LLVMCodeGen::Emit(const std::string &filename) {
   return absl::OkStatus();
 }
 
-absl::Status LLVMCodeGen::Build(const std::string &filename) {
-  absl::Status status = Emit(absl::StrCat(filename, ".o"));
+absl::Status LLVMCodeGen::Build(const std::string &filename,
+                                OptimizationLevel level) {
+  absl::Status status = Emit(absl::StrCat(filename, ".o"), level);
   if (!status.ok())
     return status;
   std::system(absl::StrCat("gcc ", absl::StrCat(filename, ".o"),
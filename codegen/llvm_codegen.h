@@ -2,29 +2,54 @@
 #define COBOLD_CODEGEN_LLVM_CODEGEN
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "codegen/build_context.h"
+#include "codegen/optimization_level.h"
 #include "parser/source_file.h"
 
 #include "absl/status/status.h"
 
+#include "llvm/Target/TargetMachine.h"
+
 namespace Cobold {
 class LLVMCodeGen {
 public:
-  static absl::Status Generate(const SourceFile &file);
+  // Generates a single executable `output` from all modules of the program.
+  // The IR is created in `context`, which is not shared with other threads.
+  static absl::Status Generate(llvm::LLVMContext *context,
+                               const std::vector<SourceFile> &modules,
+                               const std::string &output,
+                               OptimizationLevel level);
+  // The IR of `function` alone, optimized at `level`, in a module of its own
+  // that declares `callees` as external functions.
+  static std::string
+  GenerateFunctionIR(llvm::LLVMContext *context,
+                     const DefinedFunction *function,
+                     const std::vector<const Function *> &callees,
+                     OptimizationLevel level = OptimizationLevel::O1);
 
 private:
-  LLVMCodeGen();
+  explicit LLVMCodeGen(llvm::LLVMContext *context);
   void CreateBuiltinTypes();
 
-  void GenerateLLVM(const SourceFile &file);
+  void GenerateLLVM(const std::vector<SourceFile> &modules);
   void AddFunctionDeclarations(const SourceFile &file);
   void AddFunctionDefinitions(const SourceFile &file);
+  void DeclareFunction(const Function *fn,
+                       llvm::GlobalValue::LinkageTypes linkage);
+  void DefineFunction(const DefinedFunction *fn);
+
+  // Runs the default pipeline of `level` on the module, tuned for
+  // `target_machine` (if any).
+  void Optimize(OptimizationLevel level, llvm::TargetMachine *target_machine);
 
-  absl::Status Emit(const std::string &filename);
-  absl::Status Build(const std::string &filename);
+  absl::Status Emit(const std::string &filename, OptimizationLevel level);
+  absl::Status Build(const std::string &filename, OptimizationLevel level);
 
   BuildContext context_;
+  const Function *main_ = nullptr; // the user provided "fn Main()"
 };
 } // namespace Cobold
 
@@ -13,6 +13,33 @@ llvm::Value *LLVMExpressionVisitor::Translate(BuildContext *context,
   return visitor.Visit(expr);
 }
 
+llvm::Value *LLVMExpressionVisitor::TranslateAddress(BuildContext *context,
+                                                     const Expression *lvalue) {
+  if (const auto *identifier = dyn_cast<IdentifierExpression>(lvalue))
+    return context->AllocaForSlot(identifier->slot());
+  // Any other assignment is rejected by `NameResolver`.
+  const auto *unary = dyn_cast<UnaryExpression>(lvalue);
+  assert(unary != nullptr &&
+         unary->op_type() == UnaryExpressionType::DEREFERENCE);
+  return Translate(context, unary->expression());
+}
+
+llvm::Value *LLVMExpressionVisitor::TranslateBinary(
+    BuildContext *context, BinaryExpressionType op_type, const Type *type,
+    llvm::Value *lhs, llvm::Value *rhs) {
+  assert(type->type_class() == TypeClass::Integral);
+  LLVMExpressionVisitor visitor(context);
+  return visitor.IntegralBinaryExpression(op_type, lhs, rhs);
+}
+
+llvm::Value *LLVMExpressionVisitor::TranslateCast(BuildContext *context,
+                                                  llvm::Value *value,
+                                                  const Type *from_type,
+                                                  const Type *to_type) {
+  LLVMExpressionVisitor visitor(context);
+  return visitor.CastValue(value, from_type, to_type);
+}
+
 llvm::Value *LLVMExpressionVisitor::DispatchEmpty() { assert(false); }
 
 llvm::Value *
@@ -52,8 +79,7 @@ llvm::Value *LLVMExpressionVisitor::DispatchUnary(const UnaryExpression *expr) {
 }
 
 llvm::Value *LLVMExpressionVisitor::DispatchCall(const CallExpression *expr) {
-  assert(context_->HasFunction(expr->identifier()));
-  llvm::Function *function = context_->FunctionForName(expr->identifier());
+  llvm::Function *function = context_->FunctionFor(expr->function());
   std::vector<llvm::Value *> args;
   args.reserve(expr->args().size());
   for (const auto &arg : expr->args()) {
@@ -71,34 +97,8 @@ llvm::Value *LLVMExpressionVisitor::DispatchArray(const ArrayExpression *expr) {
 }
 
 llvm::Value *LLVMExpressionVisitor::DispatchCast(const CastExpression *expr) {
-  const Type *from_type = expr->expression()->expr_type();
-  TypeClass from_tc = from_type->type_class();
-  const Type *to_type = expr->cast_type();
-  TypeClass to_tc = to_type->type_class();
-
-  if (from_tc == TypeClass::Integral && to_tc == TypeClass::Integral) {
-    return context_->llvm_builder()->CreateSExtOrTrunc(
-        Visit(expr->expression()),
-        LLVMTypeVisitor::Translate(context_, expr->cast_type()));
-  } else if (from_tc == TypeClass::Integral && to_tc == TypeClass::Bool) {
-    // x != 0
-    llvm::Value *zero = llvm::ConstantInt::get(
-        **context_,
-        llvm::APInt(expr->expression()->expr_type()->As<IntegralType>()->size(),
-                    0));
-    return context_->llvm_builder()->CreateICmpNE(Visit(expr->expression()),
-                                                  zero);
-  } else if (from_tc == TypeClass::Char && to_tc == TypeClass::Integral) {
-    return context_->llvm_builder()->CreateSExtOrTrunc(
-        Visit(expr->expression()),
-        LLVMTypeVisitor::Translate(context_, expr->cast_type()));
-  } else if (from_tc == TypeClass::Pointer && to_tc == TypeClass::Pointer) {
-    return context_->llvm_builder()->CreateBitCast(
-        Visit(expr->expression()),
-        LLVMTypeVisitor::Translate(context_, expr->cast_type()),
-        "pointer_cast");
-  }
-  assert(false);
+  return CastValue(Visit(expr->expression()), expr->expression()->expr_type(),
+                   expr->cast_type());
 }
 
 llvm::Value *
@@ -109,6 +109,12 @@ LLVMExpressionVisitor::DispatchConstant(const ConstantExpression *expr) {
     return llvm::ConstantInt::get(
         **context_, llvm::APInt(expr->expr_type()->As<IntegralType>()->size(),
                                 std::get<int64_t>(expr->data()), true));
+  } else if (std::holds_alternative<double>(expr->data())) {
+    // `f32` literals are rounded once, here (see `TypeInferenceVisitor`).
+    assert(expr->expr_type()->type_class() == TypeClass::Floating);
+    return llvm::ConstantFP::get(
+        LLVMTypeVisitor::Translate(context_, expr->expr_type()),
+        std::get<double>(expr->data()));
   } else if (std::holds_alternative<bool>(expr->data())) {
     assert(expr->expr_type()->type_class() == TypeClass::Bool);
     return llvm::ConstantInt::get(
@@ -117,13 +123,13 @@ LLVMExpressionVisitor::DispatchConstant(const ConstantExpression *expr) {
     assert(expr->expr_type()->type_class() == TypeClass::Char);
     return llvm::ConstantInt::get(
         **context_, llvm::APInt(8, std::get<char>(expr->data()), true));
-  } else if (std::holds_alternative<std::string>(expr->data())) {
+  } else if (std::holds_alternative<Symbol>(expr->data())) {
     assert(expr->expr_type()->type_class() == TypeClass::String);
-    std::string str = std::get<std::string>(expr->data());
+    const Symbol str = std::get<Symbol>(expr->data());
     llvm::StructType *str_type =
         llvm::StructType::getTypeByName(**context_, "string");
     llvm::Constant *size =
-        llvm::ConstantInt::get(**context_, llvm::APInt(64, str.size(), true));
+        llvm::ConstantInt::get(**context_, llvm::APInt(64, str.str().size(), true));
     llvm::Constant *data = context_->AddStringConstant(str);
     return llvm::ConstantStruct::get(str_type, {size, data});
   }
@@ -132,11 +138,10 @@ LLVMExpressionVisitor::DispatchConstant(const ConstantExpression *expr) {
 
 llvm::Value *
 LLVMExpressionVisitor::DispatchIdentifier(const IdentifierExpression *expr) {
-  assert(context_->HasNamedVar(expr->identifier()));
-  llvm::AllocaInst *var = context_->AllocaForNamedVar(expr->identifier());
+  llvm::AllocaInst *var = context_->AllocaForSlot(expr->slot());
   return context_->llvm_builder()->CreateLoad(
       LLVMTypeVisitor::Translate(context_, expr->expr_type()), var,
-      expr->identifier().c_str());
+      expr->identifier().str());
 }
 
 llvm::Value *LLVMExpressionVisitor::DispatchMemberAccess(
@@ -164,10 +169,10 @@ LLVMExpressionVisitor::DispatchArrayAccess(const ArrayAccessExpression *expr) {
 llvm::Value *
 LLVMExpressionVisitor::DispatchCallOp(const CallOpExpression *expr) {
   assert(expr->expression()->type() == ExpressionType::Identifier);
-  const std::string &identifier =
-      expr->expression()->As<IdentifierExpression>()->identifier();
-  assert(context_->HasFunction(identifier));
-  llvm::Function *function = context_->FunctionForName(identifier);
+  const Binding &callee =
+      expr->expression()->As<IdentifierExpression>()->binding();
+  llvm::Function *function =
+      context_->FunctionFor(std::get<const Function *>(callee));
   std::vector<llvm::Value *> args;
   args.reserve(expr->args().size());
   for (const auto &arg : expr->args()) {
@@ -189,6 +194,33 @@ LLVMExpressionVisitor::DispatchSizeof(const SizeofExpression *expr) {
           LLVMTypeVisitor::Translate(context_, expr->decl_type())));
 }
 
+llvm::Value *LLVMExpressionVisitor::CastValue(llvm::Value *value,
+                                              const Type *from_type,
+                                              const Type *to_type) {
+  if (from_type == to_type)
+    return value;
+  TypeClass from_tc = from_type->type_class();
+  TypeClass to_tc = to_type->type_class();
+
+  if (from_tc == TypeClass::Integral && to_tc == TypeClass::Integral) {
+    return context_->llvm_builder()->CreateSExtOrTrunc(
+        value, LLVMTypeVisitor::Translate(context_, to_type));
+  } else if (from_tc == TypeClass::Integral && to_tc == TypeClass::Bool) {
+    // x != 0
+    llvm::Value *zero = llvm::ConstantInt::get(
+        **context_,
+        llvm::APInt(from_type->As<IntegralType>()->size(), 0));
+    return context_->llvm_builder()->CreateICmpNE(value, zero);
+  } else if (from_tc == TypeClass::Char && to_tc == TypeClass::Integral) {
+    return context_->llvm_builder()->CreateSExtOrTrunc(
+        value, LLVMTypeVisitor::Translate(context_, to_type));
+  } else if (from_tc == TypeClass::Pointer && to_tc == TypeClass::Pointer) {
+    return context_->llvm_builder()->CreateBitCast(
+        value, LLVMTypeVisitor::Translate(context_, to_type), "pointer_cast");
+  }
+  assert(false);
+}
+
 llvm::Value *LLVMExpressionVisitor::IntegralBinaryExpression(
     BinaryExpressionType op_type, llvm::Value *lhs, llvm::Value *rhs) {
   switch (op_type) {
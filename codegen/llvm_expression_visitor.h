@@ -15,6 +15,17 @@ namespace Cobold {
 class LLVMExpressionVisitor : private ExpressionVisitor<true, llvm::Value *> {
 public:
   static llvm::Value *Translate(BuildContext *context, const Expression *expr);
+  // The address `lvalue` refers to, i.e., a variable or `>>ptr`.
+  static llvm::Value *TranslateAddress(BuildContext *context,
+                                       const Expression *lvalue);
+  // Applies `op_type` to `lhs` and `rhs`, which are both of type `type`.
+  static llvm::Value *TranslateBinary(BuildContext *context,
+                                      BinaryExpressionType op_type,
+                                      const Type *type, llvm::Value *lhs,
+                                      llvm::Value *rhs);
+  static llvm::Value *TranslateCast(BuildContext *context, llvm::Value *value,
+                                    const Type *from_type,
+                                    const Type *to_type);
 
 private:
   LLVMExpressionVisitor(BuildContext *context) : context_(context) {}
@@ -36,6 +47,9 @@ private:
   llvm::Value *DispatchMalloc(const MallocExpression *expr) override;
   llvm::Value *DispatchSizeof(const SizeofExpression *expr) override;
 
+  llvm::Value *CastValue(llvm::Value *value, const Type *from_type,
+                         const Type *to_type);
+
   llvm::Value *IntegralBinaryExpression(BinaryExpressionType op_type,
                                         llvm::Value *lhs, llvm::Value *rhs);
 
@@ -17,25 +17,24 @@ void LLVMStatementVisitor::DispatchDeinit(const DeinitStatement *stmt) {
 }
 
 void LLVMStatementVisitor::DispatchAssignment(const AssignmentStatement *stmt) {
-  assert(stmt->assgn_type() == AssignmentType::EQ);
-  if (stmt->lhs()->type() == ExpressionType::Identifier) {
-    std::string identifier =
-        stmt->lhs()->As<IdentifierExpression>()->identifier();
-    assert(context_->HasNamedVar(identifier));
-
-    llvm::AllocaInst *alloca = context_->AllocaForNamedVar(identifier);
-    llvm::Value *value =
-        LLVMExpressionVisitor::Translate(context_, stmt->rhs());
-    context_->llvm_builder()->CreateStore(value, alloca);
-  } else if (stmt->lhs()->type() == ExpressionType::Unary &&
-             stmt->lhs()->As<UnaryExpression>()->op_type() ==
-                 UnaryExpressionType::DEREFERENCE) {
-    llvm::Value *value =
-        LLVMExpressionVisitor::Translate(context_, stmt->rhs());
-    context_->llvm_builder()->CreateStore(
-        value, LLVMExpressionVisitor::Translate(
-                   context_, stmt->lhs()->As<UnaryExpression>()->expression()));
+  // Evaluated exactly once, also for compound assignments.
+  llvm::Value *address =
+      LLVMExpressionVisitor::TranslateAddress(context_, stmt->lhs());
+  llvm::Value *value = LLVMExpressionVisitor::Translate(context_, stmt->rhs());
+  if (stmt->compound()) {
+    const Type *lhs_type = stmt->lhs()->expr_type();
+    const Type *operation_type = stmt->operation_type();
+    llvm::Value *current = context_->llvm_builder()->CreateLoad(
+        LLVMTypeVisitor::Translate(context_, lhs_type), address);
+    current = LLVMExpressionVisitor::TranslateCast(context_, current, lhs_type,
+                                                   operation_type);
+    value = LLVMExpressionVisitor::TranslateBinary(
+        context_, AssignmentStatement::OperatorOf(stmt->assgn_type()),
+        operation_type, current, value);
+    value = LLVMExpressionVisitor::TranslateCast(context_, value,
+                                                 operation_type, lhs_type);
   }
+  context_->llvm_builder()->CreateStore(value, address);
 }
 
 void LLVMStatementVisitor::DispatchCompound(const CompoundStatement *stmt) {
@@ -95,10 +94,10 @@ void LLVMStatementVisitor::DispatchFor(const ForStatement *stmt) {
 
   llvm::AllocaInst *alloca = CreateEntryBlockAlloca(
       context_->llvm_builder()->GetInsertBlock()->getParent(),
-      stmt->identifier(),
+      stmt->identifier().str(),
       LLVMTypeVisitor::Translate(context_, stmt->decl_type()));
 
-  context_->PutNamedVar(stmt->identifier(), alloca);
+  context_->PutSlot(stmt->slot(), alloca);
 
   // TODO(jlscheerer) Generalize this.
   assert(stmt->expression()->expr_type()->type_class() == TypeClass::Range);
@@ -139,7 +138,7 @@ void LLVMStatementVisitor::DispatchFor(const ForStatement *stmt) {
   // *alloca >= end ?
   llvm::Value *end_cond = context_->llvm_builder()->CreateICmpUGE(
       end, context_->llvm_builder()->CreateLoad(
-               alloca->getAllocatedType(), alloca, stmt->identifier().c_str()));
+               alloca->getAllocatedType(), alloca, stmt->identifier().str()));
 
   // Branch based on the computed condition
   context_->llvm_builder()->CreateCondBr(end_cond, loop_body, after_loop);
@@ -161,7 +160,7 @@ void LLVMStatementVisitor::DispatchFor(const ForStatement *stmt) {
   // Reload, increment, and restore the alloca.  This handles the case where
   // the body of the loop mutates the variable.
   llvm::Value *current = context_->llvm_builder()->CreateLoad(
-      alloca->getAllocatedType(), alloca, stmt->identifier().c_str());
+      alloca->getAllocatedType(), alloca, stmt->identifier().str());
   llvm::Value *next = context_->llvm_builder()->CreateAdd(
       current, step_increment, "next_loop_var");
   context_->llvm_builder()->CreateStore(next, alloca);
@@ -212,12 +211,9 @@ void LLVMStatementVisitor::DispatchDeclaration(
     const DeclarationStatement *stmt) {
   llvm::AllocaInst *alloca = CreateEntryBlockAlloca(
       context_->llvm_builder()->GetInsertBlock()->getParent(),
-      stmt->identifier(),
+      stmt->identifier().str(),
       LLVMTypeVisitor::Translate(context_, stmt->decl_type()));
 
-  // TODO(jlscheerer) Clean this up.
-  assert(!context_->HasNamedVar(stmt->identifier()));
-
   if (stmt->expression()->expr_type()->type_class() == TypeClass::Dash) {
     // we only need to do initialization for "complex" types here.
     // TODO(jlscheerer) move these semantics into the type.
@@ -232,7 +228,7 @@ void LLVMStatementVisitor::DispatchDeclaration(
         LLVMExpressionVisitor::Translate(context_, stmt->expression()), alloca);
   }
 
-  context_->PutNamedVar(stmt->identifier(), alloca);
+  context_->PutSlot(stmt->slot(), alloca);
 }
 
 void LLVMStatementVisitor::DispatchBreak(const BreakStatement *stmt) {
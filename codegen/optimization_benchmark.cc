@@ -0,0 +1,93 @@
+// Compares the optimization levels (see `OptimizationLevel`) by the time to
+// generate the executable of a program and the time it runs:
+//
+//   bazel run -c opt //codegen:optimization_benchmark -- test/example.cb [runs]
+//
+// Linking needs `std/bin/cobold_io.o` (see `LLVMCodeGen::Build`), i.e., the
+// benchmark runs in the root of the workspace.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "codegen/optimization_level.h"
+#include "parser/source_file.h"
+#include "session/compilation_session.h"
+
+namespace Cobold {
+namespace {
+struct Measurement {
+  double compile_ms = 0;
+  double run_ms = 0;
+};
+
+absl::StatusOr<Measurement> Measure(const std::string &filename,
+                                    OptimizationLevel level, int runs) {
+  CompilationOptions options;
+  options.optimization_level = level;
+  const std::string output =
+      absl::StrCat("cobold_benchmark", OptimizationLevelName(level));
+  options.output = (std::filesystem::temp_directory_path() / output).string();
+  CompilationSession session(std::move(options));
+  absl::StatusOr<std::vector<SourceFile>> modules = session.Load(filename);
+  if (!modules.ok())
+    return modules.status();
+  if (absl::Status status = session.Analyze(*modules); !status.ok())
+    return status;
+
+  // Code generation (incl. the pipeline and linking) is all that differs.
+  Measurement measurement;
+  const auto start = std::chrono::steady_clock::now();
+  if (absl::Status status = session.Generate(*modules); !status.ok())
+    return status;
+  const auto generated = std::chrono::steady_clock::now();
+  measurement.compile_ms =
+      std::chrono::duration<double, std::milli>(generated - start).count();
+
+  const std::string command =
+      absl::StrCat(session.options().output, " > /dev/null");
+  for (int i = 0; i < runs; ++i) {
+    const auto run_start = std::chrono::steady_clock::now();
+    std::system(command.c_str());
+    const auto run_end = std::chrono::steady_clock::now();
+    measurement.run_ms +=
+        std::chrono::duration<double, std::milli>(run_end - run_start).count();
+  }
+  measurement.run_ms /= runs;
+  return measurement;
+}
+} // namespace
+} // namespace Cobold
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <file.cb> [runs]" << std::endl;
+    return 2;
+  }
+  const int runs = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10;
+  if (const char *workspace = std::getenv("BUILD_WORKSPACE_DIRECTORY"))
+    std::filesystem::current_path(workspace);
+
+  std::cout << argv[1] << " (" << runs << " runs)" << std::endl;
+  for (Cobold::OptimizationLevel level :
+       {Cobold::OptimizationLevel::O0, Cobold::OptimizationLevel::O1,
+        Cobold::OptimizationLevel::O2, Cobold::OptimizationLevel::O3,
+        Cobold::OptimizationLevel::Os}) {
+    absl::StatusOr<Cobold::Measurement> measurement =
+        Cobold::Measure(argv[1], level, runs);
+    if (!measurement.ok()) {
+      std::cerr << measurement.status().message() << std::endl;
+      return 1;
+    }
+    std::cout << Cobold::OptimizationLevelName(level) << ": compile "
+              << measurement->compile_ms << " ms, run " << measurement->run_ms
+              << " ms" << std::endl;
+  }
+}
@@ -0,0 +1,38 @@
+#include "codegen/optimization_level.h"
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+
+namespace Cobold {
+absl::StatusOr<OptimizationLevel>
+ParseOptimizationLevel(const std::string &name) {
+  if (name == "0")
+    return OptimizationLevel::O0;
+  if (name == "1")
+    return OptimizationLevel::O1;
+  if (name == "2")
+    return OptimizationLevel::O2;
+  if (name == "3")
+    return OptimizationLevel::O3;
+  if (name == "s")
+    return OptimizationLevel::Os;
+  return absl::InvalidArgumentError(
+      absl::StrCat("unknown optimization level '-O", name, "'"));
+}
+
+const char *OptimizationLevelName(OptimizationLevel level) {
+  switch (level) {
+  case OptimizationLevel::O0:
+    return "-O0";
+  case OptimizationLevel::O1:
+    return "-O1";
+  case OptimizationLevel::O2:
+    return "-O2";
+  case OptimizationLevel::O3:
+    return "-O3";
+  case OptimizationLevel::Os:
+    return "-Os";
+  }
+  return "";
+}
+} // namespace Cobold
@@ -0,0 +1,25 @@
+#ifndef COBOLD_CODEGEN_OPTIMIZATION_LEVEL
+#define COBOLD_CODEGEN_OPTIMIZATION_LEVEL
+
+#include <string>
+
+#include "absl/status/statusor.h"
+
+namespace Cobold {
+// Selects the LLVM pipeline run on the generated module (see
+// `LLVMCodeGen::Optimize`) and the code generator's level.
+enum class OptimizationLevel {
+  O0, // no optimization, FastISel (fastest to compile)
+  O1,
+  O2, // adds loop and SLP vectorization
+  O3,
+  Os, // like `O2`, but optimizes for size
+};
+
+// Parses the argument of `-O` (i.e., "0", "1", "2", "3" or "s").
+absl::StatusOr<OptimizationLevel>
+ParseOptimizationLevel(const std::string &name);
+const char *OptimizationLevelName(OptimizationLevel level);
+} // namespace Cobold
+
+#endif /* COBOLD_CODEGEN_OPTIMIZATION_LEVEL */
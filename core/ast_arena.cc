@@ -0,0 +1,84 @@
+#include "core/ast_arena.h"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+namespace Cobold {
+namespace {
+thread_local AstArena *current_arena = nullptr;
+
+// Precedes every `ArenaAllocated` node.
+struct NodeHeader {
+  uintptr_t in_arena;
+};
+static_assert(sizeof(NodeHeader) == ArenaAllocated::kAlignment);
+
+size_t AlignUp(size_t size) {
+  return (size + ArenaAllocated::kAlignment - 1) &
+         ~(ArenaAllocated::kAlignment - 1);
+}
+} // namespace
+
+// `AstArena` ===========================================================
+void *AstArena::Allocate(size_t size) {
+  size = AlignUp(size);
+  if (static_cast<size_t>(end_ - position_) < size) {
+    // Oversized nodes (there are none in practice) get a block of their own.
+    const size_t block_size = std::max(next_block_size_, size);
+    blocks_.push_back(std::make_unique<char[]>(block_size));
+    position_ = blocks_.back().get();
+    end_ = position_ + block_size;
+    next_block_size_ = std::min(next_block_size_ * 2, kMaxBlockSize);
+  }
+  void *ptr = position_;
+  position_ += size;
+  ++allocations_;
+  bytes_allocated_ += size;
+  return ptr;
+}
+
+void AstArena::Merge(AstArena *other) {
+  // Keep allocating from our current block, the rest of `other`'s last block
+  // is wasted.
+  for (std::unique_ptr<char[]> &block : other->blocks_) {
+    blocks_.push_back(std::move(block));
+  }
+  allocations_ += other->allocations_;
+  bytes_allocated_ += other->bytes_allocated_;
+  other->blocks_.clear();
+  other->position_ = other->end_ = nullptr;
+  other->allocations_ = 0;
+  other->bytes_allocated_ = 0;
+}
+
+AstArena::Scope::Scope(AstArena *arena) : previous_(current_arena) {
+  current_arena = arena;
+}
+
+AstArena::Scope::~Scope() { current_arena = previous_; }
+
+AstArena *AstArena::Current() { return current_arena; }
+// `AstArena` ===========================================================
+
+// `ArenaAllocated` =====================================================
+void *ArenaAllocated::operator new(size_t size) {
+  AstArena *arena = AstArena::Current();
+  void *memory = arena != nullptr
+                     ? arena->Allocate(sizeof(NodeHeader) + size)
+                     : ::operator new(sizeof(NodeHeader) + size);
+  NodeHeader *header = static_cast<NodeHeader *>(memory);
+  header->in_arena = arena != nullptr;
+  return header + 1;
+}
+
+void ArenaAllocated::operator delete(void *ptr) {
+  if (ptr == nullptr)
+    return;
+  NodeHeader *header = static_cast<NodeHeader *>(ptr) - 1;
+  // Arena memory is released together with the arena.
+  if (!header->in_arena)
+    ::operator delete(header);
+}
+// `ArenaAllocated` =====================================================
+} // namespace Cobold
@@ -0,0 +1,74 @@
+#ifndef COBOLD_CORE_AST_ARENA
+#define COBOLD_CORE_AST_ARENA
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Cobold {
+// Bump-pointer allocator for the AST nodes of a `SourceFile`. Nodes created
+// while a `Scope` is active on the current thread are allocated from its arena
+// (see `ArenaAllocated`), deleting them does not free anything. All blocks are
+// released at once when the arena is destroyed, i.e., the arena needs to
+// outlive every node allocated from it. Not thread-safe.
+class AstArena {
+public:
+  AstArena() = default;
+  AstArena(const AstArena &) = delete;
+  AstArena &operator=(const AstArena &) = delete;
+
+  // Returns `size` bytes aligned to `ArenaAllocated::kAlignment`.
+  void *Allocate(size_t size);
+
+  // Takes over the blocks of `other` (e.g., of a chunk parsed on another
+  // thread), which is empty afterwards.
+  void Merge(AstArena *other);
+
+  int64_t allocations() const { return allocations_; }
+  size_t bytes_allocated() const { return bytes_allocated_; }
+  size_t num_blocks() const { return blocks_.size(); }
+
+  // Allocates the AST nodes created on the current thread from `arena` (or
+  // from the heap if `nullptr`) until destroyed. Scopes nest.
+  class Scope {
+  public:
+    explicit Scope(AstArena *arena);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    AstArena *previous_;
+  };
+  static AstArena *Current();
+
+private:
+  static constexpr size_t kMinBlockSize = 16 * 1024;
+  static constexpr size_t kMaxBlockSize = 1024 * 1024;
+
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char *position_ = nullptr;
+  char *end_ = nullptr;
+  size_t next_block_size_ = kMinBlockSize;
+
+  int64_t allocations_ = 0;
+  size_t bytes_allocated_ = 0;
+};
+
+// Common base of `Expression` and `Statement`, allocates from
+// `AstArena::Current()` if there is one and from the heap otherwise. Every
+// node is prefixed with a header that tells `operator delete` where it came
+// from, such that nodes of either kind can be mixed within a tree.
+class ArenaAllocated {
+public:
+  // No AST node needs more than pointer alignment.
+  static constexpr size_t kAlignment = alignof(void *);
+
+  static void *operator new(size_t size);
+  static void operator delete(void *ptr);
+};
+} // namespace Cobold
+
+#endif /* COBOLD_CORE_AST_ARENA */
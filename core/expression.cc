@@ -99,7 +99,8 @@ ConstantExpression::String(SourceLocation location, const std::string &value) {
   std::string parsed_string, error;
   absl::CUnescape(value.substr(1, value.size() - 2), &parsed_string, &error);
   assert(error.size() == 0);
-  return std::make_unique<ConstantExpression>(location, parsed_string);
+  return std::make_unique<ConstantExpression>(location,
+                                              Symbol::Intern(parsed_string));
 }
 
 absl::StatusOr<std::unique_ptr<ConstantExpression>>
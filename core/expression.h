@@ -9,11 +9,24 @@
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "core/ast_arena.h"
+#include "core/symbol.h"
 #include "core/type.h"
 #include "parser/source_location.h"
+#include "util/casting.h"
 #include "util/type_traits.h"
 
 namespace Cobold {
+class DeclarationStatement;
+class Function;
+struct FunctionArgument;
+
+// The declaration an identifier refers to (see `NameResolver`): a local
+// variable (including the variable of a `for`), an argument of the enclosing
+// function or a function.
+using Binding = std::variant<std::monostate, const DeclarationStatement *,
+                             const FunctionArgument *, const Function *>;
+
 enum class ExpressionType {
   Ternary,      // x ? a : b
   Binary,       // a + b, a == b
@@ -30,25 +43,16 @@ enum class ExpressionType {
   Malloc,       // malloc(i32)(...)
   Sizeof,       // sizeof(i32)
 };
-class Expression {
+class Expression : public ArenaAllocated {
 public:
-  Expression(SourceLocation location) : location_(location) {}
+  Expression(ExpressionType type, SourceLocation location)
+      : type_(type), location_(location) {}
 
-  template <typename T> const T *As() const {
-    static_assert(std::is_base_of_v<Expression, T>,
-                  "Attempting to cast to non-derived class.");
-    // TODO(jlscheerer) check for `nullptr`
-    return dynamic_cast<const T *>(this);
-  }
+  // Same as `cast<T>(this)`, i.e., never `nullptr` (see `dyn_cast`).
+  template <typename T> const T *As() const { return cast<T>(this); }
+  template <typename T> T *As() { return cast<T>(this); }
 
-  template <typename T> T *As() {
-    static_assert(std::is_base_of_v<Expression, T>,
-                  "Attempting to cast to non-derived class.");
-    // TODO(jlscheerer) check for `nullptr`
-    return dynamic_cast<T *>(this);
-  }
-
-  virtual const ExpressionType type() const = 0;
+  const ExpressionType type() const { return type_; }
   virtual std::unique_ptr<Expression> Clone() const = 0;
 
   const SourceLocation location() const { return location_; }
@@ -67,13 +71,17 @@ protected:
     return cloned_args;
   }
 
+  const ExpressionType type_;
   SourceLocation location_;
 
 private:
   void set_expr_type(const Type *type) { expr_type_ = type; }
+  void set_location(SourceLocation location) { location_ = location; }
 
-  const Type *expr_type_;
+  const Type *expr_type_ = nullptr; // set by type inference
 
+  friend class ModuleReader;
+  friend class SourceLocationRebaser;
   friend class TypeInferenceVisitor;
 };
 
@@ -83,7 +91,8 @@ public:
                     std::unique_ptr<Expression> &&condition,
                     std::unique_ptr<Expression> &&true_case,
                     std::unique_ptr<Expression> &&false_case)
-      : Expression(location), condition_(std::move(condition)),
+      : Expression(ExpressionType::Ternary, location),
+        condition_(std::move(condition)),
         true_case_(std::move(true_case)), false_case_(std::move(false_case)) {}
 
   const Expression *condition() const { return condition_.get(); }
@@ -95,8 +104,8 @@ public:
   const Expression *false_case() const { return false_case_.get(); }
   Expression *mutable_false_case() { return false_case_.get(); }
 
-  virtual const ExpressionType type() const override {
-    return ExpressionType::Ternary;
+  static bool classof(const Expression *expr) {
+    return expr->type() == ExpressionType::Ternary;
   }
   std::unique_ptr<Expression> Clone() const override {
     return std::make_unique<TernaryExpression>(location_, condition_->Clone(),
@@ -134,7 +143,8 @@ public:
   BinaryExpression(SourceLocation location, std::unique_ptr<Expression> &&lhs,
                    BinaryExpressionType op_type,
                    std::unique_ptr<Expression> &&rhs)
-      : Expression(location), lhs_(std::move(lhs)), rhs_(std::move(rhs)),
+      : Expression(ExpressionType::Binary, location),
+        lhs_(std::move(lhs)), rhs_(std::move(rhs)),
         op_type_(op_type) {}
 
   const Expression *lhs() const { return lhs_.get(); }
@@ -147,8 +157,8 @@ public:
 
   static BinaryExpressionType TypeFromString(const std::string &type);
 
-  virtual const ExpressionType type() const override {
-    return ExpressionType::Binary;
+  static bool classof(const Expression *expr) {
+    return expr->type() == ExpressionType::Binary;
   }
   std::unique_ptr<Expression> Clone() const override {
     return std::make_unique<BinaryExpression>(location_, lhs_->Clone(),
@@ -179,7 +189,8 @@ class UnaryExpression : public Expression {
 public:
   UnaryExpression(SourceLocation location, UnaryExpressionType op_type,
                   std::unique_ptr<Expression> &&expr)
-      : Expression(location), op_type_(op_type), expr_(std::move(expr)) {}
+      : Expression(ExpressionType::Unary, location),
+        op_type_(op_type), expr_(std::move(expr)) {}
 
   const UnaryExpressionType op_type() const { return op_type_; }
   const Expression *expression() const { return expr_.get(); }
@@ -187,8 +198,8 @@ public:
 
   static UnaryExpressionType TypeFromPrefixString(const std::string &type);
 
-  virtual const ExpressionType type() const override {
-    return ExpressionType::Unary;
+  static bool classof(const Expression *expr) {
+    return expr->type() == ExpressionType::Unary;
   }
   std::unique_ptr<Expression> Clone() const override {
     return std::make_unique<UnaryExpression>(location_, op_type_,
@@ -202,31 +213,39 @@ private:
 
 class CallExpression : public Expression {
 public:
-  CallExpression(SourceLocation location, std::string identifier,
+  CallExpression(SourceLocation location, Symbol identifier,
                  std::vector<std::unique_ptr<Expression>> &&args)
-      : Expression(location), identifier_(std::move(identifier)),
+      : Expression(ExpressionType::Call, location), identifier_(identifier),
         args_(std::move(args)) {}
 
-  const std::string &identifier() const { return identifier_; }
+  Symbol identifier() const { return identifier_; }
   const std::vector<std::unique_ptr<Expression>> &args() const { return args_; }
-  virtual const ExpressionType type() const override {
-    return ExpressionType::Call;
+  // The called function, set by `NameResolver`.
+  const Function *function() const { return function_; }
+  static bool classof(const Expression *expr) {
+    return expr->type() == ExpressionType::Call;
   }
   std::unique_ptr<Expression> Clone() const override {
-    return std::make_unique<CallExpression>(location_, identifier_,
-                                            CloneVector(args_));
+    auto clone = std::make_unique<CallExpression>(location_, identifier_,
+                                                  CloneVector(args_));
+    clone->function_ = function_;
+    return clone;
   }
 
 private:
-  std::string identifier_;
+  Symbol identifier_;
   std::vector<std::unique_ptr<Expression>> args_;
+  const Function *function_ = nullptr;
+
+  friend class NameResolver;
 };
 
 class RangeExpression : public Expression {
 public:
   RangeExpression(SourceLocation location, std::unique_ptr<Expression> &&lhs,
                   std::unique_ptr<Expression> &&rhs)
-      : Expression(location), lhs_(std::move(lhs)), rhs_(std::move(rhs)) {}
+      : Expression(ExpressionType::Range, location),
+        lhs_(std::move(lhs)), rhs_(std::move(rhs)) {}
 
   const bool left_bounded() const {
     return lhs() != nullptr && rhs() == nullptr;
@@ -242,8 +261,8 @@ public:
   const Expression *rhs() const { return rhs_.get(); }
   Expression *mutable_rhs() { return rhs_.get(); }
 
-  virtual const ExpressionType type() const override {
-    return ExpressionType::Range;
+  static bool classof(const Expression *expr) {
+    return expr->type() == ExpressionType::Range;
   }
   std::unique_ptr<Expression> Clone() const override {
     return std::make_unique<RangeExpression>(location_,
@@ -259,7 +278,8 @@ class ArrayExpression : public Expression {
 public:
   ArrayExpression(SourceLocation location,
                   std::vector<std::unique_ptr<Expression>> &&elements)
-      : Expression(location), elements_(std::move(elements)) {}
+      : Expression(ExpressionType::Array, location),
+        elements_(std::move(elements)) {}
 
   const std::vector<std::unique_ptr<Expression>> &elements() const {
     return elements_;
@@ -267,8 +287,8 @@ public:
   std::vector<std::unique_ptr<Expression>> &mutable_elements() {
     return elements_;
   }
-  virtual const ExpressionType type() const override {
-    return ExpressionType::Array;
+  static bool classof(const Expression *expr) {
+    return expr->type() == ExpressionType::Array;
   }
   std::unique_ptr<Expression> Clone() const override {
     return std::make_unique<ArrayExpression>(location_, CloneVector(elements_));
@@ -282,13 +302,14 @@ class CastExpression : public Expression {
 public:
   CastExpression(SourceLocation location, const Type *cast_type,
                  std::unique_ptr<Expression> &&expr)
-      : Expression(location), cast_type_(cast_type), expr_(std::move(expr)) {}
+      : Expression(ExpressionType::Cast, location),
+        cast_type_(cast_type), expr_(std::move(expr)) {}
 
   const Type *cast_type() const { return cast_type_; }
   const Expression *expression() const { return expr_.get(); }
   Expression *mutable_expression() { return expr_.get(); }
-  virtual const ExpressionType type() const override {
-    return ExpressionType::Cast;
+  static bool classof(const Expression *expr) {
+    return expr->type() == ExpressionType::Cast;
   }
   std::unique_ptr<Expression> Clone() const override {
     return std::make_unique<CastExpression>(location_, cast_type_,
@@ -298,6 +319,8 @@ public:
 private:
   const Type *cast_type_;
   std::unique_ptr<Expression> expr_;
+
+  friend class TypeInferenceVisitor;
 };
 
 struct DashTypeTag {};
@@ -305,10 +328,10 @@ struct DashTypeTag {};
 class ConstantExpression : public Expression {
 public:
   using data_type =
-      std::variant<DashTypeTag, bool, int64_t, double, std::string, char>;
+      std::variant<DashTypeTag, bool, int64_t, double, Symbol, char>;
 
   ConstantExpression(SourceLocation location, data_type data)
-      : Expression(location), data_(data) {}
+      : Expression(ExpressionType::Constant, location), data_(data) {}
   const data_type &data() const { return data_; }
 
   static std::unique_ptr<ConstantExpression> True(SourceLocation location) {
@@ -334,8 +357,8 @@ public:
   static absl::StatusOr<std::unique_ptr<ConstantExpression>>
   Floating(SourceLocation location, const std::string &value);
 
-  virtual const ExpressionType type() const override {
-    return ExpressionType::Constant;
+  static bool classof(const Expression *expr) {
+    return expr->type() == ExpressionType::Constant;
   }
   std::unique_ptr<Expression> Clone() const override {
     return std::make_unique<ConstantExpression>(location_, data_);
@@ -347,35 +370,49 @@ private:
 
 class IdentifierExpression : public Expression {
 public:
-  IdentifierExpression(SourceLocation location, const std::string &identifier)
-      : Expression(location), identifier_(identifier) {}
+  IdentifierExpression(SourceLocation location, Symbol identifier)
+      : Expression(ExpressionType::Identifier, location),
+        identifier_(identifier) {}
 
-  const std::string identifier() const { return identifier_; }
-  virtual const ExpressionType type() const override {
-    return ExpressionType::Identifier;
-  }
+  Symbol identifier() const { return identifier_; }
+  // Set by `NameResolver`. Only the callee of a `CallOpExpression` is bound
+  // to a `Function`.
+  const Binding &binding() const { return binding_; }
+  // Index of the bound variable within its function (see
+  // `DefinedFunction::num_slots`), -1 if bound to a function.
+  int slot() const { return slot_; }
+  static bool classof(const Expression *expr) {
+    return expr->type() == ExpressionType::Identifier;
+  }
+  // Unresolved, like a freshly parsed identifier.
   std::unique_ptr<Expression> Clone() const override {
     return std::make_unique<IdentifierExpression>(location_, identifier_);
   }
 
 private:
-  std::string identifier_;
+  Symbol identifier_;
+  Binding binding_;
+  int slot_ = -1;
+
+  friend class NameResolver;
 };
 
 class MemberAccessExpression : public Expression {
 public:
   MemberAccessExpression(SourceLocation location,
                          std::unique_ptr<Expression> &&expr, bool direct,
-                         const std::string &identifier)
-      : Expression(location), expr_(std::move(expr)), direct_(direct),
+                         Symbol identifier)
+      : Expression(ExpressionType::MemberAccess, location),
+        expr_(std::move(expr)), direct_(direct),
         identifier_(identifier) {}
 
   const Expression *expression() const { return expr_.get(); }
+  Expression *mutable_expression() { return expr_.get(); }
   const bool direct() const { return direct_; }
-  const std::string &identifier() const { return identifier_; }
+  Symbol identifier() const { return identifier_; }
 
-  virtual const ExpressionType type() const override {
-    return ExpressionType::MemberAccess;
+  static bool classof(const Expression *expr) {
+    return expr->type() == ExpressionType::MemberAccess;
   }
   std::unique_ptr<Expression> Clone() const override {
     return std::make_unique<MemberAccessExpression>(location_, expr_->Clone(),
@@ -385,7 +422,7 @@ public:
 private:
   std::unique_ptr<Expression> expr_;
   bool direct_; //  "->" -> !direct_, "." -> direct
-  std::string identifier_;
+  Symbol identifier_;
 };
 
 class ArrayAccessExpression : public Expression {
@@ -393,7 +430,8 @@ public:
   ArrayAccessExpression(SourceLocation location,
                         std::unique_ptr<Expression> &&expr,
                         std::unique_ptr<Expression> &&index)
-      : Expression(location), expr_(std::move(expr)), index_(std::move(index)) {
+      : Expression(ExpressionType::ArrayAccess, location),
+        expr_(std::move(expr)), index_(std::move(index)) {
   }
 
   const Expression *expression() const { return expr_.get(); }
@@ -401,8 +439,8 @@ public:
   const Expression *index() const { return index_.get(); }
   Expression *mutable_index() { return index_.get(); }
 
-  virtual const ExpressionType type() const override {
-    return ExpressionType::ArrayAccess;
+  static bool classof(const Expression *expr) {
+    return expr->type() == ExpressionType::ArrayAccess;
   }
   std::unique_ptr<Expression> Clone() const override {
     return std::make_unique<ArrayAccessExpression>(location_, expr_->Clone(),
@@ -417,14 +455,16 @@ class CallOpExpression : public Expression {
 public:
   CallOpExpression(SourceLocation location, std::unique_ptr<Expression> &&expr,
                    std::vector<std::unique_ptr<Expression>> &&args)
-      : Expression(location), expr_(std::move(expr)), args_(std::move(args)) {}
+      : Expression(ExpressionType::CallOp, location),
+        expr_(std::move(expr)), args_(std::move(args)) {}
 
   const Expression *expression() const { return expr_.get(); }
+  Expression *mutable_expression() { return expr_.get(); }
   const std::vector<std::unique_ptr<Expression>> &args() const { return args_; }
   std::vector<std::unique_ptr<Expression>> &mutable_args() { return args_; }
 
-  virtual const ExpressionType type() const override {
-    return ExpressionType::CallOp;
+  static bool classof(const Expression *expr) {
+    return expr->type() == ExpressionType::CallOp;
   }
   std::unique_ptr<Expression> Clone() const override {
     return std::make_unique<CallOpExpression>(location_, expr_->Clone(),
@@ -440,14 +480,15 @@ class MallocExpression : public Expression {
 public:
   MallocExpression(SourceLocation location, const Type *type,
                    std::unique_ptr<Expression> &&expr)
-      : Expression(location), decl_type_(type), expr_(std::move(expr)) {}
+      : Expression(ExpressionType::Malloc, location),
+        decl_type_(type), expr_(std::move(expr)) {}
 
   const Type *decl_type() const { return decl_type_; }
   const Expression *expression() const { return expr_.get(); }
   Expression *mutable_expression() { return expr_.get(); }
 
-  virtual const ExpressionType type() const override {
-    return ExpressionType::Malloc;
+  static bool classof(const Expression *expr) {
+    return expr->type() == ExpressionType::Malloc;
   }
   std::unique_ptr<Expression> Clone() const override {
     return std::make_unique<MallocExpression>(location_, decl_type_,
@@ -464,11 +505,11 @@ private:
 class SizeofExpression : public Expression {
 public:
   SizeofExpression(SourceLocation location, const Type *type)
-      : Expression(location), decl_type_(type) {}
+      : Expression(ExpressionType::Sizeof, location), decl_type_(type) {}
 
   const Type *decl_type() const { return decl_type_; }
-  virtual const ExpressionType type() const override {
-    return ExpressionType::Sizeof;
+  static bool classof(const Expression *expr) {
+    return expr->type() == ExpressionType::Sizeof;
   }
   std::unique_ptr<Expression> Clone() const override {
     return std::make_unique<SizeofExpression>(location_, decl_type_);
@@ -0,0 +1,324 @@
+#include "core/flat_ast.h"
+
+#include <cassert>
+
+#include "visitor/expression_visitor.h"
+#include "visitor/statement_visitor.h"
+
+namespace Cobold {
+// Appends the nodes of a pointer-based tree in pre-order, i.e., a node comes
+// before its children and siblings are adjacent, which is the order the
+// traversals walk them in.
+class FlatAstBuilder : private ExpressionVisitor<true, NodeIndex>,
+                       private StatementVisitor<true> {
+public:
+  explicit FlatAstBuilder(FlatAst *ast) : ast_(ast) {}
+
+  NodeIndex Build(const CompoundStatement &body) {
+    StatementVisitor::Visit(&body);
+    return last_statement_;
+  }
+
+private:
+  template <typename T>
+  NodeIndex AddExpression(const Expression *expr, T payload = T{}) {
+    std::vector<T> &payloads = ast_->PayloadsOf<T>();
+    const NodeIndex index = ast_->expressions_.size();
+    ast_->expressions_.push_back(
+        {expr->type(), static_cast<uint32_t>(payloads.size())});
+    ast_->expr_types_.push_back(expr->expr_type());
+    ast_->locations_.push_back(expr->location());
+    payloads.push_back(std::move(payload));
+    return index;
+  }
+  template <typename T> T &ExpressionPayload(NodeIndex index) {
+    return ast_->PayloadsOf<T>()[ast_->expressions_[index].payload];
+  }
+
+  template <typename T>
+  NodeIndex AddStatement(StatementType type, T payload = T{}) {
+    std::vector<T> &payloads = ast_->PayloadsOf<T>();
+    const NodeIndex index = ast_->statements_.size();
+    ast_->statements_.push_back(
+        {type, static_cast<uint32_t>(payloads.size())});
+    payloads.push_back(std::move(payload));
+    return index;
+  }
+  template <typename T> T &StatementPayload(NodeIndex index) {
+    return ast_->PayloadsOf<T>()[ast_->statements_[index].payload];
+  }
+
+  NodeIndex VisitStatement(const Statement *stmt) {
+    StatementVisitor::Visit(stmt);
+    return last_statement_;
+  }
+  NodeIndex VisitOptional(const Expression *expr) {
+    return expr == nullptr ? kNoNode : ExpressionVisitor::Visit(expr);
+  }
+  NodeRange AddChildren(const std::vector<NodeIndex> &children) {
+    NodeRange range{static_cast<uint32_t>(ast_->children_.size()),
+                    static_cast<uint32_t>(children.size())};
+    ast_->children_.insert(ast_->children_.end(), children.begin(),
+                           children.end());
+    return range;
+  }
+  NodeRange
+  VisitExpressions(const std::vector<std::unique_ptr<Expression>> &exprs) {
+    std::vector<NodeIndex> children;
+    children.reserve(exprs.size());
+    for (const auto &expr : exprs)
+      children.push_back(ExpressionVisitor::Visit(expr.get()));
+    return AddChildren(children);
+  }
+
+  NodeIndex DispatchTernary(const TernaryExpression *expr) override;
+  NodeIndex DispatchBinary(const BinaryExpression *expr) override;
+  NodeIndex DispatchUnary(const UnaryExpression *expr) override;
+  NodeIndex DispatchCall(const CallExpression *expr) override;
+  NodeIndex DispatchRange(const RangeExpression *expr) override;
+  NodeIndex DispatchArray(const ArrayExpression *expr) override;
+  NodeIndex DispatchCast(const CastExpression *expr) override;
+  NodeIndex DispatchConstant(const ConstantExpression *expr) override;
+  NodeIndex DispatchIdentifier(const IdentifierExpression *expr) override;
+  NodeIndex DispatchMemberAccess(const MemberAccessExpression *expr) override;
+  NodeIndex DispatchArrayAccess(const ArrayAccessExpression *expr) override;
+  NodeIndex DispatchCallOp(const CallOpExpression *expr) override;
+  NodeIndex DispatchMalloc(const MallocExpression *expr) override;
+  NodeIndex DispatchSizeof(const SizeofExpression *expr) override;
+
+  void DispatchReturn(const ReturnStatement *stmt) override;
+  void DispatchDeinit(const DeinitStatement *stmt) override;
+  void DispatchAssignment(const AssignmentStatement *stmt) override;
+  void DispatchCompound(const CompoundStatement *stmt) override;
+  void DispatchExpression(const ExpressionStatement *stmt) override;
+  void DispatchIf(const IfStatement *stmt) override;
+  void DispatchFor(const ForStatement *stmt) override;
+  void DispatchWhile(const WhileStatement *stmt) override;
+  void DispatchDeclaration(const DeclarationStatement *stmt) override;
+  void DispatchBreak(const BreakStatement *stmt) override;
+  void DispatchContinue(const ContinueStatement *stmt) override;
+
+  void AddExpressionStatement(const ExpressionStatement *stmt);
+  void AddDeclaration(const DeclarationStatement *stmt,
+                      const CompoundStatement *body);
+
+  FlatAst *ast_;
+  NodeIndex last_statement_ = kNoNode;
+};
+
+// `FlatAstBuilder` =====================================================
+NodeIndex FlatAstBuilder::DispatchTernary(const TernaryExpression *expr) {
+  const NodeIndex index = AddExpression<Flat::Ternary>(expr);
+  const NodeIndex condition = ExpressionVisitor::Visit(expr->condition());
+  const NodeIndex true_case = ExpressionVisitor::Visit(expr->true_case());
+  const NodeIndex false_case = ExpressionVisitor::Visit(expr->false_case());
+  ExpressionPayload<Flat::Ternary>(index) = {condition, true_case, false_case};
+  return index;
+}
+
+NodeIndex FlatAstBuilder::DispatchBinary(const BinaryExpression *expr) {
+  const NodeIndex index = AddExpression<Flat::Binary>(expr);
+  const NodeIndex lhs = ExpressionVisitor::Visit(expr->lhs());
+  const NodeIndex rhs = ExpressionVisitor::Visit(expr->rhs());
+  ExpressionPayload<Flat::Binary>(index) = {lhs, rhs, expr->op_type()};
+  return index;
+}
+
+NodeIndex FlatAstBuilder::DispatchUnary(const UnaryExpression *expr) {
+  const NodeIndex index = AddExpression<Flat::Unary>(expr);
+  const NodeIndex expression = ExpressionVisitor::Visit(expr->expression());
+  ExpressionPayload<Flat::Unary>(index) = {expression, expr->op_type()};
+  return index;
+}
+
+NodeIndex FlatAstBuilder::DispatchCall(const CallExpression *expr) {
+  const NodeIndex index = AddExpression<Flat::Call>(expr);
+  const NodeRange args = VisitExpressions(expr->args());
+  ExpressionPayload<Flat::Call>(index) = {expr->identifier(), args,
+                                          expr->function()};
+  return index;
+}
+
+NodeIndex FlatAstBuilder::DispatchRange(const RangeExpression *expr) {
+  const NodeIndex index = AddExpression<Flat::Range>(expr);
+  const NodeIndex lhs = VisitOptional(expr->lhs());
+  const NodeIndex rhs = VisitOptional(expr->rhs());
+  ExpressionPayload<Flat::Range>(index) = {lhs, rhs};
+  return index;
+}
+
+NodeIndex FlatAstBuilder::DispatchArray(const ArrayExpression *expr) {
+  const NodeIndex index = AddExpression<Flat::Array>(expr);
+  const NodeRange elements = VisitExpressions(expr->elements());
+  ExpressionPayload<Flat::Array>(index) = {elements};
+  return index;
+}
+
+NodeIndex FlatAstBuilder::DispatchCast(const CastExpression *expr) {
+  const NodeIndex index = AddExpression<Flat::Cast>(expr);
+  const NodeIndex expression = ExpressionVisitor::Visit(expr->expression());
+  ExpressionPayload<Flat::Cast>(index) = {expression, expr->cast_type()};
+  return index;
+}
+
+NodeIndex FlatAstBuilder::DispatchConstant(const ConstantExpression *expr) {
+  return AddExpression<Flat::Constant>(expr, {expr->data()});
+}
+
+NodeIndex FlatAstBuilder::DispatchIdentifier(const IdentifierExpression *expr) {
+  return AddExpression<Flat::Identifier>(
+      expr, {expr->identifier(), expr->slot(), expr->binding()});
+}
+
+NodeIndex
+FlatAstBuilder::DispatchMemberAccess(const MemberAccessExpression *expr) {
+  const NodeIndex index = AddExpression<Flat::MemberAccess>(expr);
+  const NodeIndex expression = ExpressionVisitor::Visit(expr->expression());
+  ExpressionPayload<Flat::MemberAccess>(index) = {
+      expression, expr->identifier(), expr->direct()};
+  return index;
+}
+
+NodeIndex
+FlatAstBuilder::DispatchArrayAccess(const ArrayAccessExpression *expr) {
+  const NodeIndex index = AddExpression<Flat::ArrayAccess>(expr);
+  const NodeIndex expression = ExpressionVisitor::Visit(expr->expression());
+  const NodeIndex array_index = ExpressionVisitor::Visit(expr->index());
+  ExpressionPayload<Flat::ArrayAccess>(index) = {expression, array_index};
+  return index;
+}
+
+NodeIndex FlatAstBuilder::DispatchCallOp(const CallOpExpression *expr) {
+  const NodeIndex index = AddExpression<Flat::CallOp>(expr);
+  const NodeIndex expression = ExpressionVisitor::Visit(expr->expression());
+  const NodeRange args = VisitExpressions(expr->args());
+  ExpressionPayload<Flat::CallOp>(index) = {expression, args};
+  return index;
+}
+
+NodeIndex FlatAstBuilder::DispatchMalloc(const MallocExpression *expr) {
+  const NodeIndex index = AddExpression<Flat::Malloc>(expr);
+  const NodeIndex expression = ExpressionVisitor::Visit(expr->expression());
+  ExpressionPayload<Flat::Malloc>(index) = {expression, expr->decl_type()};
+  return index;
+}
+
+NodeIndex FlatAstBuilder::DispatchSizeof(const SizeofExpression *expr) {
+  return AddExpression<Flat::Sizeof>(expr, {expr->decl_type()});
+}
+
+void FlatAstBuilder::DispatchReturn(const ReturnStatement *stmt) {
+  AddExpressionStatement(stmt);
+}
+
+void FlatAstBuilder::DispatchDeinit(const DeinitStatement *stmt) {
+  AddExpressionStatement(stmt);
+}
+
+void FlatAstBuilder::DispatchExpression(const ExpressionStatement *stmt) {
+  AddExpressionStatement(stmt);
+}
+
+void FlatAstBuilder::AddExpressionStatement(const ExpressionStatement *stmt) {
+  const NodeIndex index =
+      AddStatement<Flat::ExpressionStmt>(stmt->type(), {kNoNode});
+  StatementPayload<Flat::ExpressionStmt>(index).expression =
+      ExpressionVisitor::Visit(stmt->expression());
+  last_statement_ = index;
+}
+
+void FlatAstBuilder::DispatchAssignment(const AssignmentStatement *stmt) {
+  const NodeIndex index = AddStatement<Flat::Assignment>(stmt->type());
+  const NodeIndex lhs = ExpressionVisitor::Visit(stmt->lhs());
+  const NodeIndex rhs = ExpressionVisitor::Visit(stmt->rhs());
+  StatementPayload<Flat::Assignment>(index) = {
+      lhs, rhs, stmt->assgn_type(), stmt->operation_type()};
+  last_statement_ = index;
+}
+
+void FlatAstBuilder::DispatchCompound(const CompoundStatement *stmt) {
+  const NodeIndex index = AddStatement<Flat::Compound>(stmt->type());
+  std::vector<NodeIndex> children;
+  children.reserve(stmt->statements().size());
+  for (const auto &child : stmt->statements())
+    children.push_back(VisitStatement(child.get()));
+  StatementPayload<Flat::Compound>(index) = {AddChildren(children)};
+  last_statement_ = index;
+}
+
+void FlatAstBuilder::DispatchIf(const IfStatement *stmt) {
+  const NodeIndex index = AddStatement<Flat::If>(stmt->type());
+  std::vector<Flat::IfBranch> branches;
+  branches.reserve(stmt->branches().size());
+  for (const IfBranch &branch : stmt->branches()) {
+    const NodeIndex condition = ExpressionVisitor::Visit(branch.condition.get());
+    branches.push_back({condition, VisitStatement(branch.body.get())});
+  }
+  NodeRange range{static_cast<uint32_t>(ast_->branches_.size()),
+                  static_cast<uint32_t>(branches.size())};
+  ast_->branches_.insert(ast_->branches_.end(), branches.begin(),
+                         branches.end());
+  StatementPayload<Flat::If>(index) = {range};
+  last_statement_ = index;
+}
+
+void FlatAstBuilder::DispatchFor(const ForStatement *stmt) {
+  AddDeclaration(stmt, stmt->body().get());
+}
+
+void FlatAstBuilder::DispatchWhile(const WhileStatement *stmt) {
+  const NodeIndex index = AddStatement<Flat::While>(stmt->type());
+  const NodeIndex condition = ExpressionVisitor::Visit(stmt->condition());
+  const NodeIndex body = VisitStatement(stmt->body().get());
+  StatementPayload<Flat::While>(index) = {condition, body};
+  last_statement_ = index;
+}
+
+void FlatAstBuilder::DispatchDeclaration(const DeclarationStatement *stmt) {
+  AddDeclaration(stmt, /*body=*/nullptr);
+}
+
+void FlatAstBuilder::AddDeclaration(const DeclarationStatement *stmt,
+                                    const CompoundStatement *body) {
+  const NodeIndex index = AddStatement<Flat::Declaration>(stmt->type());
+  const NodeIndex expression = VisitOptional(stmt->expression());
+  const NodeIndex body_index = body == nullptr ? kNoNode : VisitStatement(body);
+  StatementPayload<Flat::Declaration>(index) = {
+      stmt->identifier(), stmt->is_const(), stmt->slot(),
+      stmt->decl_type(),  expression,       body_index};
+  last_statement_ = index;
+}
+
+void FlatAstBuilder::DispatchBreak(const BreakStatement *stmt) {
+  last_statement_ = ast_->statements_.size();
+  ast_->statements_.push_back({stmt->type(), 0});
+}
+
+void FlatAstBuilder::DispatchContinue(const ContinueStatement *stmt) {
+  last_statement_ = ast_->statements_.size();
+  ast_->statements_.push_back({stmt->type(), 0});
+}
+// `FlatAstBuilder` =====================================================
+
+// `FlatAst` ============================================================
+NodeIndex FlatAst::Add(const CompoundStatement &body) {
+  FlatAstBuilder builder(this);
+  return builder.Build(body);
+}
+
+size_t FlatAst::bytes_allocated() const {
+  auto bytes = [](const auto &nodes) {
+    return nodes.capacity() * sizeof(nodes[0]);
+  };
+  return bytes(expressions_) + bytes(expr_types_) + bytes(locations_) +
+         bytes(statements_) + bytes(children_) + bytes(branches_) +
+         bytes(ternaries_) + bytes(binaries_) + bytes(unaries_) +
+         bytes(calls_) + bytes(ranges_) + bytes(arrays_) + bytes(casts_) +
+         bytes(constants_) + bytes(identifiers_) + bytes(member_accesses_) +
+         bytes(array_accesses_) + bytes(call_ops_) + bytes(mallocs_) +
+         bytes(sizeofs_) + bytes(expression_stmts_) + bytes(assignments_) +
+         bytes(compounds_) + bytes(ifs_) + bytes(whiles_) +
+         bytes(declarations_);
+}
+// `FlatAst` ============================================================
+} // namespace Cobold
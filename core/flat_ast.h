@@ -0,0 +1,227 @@
+#ifndef COBOLD_CORE_FLAT_AST
+#define COBOLD_CORE_FLAT_AST
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "core/expression.h"
+#include "core/statement.h"
+#include "core/symbol.h"
+#include "core/type.h"
+#include "parser/source_location.h"
+
+namespace Cobold {
+// Index of a node in a `FlatAst`, `kNoNode` for an absent child (e.g., the
+// missing bound of `[1..]`).
+using NodeIndex = uint32_t;
+inline constexpr NodeIndex kNoNode = std::numeric_limits<NodeIndex>::max();
+
+// The children `[begin, begin + size)` of a list (see `FlatAst::children`).
+struct NodeRange {
+  uint32_t begin = 0, size = 0;
+};
+
+// The payloads of the flat nodes, one array per kind. Children are referred
+// to by their `NodeIndex`, never by pointer.
+namespace Flat {
+struct Ternary {
+  NodeIndex condition, true_case, false_case;
+};
+struct Binary {
+  NodeIndex lhs, rhs;
+  BinaryExpressionType op_type;
+};
+struct Unary {
+  NodeIndex expression;
+  UnaryExpressionType op_type;
+};
+struct Call {
+  Symbol identifier;
+  NodeRange args;
+  const Function *function;
+};
+struct Range {
+  NodeIndex lhs, rhs;
+};
+struct Array {
+  NodeRange elements;
+};
+struct Cast {
+  NodeIndex expression;
+  const Type *cast_type;
+};
+struct Constant {
+  ConstantExpression::data_type data;
+};
+struct Identifier {
+  Symbol identifier;
+  int slot;
+  Binding binding;
+};
+struct MemberAccess {
+  NodeIndex expression;
+  Symbol identifier;
+  bool direct;
+};
+struct ArrayAccess {
+  NodeIndex expression, index;
+};
+struct CallOp {
+  NodeIndex expression;
+  NodeRange args;
+};
+struct Malloc {
+  NodeIndex expression;
+  const Type *decl_type;
+};
+struct Sizeof {
+  const Type *decl_type;
+};
+
+// `Return`, `Deinit` and `Expression` statements.
+struct ExpressionStmt {
+  NodeIndex expression;
+};
+struct Assignment {
+  NodeIndex lhs, rhs;
+  AssignmentType assgn_type;
+  const Type *operation_type;
+};
+struct Compound {
+  NodeRange statements;
+};
+struct IfBranch {
+  NodeIndex condition, body;
+};
+struct If {
+  // Into `FlatAst::branches()`.
+  NodeRange branches;
+};
+struct While {
+  NodeIndex condition, body;
+};
+// `Declaration` and `For` (which has a `body`) statements.
+struct Declaration {
+  Symbol identifier;
+  bool is_const;
+  int slot;
+  const Type *decl_type;
+  NodeIndex expression, body;
+};
+} // namespace Flat
+
+// Data-oriented representation of the statements of (several) functions: each
+// node is a `kind` plus the index of its payload in the array of that kind,
+// while the `expr_type` and location of the expressions are kept in side
+// tables. Traversals (see `FlatExpressionVisitor`) hence walk a few contiguous
+// arrays rather than chasing pointers, and the whole AST is a handful of
+// allocations that can be copied, serialized or handed to another thread.
+// Built from the pointer-based tree, which stays the representation the
+// passes mutate.
+class FlatAst {
+public:
+  template <typename Kind> struct Node {
+    Kind type;
+    uint32_t payload;
+  };
+
+  // Appends `body` (and all nodes beneath it), returns the index of the
+  // `Compound` statement.
+  NodeIndex Add(const CompoundStatement &body);
+
+  const Node<ExpressionType> &expression(NodeIndex index) const {
+    return expressions_[index];
+  }
+  const Node<StatementType> &statement(NodeIndex index) const {
+    return statements_[index];
+  }
+  const Type *expr_type(NodeIndex expr) const { return expr_types_[expr]; }
+  SourceLocation location(NodeIndex expr) const { return locations_[expr]; }
+
+  // The expressions or statements of `range`.
+  const NodeIndex *children(NodeRange range) const {
+    return children_.data() + range.begin;
+  }
+  const Flat::IfBranch *branches(NodeRange range) const {
+    return branches_.data() + range.begin;
+  }
+
+  // The payload of `node`, which needs to be of the matching kind.
+  template <typename T, typename Kind> const T &Get(const Node<Kind> &node) const;
+
+  size_t num_expressions() const { return expressions_.size(); }
+  size_t num_statements() const { return statements_.size(); }
+  size_t bytes_allocated() const;
+
+private:
+  friend class FlatAstBuilder;
+
+  std::vector<Node<ExpressionType>> expressions_;
+  std::vector<const Type *> expr_types_;
+  std::vector<SourceLocation> locations_;
+  std::vector<Node<StatementType>> statements_;
+  std::vector<NodeIndex> children_;
+  std::vector<Flat::IfBranch> branches_;
+
+  std::vector<Flat::Ternary> ternaries_;
+  std::vector<Flat::Binary> binaries_;
+  std::vector<Flat::Unary> unaries_;
+  std::vector<Flat::Call> calls_;
+  std::vector<Flat::Range> ranges_;
+  std::vector<Flat::Array> arrays_;
+  std::vector<Flat::Cast> casts_;
+  std::vector<Flat::Constant> constants_;
+  std::vector<Flat::Identifier> identifiers_;
+  std::vector<Flat::MemberAccess> member_accesses_;
+  std::vector<Flat::ArrayAccess> array_accesses_;
+  std::vector<Flat::CallOp> call_ops_;
+  std::vector<Flat::Malloc> mallocs_;
+  std::vector<Flat::Sizeof> sizeofs_;
+
+  std::vector<Flat::ExpressionStmt> expression_stmts_;
+  std::vector<Flat::Assignment> assignments_;
+  std::vector<Flat::Compound> compounds_;
+  std::vector<Flat::If> ifs_;
+  std::vector<Flat::While> whiles_;
+  std::vector<Flat::Declaration> declarations_;
+
+  template <typename T> std::vector<T> &PayloadsOf();
+  template <typename T> const std::vector<T> &PayloadsOf() const {
+    return const_cast<FlatAst *>(this)->PayloadsOf<T>();
+  }
+};
+
+template <typename T, typename Kind>
+const T &FlatAst::Get(const Node<Kind> &node) const {
+  return PayloadsOf<T>()[node.payload];
+}
+
+#define COBOLD_FLAT_AST_PAYLOADS(T, member)                                   \
+  template <> inline std::vector<Flat::T> &FlatAst::PayloadsOf<Flat::T>() {    \
+    return member;                                                             \
+  }
+COBOLD_FLAT_AST_PAYLOADS(Ternary, ternaries_)
+COBOLD_FLAT_AST_PAYLOADS(Binary, binaries_)
+COBOLD_FLAT_AST_PAYLOADS(Unary, unaries_)
+COBOLD_FLAT_AST_PAYLOADS(Call, calls_)
+COBOLD_FLAT_AST_PAYLOADS(Range, ranges_)
+COBOLD_FLAT_AST_PAYLOADS(Array, arrays_)
+COBOLD_FLAT_AST_PAYLOADS(Cast, casts_)
+COBOLD_FLAT_AST_PAYLOADS(Constant, constants_)
+COBOLD_FLAT_AST_PAYLOADS(Identifier, identifiers_)
+COBOLD_FLAT_AST_PAYLOADS(MemberAccess, member_accesses_)
+COBOLD_FLAT_AST_PAYLOADS(ArrayAccess, array_accesses_)
+COBOLD_FLAT_AST_PAYLOADS(CallOp, call_ops_)
+COBOLD_FLAT_AST_PAYLOADS(Malloc, mallocs_)
+COBOLD_FLAT_AST_PAYLOADS(Sizeof, sizeofs_)
+COBOLD_FLAT_AST_PAYLOADS(ExpressionStmt, expression_stmts_)
+COBOLD_FLAT_AST_PAYLOADS(Assignment, assignments_)
+COBOLD_FLAT_AST_PAYLOADS(Compound, compounds_)
+COBOLD_FLAT_AST_PAYLOADS(If, ifs_)
+COBOLD_FLAT_AST_PAYLOADS(While, whiles_)
+COBOLD_FLAT_AST_PAYLOADS(Declaration, declarations_)
+#undef COBOLD_FLAT_AST_PAYLOADS
+} // namespace Cobold
+
+#endif /* COBOLD_CORE_FLAT_AST */
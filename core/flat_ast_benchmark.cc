@@ -0,0 +1,342 @@
+// Compares the traversal throughput of the pointer-based AST (allocated from
+// the heap and from an `AstArena`) against the `FlatAst` of the same
+// synthetic program:
+//
+//   bazel run -c opt //core:flat_ast_benchmark -- [nodes] [iterations]
+//
+// Each traversal visits every statement and expression, i.e., measures the
+// cost of walking the tree rather than of any particular pass.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "core/ast_arena.h"
+#include "core/expression.h"
+#include "core/flat_ast.h"
+#include "core/statement.h"
+#include "core/symbol.h"
+#include "visitor/expression_visitor.h"
+#include "visitor/flat_ast_visitor.h"
+#include "visitor/statement_visitor.h"
+
+namespace Cobold {
+namespace {
+// Builds statements of `depth`-deep binary expressions over variables and
+// constants (declarations, assignments and calls) until there are at least
+// `num_nodes` statements and expressions.
+class ProgramGenerator {
+public:
+  explicit ProgramGenerator(int64_t num_nodes) : num_nodes_(num_nodes) {
+    for (int i = 0; i < 16; ++i)
+      variables_.push_back(Symbol::Intern("v" + std::to_string(i)));
+    callee_ = Symbol::Intern("f");
+  }
+
+  CompoundStatement Generate() {
+    std::vector<std::unique_ptr<Statement>> statements;
+    while (nodes_ < num_nodes_) {
+      ++nodes_;
+      switch (statements.size() % 3) {
+      case 0:
+        statements.push_back(std::make_unique<DeclarationStatement>(
+            /*is_const=*/false, NextVariable(), /*decl_type=*/nullptr,
+            Expr(kDepth)));
+        break;
+      case 1:
+        statements.push_back(std::make_unique<AssignmentStatement>(
+            Leaf(/*constant=*/false), AssignmentType::ADD_EQ, Expr(kDepth)));
+        break;
+      case 2: {
+        std::vector<std::unique_ptr<Expression>> args;
+        args.push_back(Expr(kDepth - 1));
+        args.push_back(Expr(kDepth - 1));
+        ++nodes_;
+        statements.push_back(std::make_unique<ExpressionStatement>(
+            std::make_unique<CallExpression>(SourceLocation::Generated(),
+                                             callee_, std::move(args))));
+        break;
+      }
+      }
+    }
+    ++nodes_;
+    return CompoundStatement(std::move(statements));
+  }
+
+  int64_t nodes() const { return nodes_; }
+
+private:
+  static constexpr int kDepth = 4;
+
+  std::unique_ptr<Expression> Expr(int depth) {
+    if (depth == 0)
+      return Leaf(/*constant=*/nodes_ % 2 == 0);
+    ++nodes_;
+    auto lhs = Expr(depth - 1);
+    auto op = static_cast<BinaryExpressionType>(
+        static_cast<int>(BinaryExpressionType::ADD) + nodes_ % 4);
+    return std::make_unique<BinaryExpression>(
+        SourceLocation::Complex(), std::move(lhs), op, Expr(depth - 1));
+  }
+
+  std::unique_ptr<Expression> Leaf(bool constant) {
+    ++nodes_;
+    if (constant)
+      return std::make_unique<ConstantExpression>(SourceLocation::Generated(),
+                                                  nodes_);
+    return std::make_unique<IdentifierExpression>(SourceLocation::Generated(),
+                                                  NextVariable());
+  }
+
+  Symbol NextVariable() { return variables_[nodes_ % variables_.size()]; }
+
+  const int64_t num_nodes_;
+  int64_t nodes_ = 0;
+  std::vector<Symbol> variables_;
+  Symbol callee_;
+};
+
+// Counts the nodes and folds in their data, such that nothing is optimized
+// away.
+class NodeCounter : private ExpressionVisitor<true, int64_t>,
+                    private StatementVisitor<true> {
+public:
+  int64_t Count(const CompoundStatement &body) {
+    result_ = 0;
+    StatementVisitor::Visit(&body);
+    return result_;
+  }
+
+private:
+  int64_t Visit(const Expression *expr) {
+    return ExpressionVisitor::Visit(expr);
+  }
+  int64_t VisitAll(const std::vector<std::unique_ptr<Expression>> &exprs) {
+    int64_t result = 0;
+    for (const auto &expr : exprs)
+      result += Visit(expr.get());
+    return result;
+  }
+
+  int64_t DispatchEmpty() override { return 0; }
+  int64_t DispatchTernary(const TernaryExpression *expr) override {
+    return 1 + Visit(expr->condition()) + Visit(expr->true_case()) +
+           Visit(expr->false_case());
+  }
+  int64_t DispatchBinary(const BinaryExpression *expr) override {
+    return 1 + static_cast<int>(expr->op_type()) + Visit(expr->lhs()) +
+           Visit(expr->rhs());
+  }
+  int64_t DispatchUnary(const UnaryExpression *expr) override {
+    return 1 + Visit(expr->expression());
+  }
+  int64_t DispatchCall(const CallExpression *expr) override {
+    return 1 + expr->identifier().id() + VisitAll(expr->args());
+  }
+  int64_t DispatchRange(const RangeExpression *expr) override {
+    return 1 + Visit(expr->lhs()) + Visit(expr->rhs());
+  }
+  int64_t DispatchArray(const ArrayExpression *expr) override {
+    return 1 + VisitAll(expr->elements());
+  }
+  int64_t DispatchCast(const CastExpression *expr) override {
+    return 1 + Visit(expr->expression());
+  }
+  int64_t DispatchConstant(const ConstantExpression *expr) override {
+    return 1 + std::get<int64_t>(expr->data());
+  }
+  int64_t DispatchIdentifier(const IdentifierExpression *expr) override {
+    return 1 + expr->identifier().id();
+  }
+  int64_t DispatchMemberAccess(const MemberAccessExpression *expr) override {
+    return 1 + Visit(expr->expression());
+  }
+  int64_t DispatchArrayAccess(const ArrayAccessExpression *expr) override {
+    return 1 + Visit(expr->expression()) + Visit(expr->index());
+  }
+  int64_t DispatchCallOp(const CallOpExpression *expr) override {
+    return 1 + Visit(expr->expression()) + VisitAll(expr->args());
+  }
+  int64_t DispatchMalloc(const MallocExpression *expr) override {
+    return 1 + Visit(expr->expression());
+  }
+  int64_t DispatchSizeof(const SizeofExpression *expr) override { return 1; }
+
+  void DispatchAssignment(const AssignmentStatement *stmt) override {
+    result_ += 1 + Visit(stmt->lhs()) + Visit(stmt->rhs());
+  }
+  void DispatchCompound(const CompoundStatement *stmt) override {
+    ++result_;
+    for (const auto &child : stmt->statements())
+      StatementVisitor::Visit(child.get());
+  }
+  void DispatchExpression(const ExpressionStatement *stmt) override {
+    result_ += 1 + Visit(stmt->expression());
+  }
+  void DispatchDeclaration(const DeclarationStatement *stmt) override {
+    result_ += 1 + stmt->identifier().id() + Visit(stmt->expression());
+  }
+
+  int64_t result_ = 0;
+};
+
+// `NodeCounter` for a `FlatAst`.
+class FlatNodeCounter : private FlatExpressionVisitor<int64_t>,
+                        private FlatStatementVisitor {
+public:
+  explicit FlatNodeCounter(const FlatAst *ast)
+      : FlatExpressionVisitor(ast), FlatStatementVisitor(ast) {}
+
+  int64_t Count(NodeIndex body) {
+    result_ = 0;
+    FlatStatementVisitor::Visit(body);
+    return result_;
+  }
+
+private:
+  int64_t Visit(NodeIndex expr) { return FlatExpressionVisitor::Visit(expr); }
+  int64_t VisitAll(NodeRange exprs) {
+    const NodeIndex *children = FlatExpressionVisitor::ast_->children(exprs);
+    int64_t result = 0;
+    for (uint32_t i = 0; i < exprs.size; ++i)
+      result += Visit(children[i]);
+    return result;
+  }
+
+  int64_t DispatchEmpty() override { return 0; }
+  int64_t DispatchTernary(NodeIndex, const Flat::Ternary &expr) override {
+    return 1 + Visit(expr.condition) + Visit(expr.true_case) +
+           Visit(expr.false_case);
+  }
+  int64_t DispatchBinary(NodeIndex, const Flat::Binary &expr) override {
+    return 1 + static_cast<int>(expr.op_type) + Visit(expr.lhs) +
+           Visit(expr.rhs);
+  }
+  int64_t DispatchUnary(NodeIndex, const Flat::Unary &expr) override {
+    return 1 + Visit(expr.expression);
+  }
+  int64_t DispatchCall(NodeIndex, const Flat::Call &expr) override {
+    return 1 + expr.identifier.id() + VisitAll(expr.args);
+  }
+  int64_t DispatchRange(NodeIndex, const Flat::Range &expr) override {
+    return 1 + Visit(expr.lhs) + Visit(expr.rhs);
+  }
+  int64_t DispatchArray(NodeIndex, const Flat::Array &expr) override {
+    return 1 + VisitAll(expr.elements);
+  }
+  int64_t DispatchCast(NodeIndex, const Flat::Cast &expr) override {
+    return 1 + Visit(expr.expression);
+  }
+  int64_t DispatchConstant(NodeIndex, const Flat::Constant &expr) override {
+    return 1 + std::get<int64_t>(expr.data);
+  }
+  int64_t DispatchIdentifier(NodeIndex,
+                             const Flat::Identifier &expr) override {
+    return 1 + expr.identifier.id();
+  }
+  int64_t DispatchMemberAccess(NodeIndex,
+                               const Flat::MemberAccess &expr) override {
+    return 1 + Visit(expr.expression);
+  }
+  int64_t DispatchArrayAccess(NodeIndex,
+                              const Flat::ArrayAccess &expr) override {
+    return 1 + Visit(expr.expression) + Visit(expr.index);
+  }
+  int64_t DispatchCallOp(NodeIndex, const Flat::CallOp &expr) override {
+    return 1 + Visit(expr.expression) + VisitAll(expr.args);
+  }
+  int64_t DispatchMalloc(NodeIndex, const Flat::Malloc &expr) override {
+    return 1 + Visit(expr.expression);
+  }
+  int64_t DispatchSizeof(NodeIndex, const Flat::Sizeof &) override {
+    return 1;
+  }
+
+  void DispatchAssignment(const Flat::Assignment &stmt) override {
+    result_ += 1 + Visit(stmt.lhs) + Visit(stmt.rhs);
+  }
+  void DispatchCompound(const Flat::Compound &stmt) override {
+    ++result_;
+    const NodeIndex *children =
+        FlatStatementVisitor::ast_->children(stmt.statements);
+    for (uint32_t i = 0; i < stmt.statements.size; ++i)
+      FlatStatementVisitor::Visit(children[i]);
+  }
+  void DispatchExpression(const Flat::ExpressionStmt &stmt) override {
+    result_ += 1 + Visit(stmt.expression);
+  }
+  void DispatchDeclaration(const Flat::Declaration &stmt) override {
+    result_ += 1 + stmt.identifier.id() + Visit(stmt.expression);
+  }
+
+  int64_t result_ = 0;
+};
+
+// Runs `count` (which returns a checksum) `iterations` times, returns the
+// average time in microseconds.
+template <typename Count>
+double Measure(int iterations, int64_t expected, Count count) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    if (count() != expected) {
+      std::cerr << "traversals disagree" << std::endl;
+      std::exit(1);
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         iterations;
+}
+
+void Print(const char *name, int64_t nodes, double us) {
+  std::cout << name << ": " << us << " us per traversal, "
+            << (nodes / us) << " M nodes/s" << std::endl;
+}
+} // namespace
+} // namespace Cobold
+
+int main(int argc, char **argv) {
+  const int64_t num_nodes =
+      argc > 1 ? std::max<int64_t>(1, std::atoll(argv[1])) : 1'000'000;
+  const int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+
+  Cobold::ProgramGenerator heap_generator(num_nodes);
+  Cobold::CompoundStatement heap_tree = heap_generator.Generate();
+
+  Cobold::AstArena arena;
+  std::optional<Cobold::CompoundStatement> arena_tree;
+  {
+    Cobold::AstArena::Scope scope(&arena);
+    arena_tree = Cobold::ProgramGenerator(num_nodes).Generate();
+  }
+
+  Cobold::FlatAst flat;
+  const Cobold::NodeIndex flat_tree = flat.Add(heap_tree);
+
+  const int64_t nodes = heap_generator.nodes();
+  Cobold::NodeCounter counter;
+  const int64_t expected = counter.Count(heap_tree);
+  Cobold::FlatNodeCounter flat_counter(&flat);
+  std::cout << nodes << " nodes (" << flat.num_statements() << " statements, "
+            << flat.num_expressions() << " expressions), " << iterations
+            << " iterations" << std::endl;
+  std::cout << "flat AST: " << flat.bytes_allocated() << " bytes, arena: "
+            << arena.bytes_allocated() << " bytes" << std::endl;
+
+  Cobold::Print("heap ", nodes, Cobold::Measure(iterations, expected, [&]() {
+                  return counter.Count(heap_tree);
+                }));
+  Cobold::Print("arena", nodes, Cobold::Measure(iterations, expected, [&]() {
+                  return counter.Count(*arena_tree);
+                }));
+  Cobold::Print("flat ", nodes, Cobold::Measure(iterations, expected, [&]() {
+                  return flat_counter.Count(flat_tree);
+                }));
+  return 0;
+}
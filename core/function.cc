@@ -11,7 +11,7 @@ std::string Function::GetSignature() const {
   for (const auto &argument : arguments_) {
     arguments.push_back(argument.DebugString());
   }
-  return absl::StrCat(name_, "(", absl::StrJoin(arguments, ", "), ") -> ",
+  return absl::StrCat(name_.str(), "(", absl::StrJoin(arguments, ", "), ") -> ",
                       return_type_->DebugString());
 }
 // `Function` ===========================================================
@@ -1,48 +1,49 @@
 #ifndef COBOLD_CORE_FUNCTION
 #define COBOLD_CORE_FUNCTION
 
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <type_traits>
 #include <vector>
 
 #include "core/statement.h"
+#include "core/symbol.h"
 #include "core/type.h"
+#include "parser/source_location.h"
+#include "parser/source_manager.h"
+#include "util/casting.h"
 #include "util/statement_printer.h"
 
 namespace Cobold {
 struct FunctionArgument {
-  std::string name;
+  Symbol name;
   const Type *type;
 
   std::string DebugString() const {
-    return absl::StrCat(name, ": ", type->DebugString());
+    return absl::StrCat(name.str(), ": ", type->DebugString());
   }
 };
 
 class Function {
 public:
-  Function(std::string name, std::vector<FunctionArgument> arguments,
-           const Type *return_type)
-      : name_(name), arguments_(arguments), return_type_(return_type) {}
+  Function(bool external, Symbol name,
+           std::vector<FunctionArgument> arguments, const Type *return_type,
+           SourceLocation location = SourceLocation::Generated())
+      : external_(external), name_(name), arguments_(arguments),
+        return_type_(return_type), location_(location) {}
   virtual ~Function() = default;
 
-  const std::string name() const { return name_; };
+  Symbol name() const { return name_; };
+  // Location of the name in the declaration (used for diagnostics about the
+  // function and its arguments).
+  SourceLocation location() const { return location_; }
   const std::vector<FunctionArgument> &arguments() const { return arguments_; }
   const Type *return_type() const { return return_type_; }
-  virtual const bool external() const = 0;
-  template <typename T> const T *As() const {
-    static_assert(std::is_base_of_v<Function, T>,
-                  "Attempting to cast to non-derived class.");
-    // TODO(jlscheerer) check for `nullptr`
-    return dynamic_cast<const T *>(this);
-  }
-
-  template <typename T> T *As() {
-    static_assert(std::is_base_of_v<Function, T>,
-                  "Attempting to cast to non-derived class.");
-    // TODO(jlscheerer) check for `nullptr`
-    return dynamic_cast<T *>(this);
-  }
+  const bool external() const { return external_; }
+  // Same as `cast<T>(this)`, i.e., never `nullptr` (see `dyn_cast`).
+  template <typename T> const T *As() const { return cast<T>(this); }
+  template <typename T> T *As() { return cast<T>(this); }
 
   virtual std::string DebugString() const { return GetSignature(); }
 
@@ -50,34 +51,79 @@ protected:
   std::string GetSignature() const;
 
 private:
-  std::string name_;
+  void set_location(SourceLocation location) { location_ = location; }
+
+  const bool external_;
+  Symbol name_;
   std::vector<FunctionArgument> arguments_;
   const Type *return_type_;
+  SourceLocation location_;
+
+  friend class SourceLocationRebaser;
+};
+
+// Location of a function body (i.e., its `compoundStatement`) that was skipped
+// while parsing and is only parsed once it is needed.
+struct LazyBody {
+  const SourceBuffer *source;
+  uint32_t begin; // offset of the opening '{'
+  uint32_t end;   // offset past the closing '}'
 };
 
 class DefinedFunction : public Function {
 public:
-  DefinedFunction(std::string name, std::vector<FunctionArgument> arguments,
-                  const Type *return_type, CompoundStatement &&body)
-      : Function(name, arguments, return_type), body_(std::move(body)) {}
-  const bool external() const override { return false; }
+  DefinedFunction(Symbol name, std::vector<FunctionArgument> arguments,
+                  const Type *return_type, CompoundStatement &&body,
+                  SourceLocation location = SourceLocation::Generated())
+      : Function(/*external=*/false, name, arguments, return_type, location),
+        body_(std::move(body)) {}
+  DefinedFunction(Symbol name, std::vector<FunctionArgument> arguments,
+                  const Type *return_type, LazyBody lazy_body,
+                  SourceLocation location = SourceLocation::Generated())
+      : Function(/*external=*/false, name, arguments, return_type, location),
+        lazy_body_(lazy_body) {}
+  static bool classof(const Function *function) {
+    return !function->external();
+  }
   const CompoundStatement &body() const { return body_; }
   CompoundStatement &mutable_body() { return body_; }
 
+  // Whether the body was parsed (otherwise `body()` is empty).
+  bool parsed() const { return !lazy_body_.has_value(); }
+  const std::optional<LazyBody> &lazy_body() const { return lazy_body_; }
+  void SetBody(CompoundStatement &&body) {
+    body_ = std::move(body);
+    lazy_body_.reset();
+  }
+
+  // Number of variables (arguments first, then the local declarations) of
+  // the function, set by `NameResolver`.
+  int num_slots() const { return num_slots_; }
+
   std::string DebugString() const override {
+    if (!parsed())
+      return absl::StrCat(GetSignature(), " { ... }\n");
     return absl::StrCat(GetSignature(), "\n", StatementPrinter::Print(&body_));
   }
 
 private:
   CompoundStatement body_;
+  std::optional<LazyBody> lazy_body_;
+  int num_slots_ = 0;
+
+  friend class NameResolver;
 };
 
 class ExternFunction : public Function {
 public:
-  ExternFunction(std::string name, std::vector<FunctionArgument> arguments,
-                 const Type *return_type, std::string specifier)
-      : Function(name, arguments, return_type), specifier_(specifier) {}
-  const bool external() const override { return true; }
+  ExternFunction(Symbol name, std::vector<FunctionArgument> arguments,
+                 const Type *return_type, std::string specifier,
+                 SourceLocation location = SourceLocation::Generated())
+      : Function(/*external=*/true, name, arguments, return_type, location),
+        specifier_(specifier) {}
+  static bool classof(const Function *function) {
+    return function->external();
+  }
   const std::string &specifier() const { return specifier_; }
 
   std::string DebugString() const override {
@@ -55,5 +55,35 @@ AssignmentStatement::TypeFromString(const std::string &assign_type) {
   }
   assert(false);
 }
+
+BinaryExpressionType
+AssignmentStatement::OperatorOf(const AssignmentType assgn_type) {
+  switch (assgn_type) {
+  case AssignmentType::EQ:
+    break;
+  case AssignmentType::MUL_EQ:
+    return BinaryExpressionType::MULTIPLY;
+  case AssignmentType::DIV_EQ:
+    return BinaryExpressionType::DIVIDE;
+  case AssignmentType::MOD_EQ:
+    return BinaryExpressionType::MOD;
+  case AssignmentType::ADD_EQ:
+    return BinaryExpressionType::ADD;
+  case AssignmentType::SUB_EQ:
+    return BinaryExpressionType::SUBTRACT;
+  case AssignmentType::SHL_EQ:
+    return BinaryExpressionType::SHIFT_LEFT;
+  case AssignmentType::SHR_EQ:
+    return BinaryExpressionType::SHIFT_RIGHT;
+  // TODO(jlscheerer) For bit operations they could be logical or bitwise!
+  case AssignmentType::AND_EQ:
+    return BinaryExpressionType::BIT_AND;
+  case AssignmentType::XOR_EQ:
+    return BinaryExpressionType::BIT_XOR;
+  case AssignmentType::OR_EQ:
+    return BinaryExpressionType::BIT_OR;
+  }
+  assert(false); // `=` has no operator.
+}
 // `AssignmentStatement` ================================================
 } // namespace Cobold
\ No newline at end of file
@@ -6,8 +6,11 @@
 #include <type_traits>
 #include <vector>
 
+#include "core/ast_arena.h"
+#include "core/symbol.h"
 #include "core/expression.h"
 #include "core/type.h"
+#include "util/casting.h"
 
 namespace Cobold {
 enum class StatementType {
@@ -24,25 +27,23 @@ enum class StatementType {
   Continue
 };
 
-class Statement {
+class Statement : public ArenaAllocated {
 public:
-  virtual StatementType type() const = 0;
+  Statement(StatementType type) : type_(type) {}
 
-  template <typename T> const T *As() const {
-    static_assert(std::is_base_of_v<Statement, T>,
-                  "Attempting to cast to non-derived class.");
-    // TODO(jlscheerer) check for `nullptr`
-    return dynamic_cast<const T *>(this);
-  }
+  StatementType type() const { return type_; }
+  // Copies the statement as parsed, i.e., without the results of name
+  // resolution and type inference.
+  virtual std::unique_ptr<Statement> Clone() const = 0;
 
-  template <typename T> T *As() {
-    static_assert(std::is_base_of_v<Statement, T>,
-                  "Attempting to cast to non-derived class.");
-    // TODO(jlscheerer) check for `nullptr`
-    return dynamic_cast<T *>(this);
-  }
+  // Same as `cast<T>(this)`, i.e., never `nullptr` (see `dyn_cast`).
+  template <typename T> const T *As() const { return cast<T>(this); }
+  template <typename T> T *As() { return cast<T>(this); }
 
   virtual ~Statement() = default;
+
+private:
+  StatementType type_;
 };
 
 enum class AssignmentType {
@@ -70,26 +71,42 @@ public:
   AssignmentStatement(std::unique_ptr<Expression> &&lhs,
                       AssignmentType assign_type,
                       std::unique_ptr<Expression> &&rhs)
-      : lhs_(std::move(lhs)), rhs_(std::move(rhs)), assgn_type_(assign_type) {}
+      : Statement(StatementType::Assignment), lhs_(std::move(lhs)),
+        rhs_(std::move(rhs)), assgn_type_(assign_type) {}
 
   const Expression *lhs() const { return lhs_.get(); }
   Expression *mutable_lhs() { return lhs_.get(); }
 
   const AssignmentType assgn_type() const { return assgn_type_; }
+  bool compound() const { return assgn_type_ != AssignmentType::EQ; }
+
+  // The type `lhs op rhs` of a compound assignment is computed in, i.e., `rhs`
+  // is cast to it and the result is cast back to the type of `lhs`.
+  const Type *operation_type() const { return operation_type_; }
 
   const Expression *rhs() const { return rhs_.get(); }
   Expression *mutable_rhs() { return rhs_.get(); }
 
-  StatementType type() const { return StatementType::Assignment; }
+  static bool classof(const Statement *stmt) {
+    return stmt->type() == StatementType::Assignment;
+  }
+  std::unique_ptr<Statement> Clone() const override {
+    return std::make_unique<AssignmentStatement>(lhs_->Clone(), assgn_type_,
+                                                 rhs_->Clone());
+  }
 
   static std::string TypeToString(const AssignmentType assgn_type);
+  // The operator of a compound assignment, e.g., `+` for `+=`.
+  static BinaryExpressionType OperatorOf(const AssignmentType assgn_type);
 
 private:
   static AssignmentType TypeFromString(const std::string &assign_type);
 
   std::unique_ptr<Expression> lhs_, rhs_;
   AssignmentType assgn_type_;
+  const Type *operation_type_ = nullptr;
 
+  friend class ModuleReader;
   friend class TypeInferenceVisitor;
 };
 
@@ -98,12 +115,25 @@ public:
   CompoundStatement()
       : CompoundStatement(std::vector<std::unique_ptr<Statement>>{}) {}
   CompoundStatement(std::vector<std::unique_ptr<Statement>> &&statements)
-      : statements_(std::move(statements)) {}
+      : Statement(StatementType::Compound), statements_(std::move(statements)) {
+  }
 
   const std::vector<std::unique_ptr<Statement>> &statements() const {
     return statements_;
   }
-  StatementType type() const { return StatementType::Compound; }
+  static bool classof(const Statement *stmt) {
+    return stmt->type() == StatementType::Compound;
+  }
+  std::unique_ptr<Statement> Clone() const override {
+    return std::make_unique<CompoundStatement>(CloneStatements());
+  }
+  std::vector<std::unique_ptr<Statement>> CloneStatements() const {
+    std::vector<std::unique_ptr<Statement>> statements;
+    statements.reserve(statements_.size());
+    for (const auto &statement : statements_)
+      statements.push_back(statement->Clone());
+    return statements;
+  }
 
 private:
   std::vector<std::unique_ptr<Statement>> statements_;
@@ -112,12 +142,25 @@ private:
 class ExpressionStatement : public Statement {
 public:
   ExpressionStatement(std::unique_ptr<Expression> &&expression)
-      : expression_(std::move(expression)) {}
+      : ExpressionStatement(StatementType::Expression, std::move(expression)) {
+  }
 
   const Expression *expression() const { return expression_.get(); }
   Expression *mutable_expression() { return expression_.get(); }
 
-  StatementType type() const { return StatementType::Expression; }
+  static bool classof(const Statement *stmt) {
+    return stmt->type() == StatementType::Expression ||
+           stmt->type() == StatementType::Return ||
+           stmt->type() == StatementType::Deinit;
+  }
+  std::unique_ptr<Statement> Clone() const override {
+    return std::make_unique<ExpressionStatement>(expression_->Clone());
+  }
+
+protected:
+  ExpressionStatement(StatementType type,
+                      std::unique_ptr<Expression> &&expression)
+      : Statement(type), expression_(std::move(expression)) {}
 
 private:
   std::unique_ptr<Expression> expression_;
@@ -127,16 +170,28 @@ private:
 
 class ReturnStatement : public ExpressionStatement {
 public:
-  using ExpressionStatement::ExpressionStatement;
+  ReturnStatement(std::unique_ptr<Expression> &&expression)
+      : ExpressionStatement(StatementType::Return, std::move(expression)) {}
 
-  StatementType type() const { return StatementType::Return; }
+  static bool classof(const Statement *stmt) {
+    return stmt->type() == StatementType::Return;
+  }
+  std::unique_ptr<Statement> Clone() const override {
+    return std::make_unique<ReturnStatement>(expression()->Clone());
+  }
 };
 
 class DeinitStatement : public ExpressionStatement {
 public:
-  using ExpressionStatement::ExpressionStatement;
+  DeinitStatement(std::unique_ptr<Expression> &&expression)
+      : ExpressionStatement(StatementType::Deinit, std::move(expression)) {}
 
-  StatementType type() const { return StatementType::Deinit; }
+  static bool classof(const Statement *stmt) {
+    return stmt->type() == StatementType::Deinit;
+  }
+  std::unique_ptr<Statement> Clone() const override {
+    return std::make_unique<DeinitStatement>(expression()->Clone());
+  }
 };
 
 struct IfBranch {
@@ -148,10 +203,22 @@ class IfStatement : public Statement {
 public:
   IfStatement() : IfStatement(std::vector<IfBranch>{}) {}
   IfStatement(std::vector<IfBranch> &&branches)
-      : branches_(std::move(branches)) {}
+      : Statement(StatementType::If), branches_(std::move(branches)) {}
 
   const std::vector<IfBranch> &branches() const { return branches_; }
-  StatementType type() const { return StatementType::If; }
+  static bool classof(const Statement *stmt) {
+    return stmt->type() == StatementType::If;
+  }
+  std::unique_ptr<Statement> Clone() const override {
+    std::vector<IfBranch> branches;
+    branches.reserve(branches_.size());
+    for (const IfBranch &branch : branches_) {
+      branches.push_back(
+          {branch.condition->Clone(),
+           std::make_unique<CompoundStatement>(branch.body->CloneStatements())});
+    }
+    return std::make_unique<IfStatement>(std::move(branches));
+  }
 
 private:
   std::vector<IfBranch> branches_;
@@ -161,13 +228,21 @@ class WhileStatement : public Statement {
 public:
   WhileStatement(std::unique_ptr<Expression> &&condition,
                  std::unique_ptr<CompoundStatement> &&body)
-      : condition_(std::move(condition)), body_(std::move(body)) {}
+      : Statement(StatementType::While), condition_(std::move(condition)),
+        body_(std::move(body)) {}
 
   const Expression *condition() const { return condition_.get(); }
   Expression *mutable_condition() { return condition_.get(); }
 
   const std::unique_ptr<CompoundStatement> &body() const { return body_; }
-  StatementType type() const { return StatementType::While; }
+  static bool classof(const Statement *stmt) {
+    return stmt->type() == StatementType::While;
+  }
+  std::unique_ptr<Statement> Clone() const override {
+    return std::make_unique<WhileStatement>(
+        condition_->Clone(),
+        std::make_unique<CompoundStatement>(body_->CloneStatements()));
+  }
 
 private:
   std::unique_ptr<Expression> condition_;
@@ -178,55 +253,101 @@ private:
 
 class DeclarationStatement : public Statement {
 public:
-  DeclarationStatement(bool is_const, std::string identifier,
+  DeclarationStatement(bool is_const, Symbol identifier,
                        const Type *decl_type,
                        std::unique_ptr<Expression> &&expression)
-      : is_const_(is_const), identifier_(identifier), decl_type_(decl_type),
-        expression_(std::move(expression)) {}
+      : DeclarationStatement(StatementType::Declaration, is_const, identifier,
+                             decl_type, std::move(expression)) {}
 
   const bool is_const() const { return is_const_; }
-  const std::string &identifier() const { return identifier_; }
+  Symbol identifier() const { return identifier_; }
   const Type *decl_type() const { return decl_type_; }
+  // The type as parsed, i.e., `nullptr` for an inferred type.
+  const Type *declared_type() const { return declared_type_; }
+  // Index of the variable within its function, set by `NameResolver`.
+  int slot() const { return slot_; }
 
   const Expression *expression() const { return expression_.get(); }
   Expression *mutable_expression() { return expression_.get(); }
 
-  StatementType type() const { return StatementType::Declaration; }
+  static bool classof(const Statement *stmt) {
+    return stmt->type() == StatementType::Declaration ||
+           stmt->type() == StatementType::For;
+  }
+  std::unique_ptr<Statement> Clone() const override {
+    return std::make_unique<DeclarationStatement>(
+        is_const_, identifier_, declared_type_,
+        expression_ ? expression_->Clone() : nullptr);
+  }
+
+protected:
+  DeclarationStatement(StatementType type, bool is_const,
+                       Symbol identifier, const Type *decl_type,
+                       std::unique_ptr<Expression> &&expression)
+      : Statement(type), is_const_(is_const), identifier_(identifier),
+        decl_type_(decl_type), declared_type_(decl_type),
+        expression_(std::move(expression)) {}
 
 private:
   void infer_type(const Type *decl_type) { decl_type_ = decl_type; }
 
   bool is_const_; // "var" -> !is_const, "let" -> is_const
-  std::string identifier_;
+  Symbol identifier_;
   const Type *decl_type_;
+  const Type *declared_type_; // as parsed, see `infer_type`
   std::unique_ptr<Expression> expression_;
+  int slot_ = -1;
 
+  friend class NameResolver;
   friend class TypeInferenceVisitor;
 };
 
 class ForStatement : public DeclarationStatement {
 public:
-  ForStatement(std::string identifier, const Type *decl_type,
+  ForStatement(Symbol identifier, const Type *decl_type,
                std::unique_ptr<Expression> &&expression,
                std::unique_ptr<CompoundStatement> &&body)
-      : DeclarationStatement(/*is_const=*/false, identifier, decl_type,
-                             std::move(expression)),
+      : DeclarationStatement(StatementType::For, /*is_const=*/false,
+                             identifier, decl_type, std::move(expression)),
         body_(std::move(body)) {}
 
   const std::unique_ptr<CompoundStatement> &body() const { return body_; }
 
-  StatementType type() const { return StatementType::For; }
+  static bool classof(const Statement *stmt) {
+    return stmt->type() == StatementType::For;
+  }
+  std::unique_ptr<Statement> Clone() const override {
+    return std::make_unique<ForStatement>(
+        identifier(), declared_type(), expression()->Clone(),
+        std::make_unique<CompoundStatement>(body_->CloneStatements()));
+  }
 
 private:
   std::unique_ptr<CompoundStatement> body_;
 };
 
 class BreakStatement : public Statement {
-  StatementType type() const { return StatementType::Break; }
+public:
+  BreakStatement() : Statement(StatementType::Break) {}
+
+  static bool classof(const Statement *stmt) {
+    return stmt->type() == StatementType::Break;
+  }
+  std::unique_ptr<Statement> Clone() const override {
+    return std::make_unique<BreakStatement>();
+  }
 };
 
 class ContinueStatement : public Statement {
-  StatementType type() const { return StatementType::Continue; }
+public:
+  ContinueStatement() : Statement(StatementType::Continue) {}
+
+  static bool classof(const Statement *stmt) {
+    return stmt->type() == StatementType::Continue;
+  }
+  std::unique_ptr<Statement> Clone() const override {
+    return std::make_unique<ContinueStatement>();
+  }
 };
 } // namespace Cobold
 
@@ -0,0 +1,73 @@
+#include "core/symbol.h"
+
+#include <bit>
+#include <cassert>
+#include <limits>
+
+namespace Cobold {
+// `Symbol` ============================================================
+Symbol Symbol::Intern(std::string_view str) {
+  return SymbolTable::Get().Intern(str);
+}
+
+const std::string &Symbol::str() const {
+  return SymbolTable::Get().Lookup(*this);
+}
+// `Symbol` ============================================================
+
+// `SymbolTable` =======================================================
+SymbolTable &SymbolTable::Get() {
+  static SymbolTable *table = new SymbolTable();
+  return *table;
+}
+
+SymbolTable::SymbolTable() {
+  // Reserves id 0 for the empty string, see `Symbol::Symbol()`.
+  Intern("");
+}
+
+std::pair<int, size_t> SymbolTable::Locate(uint32_t id) {
+  // Chunk `i` starts at `kFirstChunkSize * (2^i - 1)`.
+  const int chunk =
+      std::bit_width(static_cast<uint64_t>(id) / kFirstChunkSize + 1) - 1;
+  return {chunk, id - kFirstChunkSize * ((size_t{1} << chunk) - 1)};
+}
+
+Symbol SymbolTable::Intern(std::string_view str) {
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    auto it = ids_.find(str);
+    if (it != ids_.end())
+      return Symbol(it->second);
+  }
+  absl::MutexLock lock(&mutex_);
+  // Another thread might have interned `str` in the meantime.
+  auto it = ids_.find(str);
+  if (it != ids_.end())
+    return Symbol(it->second);
+  const uint32_t id = size_.load(std::memory_order_relaxed);
+  assert(id < std::numeric_limits<uint32_t>::max());
+  const auto [chunk, index] = Locate(id);
+  if (owned_chunks_[chunk] == nullptr) {
+    owned_chunks_[chunk] =
+        std::make_unique<std::string[]>(kFirstChunkSize << chunk);
+    chunks_[chunk].store(owned_chunks_[chunk].get(),
+                         std::memory_order_release);
+  }
+  std::string &stored = owned_chunks_[chunk][index];
+  stored = str;
+  ids_[stored] = id;
+  size_.store(id + 1, std::memory_order_release);
+  return Symbol(id);
+}
+
+const std::string &SymbolTable::Lookup(Symbol symbol) const {
+  // `symbol` was returned by `Intern` (which happens before any use of it),
+  // i.e., its string is published.
+  assert(symbol.id_ < size());
+  const auto [chunk, index] = Locate(symbol.id_);
+  return chunks_[chunk].load(std::memory_order_acquire)[index];
+}
+
+// `SymbolTable` =======================================================
+} // namespace Cobold
@@ -0,0 +1,88 @@
+#ifndef COBOLD_CORE_SYMBOL
+#define COBOLD_CORE_SYMBOL
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Cobold {
+// An interned string (e.g., the name of a variable or function, or the value
+// of a string literal), i.e., a 32-bit handle into the `SymbolTable`. Symbols
+// of equal strings are equal, so comparing and hashing does not look at the
+// characters.
+class Symbol {
+public:
+  // The empty string.
+  Symbol() : id_(0) {}
+
+  static Symbol Intern(std::string_view str);
+
+  // Valid for the lifetime of the process (see `SymbolTable`).
+  const std::string &str() const;
+  bool empty() const { return id_ == 0; }
+  uint32_t id() const { return id_; }
+
+  friend bool operator==(Symbol lhs, Symbol rhs) { return lhs.id_ == rhs.id_; }
+  friend bool operator!=(Symbol lhs, Symbol rhs) { return lhs.id_ != rhs.id_; }
+  template <typename H> friend H AbslHashValue(H h, Symbol symbol) {
+    return H::combine(std::move(h), symbol.id_);
+  }
+
+private:
+  explicit Symbol(uint32_t id) : id_(id) {}
+
+  uint32_t id_;
+
+  friend class SymbolTable;
+};
+static_assert(sizeof(Symbol) == sizeof(uint32_t));
+
+// Owns the strings of all symbols. Strings are never removed, such that the
+// references returned by `Symbol::str` stay valid. Thread-safe, and `Lookup`
+// does not lock: strings are stored in chunks of doubling size that never
+// move, and a symbol can only be looked up once `Intern` returned it.
+//
+// The table is shared by all `CompilationSession`s of the process instead of
+// being installed per session (like `TypeTable::Scope`): a `Symbol` is a bare
+// id that is copied between threads and (through the module cache) between
+// sessions, and the table only grows with the number of distinct names and
+// string literals, not with the number of compilations.
+class SymbolTable {
+public:
+  static SymbolTable &Get();
+
+  Symbol Intern(std::string_view str) ABSL_LOCKS_EXCLUDED(mutex_);
+  const std::string &Lookup(Symbol symbol) const;
+  size_t size() const { return size_.load(std::memory_order_acquire); }
+
+private:
+  // Chunk `i` holds `kFirstChunkSize << i` strings, enough chunks for every
+  // 32-bit id.
+  static constexpr size_t kFirstChunkSize = 1024;
+  static constexpr int kNumChunks = 23;
+
+  SymbolTable();
+
+  // The chunk and the index in the chunk of the string of `id`.
+  static std::pair<int, size_t> Locate(uint32_t id);
+
+  mutable absl::Mutex mutex_;
+  std::array<std::atomic<std::string *>, kNumChunks> chunks_ = {};
+  std::array<std::unique_ptr<std::string[]>, kNumChunks> owned_chunks_
+      ABSL_GUARDED_BY(mutex_);
+  std::atomic<uint32_t> size_ = 0;
+  // The keys refer to the strings of `chunks_`.
+  absl::flat_hash_map<std::string_view, uint32_t> ids_ ABSL_GUARDED_BY(mutex_);
+};
+} // namespace Cobold
+
+#endif /* COBOLD_CORE_SYMBOL */
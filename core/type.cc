@@ -1,98 +1,123 @@
 #include "core/type.h"
 
+#include <cassert>
+
+#include "absl/hash/hash.h"
+#include "absl/memory/memory.h"
+
 namespace Cobold {
+namespace {
+thread_local TypeTable *current_table = nullptr;
+
+TypeTable *CurrentTable() {
+  assert(current_table != nullptr && "types require a `TypeTable::Scope`");
+  return current_table;
+}
+} // namespace
+
 // `Type` ===============================================================
 const Type *Type::ArrayOf(const Type *underlying_type) {
-  if (underlying_type == nullptr)
-    return nullptr;
-  if (underlying_type->array_type_ == nullptr) {
-    auto array_type = absl::WrapUnique(new ArrayType(underlying_type));
-    underlying_type->array_type_ = std::move(array_type);
-  }
-  return underlying_type->array_type_.get();
+  return CurrentTable()->ArrayOf(underlying_type);
 }
 
 const Type *Type::PointerTo(const Type *underlying_type) {
-  if (underlying_type == nullptr)
-    return nullptr;
-  if (underlying_type->pointer_type_ == nullptr) {
-    auto pointer_type = absl::WrapUnique(new PointerType(underlying_type));
-    underlying_type->pointer_type_ = std::move(pointer_type);
-  }
-  return underlying_type->pointer_type_.get();
+  return CurrentTable()->PointerTo(underlying_type);
 }
 // `Type` ===============================================================
 
 // `NilType` ============================================================
-const NilType *NilType::Get() {
-  if (type_ == nullptr) {
-    type_ = absl::WrapUnique(new NilType());
-  }
-  return type_.get();
-}
+const NilType *NilType::Get() { return CurrentTable()->Nil(); }
 // `NilType` ============================================================
 
 // `DashType` ===========================================================
-const DashType *DashType::Get() {
-  if (type_ == nullptr) {
-    type_ = absl::WrapUnique(new DashType());
-  }
-  return type_.get();
-}
-// `DashType` ============================================================
+const DashType *DashType::Get() { return CurrentTable()->Dash(); }
+// `DashType` ===========================================================
 
 // `IntegralType` =======================================================
 const IntegralType *IntegralType::OfSize(int size) {
-  if (!type_cache_.contains(size)) {
-    type_cache_[size] = absl::WrapUnique(new IntegralType(size));
-  }
-  return type_cache_[size].get();
+  return CurrentTable()->Integral(size);
 }
 // `IntegralType` =======================================================
 
 // `RangeType` ==========================================================
 const RangeType *RangeType::Of(const Type *underlying_type) {
-  if (!type_cache_.contains(underlying_type)) {
-    type_cache_[underlying_type] =
-        absl::WrapUnique(new RangeType(underlying_type));
-  }
-  return type_cache_[underlying_type].get();
+  return CurrentTable()->RangeOf(underlying_type);
 }
 // `RangeType` ==========================================================
 
 // `FloatingType` =======================================================
 const FloatingType *FloatingType::OfSize(int size) {
-  if (!type_cache_.contains(size)) {
-    type_cache_[size] = absl::WrapUnique(new FloatingType(size));
-  }
-  return type_cache_[size].get();
+  return CurrentTable()->Floating(size);
 }
 // `FloatingType` =======================================================
 
-// `BoolType` ===========================================================
-const CharType *CharType::Get() {
-  if (type_ == nullptr) {
-    type_ = absl::WrapUnique(new CharType());
-  }
-  return type_.get();
-}
-// `BoolType` ===========================================================
+// `CharType` ===========================================================
+const CharType *CharType::Get() { return CurrentTable()->Char(); }
+// `CharType` ===========================================================
 
 // `BoolType` ===========================================================
-const BoolType *BoolType::Get() {
-  if (type_ == nullptr) {
-    type_ = absl::WrapUnique(new BoolType());
-  }
-  return type_.get();
-}
+const BoolType *BoolType::Get() { return CurrentTable()->Bool(); }
 // `BoolType` ===========================================================
 
 // `StringType` =========================================================
-const StringType *StringType::Get() {
-  if (type_ == nullptr) {
-    type_ = absl::WrapUnique(new StringType());
-  }
-  return type_.get();
-}
+const StringType *StringType::Get() { return CurrentTable()->String(); }
 // `StringType` =========================================================
-} // namespace Cobold
\ No newline at end of file
+
+// `TypeTable` ==========================================================
+TypeTable::TypeTable()
+    : nil_(new NilType()), dash_(new DashType()), bool_(new BoolType()),
+      char_(new CharType()), string_(new StringType()) {}
+
+TypeTable::~TypeTable() = default;
+
+template <typename T, typename Create>
+const T *TypeTable::Intern(Key key, Create create) {
+  Shard &shard = shards_[absl::Hash<Key>()(key) % kNumShards];
+  absl::MutexLock lock(&shard.mutex);
+  std::unique_ptr<Type> &type = shard.types[key];
+  if (type == nullptr)
+    type = absl::WrapUnique(create());
+  return static_cast<const T *>(type.get());
+}
+
+const IntegralType *TypeTable::Integral(int size) {
+  return Intern<IntegralType>({TypeClass::Integral, nullptr, size},
+                              [size]() { return new IntegralType(size); });
+}
+
+const FloatingType *TypeTable::Floating(int size) {
+  return Intern<FloatingType>({TypeClass::Floating, nullptr, size},
+                              [size]() { return new FloatingType(size); });
+}
+
+const Type *TypeTable::ArrayOf(const Type *underlying_type) {
+  if (underlying_type == nullptr)
+    return nullptr;
+  return Intern<ArrayType>(
+      {TypeClass::Array, underlying_type, 0},
+      [underlying_type]() { return new ArrayType(underlying_type); });
+}
+
+const Type *TypeTable::PointerTo(const Type *underlying_type) {
+  if (underlying_type == nullptr)
+    return nullptr;
+  return Intern<PointerType>(
+      {TypeClass::Pointer, underlying_type, 0},
+      [underlying_type]() { return new PointerType(underlying_type); });
+}
+
+const RangeType *TypeTable::RangeOf(const Type *underlying_type) {
+  return Intern<RangeType>(
+      {TypeClass::Range, underlying_type, 0},
+      [underlying_type]() { return new RangeType(underlying_type); });
+}
+
+TypeTable::Scope::Scope(TypeTable *table) : previous_(current_table) {
+  current_table = table;
+}
+
+TypeTable::Scope::~Scope() { current_table = previous_; }
+
+TypeTable *TypeTable::Current() { return current_table; }
+// `TypeTable` ==========================================================
+} // namespace Cobold
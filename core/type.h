@@ -1,12 +1,16 @@
 #ifndef COBOLD_CORE_TYPE
 #define COBOLD_CORE_TYPE
 
+#include <array>
 #include <memory>
 #include <string>
 #include <type_traits>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "util/casting.h"
 
 namespace Cobold {
 enum class TypeClass {
@@ -21,50 +25,55 @@ enum class TypeClass {
   Range,
   Pointer
 };
+class TypeTable;
+
+// Types are interned by the `TypeTable` of the current thread (see
+// `TypeTable::Scope`), i.e., equal types of one compilation are compared by
+// address.
 class Type {
 public:
   static const Type *ArrayOf(const Type *underlying_type);
   static const Type *PointerTo(const Type *underlying_type);
 
-  virtual const TypeClass type_class() const { return class_; }
+  const TypeClass type_class() const { return class_; }
   virtual const std::string DebugString() const = 0;
-  template <typename T> const T *As() const {
-    static_assert(std::is_base_of_v<Type, T>,
-                  "Attempting to cast to non-derived class.");
-    // TODO(jlscheerer) check for `nullptr`
-    return dynamic_cast<const T *>(this);
-  }
+  // Same as `cast<T>(this)`, i.e., never `nullptr` (see `dyn_cast`).
+  template <typename T> const T *As() const { return cast<T>(this); }
   virtual ~Type() = default;
 
-private:
-  TypeClass class_;
+protected:
+  Type(TypeClass type_class) : class_(type_class) {}
 
-  mutable std::unique_ptr<Type> array_type_;
-  mutable std::unique_ptr<Type> pointer_type_;
+private:
+  const TypeClass class_;
 };
 
 class NilType : public Type {
 public:
   static const NilType *Get();
-  const TypeClass type_class() const override { return TypeClass::Nil; }
+  static bool classof(const Type *type) {
+    return type->type_class() == TypeClass::Nil;
+  }
   const std::string DebugString() const override { return "nil"; }
 
 private:
-  NilType() {}
+  NilType() : Type(TypeClass::Nil) {}
 
-  static inline std::unique_ptr<NilType> type_;
+  friend class TypeTable;
 };
 
 class DashType : public Type {
 public:
   static const DashType *Get();
-  const TypeClass type_class() const override { return TypeClass::Dash; }
+  static bool classof(const Type *type) {
+    return type->type_class() == TypeClass::Dash;
+  }
   const std::string DebugString() const override { return "--"; }
 
 private:
-  DashType() {}
+  DashType() : Type(TypeClass::Dash) {}
 
-  static inline std::unique_ptr<DashType> type_;
+  friend class TypeTable;
 };
 
 class IntegralType : public Type {
@@ -72,17 +81,18 @@ public:
   static const IntegralType *OfSize(int size);
 
   const int size() const { return size_; }
-  const TypeClass type_class() const override { return TypeClass::Integral; }
+  static bool classof(const Type *type) {
+    return type->type_class() == TypeClass::Integral;
+  }
   const std::string DebugString() const override {
     return absl::StrCat("i", size());
   }
 
 private:
-  IntegralType(int size) : size_(size) {}
+  IntegralType(int size) : Type(TypeClass::Integral), size_(size) {}
 
-  static inline absl::flat_hash_map<int, std::unique_ptr<IntegralType>>
-      type_cache_;
   int size_;
+  friend class TypeTable;
 };
 
 class FloatingType : public Type {
@@ -90,90 +100,104 @@ public:
   static const FloatingType *OfSize(int size);
 
   const int size() const { return size_; }
-  const TypeClass type_class() const override { return TypeClass::Floating; }
+  static bool classof(const Type *type) {
+    return type->type_class() == TypeClass::Floating;
+  }
   const std::string DebugString() const override {
     return absl::StrCat("f", size());
   }
 
 private:
-  FloatingType(int size) : size_(size) {}
+  FloatingType(int size) : Type(TypeClass::Floating), size_(size) {}
 
-  static inline absl::flat_hash_map<int, std::unique_ptr<FloatingType>>
-      type_cache_;
   int size_;
+  friend class TypeTable;
 };
 
 class BoolType : public Type {
 public:
   static const BoolType *Get();
-  const TypeClass type_class() const override { return TypeClass::Bool; }
+  static bool classof(const Type *type) {
+    return type->type_class() == TypeClass::Bool;
+  }
   const std::string DebugString() const override { return "bool"; }
 
 private:
-  BoolType() {}
+  BoolType() : Type(TypeClass::Bool) {}
 
-  static inline std::unique_ptr<BoolType> type_;
+  friend class TypeTable;
 };
 
 class CharType : public Type {
 public:
   static const CharType *Get();
-  const TypeClass type_class() const override { return TypeClass::Char; }
+  static bool classof(const Type *type) {
+    return type->type_class() == TypeClass::Char;
+  }
   const std::string DebugString() const override { return "char"; }
 
 private:
-  CharType() {}
+  CharType() : Type(TypeClass::Char) {}
 
-  static inline std::unique_ptr<CharType> type_;
+  friend class TypeTable;
 };
 
 class StringType : public Type {
 public:
   static const StringType *Get();
-  const TypeClass type_class() const override { return TypeClass::String; }
+  static bool classof(const Type *type) {
+    return type->type_class() == TypeClass::String;
+  }
   const std::string DebugString() const override { return "string"; }
 
 private:
-  StringType() {}
+  StringType() : Type(TypeClass::String) {}
 
-  static inline std::unique_ptr<StringType> type_;
+  friend class TypeTable;
 };
 
 class ArrayType : public Type {
 public:
-  const TypeClass type_class() const override { return TypeClass::Array; }
+  static bool classof(const Type *type) {
+    return type->type_class() == TypeClass::Array;
+  }
   const std::string DebugString() const override {
     return absl::StrCat("[", underlying_type_->DebugString(), "]");
   }
   const Type *underlying_type() const { return underlying_type_; }
 
 private:
-  ArrayType(const Type *underlying_type) : underlying_type_(underlying_type) {}
+  ArrayType(const Type *underlying_type)
+      : Type(TypeClass::Array), underlying_type_(underlying_type) {}
 
   const Type *underlying_type_;
-  friend class Type;
+  friend class TypeTable;
 };
 
 class RangeType : public Type {
 public:
   static const RangeType *Of(const Type *underlying_type);
-  const TypeClass type_class() const override { return TypeClass::Range; }
+  static bool classof(const Type *type) {
+    return type->type_class() == TypeClass::Range;
+  }
   const std::string DebugString() const override {
     return absl::StrCat("[|", underlying_type_->DebugString(), "|]");
   }
   const Type *underlying_type() const { return underlying_type_; }
 
 private:
-  RangeType(const Type *underlying_type) : underlying_type_(underlying_type) {}
+  RangeType(const Type *underlying_type)
+      : Type(TypeClass::Range), underlying_type_(underlying_type) {}
 
   const Type *underlying_type_;
-  static inline absl::flat_hash_map<const Type *, std::unique_ptr<RangeType>>
-      type_cache_;
+  friend class TypeTable;
 };
 
 class PointerType : public Type {
 public:
-  const TypeClass type_class() const override { return TypeClass::Pointer; }
+  static bool classof(const Type *type) {
+    return type->type_class() == TypeClass::Pointer;
+  }
   const std::string DebugString() const override {
     return absl::StrCat(underlying_type_->DebugString(), "*");
   }
@@ -181,10 +205,81 @@ public:
 
 private:
   PointerType(const Type *underlying_type)
-      : underlying_type_(underlying_type) {}
+      : Type(TypeClass::Pointer), underlying_type_(underlying_type) {}
 
   const Type *underlying_type_;
-  friend class Type;
+  friend class TypeTable;
+};
+
+// Owns the types of a compilation (see `CompilationSession`). The primitive
+// types are created upfront, all others are interned on first use in one of
+// `kNumShards` independently locked shards. Thread-safe.
+class TypeTable {
+public:
+  TypeTable();
+  ~TypeTable();
+  TypeTable(const TypeTable &) = delete;
+  TypeTable &operator=(const TypeTable &) = delete;
+
+  const NilType *Nil() const { return nil_.get(); }
+  const DashType *Dash() const { return dash_.get(); }
+  const BoolType *Bool() const { return bool_.get(); }
+  const CharType *Char() const { return char_.get(); }
+  const StringType *String() const { return string_.get(); }
+  const IntegralType *Integral(int size);
+  const FloatingType *Floating(int size);
+  const Type *ArrayOf(const Type *underlying_type);
+  const Type *PointerTo(const Type *underlying_type);
+  const RangeType *RangeOf(const Type *underlying_type);
+
+  // Interns the types created on the current thread (e.g., by
+  // `IntegralType::OfSize`) in `table` until destroyed. Scopes nest.
+  class Scope {
+  public:
+    explicit Scope(TypeTable *table);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    TypeTable *previous_;
+  };
+  // The table of the innermost `Scope` of the current thread.
+  static TypeTable *Current();
+
+private:
+  struct Key {
+    TypeClass type_class;
+    const Type *underlying_type;
+    int size;
+
+    friend bool operator==(const Key &lhs, const Key &rhs) {
+      return lhs.type_class == rhs.type_class &&
+             lhs.underlying_type == rhs.underlying_type &&
+             lhs.size == rhs.size;
+    }
+    template <typename H> friend H AbslHashValue(H h, const Key &key) {
+      return H::combine(std::move(h), key.type_class, key.underlying_type,
+                        key.size);
+    }
+  };
+  struct Shard {
+    absl::Mutex mutex;
+    absl::flat_hash_map<Key, std::unique_ptr<Type>> types
+        ABSL_GUARDED_BY(mutex);
+  };
+  static constexpr size_t kNumShards = 16;
+
+  // Returns the type for `key`, creates it using `create` if there is none.
+  template <typename T, typename Create> const T *Intern(Key key, Create create);
+
+  std::unique_ptr<NilType> nil_;
+  std::unique_ptr<DashType> dash_;
+  std::unique_ptr<BoolType> bool_;
+  std::unique_ptr<CharType> char_;
+  std::unique_ptr<StringType> string_;
+  std::array<Shard, kNumShards> shards_;
 };
 } // namespace Cobold
 
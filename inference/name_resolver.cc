@@ -0,0 +1,232 @@
+#include "inference/name_resolver.h"
+
+#include <optional>
+
+#include "absl/strings/str_cat.h"
+
+namespace Cobold {
+// `NameResolver` =======================================================
+absl::Status NameResolver::Resolve(std::vector<SourceFile> &modules) {
+  // The only lookups by name, once per function and call site.
+  absl::flat_hash_map<Symbol, const Function *> functions;
+  NameResolver resolver(functions);
+  for (const SourceFile &file : modules) {
+    for (const auto &fn : file.functions()) {
+      // Calls are bound to the first definition.
+      if (!functions.try_emplace(fn->name(), fn.get()).second) {
+        resolver.error_context_ << MakeError(
+            fn->location(),
+            absl::StrCat("redefinition of function '", fn->name().str(), "'"));
+      }
+    }
+  }
+  for (SourceFile &file : modules) {
+    for (const auto &fn : file.functions()) {
+      // Unparsed bodies are unreachable from `Main` (see `BodyLoader`).
+      DefinedFunction *defined = dyn_cast<DefinedFunction>(fn.get());
+      if (defined != nullptr && defined->parsed())
+        resolver.ResolveFunction(defined);
+    }
+  }
+  return resolver.error_context_.ToStatus();
+}
+
+absl::Status NameResolver::Resolve(
+    DefinedFunction *function,
+    const absl::flat_hash_map<Symbol, const Function *> &functions) {
+  NameResolver resolver(functions);
+  resolver.ResolveFunction(function);
+  return resolver.error_context_.ToStatus();
+}
+
+void NameResolver::ResolveFunction(DefinedFunction *function) {
+  num_slots_ = 0;
+  variables_.PushScope();
+  for (const FunctionArgument &arg : function->arguments()) {
+    if (!variables_.store(arg.name, {&arg, num_slots_++})) {
+      error_context_ << MakeError(
+          function->location(),
+          absl::StrCat("redefinition of argument '", arg.name.str(), "' of '",
+                       function->name().str(), "'"));
+    }
+  }
+  StatementVisitor::Visit(&function->mutable_body());
+  variables_.PopScope();
+  function->num_slots_ = num_slots_;
+}
+
+void NameResolver::Declare(DeclarationStatement *stmt) {
+  stmt->slot_ = num_slots_++;
+  if (!variables_.store(stmt->identifier(),
+                        {static_cast<const DeclarationStatement *>(stmt),
+                         stmt->slot_})) {
+    error_context_ << MakeError(
+        stmt->expression()->location(),
+        absl::StrCat("redefinition of '", stmt->identifier().str(), "'"));
+  }
+}
+
+const Function *NameResolver::LookupFunction(Symbol name,
+                                             SourceLocation location) {
+  auto it = functions_.find(name);
+  if (it != functions_.end())
+    return it->second;
+  error_context_ << MakeError(
+      location,
+      absl::StrCat("call to undeclared function '", name.str(), "'"));
+  return nullptr;
+}
+
+// Statements
+void NameResolver::DispatchReturn(ReturnStatement *stmt) {
+  ExpressionVisitor::Visit(stmt->mutable_expression());
+}
+
+void NameResolver::DispatchDeinit(DeinitStatement *stmt) {
+  ExpressionVisitor::Visit(stmt->mutable_expression());
+}
+
+void NameResolver::DispatchAssignment(AssignmentStatement *stmt) {
+  // Codegen stores to variables and `>>ptr` only. In particular, `s[i]` is not
+  // assignable, as string literals are constant (and shared).
+  const Expression *lhs = stmt->lhs();
+  const auto *unary = dyn_cast<UnaryExpression>(lhs);
+  if (!isa<IdentifierExpression>(lhs) &&
+      (unary == nullptr ||
+       unary->op_type() != UnaryExpressionType::DEREFERENCE)) {
+    error_context_ << MakeError(
+        lhs->location(),
+        "expression is not assignable (only variables and `>>ptr` are)");
+  }
+  ExpressionVisitor::Visit(stmt->mutable_lhs());
+  ExpressionVisitor::Visit(stmt->mutable_rhs());
+}
+
+void NameResolver::DispatchCompound(CompoundStatement *stmt) {
+  variables_.PushScope();
+  for (const auto &child : stmt->statements())
+    StatementVisitor::Visit(child.get());
+  variables_.PopScope();
+}
+
+void NameResolver::DispatchExpression(ExpressionStatement *stmt) {
+  ExpressionVisitor::Visit(stmt->mutable_expression());
+}
+
+void NameResolver::DispatchIf(IfStatement *stmt) {
+  for (const IfBranch &branch : stmt->branches()) {
+    ExpressionVisitor::Visit(branch.condition.get());
+    StatementVisitor::Visit(branch.body.get());
+  }
+}
+
+void NameResolver::DispatchFor(ForStatement *stmt) {
+  ExpressionVisitor::Visit(stmt->mutable_expression());
+  // The variable is only visible in the body.
+  variables_.PushScope();
+  Declare(stmt);
+  StatementVisitor::Visit(stmt->body().get());
+  variables_.PopScope();
+}
+
+void NameResolver::DispatchWhile(WhileStatement *stmt) {
+  ExpressionVisitor::Visit(stmt->mutable_condition());
+  StatementVisitor::Visit(stmt->body().get());
+}
+
+void NameResolver::DispatchDeclaration(DeclarationStatement *stmt) {
+  // The initializer cannot refer to the variable itself.
+  ExpressionVisitor::Visit(stmt->mutable_expression());
+  Declare(stmt);
+}
+
+void NameResolver::DispatchBreak(BreakStatement *stmt) {}
+
+void NameResolver::DispatchContinue(ContinueStatement *stmt) {}
+
+// Expressions
+// The condition of an `else` branch (and the bounds of a range) are optional.
+void NameResolver::DispatchEmpty() {}
+
+void NameResolver::DispatchTernary(TernaryExpression *expr) {
+  ExpressionVisitor::Visit(expr->mutable_condition());
+  ExpressionVisitor::Visit(expr->mutable_true_case());
+  ExpressionVisitor::Visit(expr->mutable_false_case());
+}
+
+void NameResolver::DispatchBinary(BinaryExpression *expr) {
+  ExpressionVisitor::Visit(expr->mutable_lhs());
+  ExpressionVisitor::Visit(expr->mutable_rhs());
+}
+
+void NameResolver::DispatchUnary(UnaryExpression *expr) {
+  ExpressionVisitor::Visit(expr->mutable_expression());
+}
+
+void NameResolver::DispatchCall(CallExpression *expr) {
+  expr->function_ = LookupFunction(expr->identifier(), expr->location());
+  for (const auto &arg : expr->args()) {
+    ExpressionVisitor::Visit(arg.get());
+  }
+}
+
+void NameResolver::DispatchRange(RangeExpression *expr) {
+  ExpressionVisitor::Visit(expr->mutable_lhs());
+  ExpressionVisitor::Visit(expr->mutable_rhs());
+}
+
+void NameResolver::DispatchArray(ArrayExpression *expr) {
+  for (const auto &element : expr->mutable_elements()) {
+    ExpressionVisitor::Visit(element.get());
+  }
+}
+
+void NameResolver::DispatchCast(CastExpression *expr) {
+  ExpressionVisitor::Visit(expr->mutable_expression());
+}
+
+void NameResolver::DispatchConstant(ConstantExpression *expr) {}
+
+void NameResolver::DispatchIdentifier(IdentifierExpression *expr) {
+  std::optional<Variable> variable = variables_.lookup(expr->identifier());
+  if (!variable.has_value()) {
+    error_context_ << MakeError(
+        expr->location(),
+        absl::StrCat("use of undeclared identifier '",
+                     expr->identifier().str(), "'"));
+    return;
+  }
+  expr->binding_ = variable->binding;
+  expr->slot_ = variable->slot;
+}
+
+void NameResolver::DispatchMemberAccess(MemberAccessExpression *expr) {
+  ExpressionVisitor::Visit(expr->mutable_expression());
+}
+
+void NameResolver::DispatchArrayAccess(ArrayAccessExpression *expr) {
+  ExpressionVisitor::Visit(expr->mutable_expression());
+  ExpressionVisitor::Visit(expr->mutable_index());
+}
+
+void NameResolver::DispatchCallOp(CallOpExpression *expr) {
+  // Functions are only called by name, the callee never refers to a variable.
+  if (IdentifierExpression *callee =
+          dyn_cast<IdentifierExpression>(expr->mutable_expression())) {
+    callee->binding_ = LookupFunction(callee->identifier(), callee->location());
+    callee->slot_ = -1;
+  } else {
+    ExpressionVisitor::Visit(expr->mutable_expression());
+  }
+  for (const auto &arg : expr->mutable_args()) {
+    ExpressionVisitor::Visit(arg.get());
+  }
+}
+
+void NameResolver::DispatchMalloc(MallocExpression *expr) {
+  ExpressionVisitor::Visit(expr->mutable_expression());
+}
+
+void NameResolver::DispatchSizeof(SizeofExpression *expr) {}
+// `NameResolver` =======================================================
+} // namespace Cobold
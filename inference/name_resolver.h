@@ -0,0 +1,85 @@
+#ifndef COBOLD_INFERENCE_NAME_RESOLVER
+#define COBOLD_INFERENCE_NAME_RESOLVER
+
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "core/function.h"
+#include "core/symbol.h"
+#include "parser/source_file.h"
+#include "reporting/error_context.h"
+#include "util/scoped_map.h"
+#include "visitor/expression_visitor.h"
+#include "visitor/statement_visitor.h"
+
+namespace Cobold {
+// Binds every identifier and call of the program to its declaration (see
+// `IdentifierExpression::binding`) and numbers the variables of every
+// function (see `DefinedFunction::num_slots`). Runs once after parsing, such
+// that type inference and code generation do not look up names at all.
+class NameResolver : private StatementVisitor<false>,
+                     private ExpressionVisitor<false, void> {
+public:
+  // Resolves the parsed functions of all modules, i.e., `modules` needs to
+  // contain the transitive imports of every module. Reports undeclared and
+  // redeclared names, and assignments to anything but a variable or `>>ptr`.
+  static absl::Status Resolve(std::vector<SourceFile> &modules);
+  // Resolves the body of `function` alone, calls are bound to `functions`.
+  static absl::Status
+  Resolve(DefinedFunction *function,
+          const absl::flat_hash_map<Symbol, const Function *> &functions);
+
+private:
+  struct Variable {
+    Binding binding;
+    int slot;
+  };
+
+  NameResolver(
+      const absl::flat_hash_map<Symbol, const Function *> &functions)
+      : functions_(functions) {}
+  void ResolveFunction(DefinedFunction *function);
+
+  // Declares the variable of `stmt` in the innermost scope.
+  void Declare(DeclarationStatement *stmt);
+  const Function *LookupFunction(Symbol name, SourceLocation location);
+
+  // Statements
+  void DispatchReturn(ReturnStatement *stmt) override;
+  void DispatchDeinit(DeinitStatement *stmt) override;
+  void DispatchAssignment(AssignmentStatement *stmt) override;
+  void DispatchCompound(CompoundStatement *stmt) override;
+  void DispatchExpression(ExpressionStatement *stmt) override;
+  void DispatchIf(IfStatement *stmt) override;
+  void DispatchFor(ForStatement *stmt) override;
+  void DispatchWhile(WhileStatement *stmt) override;
+  void DispatchDeclaration(DeclarationStatement *stmt) override;
+  void DispatchBreak(BreakStatement *stmt) override;
+  void DispatchContinue(ContinueStatement *stmt) override;
+
+  // Expressions
+  void DispatchEmpty() override;
+  void DispatchTernary(TernaryExpression *expr) override;
+  void DispatchBinary(BinaryExpression *expr) override;
+  void DispatchUnary(UnaryExpression *expr) override;
+  void DispatchCall(CallExpression *expr) override;
+  void DispatchRange(RangeExpression *expr) override;
+  void DispatchArray(ArrayExpression *expr) override;
+  void DispatchCast(CastExpression *expr) override;
+  void DispatchConstant(ConstantExpression *expr) override;
+  void DispatchIdentifier(IdentifierExpression *expr) override;
+  void DispatchMemberAccess(MemberAccessExpression *expr) override;
+  void DispatchArrayAccess(ArrayAccessExpression *expr) override;
+  void DispatchCallOp(CallOpExpression *expr) override;
+  void DispatchMalloc(MallocExpression *expr) override;
+  void DispatchSizeof(SizeofExpression *expr) override;
+
+  const absl::flat_hash_map<Symbol, const Function *> &functions_;
+  ScopedMap<Symbol, Variable> variables_;
+  int num_slots_ = 0; // of the current function
+  ErrorContext error_context_;
+};
+} // namespace Cobold
+
+#endif /* COBOLD_INFERENCE_NAME_RESOLVER */
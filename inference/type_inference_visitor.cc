@@ -1,10 +1,15 @@
 #include "inference/type_inference_visitor.h"
 
+#include <algorithm>
 #include <cassert>
 #include <memory>
 #include <optional>
 #include <variant>
 
+#include "absl/synchronization/mutex.h"
+#include "core/ast_arena.h"
+#include "util/thread_pool.h"
+
 namespace Cobold {
 namespace {
 const IntegralType *PromoteIntegral(const Type *lhs, const Type *rhs) {
@@ -59,25 +64,195 @@ const Type *PromoteArithmetic(const Type *lhs, const Type *rhs) {
   }
   assert(false);
 }
+// The type `lhs op rhs` is computed in, see `DispatchBinary`.
+const Type *CompoundOperationType(BinaryExpressionType op_type,
+                                  const Type *lhs, const Type *rhs) {
+  const bool integral = lhs->type_class() == TypeClass::Integral &&
+                        rhs->type_class() == TypeClass::Integral;
+  switch (op_type) {
+  case BinaryExpressionType::BIT_OR:
+  case BinaryExpressionType::BIT_XOR:
+  case BinaryExpressionType::BIT_AND:
+  case BinaryExpressionType::SHIFT_LEFT:
+  case BinaryExpressionType::SHIFT_RIGHT:
+    assert(integral); // Bit operations only for Integral types!
+    return PromoteIntegral(lhs, rhs);
+  case BinaryExpressionType::MOD:
+    if (integral)
+      return PromoteIntegral(lhs, rhs);
+    assert(ArePointerMathTypes(lhs, rhs));
+    return PromotePointer(lhs, rhs);
+  case BinaryExpressionType::ADD:
+  case BinaryExpressionType::SUBTRACT:
+  case BinaryExpressionType::MULTIPLY:
+  case BinaryExpressionType::DIVIDE:
+    if (IsArithmetic(lhs) && IsArithmetic(rhs))
+      return PromoteArithmetic(lhs, rhs);
+    assert(ArePointerMathTypes(lhs, rhs));
+    return PromotePointer(lhs, rhs);
+  default:
+    assert(false); // Not a compound assignment operator.
+  }
+}
+// Whether the low bits of `lhs op rhs` only depend on the low bits of the
+// operands, i.e., whether the operation wraps around the same way in any
+// integral type. Not so for division, remainder and shifts.
+bool IsWrapping(BinaryExpressionType op_type) {
+  switch (op_type) {
+  case BinaryExpressionType::ADD:
+  case BinaryExpressionType::SUBTRACT:
+  case BinaryExpressionType::MULTIPLY:
+  case BinaryExpressionType::BIT_OR:
+  case BinaryExpressionType::BIT_XOR:
+  case BinaryExpressionType::BIT_AND:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Whether the literal `expr` (still typed `i64` or `f64`) can be created as a
+// `type` directly, instead of being cast to it. That is, an integer (floating)
+// constant that fits into the integral (floating) `type`, or integer
+// arithmetic on such constants, which wraps around the same way in `type`.
+bool IsRetypableLiteral(const Expression *expr, const Type *type) {
+  const TypeClass type_class = type->type_class();
+  switch (expr->type()) {
+  case ExpressionType::Constant: {
+    const auto &data = expr->As<ConstantExpression>()->data();
+    if (const auto *value = std::get_if<int64_t>(&data)) {
+      if (type_class != TypeClass::Integral)
+        return false;
+      const int size = type->As<IntegralType>()->size();
+      if (size >= 64)
+        return true;
+      const int64_t bound = int64_t{1} << (size - 1);
+      return -bound <= *value && *value < bound;
+    }
+    return std::holds_alternative<double>(data) &&
+           type_class == TypeClass::Floating;
+  }
+  case ExpressionType::Unary: {
+    const auto *unary = expr->As<UnaryExpression>();
+    switch (unary->op_type()) {
+    case UnaryExpressionType::NEGATIVE:
+    case UnaryExpressionType::POSITIVE:
+      return IsRetypableLiteral(unary->expression(), type);
+    case UnaryExpressionType::INVERT:
+      return type_class == TypeClass::Integral &&
+             IsRetypableLiteral(unary->expression(), type);
+    default:
+      return false;
+    }
+  }
+  case ExpressionType::Binary: {
+    const auto *binary = expr->As<BinaryExpression>();
+    return IsWrapping(binary->op_type()) && type_class == TypeClass::Integral &&
+           IsRetypableLiteral(binary->lhs(), type) &&
+           IsRetypableLiteral(binary->rhs(), type);
+  }
+  default:
+    return false;
+  }
+}
+
+// Whether `from` is an integral type wider than the integral `to`.
+bool IsTruncation(const Type *from, const Type *to) {
+  const auto *from_integral = dyn_cast<IntegralType>(from);
+  const auto *to_integral = dyn_cast<IntegralType>(to);
+  return from_integral != nullptr && to_integral != nullptr &&
+         to_integral->size() < from_integral->size();
+}
+
+// Whether `expr`, which is truncated to the integral `type`, can be computed
+// in `type` directly. That is, a retypable literal, an operand that was only
+// widened from `type` (by the promotion of its binary expression), or
+// wrapping arithmetic on those (e.g., `x + 1` for `x: i8` used as an `i8`).
+bool IsNarrowable(const Expression *expr, const Type *type) {
+  if (IsRetypableLiteral(expr, type))
+    return true;
+  if (const auto *widened = dyn_cast<CastExpression>(expr))
+    return widened->expression()->expr_type() == type;
+  const auto *binary = dyn_cast<BinaryExpression>(expr);
+  return binary != nullptr && IsWrapping(binary->op_type()) &&
+         IsTruncation(binary->expr_type(), type) &&
+         IsNarrowable(binary->lhs(), type) && IsNarrowable(binary->rhs(), type);
+}
 } // namespace
 // `TypeInferenceVisitor` ===============================================
-void TypeInferenceVisitor::Annotate(SourceFile &file) {
-  TypeInferenceVisitor visitor(file);
-  for (const auto &fn : file.functions()) {
-    if (!fn->external()) {
-      visitor.AnnotateFunction(fn->As<DefinedFunction>());
+void TypeInferenceVisitor::Annotate(std::vector<SourceFile> &modules,
+                                    int num_threads) {
+  // A body only reads the signatures (bound by `NameResolver`) and writes to
+  // its own nodes, i.e., functions can be annotated in any order and on any
+  // thread with the same result. Each task annotates a chunk of the functions
+  // of one file with a visitor of its own.
+  struct Chunk {
+    std::vector<DefinedFunction *> functions;
+    AstArena *arena; // of the file, see `SourceFile::arena`
+  };
+  constexpr int kFunctionsPerChunk = 32;
+  std::vector<Chunk> chunks;
+  for (SourceFile &file : modules) {
+    if (file.annotated())
+      continue;
+    Chunk chunk{{}, file.arena()};
+    for (const auto &fn : file.functions()) {
+      // Unparsed bodies are unreachable from `Main` (see `BodyLoader`).
+      if (fn->external() || !fn->As<DefinedFunction>()->parsed())
+        continue;
+      chunk.functions.push_back(fn->As<DefinedFunction>());
+      if (chunk.functions.size() == kFunctionsPerChunk) {
+        chunks.push_back(std::move(chunk));
+        chunk = Chunk{{}, file.arena()};
+      }
     }
+    if (!chunk.functions.empty())
+      chunks.push_back(std::move(chunk));
+    file.annotated_ = true;
   }
+
+  if (chunks.size() <= 1 || num_threads == 1) {
+    TypeInferenceVisitor visitor;
+    for (const Chunk &chunk : chunks) {
+      AstArena::Scope scope(chunk.arena);
+      for (DefinedFunction *function : chunk.functions)
+        visitor.AnnotateFunction(function);
+    }
+    return;
+  }
+
+  TypeTable *types = TypeTable::Current();
+  absl::Mutex arena_mutex;
+  ThreadPool pool(num_threads);
+  for (const Chunk &chunk : chunks) {
+    pool.Schedule([&chunk, types, &arena_mutex]() {
+      TypeTable::Scope types_scope(types);
+      // Arenas are not thread-safe, the inserted casts are allocated from an
+      // arena of the task that is handed to the file afterwards.
+      AstArena arena;
+      {
+        AstArena::Scope arena_scope(chunk.arena != nullptr ? &arena : nullptr);
+        TypeInferenceVisitor visitor;
+        for (DefinedFunction *function : chunk.functions)
+          visitor.AnnotateFunction(function);
+      }
+      if (chunk.arena != nullptr) {
+        absl::MutexLock lock(&arena_mutex);
+        chunk.arena->Merge(&arena);
+      }
+    });
+  }
+  pool.Wait();
+}
+
+void TypeInferenceVisitor::Annotate(DefinedFunction *function) {
+  TypeInferenceVisitor visitor;
+  visitor.AnnotateFunction(function);
 }
 
 void TypeInferenceVisitor::AnnotateFunction(DefinedFunction *function) {
   type_context_.PushFunctionReturn(function->return_type());
-  type_context_.PushScope();
-  for (const auto &arg : function->arguments()) {
-    type_context_.StoreVar(arg.name, arg.type);
-  }
   StatementVisitor::Visit(&function->mutable_body());
-  type_context_.PopScope();
   type_context_.PopFunctionReturn();
 }
 
@@ -211,62 +386,31 @@ void TypeInferenceVisitor::DispatchDeinit(DeinitStatement *stmt) {
 }
 
 void TypeInferenceVisitor::DispatchAssignment(AssignmentStatement *stmt) {
-  // TODO(jlscheerer) Check that the types are compatible by the operation!
-  BinaryExpressionType bin_op;
-  switch (stmt->assgn_type()) {
-  case AssignmentType::EQ:
-    ExpressionVisitor::Visit(stmt->mutable_lhs());
-    ExpressionVisitor::Visit(stmt->mutable_rhs());
-    assert(
-        CanCastExplicitTo(stmt->rhs()->expr_type(), stmt->lhs()->expr_type()));
-    stmt->rhs_ =
-        WrapExplicitCast(stmt->lhs()->expr_type(), std::move(stmt->rhs_));
+  ExpressionVisitor::Visit(stmt->mutable_lhs());
+  ExpressionVisitor::Visit(stmt->mutable_rhs());
+  const Type *lhs_type = stmt->lhs()->expr_type();
+  if (!stmt->compound()) {
+    assert(CanCastExplicitTo(stmt->rhs()->expr_type(), lhs_type));
+    stmt->rhs_ = WrapExplicitCast(lhs_type, std::move(stmt->rhs_));
     return;
-  // in the non-trivial case rewrite: a x= b to a = a x b
-  case AssignmentType::MUL_EQ:
-    bin_op = BinaryExpressionType::MULTIPLY;
-    break;
-  case AssignmentType::DIV_EQ:
-    bin_op = BinaryExpressionType::DIVIDE;
-    break;
-  case AssignmentType::MOD_EQ:
-    bin_op = BinaryExpressionType::MOD;
-    break;
-  case AssignmentType::ADD_EQ:
-    bin_op = BinaryExpressionType::ADD;
-    break;
-  case AssignmentType::SUB_EQ:
-    bin_op = BinaryExpressionType::SUBTRACT;
-    break;
-  case AssignmentType::SHL_EQ:
-    bin_op = BinaryExpressionType::SHIFT_LEFT;
-    break;
-  case AssignmentType::SHR_EQ:
-    bin_op = BinaryExpressionType::SHIFT_RIGHT;
-    break;
-  // TODO(jlscheerer) For bit operations they could be logical or bitwise!
-  case AssignmentType::AND_EQ:
-    bin_op = BinaryExpressionType::BIT_AND;
-    break;
-  case AssignmentType::XOR_EQ:
-    bin_op = BinaryExpressionType::BIT_XOR;
-    break;
-  case AssignmentType::OR_EQ:
-    bin_op = BinaryExpressionType::BIT_OR;
-    break;
   }
-  stmt->assgn_type_ = AssignmentType::EQ;
-  stmt->rhs_ = std::make_unique<BinaryExpression>(SourceLocation::Generated(),
-                                                  stmt->lhs()->Clone(), bin_op,
-                                                  std::move(stmt->rhs_));
-  return DispatchAssignment(stmt);
+  // `a x= b` is kept as is (instead of `a = a x b`), such that codegen only
+  // evaluates the address of `a` once. The result is truncated to the type of
+  // `a`, i.e., a literal `b` is created at that type if the operation wraps.
+  const BinaryExpressionType op_type =
+      AssignmentStatement::OperatorOf(stmt->assgn_type());
+  if (IsWrapping(op_type) && IsRetypableLiteral(stmt->rhs(), lhs_type))
+    RetypeLiteral(stmt->mutable_rhs(), lhs_type);
+  const Type *operation_type =
+      CompoundOperationType(op_type, lhs_type, stmt->rhs()->expr_type());
+  assert(CanCastExplicitTo(operation_type, lhs_type));
+  stmt->operation_type_ = operation_type;
+  stmt->rhs_ = WrapExplicitCast(operation_type, std::move(stmt->rhs_));
 }
 
 void TypeInferenceVisitor::DispatchCompound(CompoundStatement *stmt) {
-  type_context_.PushScope();
   for (const auto &child : stmt->statements())
     StatementVisitor::Visit(child.get());
-  type_context_.PopScope();
 }
 
 void TypeInferenceVisitor::DispatchExpression(ExpressionStatement *stmt) {
@@ -292,7 +436,6 @@ void TypeInferenceVisitor::DispatchFor(ForStatement *stmt) {
   } else {
     stmt->decl_type_ = IteratorType(stmt->expression()->expr_type());
   }
-  type_context_.StoreVar(stmt->identifier(), stmt->decl_type());
   StatementVisitor::Visit(stmt->body().get());
 }
 
@@ -361,7 +504,6 @@ void TypeInferenceVisitor::DispatchDeclaration(DeclarationStatement *stmt) {
   }
   // stmt->decl_type() == stmt->expression()->expr_type() should be fine for
   // now (and does not require an explicit cast)!
-  assert(type_context_.StoreVar(stmt->identifier(), stmt->decl_type()));
 }
 
 void TypeInferenceVisitor::DispatchBreak(BreakStatement *stmt) {
@@ -393,10 +535,12 @@ void TypeInferenceVisitor::DispatchTernary(TernaryExpression *expr) {
 
 void TypeInferenceVisitor::DispatchBinary(BinaryExpression *expr) {
   ExpressionVisitor::Visit(expr->mutable_lhs());
+  ExpressionVisitor::Visit(expr->mutable_rhs());
+  // Literal operands keep their type here (e.g., `x * 100` for `x: i8` is an
+  // `i64` multiplication), only the consumer of the result can narrow it (see
+  // `WrapExplicitCast`).
   const Type *lhs_type = expr->lhs()->expr_type();
   const TypeClass lhs_tc = lhs_type->type_class();
-
-  ExpressionVisitor::Visit(expr->mutable_rhs());
   const Type *rhs_type = expr->rhs()->expr_type();
   const TypeClass rhs_tc = rhs_type->type_class();
 
@@ -607,7 +751,7 @@ void TypeInferenceVisitor::DispatchConstant(ConstantExpression *expr) {
     expr->set_expr_type(IntegralType::OfSize(64));
   } else if (std::holds_alternative<double>(expr->data())) {
     expr->set_expr_type(FloatingType::OfSize(64));
-  } else if (std::holds_alternative<std::string>(expr->data())) {
+  } else if (std::holds_alternative<Symbol>(expr->data())) {
     expr->set_expr_type(StringType::Get());
   } else {
     // this should not happen (i.e. there are no other constant types!)
@@ -616,8 +760,15 @@ void TypeInferenceVisitor::DispatchConstant(ConstantExpression *expr) {
 }
 
 void TypeInferenceVisitor::DispatchIdentifier(IdentifierExpression *expr) {
-  assert(type_context_.LookupVar(expr->identifier()) != std::nullopt);
-  expr->set_expr_type(*type_context_.LookupVar(expr->identifier()));
+  // Declarations are annotated before any of their uses (see `NameResolver`).
+  const Binding &binding = expr->binding();
+  if (const auto *stmt = std::get_if<const DeclarationStatement *>(&binding)) {
+    expr->set_expr_type((*stmt)->decl_type());
+  } else if (const auto *arg = std::get_if<const FunctionArgument *>(&binding)) {
+    expr->set_expr_type((*arg)->type);
+  } else {
+    assert(false); // unresolved or a function (which is only called)!
+  }
 }
 
 void TypeInferenceVisitor::DispatchMemberAccess(MemberAccessExpression *expr) {}
@@ -642,11 +793,17 @@ void TypeInferenceVisitor::DispatchArrayAccess(ArrayAccessExpression *expr) {
 
 void TypeInferenceVisitor::DispatchCallOp(CallOpExpression *expr) {
   assert(expr->expression()->type() == ExpressionType::Identifier);
-  std::string identifier =
-      expr->expression()->As<IdentifierExpression>()->identifier();
-  const auto fn_declaration = type_context_.LookupFn(identifier);
-  assert(fn_declaration != std::nullopt); // function does not exist!
-  const auto &[fn_ret_type, fn_arg_types] = *fn_declaration;
+  const Binding &callee =
+      expr->expression()->As<IdentifierExpression>()->binding();
+  assert(std::holds_alternative<const Function *>(callee));
+  const Function *function = std::get<const Function *>(callee);
+  assert(function != nullptr); // function does not exist!
+  const Type *fn_ret_type = function->return_type();
+  std::vector<const Type *> fn_arg_types;
+  fn_arg_types.reserve(function->arguments().size());
+  for (const FunctionArgument &arg : function->arguments()) {
+    fn_arg_types.push_back(arg.type);
+  }
   std::vector<const Type *> arg_types;
   arg_types.reserve(expr->args().size());
   for (const auto &arg : expr->args()) {
@@ -672,11 +829,49 @@ void TypeInferenceVisitor::DispatchSizeof(SizeofExpression *expr) {
   expr->set_expr_type(IntegralType::OfSize(64));
 }
 
+void TypeInferenceVisitor::RetypeLiteral(Expression *expr, const Type *type) {
+  assert(IsRetypableLiteral(expr, type));
+  if (auto *unary = dyn_cast<UnaryExpression>(expr)) {
+    RetypeLiteral(unary->mutable_expression(), type);
+  } else if (auto *binary = dyn_cast<BinaryExpression>(expr)) {
+    RetypeLiteral(binary->mutable_lhs(), type);
+    RetypeLiteral(binary->mutable_rhs(), type);
+  }
+  expr->set_expr_type(type);
+}
+
+void TypeInferenceVisitor::Narrow(std::unique_ptr<Expression> &expr,
+                                  const Type *type) {
+  assert(IsNarrowable(expr.get(), type));
+  if (IsRetypableLiteral(expr.get(), type)) {
+    RetypeLiteral(expr.get(), type);
+  } else if (auto *widened = dyn_cast<CastExpression>(expr.get())) {
+    expr = std::move(widened->expr_);
+  } else {
+    auto *binary = cast<BinaryExpression>(expr.get());
+    Narrow(binary->lhs_, type);
+    Narrow(binary->rhs_, type);
+    binary->set_expr_type(type);
+  }
+}
+
 std::unique_ptr<Expression>
 TypeInferenceVisitor::WrapExplicitCast(const Type *type,
                                        std::unique_ptr<Expression> &&expr) {
   if (type == expr->expr_type())
     return std::move(expr);
+  // Literals are created at the expected type instead (e.g., `var x: i8 = 1`
+  // or `f(1)`), which saves the cast in the AST and the IR.
+  if (IsRetypableLiteral(expr.get(), type)) {
+    RetypeLiteral(expr.get(), type);
+    return std::move(expr);
+  }
+  // Likewise, wrapping arithmetic that is only used truncated is computed at
+  // the narrower type (e.g., `var y: i8 = x + 1` for `x: i8`).
+  if (IsTruncation(expr->expr_type(), type) && IsNarrowable(expr.get(), type)) {
+    Narrow(expr, type);
+    return std::move(expr);
+  }
   auto new_expr = std::make_unique<CastExpression>(SourceLocation::Generated(),
                                                    type, std::move(expr));
   new_expr->set_expr_type(type);
@@ -11,10 +11,16 @@ namespace Cobold {
 class TypeInferenceVisitor : private ExpressionVisitor<false, void>,
                              private StatementVisitor<false> {
 public:
-  static void Annotate(SourceFile &file);
+  // Annotates all modules of the program, which need to be resolved (see
+  // `NameResolver`). Modules that are already annotated (e.g., loaded from
+  // the module cache) are skipped. Functions are annotated concurrently on
+  // `num_threads` threads (`<= 0` uses all hardware threads).
+  static void Annotate(std::vector<SourceFile> &modules, int num_threads = 0);
+  // Annotates the (resolved) body of `function` alone.
+  static void Annotate(DefinedFunction *function);
 
 private:
-  TypeInferenceVisitor(SourceFile &file) : type_context_(file) {}
+  TypeInferenceVisitor() = default;
   void AnnotateFunction(DefinedFunction *function);
 
   static bool CanCastExplicitTo(const Type *from, const Type *to);
@@ -56,6 +62,10 @@ private:
   void DispatchMalloc(MallocExpression *expr) override;
   void DispatchSizeof(SizeofExpression *expr) override;
 
+  // Types the literal `expr` as `type` (see `IsRetypableLiteral`).
+  static void RetypeLiteral(Expression *expr, const Type *type);
+  // Computes the truncated `expr` in `type` (see `IsNarrowable`).
+  static void Narrow(std::unique_ptr<Expression> &expr, const Type *type);
   std::unique_ptr<Expression>
   WrapExplicitCast(const Type *type, std::unique_ptr<Expression> &&expr);
 
@@ -0,0 +1,127 @@
+#include "inference/type_inference_visitor.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "codegen/llvm_codegen.h"
+#include "core/expression.h"
+#include "core/function.h"
+#include "core/statement.h"
+#include "core/type.h"
+#include "gtest/gtest.h"
+#include "inference/name_resolver.h"
+#include "parser/parser.h"
+#include "parser/source_file.h"
+#include "parser/source_manager.h"
+#include "util/casting.h"
+
+#include "llvm/IR/LLVMContext.h"
+
+namespace Cobold {
+namespace {
+// Operands of different widths are computed at the wider type, unless the
+// result is only used at the narrower one (where it wraps around the same).
+constexpr char kSource[] = R"(fn Product() -> i64 {
+    let x: i8 = 100;
+    return x * 100;
+}
+
+fn Declared() -> i64 {
+    let x: i8 = 100;
+    var y: i64 = x * 100;
+    return y;
+}
+
+fn Quotient() -> i64 {
+    let x: i8 = -128;
+    var y: i64 = x / -1;
+    return y;
+}
+
+fn NarrowQuotient() -> i64 {
+    let x: i8 = -128;
+    var y: i8 = x / -1;
+    return y;
+}
+
+fn Remainder() -> i64 {
+    let x: i8 = -128;
+    return x % -1;
+}
+
+fn Wrapped() -> i64 {
+    let x: i8 = 100;
+    var y: i8 = x + 100;
+    return y;
+}
+
+fn Compound() -> i64 {
+    var x: i8 = -128;
+    x /= -1;
+    return x;
+}
+)";
+
+class TypeInferenceVisitorTest : public ::testing::Test {
+protected:
+  TypeInferenceVisitorTest() : scope_(&types_) {}
+
+  void SetUp() override {
+    source_ = SourceBuffer::FromString("mixed_width.cb", kSource);
+    absl::StatusOr<SourceFile> file = Parser::Parse(*source_);
+    ASSERT_TRUE(file.ok()) << file.status();
+    modules_.push_back(*std::move(file));
+    ASSERT_TRUE(NameResolver::Resolve(modules_).ok());
+    TypeInferenceVisitor::Annotate(modules_);
+  }
+
+  const DefinedFunction *Lookup(const std::string &name) const {
+    for (const auto &function : modules_[0].functions()) {
+      if (function->name().str() == name)
+        return cast<DefinedFunction>(function.get());
+    }
+    return nullptr;
+  }
+
+  // The (constant folded) IR of the function `name`.
+  std::string IR(const std::string &name) {
+    const DefinedFunction *function = Lookup(name);
+    EXPECT_NE(function, nullptr) << name;
+    return function == nullptr
+               ? ""
+               : LLVMCodeGen::GenerateFunctionIR(&context_, function, {});
+  }
+
+  TypeTable types_;
+  TypeTable::Scope scope_;
+  llvm::LLVMContext context_;
+  std::unique_ptr<SourceBuffer> source_;
+  std::vector<SourceFile> modules_;
+};
+
+TEST_F(TypeInferenceVisitorTest, MixedWidthArithmeticUsesWiderType) {
+  EXPECT_NE(IR("Product").find("ret i64 10000"), std::string::npos);
+  EXPECT_NE(IR("Declared").find("ret i64 10000"), std::string::npos);
+}
+
+TEST_F(TypeInferenceVisitorTest, MixedWidthDivisionDoesNotOverflow) {
+  EXPECT_NE(IR("Quotient").find("ret i64 128"), std::string::npos);
+  EXPECT_NE(IR("NarrowQuotient").find("ret i64 -128"), std::string::npos);
+  EXPECT_NE(IR("Remainder").find("ret i64 0"), std::string::npos);
+  EXPECT_NE(IR("Compound").find("ret i64 -128"), std::string::npos);
+}
+
+TEST_F(TypeInferenceVisitorTest, NarrowsWrappingArithmeticUsedTruncated) {
+  EXPECT_NE(IR("Wrapped").find("ret i64 -56"), std::string::npos);
+  // `x + 100` is an `i8` addition without casts.
+  const Statement *stmt = Lookup("Wrapped")->body().statements()[1].get();
+  const Expression *expr = cast<DeclarationStatement>(stmt)->expression();
+  ASSERT_TRUE(isa<BinaryExpression>(expr));
+  EXPECT_EQ(expr->expr_type(), IntegralType::OfSize(8));
+  EXPECT_TRUE(
+      isa<IdentifierExpression>(cast<BinaryExpression>(expr)->lhs()));
+}
+} // namespace
+} // namespace Cobold
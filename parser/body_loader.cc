@@ -0,0 +1,57 @@
+#include "parser/body_loader.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "core/ast_arena.h"
+#include "core/symbol.h"
+#include "parser/parser.h"
+#include "util/call_collector.h"
+
+namespace Cobold {
+// `BodyLoader` =========================================================
+absl::Status BodyLoader::LoadReachable(std::vector<SourceFile> &modules,
+                                       const ParserOptions &options) {
+  // Bodies are allocated from the arena of their file.
+  absl::flat_hash_map<Symbol,
+                      std::vector<std::pair<DefinedFunction *, AstArena *>>>
+      functions;
+  for (const SourceFile &file : modules) {
+    for (const auto &fn : file.functions()) {
+      if (!fn->external()) {
+        functions[fn->name()].push_back(
+            {fn->As<DefinedFunction>(), file.arena()});
+      }
+    }
+  }
+
+  const Symbol main = Symbol::Intern("Main");
+  absl::flat_hash_set<Symbol> visited = {main};
+  std::vector<Symbol> worklist = {main};
+  while (!worklist.empty()) {
+    const Symbol name = worklist.back();
+    worklist.pop_back();
+    auto it = functions.find(name);
+    if (it == functions.end())
+      continue;
+    for (const auto &[function, arena] : it->second) {
+      // Modules loaded from the cache are always parsed completely.
+      if (!function->parsed()) {
+        AstArena::Scope scope(arena);
+        absl::Status status = Parser::ParseBody(function, options);
+        if (!status.ok())
+          return status;
+      }
+      for (Symbol callee :
+           CallCollector::Collect(&function->body())) {
+        if (visited.insert(callee).second)
+          worklist.push_back(callee);
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+// `BodyLoader` =========================================================
+} // namespace Cobold
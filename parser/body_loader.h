@@ -0,0 +1,22 @@
+#ifndef COBOLD_PARSER_BODY_LOADER
+#define COBOLD_PARSER_BODY_LOADER
+
+#include <vector>
+
+#include "absl/status/status.h"
+#include "parser/internal/options.h"
+#include "parser/source_file.h"
+
+namespace Cobold {
+// Parses the skipped bodies (see `ParserOptions::lazy_bodies`) of all
+// functions reachable from `Main` through calls. The bodies of all other
+// functions are never parsed (nor checked for syntax errors), such that large
+// imported libraries only cost as much as the part of them that is used.
+class BodyLoader {
+public:
+  static absl::Status LoadReachable(std::vector<SourceFile> &modules,
+                                    const ParserOptions &options);
+};
+} // namespace Cobold
+
+#endif /* COBOLD_PARSER_BODY_LOADER */
@@ -0,0 +1,631 @@
+#include "parser/expression_parser.h"
+
+#include <cstdlib>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "parser/internal/limits.h"
+
+namespace Cobold {
+namespace {
+// Binding power of binary operators, 0 for tokens that are not binary
+// operators. Mirrors the nesting of the `*Expression` rules in `Cobold.g4`.
+int BinaryPrecedence(TokenKind kind) {
+  switch (kind) {
+  case TokenKind::PipePipe:
+    return 1;
+  case TokenKind::AmpAmp:
+    return 2;
+  case TokenKind::Pipe:
+    return 3;
+  case TokenKind::Caret:
+    return 4;
+  case TokenKind::Amp:
+    return 5;
+  case TokenKind::EqualEqual:
+  case TokenKind::NotEqual:
+    return 6;
+  case TokenKind::Less:
+  case TokenKind::Greater:
+  case TokenKind::LessEqual:
+  case TokenKind::GreaterEqual:
+    return 7;
+  case TokenKind::ShiftLeft:
+  case TokenKind::ShiftRight:
+    return 8;
+  case TokenKind::Plus:
+  case TokenKind::Minus:
+    return 9;
+  case TokenKind::Star:
+  case TokenKind::Slash:
+  case TokenKind::Percent:
+    return 10;
+  default:
+    return 0;
+  }
+}
+constexpr int kLowestPrecedence = 1;
+
+BinaryExpressionType BinaryType(TokenKind kind) {
+  switch (kind) {
+  case TokenKind::PipePipe:
+    return BinaryExpressionType::LOGICAL_OR;
+  case TokenKind::AmpAmp:
+    return BinaryExpressionType::LOGICAL_AND;
+  case TokenKind::Pipe:
+    return BinaryExpressionType::BIT_OR;
+  case TokenKind::Caret:
+    return BinaryExpressionType::BIT_XOR;
+  case TokenKind::Amp:
+    return BinaryExpressionType::BIT_AND;
+  case TokenKind::EqualEqual:
+    return BinaryExpressionType::EQUALS;
+  case TokenKind::NotEqual:
+    return BinaryExpressionType::NOT_EQUALS;
+  case TokenKind::Less:
+    return BinaryExpressionType::LESS_THAN;
+  case TokenKind::Greater:
+    return BinaryExpressionType::GREATER_THAN;
+  case TokenKind::LessEqual:
+    return BinaryExpressionType::LESS_EQUAL;
+  case TokenKind::GreaterEqual:
+    return BinaryExpressionType::GREATER_EQUAL;
+  case TokenKind::ShiftLeft:
+    return BinaryExpressionType::SHIFT_LEFT;
+  case TokenKind::ShiftRight:
+    return BinaryExpressionType::SHIFT_RIGHT;
+  case TokenKind::Plus:
+    return BinaryExpressionType::ADD;
+  case TokenKind::Minus:
+    return BinaryExpressionType::SUBTRACT;
+  case TokenKind::Star:
+    return BinaryExpressionType::MULTIPLY;
+  case TokenKind::Slash:
+    return BinaryExpressionType::DIVIDE;
+  default:
+    assert(kind == TokenKind::Percent);
+    return BinaryExpressionType::MOD;
+  }
+}
+
+// unaryOperator: '&' | '>>' | '+' | '-' | '~' | '!'
+bool IsUnaryOperator(TokenKind kind) {
+  return kind == TokenKind::Amp || kind == TokenKind::ShiftRight ||
+         kind == TokenKind::Plus || kind == TokenKind::Minus ||
+         kind == TokenKind::Tilde || kind == TokenKind::Bang;
+}
+
+UnaryExpressionType PrefixType(TokenKind kind) {
+  switch (kind) {
+  case TokenKind::PlusPlus:
+    return UnaryExpressionType::PRE_INCREMENT;
+  case TokenKind::DashDash:
+    return UnaryExpressionType::PRE_DECREMENT;
+  case TokenKind::Amp:
+    return UnaryExpressionType::REFERENCE;
+  case TokenKind::ShiftRight:
+    return UnaryExpressionType::DEREFERENCE;
+  case TokenKind::Minus:
+    return UnaryExpressionType::NEGATIVE;
+  case TokenKind::Plus:
+    return UnaryExpressionType::POSITIVE;
+  case TokenKind::Tilde:
+    return UnaryExpressionType::INVERT;
+  default:
+    assert(kind == TokenKind::Bang);
+    return UnaryExpressionType::NOT;
+  }
+}
+
+bool StartsBaseType(TokenKind kind) {
+  return kind == TokenKind::IntegralType || kind == TokenKind::FloatingType ||
+         kind == TokenKind::String || kind == TokenKind::Char ||
+         kind == TokenKind::Bool || kind == TokenKind::Nil;
+}
+} // namespace
+
+std::unique_ptr<Expression>
+RewriteMalloc(std::unique_ptr<MallocExpression> &&malloc) {
+  std::unique_ptr<Expression> lib_malloc =
+      std::make_unique<IdentifierExpression>(SourceLocation::Generated(),
+                                             Symbol::Intern("__lib_malloc"));
+  std::unique_ptr<Expression> type_size = std::make_unique<SizeofExpression>(
+      SourceLocation::Generated(), malloc->decl_type());
+  std::unique_ptr<Expression> alloc_size = std::make_unique<BinaryExpression>(
+      SourceLocation::Generated(), std::move(type_size),
+      BinaryExpressionType::MULTIPLY, malloc->expression()->Clone());
+  std::vector<std::unique_ptr<Expression>> args;
+  args.push_back(std::move(alloc_size));
+
+  std::unique_ptr<Expression> lib_call = std::make_unique<CallOpExpression>(
+      SourceLocation::Generated(), std::move(lib_malloc), std::move(args));
+  return std::make_unique<CastExpression>(SourceLocation::Generated(),
+                                          Type::PointerTo(malloc->decl_type()),
+                                          std::move(lib_call));
+}
+
+// `ExpressionParser` ===================================================
+absl::StatusOr<std::unique_ptr<Expression>>
+ExpressionParser::ParseExpression() {
+  const size_t begin = position_;
+  const bool top_level = depth_ == 0;
+  absl::StatusOr<std::unique_ptr<Expression>> status_or_expr;
+  {
+    NestingScope nesting(&depth_);
+    if (absl::Status status = CheckDepth(); !status.ok())
+      return status;
+    status_or_expr = Peek().kind == TokenKind::LeftBracket
+                         ? ParseBracketExpression()
+                         : ParseConditionalExpression();
+  }
+  if (!status_or_expr.ok() || !top_level)
+    return status_or_expr;
+  if (absl::Status status = CheckExpressionSize(begin); !status.ok())
+    return status;
+  return status_or_expr;
+}
+
+absl::StatusOr<std::unique_ptr<Expression>>
+ExpressionParser::ParseBracketExpression() {
+  // bracketExpression: LBRACKET (RANGE rightExpression?
+  //                   | leftExpression (RANGE rightExpression?
+  //                                     | (',' expression)*))? RBRACKET
+  Next(); // '['
+  std::unique_ptr<Expression> left;
+  if (Peek().kind != TokenKind::DotDot) {
+    if (Accept(TokenKind::RightBracket)) {
+      return std::make_unique<ArrayExpression>(
+          SourceLocation::Complex(),
+          std::vector<std::unique_ptr<Expression>>());
+    }
+    absl::StatusOr<std::unique_ptr<Expression>> status_or_expr =
+        ParseExpression();
+    if (!status_or_expr.ok())
+      return status_or_expr.status();
+    left = *std::move(status_or_expr);
+  }
+
+  if (!Accept(TokenKind::DotDot)) {
+    // array: '[' (expression (',' expression)*)? ']'
+    std::vector<std::unique_ptr<Expression>> elements;
+    elements.push_back(std::move(left));
+    while (Accept(TokenKind::Comma)) {
+      absl::StatusOr<std::unique_ptr<Expression>> status_or_elem =
+          ParseExpression();
+      if (!status_or_elem.ok())
+        return status_or_elem.status();
+      elements.push_back(*std::move(status_or_elem));
+    }
+    if (absl::Status status = Expect(TokenKind::RightBracket); !status.ok())
+      return status;
+    return std::make_unique<ArrayExpression>(SourceLocation::Complex(),
+                                             std::move(elements));
+  }
+
+  // range: '[' leftExpression? '..' rightExpression? ']'
+  std::unique_ptr<Expression> right;
+  if (Peek().kind != TokenKind::RightBracket) {
+    absl::StatusOr<std::unique_ptr<Expression>> status_or_expr =
+        ParseExpression();
+    if (!status_or_expr.ok())
+      return status_or_expr.status();
+    right = *std::move(status_or_expr);
+  }
+  if (absl::Status status = Expect(TokenKind::RightBracket); !status.ok())
+    return status;
+  return std::make_unique<RangeExpression>(SourceLocation::Complex(),
+                                           std::move(left), std::move(right));
+}
+
+absl::StatusOr<std::unique_ptr<Expression>>
+ExpressionParser::ParseConditionalExpression() {
+  const size_t begin = position_;
+  const bool top_level = depth_ == 0;
+  absl::StatusOr<std::unique_ptr<Expression>> status_or_expr =
+      ParseCastExpression();
+  if (!status_or_expr.ok())
+    return status_or_expr.status();
+  status_or_expr =
+      ParseBinaryExpression(*std::move(status_or_expr), kLowestPrecedence);
+  if (!status_or_expr.ok())
+    return status_or_expr.status();
+  status_or_expr = ParseTernaryExpression(*std::move(status_or_expr));
+  if (!status_or_expr.ok() || !top_level)
+    return status_or_expr;
+  if (absl::Status status = CheckExpressionSize(begin); !status.ok())
+    return status;
+  return status_or_expr;
+}
+
+absl::StatusOr<std::unique_ptr<Expression>>
+ExpressionParser::ParseBinaryExpression(std::unique_ptr<Expression> lhs,
+                                        int precedence) {
+  while (true) {
+    const TokenKind op = Peek().kind;
+    const int op_precedence = BinaryPrecedence(op);
+    if (op_precedence == 0 || op_precedence < precedence)
+      return lhs;
+    Next();
+    absl::StatusOr<std::unique_ptr<Expression>> status_or_rhs =
+        ParseCastExpression();
+    if (!status_or_rhs.ok())
+      return status_or_rhs.status();
+    // All operators are left-associative, i.e., only operators binding
+    // tighter than `op` belong to its right operand.
+    status_or_rhs =
+        ParseBinaryExpression(*std::move(status_or_rhs), op_precedence + 1);
+    if (!status_or_rhs.ok())
+      return status_or_rhs.status();
+    lhs = std::make_unique<BinaryExpression>(SourceLocation::Complex(),
+                                             std::move(lhs), BinaryType(op),
+                                             *std::move(status_or_rhs));
+  }
+}
+
+absl::StatusOr<std::unique_ptr<Expression>>
+ExpressionParser::ParseTernaryExpression(
+    std::unique_ptr<Expression> condition) {
+  if (!Accept(TokenKind::Question))
+    return condition;
+  absl::StatusOr<std::unique_ptr<Expression>> status_or_true =
+      ParseExpression();
+  if (!status_or_true.ok())
+    return status_or_true.status();
+  if (absl::Status status = Expect(TokenKind::Colon); !status.ok())
+    return status;
+  absl::StatusOr<std::unique_ptr<Expression>> status_or_false =
+      ParseConditionalExpression();
+  if (!status_or_false.ok())
+    return status_or_false.status();
+  return std::make_unique<TernaryExpression>(
+      SourceLocation::Complex(), std::move(condition),
+      *std::move(status_or_true), *std::move(status_or_false));
+}
+
+absl::StatusOr<std::unique_ptr<Expression>>
+ExpressionParser::ParseCastExpression() {
+  NestingScope nesting(&depth_);
+  if (absl::Status status = CheckDepth(); !status.ok())
+    return status;
+  switch (Peek().kind) {
+  case TokenKind::Malloc:
+    return ParseMallocExpression();
+  case TokenKind::Sizeof:
+    return ParseSizeofExpression();
+  case TokenKind::LeftParen:
+    if (AtCast())
+      break;
+    [[fallthrough]];
+  default:
+    return ParseUnaryExpression();
+  }
+
+  // '(' typeSpecifier ')' castExpression
+  Next(); // '('
+  absl::StatusOr<const Type *> status_or_type = ParseType();
+  if (!status_or_type.ok())
+    return status_or_type.status();
+  if (absl::Status status = Expect(TokenKind::RightParen); !status.ok())
+    return status;
+  absl::StatusOr<std::unique_ptr<Expression>> status_or_expr =
+      ParseCastExpression();
+  if (!status_or_expr.ok())
+    return status_or_expr.status();
+  return std::make_unique<CastExpression>(
+      SourceLocation::Complex(), *status_or_type, *std::move(status_or_expr));
+}
+
+absl::StatusOr<std::unique_ptr<Expression>>
+ExpressionParser::ParseUnaryExpression() {
+  // unaryExpression: prefixOperator* (postfixExpression
+  //                                   | unaryOperator castExpression)
+  const size_t prefix_begin = position_;
+  while (Peek().kind == TokenKind::PlusPlus ||
+         Peek().kind == TokenKind::DashDash)
+    Next();
+  const size_t prefix_end = position_;
+
+  std::unique_ptr<Expression> expr;
+  if (IsUnaryOperator(Peek().kind)) {
+    const TokenKind op = Next().kind;
+    absl::StatusOr<std::unique_ptr<Expression>> status_or_expr =
+        ParseCastExpression();
+    if (!status_or_expr.ok())
+      return status_or_expr.status();
+    expr = std::make_unique<UnaryExpression>(
+        SourceLocation::Complex(), PrefixType(op), *std::move(status_or_expr));
+  } else {
+    absl::StatusOr<std::unique_ptr<Expression>> status_or_expr =
+        ParsePostfixExpression();
+    if (!status_or_expr.ok())
+      return status_or_expr.status();
+    expr = *std::move(status_or_expr);
+  }
+  // Same nesting as `Parser::ParseUnaryExpression`.
+  for (size_t i = prefix_begin; i < prefix_end; ++i) {
+    expr = std::make_unique<UnaryExpression>(SourceLocation::Complex(),
+                                             PrefixType(tokens_[i].kind),
+                                             std::move(expr));
+  }
+  return expr;
+}
+
+absl::StatusOr<std::unique_ptr<Expression>>
+ExpressionParser::ParseMallocExpression() {
+  // MALLOC '(' typeSpecifier ')' '(' conditionalExpression ')'
+  const Token malloc = Next();
+  if (absl::Status status = Expect(TokenKind::LeftParen); !status.ok())
+    return status;
+  absl::StatusOr<const Type *> status_or_type = ParseType();
+  if (!status_or_type.ok())
+    return status_or_type.status();
+  if (absl::Status status = Expect(TokenKind::RightParen); !status.ok())
+    return status;
+  if (absl::Status status = Expect(TokenKind::LeftParen); !status.ok())
+    return status;
+  absl::StatusOr<std::unique_ptr<Expression>> status_or_expr =
+      ParseConditionalExpression();
+  if (!status_or_expr.ok())
+    return status_or_expr.status();
+  if (absl::Status status = Expect(TokenKind::RightParen); !status.ok())
+    return status;
+  return RewriteMalloc(std::make_unique<MallocExpression>(
+      LocationOf(malloc), *status_or_type, *std::move(status_or_expr)));
+}
+
+absl::StatusOr<std::unique_ptr<Expression>>
+ExpressionParser::ParseSizeofExpression() {
+  // SIZEOF '(' typeSpecifier ')'
+  const Token size_of = Next();
+  if (absl::Status status = Expect(TokenKind::LeftParen); !status.ok())
+    return status;
+  absl::StatusOr<const Type *> status_or_type = ParseType();
+  if (!status_or_type.ok())
+    return status_or_type.status();
+  if (absl::Status status = Expect(TokenKind::RightParen); !status.ok())
+    return status;
+  return std::make_unique<SizeofExpression>(LocationOf(size_of),
+                                            *status_or_type);
+}
+
+absl::StatusOr<std::unique_ptr<Expression>>
+ExpressionParser::ParsePostfixExpression() {
+  // postfixExpression: '(' expression ')'
+  //                  | primaryExpression postfixOperations?
+  if (Accept(TokenKind::LeftParen)) {
+    absl::StatusOr<std::unique_ptr<Expression>> status_or_expr =
+        ParseExpression();
+    if (!status_or_expr.ok())
+      return status_or_expr.status();
+    if (absl::Status status = Expect(TokenKind::RightParen); !status.ok())
+      return status;
+    return status_or_expr;
+  }
+  absl::StatusOr<std::unique_ptr<Expression>> status_or_expr =
+      ParsePrimaryExpression();
+  if (!status_or_expr.ok())
+    return status_or_expr.status();
+  return ParsePostfixOperations(*std::move(status_or_expr));
+}
+
+absl::StatusOr<std::unique_ptr<Expression>>
+ExpressionParser::ParsePostfixOperations(std::unique_ptr<Expression> expr) {
+  while (true) {
+    switch (Peek().kind) {
+    case TokenKind::LeftBracket: {
+      // array access operation a[..]
+      Next();
+      absl::StatusOr<std::unique_ptr<Expression>> status_or_index =
+          ParseExpression();
+      if (!status_or_index.ok())
+        return status_or_index.status();
+      if (absl::Status status = Expect(TokenKind::RightBracket); !status.ok())
+        return status;
+      expr = std::make_unique<ArrayAccessExpression>(
+          SourceLocation::Complex(), std::move(expr),
+          *std::move(status_or_index));
+      break;
+    }
+    case TokenKind::LeftParen: {
+      // call operation a(...)
+      Next();
+      absl::StatusOr<std::vector<std::unique_ptr<Expression>>> status_or_args =
+          ParseArguments();
+      if (!status_or_args.ok())
+        return status_or_args.status();
+      expr = std::make_unique<CallOpExpression>(SourceLocation::Complex(),
+                                                std::move(expr),
+                                                *std::move(status_or_args));
+      break;
+    }
+    case TokenKind::Dot:
+    case TokenKind::Arrow: {
+      // member access a.identifier or a->identifier
+      const bool direct = Next().kind == TokenKind::Dot;
+      const Token identifier = Peek();
+      if (absl::Status status = Expect(TokenKind::Identifier); !status.ok())
+        return status;
+      expr = std::make_unique<MemberAccessExpression>(
+          SourceLocation::Complex(), std::move(expr), direct,
+          SymbolOf(identifier));
+      break;
+    }
+    case TokenKind::PlusPlus:
+    case TokenKind::DashDash: {
+      // post increment/decrement
+      UnaryExpressionType post_type = Next().kind == TokenKind::PlusPlus
+                                          ? UnaryExpressionType::POST_INCREMENT
+                                          : UnaryExpressionType::POST_DECREMENT;
+      expr = std::make_unique<UnaryExpression>(SourceLocation::Complex(),
+                                               post_type, std::move(expr));
+      break;
+    }
+    default:
+      return expr;
+    }
+  }
+}
+
+absl::StatusOr<std::unique_ptr<Expression>>
+ExpressionParser::ParsePrimaryExpression() {
+  const Token &token = Peek();
+  switch (token.kind) {
+  case TokenKind::BoolConstant:
+    Next();
+    return ConstantExpression::Bool(LocationOf(token), TextOf(token));
+  case TokenKind::CharConstant:
+    Next();
+    return ConstantExpression::Char(LocationOf(token), TextOf(token));
+  case TokenKind::StringConstant:
+    Next();
+    return ConstantExpression::String(LocationOf(token), TextOf(token));
+  case TokenKind::IntegerConstant:
+    Next();
+    return ConstantExpression::Integer(LocationOf(token), TextOf(token));
+  case TokenKind::FloatingConstant:
+    Next();
+    return ConstantExpression::Floating(LocationOf(token), TextOf(token));
+  case TokenKind::Identifier:
+    Next();
+    return std::make_unique<IdentifierExpression>(LocationOf(token),
+                                                  SymbolOf(token));
+  default:
+    return SyntaxError(token, absl::StrCat("no viable alternative at input '",
+                                           DisplayOf(token), "'"));
+  }
+}
+
+absl::StatusOr<std::vector<std::unique_ptr<Expression>>>
+ExpressionParser::ParseArguments() {
+  // argumentExpressionList? ')'
+  std::vector<std::unique_ptr<Expression>> args;
+  if (Accept(TokenKind::RightParen))
+    return args;
+  do {
+    absl::StatusOr<std::unique_ptr<Expression>> status_or_arg =
+        ParseExpression();
+    if (!status_or_arg.ok())
+      return status_or_arg.status();
+    args.push_back(*std::move(status_or_arg));
+  } while (Accept(TokenKind::Comma));
+  if (absl::Status status = Expect(TokenKind::RightParen); !status.ok())
+    return status;
+  return args;
+}
+
+absl::StatusOr<const Type *> ExpressionParser::ParseType() {
+  // typeSpecifier: (IntegralType | FloatingType | STRING | CHAR | BOOL | NIL
+  //                | LBRACKET typeSpecifier RBRACKET) POINTER*
+  NestingScope nesting(&depth_);
+  if (absl::Status status = CheckDepth(); !status.ok())
+    return status;
+  const Token &token = Peek();
+  const Type *type;
+  switch (token.kind) {
+  case TokenKind::IntegralType:
+    type = IntegralType::OfSize(std::atoi(TextOf(Next()).c_str() + 1));
+    break;
+  case TokenKind::FloatingType:
+    type = FloatingType::OfSize(std::atoi(TextOf(Next()).c_str() + 1));
+    break;
+  case TokenKind::String:
+    Next();
+    type = StringType::Get();
+    break;
+  case TokenKind::Char:
+    Next();
+    type = CharType::Get();
+    break;
+  case TokenKind::Bool:
+    Next();
+    type = BoolType::Get();
+    break;
+  case TokenKind::Nil:
+    Next();
+    type = NilType::Get();
+    break;
+  case TokenKind::LeftBracket: {
+    Next();
+    absl::StatusOr<const Type *> status_or_type = ParseType();
+    if (!status_or_type.ok())
+      return status_or_type.status();
+    if (absl::Status status = Expect(TokenKind::RightBracket); !status.ok())
+      return status;
+    type = Type::ArrayOf(*status_or_type);
+    break;
+  }
+  default:
+    return SyntaxError(token, absl::StrCat("no viable alternative at input '",
+                                           DisplayOf(token), "'"));
+  }
+  while (Accept(TokenKind::Star))
+    type = Type::PointerTo(type);
+  return type;
+}
+
+bool ExpressionParser::AtCast() const {
+  // A parenthesized type, none of the base types can start an expression.
+  size_t ahead = 1;
+  while (Peek(ahead).kind == TokenKind::LeftBracket)
+    ++ahead;
+  return StartsBaseType(Peek(ahead).kind);
+}
+
+absl::Status ExpressionParser::CheckDepth() {
+  if (depth_ > max_depth_)
+    max_depth_ = depth_;
+  if (depth_ <= max_recursion_depth_)
+    return absl::OkStatus();
+  return LimitError(Peek(), absl::StrCat("nesting exceeds the maximum depth of ",
+                                         max_recursion_depth_));
+}
+
+absl::Status ExpressionParser::CheckExpressionSize(size_t begin) {
+  if (begin >= position_)
+    return absl::OkStatus();
+  const uint32_t offset = tokens_[begin].offset;
+  const int size = CountCodepoints(source_.contents().substr(
+      offset, tokens_[position_ - 1].end() - offset));
+  if (size > max_expression_size_)
+    max_expression_size_ = size;
+  if (size <= expression_size_limit_)
+    return absl::OkStatus();
+  return LimitError(tokens_[begin],
+                    absl::StrCat("expression exceeds the maximum size of ",
+                                 expression_size_limit_, " codepoints"));
+}
+
+const Token &ExpressionParser::Next() {
+  return position_ < tokens_.size() ? tokens_[position_++] : end_of_file_;
+}
+
+bool ExpressionParser::Accept(TokenKind kind) {
+  if (Peek().kind != kind)
+    return false;
+  Next();
+  return true;
+}
+
+absl::Status ExpressionParser::Expect(TokenKind kind) {
+  if (Accept(kind))
+    return absl::OkStatus();
+  return SyntaxError(Peek(), absl::StrCat("mismatched input '",
+                                          DisplayOf(Peek()), "' expecting ",
+                                          TokenKindSpelling(kind)));
+}
+
+absl::Status ExpressionParser::SyntaxError(const Token &token,
+                                           std::string message) {
+  if (errors_ != nullptr)
+    *errors_ << MakeError(SpanOf(token), message, true);
+  return absl::InvalidArgumentError(std::move(message));
+}
+
+absl::Status ExpressionParser::LimitError(const Token &token,
+                                          std::string message) {
+  if (errors_ != nullptr)
+    *errors_ << MakeError(SpanOf(token), message, true);
+  return absl::ResourceExhaustedError(std::move(message));
+}
+// `ExpressionParser` ===================================================
+} // namespace Cobold
@@ -0,0 +1,142 @@
+#ifndef COBOLD_PARSER_EXPRESSION_PARSER
+#define COBOLD_PARSER_EXPRESSION_PARSER
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "core/expression.h"
+#include "core/symbol.h"
+#include "core/type.h"
+#include "parser/internal/options.h"
+#include "parser/source_location.h"
+#include "parser/source_manager.h"
+#include "parser/token.h"
+#include "reporting/error_context.h"
+
+namespace Cobold {
+// malloc(type)(count) => (type*) __lib_malloc(sizeof(type) * count)
+std::unique_ptr<Expression>
+RewriteMalloc(std::unique_ptr<MallocExpression> &&malloc);
+
+// Precedence climbing (Pratt) parser for the `expression` rule of `Cobold.g4`
+// operating directly on the tokens of the hand-written `Lexer`. Instead of
+// descending through one parse-tree context per precedence level, binary
+// operators are folded into `BinaryExpression`s in a single loop. The
+// resulting AST is identical to the one `Parser` builds from the parse tree.
+//
+// Syntax errors are reported to `errors` (at the offending token) and the
+// corresponding parse method returns an `InvalidArgumentError`. Exceeding the
+// `max_recursion_depth` or `expression_size_codepoint_limit` of `options` is
+// reported the same way, but returns a `ResourceExhaustedError`.
+class ExpressionParser {
+public:
+  ExpressionParser(const SourceBuffer &source, absl::Span<const Token> tokens,
+                   ErrorContext *errors,
+                   const ParserOptions &options = ParserOptions())
+      : source_(source), tokens_(tokens), errors_(errors),
+        max_recursion_depth_(options.max_recursion_depth),
+        expression_size_limit_(options.expression_size_codepoint_limit),
+        end_of_file_{TokenKind::EndOfFile,
+                     static_cast<uint32_t>(source.size()), 0} {}
+
+  // expression: conditionalExpression | bracketExpression
+  absl::StatusOr<std::unique_ptr<Expression>> ParseExpression();
+
+  // conditionalExpression: logicalOrExpression ('?' expression ':'
+  //                        conditionalExpression)?
+  absl::StatusOr<std::unique_ptr<Expression>> ParseConditionalExpression();
+
+  // typeSpecifier
+  absl::StatusOr<const Type *> ParseType();
+
+  // Deepest nesting and largest (top-level) expression encountered so far.
+  int max_depth() const { return max_depth_; }
+  int max_expression_size() const { return max_expression_size_; }
+
+  // Index of the next (unconsumed) token.
+  size_t position() const { return position_; }
+  const Token &Peek(size_t ahead = 0) const {
+    return position_ + ahead < tokens_.size() ? tokens_[position_ + ahead]
+                                              : end_of_file_;
+  }
+
+  // Token-level helpers, e.g., for parsing the surrounding declarations.
+  const Token &Next();
+  bool Accept(TokenKind kind);
+  // Consumes a token of `kind` or reports a syntax error.
+  absl::Status Expect(TokenKind kind);
+
+private:
+  // Ranges and arrays, i.e., expressions starting with '['.
+  absl::StatusOr<std::unique_ptr<Expression>> ParseBracketExpression();
+
+  // Folds all binary operators binding at least as tight as `precedence`
+  // into `lhs`.
+  absl::StatusOr<std::unique_ptr<Expression>>
+  ParseBinaryExpression(std::unique_ptr<Expression> lhs, int precedence);
+  absl::StatusOr<std::unique_ptr<Expression>>
+  ParseTernaryExpression(std::unique_ptr<Expression> condition);
+
+  absl::StatusOr<std::unique_ptr<Expression>> ParseCastExpression();
+  absl::StatusOr<std::unique_ptr<Expression>> ParseUnaryExpression();
+  absl::StatusOr<std::unique_ptr<Expression>> ParseMallocExpression();
+  absl::StatusOr<std::unique_ptr<Expression>> ParseSizeofExpression();
+  absl::StatusOr<std::unique_ptr<Expression>> ParsePostfixExpression();
+  absl::StatusOr<std::unique_ptr<Expression>>
+  ParsePostfixOperations(std::unique_ptr<Expression> expr);
+  absl::StatusOr<std::unique_ptr<Expression>> ParsePrimaryExpression();
+
+  // argumentExpressionList up to ')'.
+  absl::StatusOr<std::vector<std::unique_ptr<Expression>>>
+  ParseArguments();
+
+  // Returns true iff '(' at the current position starts a cast.
+  bool AtCast() const;
+
+  // Called on entry of every recursive parse method, after entering a
+  // `NestingScope` on `depth_`.
+  absl::Status CheckDepth();
+  // Checks the size of the expression starting at token `begin` and ending
+  // at the current position.
+  absl::Status CheckExpressionSize(size_t begin);
+
+  std::string TextOf(const Token &token) const {
+    return std::string(token.Text(source_.contents()));
+  }
+  Symbol SymbolOf(const Token &token) const {
+    return Symbol::Intern(token.Text(source_.contents()));
+  }
+  // Text of `token` as displayed in syntax errors.
+  std::string DisplayOf(const Token &token) const {
+    return token.kind == TokenKind::EndOfFile ? "<EOF>" : TextOf(token);
+  }
+  SourceLocation LocationOf(const Token &token) const {
+    return SourceLocation::AtOffset(source_, token.offset);
+  }
+  SourceSpan SpanOf(const Token &token) const {
+    const SourceLocation begin = LocationOf(token);
+    return SourceSpan(begin, begin.AdvancedBy(token.length));
+  }
+  absl::Status SyntaxError(const Token &token, std::string message);
+  absl::Status LimitError(const Token &token, std::string message);
+
+  const SourceBuffer &source_;
+  absl::Span<const Token> tokens_;
+  ErrorContext *errors_;
+  size_t position_ = 0;
+
+  const int max_recursion_depth_;
+  const int expression_size_limit_;
+  int depth_ = 0;
+  int max_depth_ = 0;
+  int max_expression_size_ = 0;
+
+  const Token end_of_file_;
+};
+} // namespace Cobold
+
+#endif /* COBOLD_PARSER_EXPRESSION_PARSER */
@@ -0,0 +1,72 @@
+// Parse time of long arithmetic expressions with the generated parser (one
+// parse tree context per precedence level and operand) against
+// `ParserOptions::hand_written` (`ExpressionParser`), for expressions of
+// 2^4 up to 2^12 operands:
+//
+//   bazel run -c opt //parser:expression_parser_benchmark
+#include <memory>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "core/type.h"
+#include "parser/internal/options.h"
+#include "parser/parser.h"
+#include "parser/source_file.h"
+#include "parser/source_manager.h"
+
+namespace Cobold {
+namespace {
+constexpr int kNumFunctions = 64;
+
+// `kNumFunctions` functions, each returning one expression of `operands`
+// operands that mixes all precedence levels of binary operators.
+std::unique_ptr<SourceBuffer> Input(int operands) {
+  constexpr const char *kOperators[] = {" + ", " * ", " - ", " / ", " % ",
+                                        " << ", " & ", " | ", " ^ "};
+  std::string input;
+  for (int i = 0; i < kNumFunctions; ++i) {
+    absl::StrAppend(&input, "fn F", i, "(a: i64, b: i64) -> i64 {\n",
+                    "    return a");
+    for (int j = 1; j < operands; ++j) {
+      absl::StrAppend(&input, kOperators[(i + j) % 9],
+                      j % 3 == 0 ? "(a - b)" : absl::StrCat(j));
+    }
+    absl::StrAppend(&input, ";\n}\n\n");
+  }
+  return SourceBuffer::FromString("benchmark.cb", std::move(input));
+}
+
+void Parse(benchmark::State &state, bool hand_written) {
+  const std::unique_ptr<SourceBuffer> input = Input(state.range(0));
+  ParserOptions options;
+  options.hand_written = hand_written;
+  TypeTable types;
+  TypeTable::Scope scope(&types);
+  for (auto _ : state) {
+    absl::StatusOr<SourceFile> file = Parser::Parse(*input, options);
+    if (!file.ok()) {
+      state.SkipWithError(std::string(file.status().message()).c_str());
+      break;
+    }
+    benchmark::DoNotOptimize(file->functions().data());
+  }
+  state.SetBytesProcessed(state.iterations() * input->size());
+}
+
+void BM_GeneratedParser(benchmark::State &state) { Parse(state, false); }
+BENCHMARK(BM_GeneratedParser)
+    ->RangeMultiplier(4)
+    ->Range(16, 4096)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_ExpressionParser(benchmark::State &state) { Parse(state, true); }
+BENCHMARK(BM_ExpressionParser)
+    ->RangeMultiplier(4)
+    ->Range(16, 4096)
+    ->Unit(benchmark::kMillisecond);
+} // namespace
+} // namespace Cobold
+
+BENCHMARK_MAIN();
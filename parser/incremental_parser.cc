@@ -0,0 +1,354 @@
+#include "parser/incremental_parser.h"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "core/ast_arena.h"
+#include "parser/lexer.h"
+#include "parser/parser.h"
+#include "visitor/expression_visitor.h"
+#include "visitor/statement_visitor.h"
+
+namespace Cobold {
+namespace {
+// Offsets of the top-level declarations (see `DeclarationScanner`) of
+// `contents` from offset `begin` on. Stops before the first one for which
+// `resync(offset)` returns true and returns its offset in `*end` (or
+// `contents.size()` if there is none).
+template <typename Resync>
+std::vector<uint32_t> DeclarationStarts(std::string_view contents,
+                                        size_t begin, Resync resync,
+                                        size_t *end) {
+  std::vector<uint32_t> starts;
+  DeclarationScanner scanner(contents, begin);
+  while (std::optional<uint32_t> start = scanner.Next()) {
+    if (!starts.empty() && resync(*start)) {
+      *end = *start;
+      return starts;
+    }
+    starts.push_back(*start);
+  }
+  *end = contents.size();
+  return starts;
+}
+} // namespace
+
+// Moves the locations of a (reused) function body from one `SourceBuffer` to
+// another, shifting them by `delta` bytes.
+class SourceLocationRebaser : private StatementVisitor<false>,
+                              private ExpressionVisitor<false, void> {
+public:
+  static void Rebase(Function *function, const SourceBuffer &from,
+                     const SourceBuffer &to, ptrdiff_t delta) {
+    SourceLocationRebaser rebaser(from, to, delta);
+    function->set_location(rebaser.Moved(function->location()));
+    DefinedFunction *defined = dyn_cast<DefinedFunction>(function);
+    if (defined == nullptr)
+      return;
+    rebaser.StatementVisitor::Visit(&defined->mutable_body());
+  }
+
+private:
+  SourceLocationRebaser(const SourceBuffer &from, const SourceBuffer &to,
+                        ptrdiff_t delta)
+      : from_(from), to_(to), delta_(delta) {}
+
+  SourceLocation Moved(SourceLocation location) const {
+    // Generated (and complex) locations do not refer to a source.
+    if (!location.HasSource())
+      return location;
+    return SourceLocation::AtOffset(to_, location.raw() - from_.base() + delta_);
+  }
+
+  void RebaseLocation(Expression *expr) {
+    expr->set_location(Moved(expr->location()));
+  }
+
+  // Statements
+  void DispatchReturn(ReturnStatement *stmt) override {
+    ExpressionVisitor::Visit(stmt->mutable_expression());
+  }
+  void DispatchDeinit(DeinitStatement *stmt) override {
+    ExpressionVisitor::Visit(stmt->mutable_expression());
+  }
+  void DispatchAssignment(AssignmentStatement *stmt) override {
+    ExpressionVisitor::Visit(stmt->mutable_lhs());
+    ExpressionVisitor::Visit(stmt->mutable_rhs());
+  }
+  void DispatchCompound(CompoundStatement *stmt) override {
+    for (const auto &statement : stmt->statements()) {
+      StatementVisitor::Visit(statement.get());
+    }
+  }
+  void DispatchExpression(ExpressionStatement *stmt) override {
+    ExpressionVisitor::Visit(stmt->mutable_expression());
+  }
+  void DispatchIf(IfStatement *stmt) override {
+    for (const IfBranch &branch : stmt->branches()) {
+      ExpressionVisitor::Visit(branch.condition.get());
+      StatementVisitor::Visit(branch.body.get());
+    }
+  }
+  void DispatchFor(ForStatement *stmt) override {
+    ExpressionVisitor::Visit(stmt->mutable_expression());
+    StatementVisitor::Visit(stmt->body().get());
+  }
+  void DispatchWhile(WhileStatement *stmt) override {
+    ExpressionVisitor::Visit(stmt->mutable_condition());
+    StatementVisitor::Visit(stmt->body().get());
+  }
+  void DispatchDeclaration(DeclarationStatement *stmt) override {
+    ExpressionVisitor::Visit(stmt->mutable_expression());
+  }
+  void DispatchBreak(BreakStatement *stmt) override {}
+  void DispatchContinue(ContinueStatement *stmt) override {}
+
+  // Expressions
+  // The condition of an `else` branch (and the bounds of a range) are
+  // optional.
+  void DispatchEmpty() override {}
+  void DispatchTernary(TernaryExpression *expr) override {
+    RebaseLocation(expr);
+    ExpressionVisitor::Visit(expr->mutable_condition());
+    ExpressionVisitor::Visit(expr->mutable_true_case());
+    ExpressionVisitor::Visit(expr->mutable_false_case());
+  }
+  void DispatchBinary(BinaryExpression *expr) override {
+    RebaseLocation(expr);
+    ExpressionVisitor::Visit(expr->mutable_lhs());
+    ExpressionVisitor::Visit(expr->mutable_rhs());
+  }
+  void DispatchUnary(UnaryExpression *expr) override {
+    RebaseLocation(expr);
+    ExpressionVisitor::Visit(expr->mutable_expression());
+  }
+  void DispatchCall(CallExpression *expr) override {
+    RebaseLocation(expr);
+    for (const auto &arg : expr->args()) {
+      ExpressionVisitor::Visit(arg.get());
+    }
+  }
+  void DispatchRange(RangeExpression *expr) override {
+    RebaseLocation(expr);
+    ExpressionVisitor::Visit(expr->mutable_lhs());
+    ExpressionVisitor::Visit(expr->mutable_rhs());
+  }
+  void DispatchArray(ArrayExpression *expr) override {
+    RebaseLocation(expr);
+    for (const auto &element : expr->mutable_elements()) {
+      ExpressionVisitor::Visit(element.get());
+    }
+  }
+  void DispatchCast(CastExpression *expr) override {
+    RebaseLocation(expr);
+    ExpressionVisitor::Visit(expr->mutable_expression());
+  }
+  void DispatchConstant(ConstantExpression *expr) override {
+    RebaseLocation(expr);
+  }
+  void DispatchIdentifier(IdentifierExpression *expr) override {
+    RebaseLocation(expr);
+  }
+  void DispatchMemberAccess(MemberAccessExpression *expr) override {
+    RebaseLocation(expr);
+    ExpressionVisitor::Visit(expr->mutable_expression());
+  }
+  void DispatchArrayAccess(ArrayAccessExpression *expr) override {
+    RebaseLocation(expr);
+    ExpressionVisitor::Visit(expr->mutable_expression());
+    ExpressionVisitor::Visit(expr->mutable_index());
+  }
+  void DispatchCallOp(CallOpExpression *expr) override {
+    RebaseLocation(expr);
+    ExpressionVisitor::Visit(expr->mutable_expression());
+    for (const auto &arg : expr->mutable_args()) {
+      ExpressionVisitor::Visit(arg.get());
+    }
+  }
+  void DispatchMalloc(MallocExpression *expr) override {
+    RebaseLocation(expr);
+    ExpressionVisitor::Visit(expr->mutable_expression());
+  }
+  void DispatchSizeof(SizeofExpression *expr) override {
+    RebaseLocation(expr);
+  }
+
+  const SourceBuffer &from_;
+  const SourceBuffer &to_;
+  const ptrdiff_t delta_;
+};
+
+// `IncrementalParser` ==================================================
+absl::StatusOr<std::unique_ptr<IncrementalParser>>
+IncrementalParser::Create(SourceManager *sources, const std::string &filename,
+                          const ParserOptions &options) {
+  absl::StatusOr<const SourceBuffer *> source = sources->Load(filename);
+  if (!source.ok())
+    return source.status();
+  std::unique_ptr<IncrementalParser> parser(
+      new IncrementalParser(filename, options));
+  // Reused bodies need to be parsed (i.e., refer to the current buffer).
+  parser->options_.lazy_bodies = false;
+  absl::Status status = parser->ParseAll(SourceBuffer::FromString(
+      filename, std::string((*source)->contents())));
+  if (!status.ok())
+    return status;
+  return parser;
+}
+
+absl::Status IncrementalParser::Edit(size_t begin, size_t end,
+                                     std::string_view text) {
+  const std::string_view old_contents = source_->contents();
+  if (begin > end || end > old_contents.size()) {
+    return absl::OutOfRangeError(absl::StrCat(
+        "invalid edit [", begin, ", ", end, ") of ", file_.filename()));
+  }
+  std::string contents = absl::StrCat(old_contents.substr(0, begin), text,
+                                      old_contents.substr(end));
+  std::unique_ptr<SourceBuffer> source =
+      SourceBuffer::FromString(file_.filename(), std::move(contents));
+  // Edits of the imports (or right in front of the first `fn`, which might
+  // merge into it) re-parse everything, as does any edit after one that did
+  // not parse (the declarations are those of an older version).
+  if (!up_to_date() || declarations_.empty() || begin <= declarations_.front())
+    return ParseAll(std::move(source));
+
+  const ptrdiff_t delta = static_cast<ptrdiff_t>(text.size()) -
+                          static_cast<ptrdiff_t>(end - begin);
+  const size_t edit_end = begin + text.size();
+  // The last declaration starting before the edit, its `fn` is unchanged.
+  const size_t first =
+      std::lower_bound(declarations_.begin(), declarations_.end(), begin) -
+      declarations_.begin() - 1;
+
+  // Re-lex until we reach the (unchanged) start of a declaration after the
+  // edit again. From there on the tokens are the same as before, since the
+  // lexer starts every token in the same state.
+  const std::string_view contents_view = source->contents();
+  size_t region_end;
+  std::vector<uint32_t> starts = DeclarationStarts(
+      contents_view, declarations_[first],
+      [&](size_t offset) {
+        if (offset < edit_end)
+          return false;
+        return std::binary_search(declarations_.begin() + first + 1,
+                                  declarations_.end(), offset - delta);
+      },
+      &region_end);
+  if (starts.empty() || starts.front() != declarations_[first])
+    return ParseAll(std::move(source));
+  const size_t resync =
+      region_end == contents_view.size()
+          ? declarations_.size()
+          : std::lower_bound(declarations_.begin(), declarations_.end(),
+                             region_end - delta) -
+                declarations_.begin();
+
+  // Declared before (i.e., destroyed after) the functions allocated from it.
+  std::unique_ptr<Region> region;
+  if (options_.ast_arena) {
+    region = std::make_unique<Region>();
+    region->arena = std::make_unique<AstArena>();
+  }
+  absl::StatusOr<std::vector<std::unique_ptr<Function>>> parsed;
+  {
+    AstArena::Scope scope(region != nullptr ? region->arena.get() : nullptr);
+    parsed = Parser::ParseDeclarations(*source, declarations_[first],
+                                       region_end, options_);
+  }
+  if (!parsed.ok())
+    return KeepUnparsed(std::move(source), parsed.status());
+  if (parsed->size() != starts.size())
+    return ParseAll(std::move(source));
+
+  // Declarations after the edit move by the number of bytes it added.
+  std::vector<std::unique_ptr<Function>> &functions = file_.functions_;
+  for (size_t i = 0; i < first; ++i) {
+    SourceLocationRebaser::Rebase(functions[i].get(), *source_, *source, 0);
+  }
+  for (size_t i = resync; i < functions.size(); ++i) {
+    SourceLocationRebaser::Rebase(functions[i].get(), *source_, *source, delta);
+    declarations_[i] += delta;
+  }
+
+  for (size_t i = first; i < resync; ++i) {
+    if (function_regions_[i] != nullptr)
+      --function_regions_[i]->live;
+  }
+  functions.erase(functions.begin() + first, functions.begin() + resync);
+  functions.insert(functions.begin() + first,
+                   std::make_move_iterator(parsed->begin()),
+                   std::make_move_iterator(parsed->end()));
+  function_regions_.erase(function_regions_.begin() + first,
+                          function_regions_.begin() + resync);
+  function_regions_.insert(function_regions_.begin() + first, starts.size(),
+                           region.get());
+  if (region != nullptr) {
+    region->live = starts.size();
+    regions_.push_back(std::move(region));
+  }
+  // None of their functions is left, i.e., nothing refers to them anymore.
+  regions_.erase(std::remove_if(regions_.begin(), regions_.end(),
+                                [](const std::unique_ptr<Region> &region) {
+                                  return region->live == 0;
+                                }),
+                 regions_.end());
+  declarations_.erase(declarations_.begin() + first,
+                      declarations_.begin() + resync);
+  declarations_.insert(declarations_.begin() + first, starts.begin(),
+                       starts.end());
+
+  file_.annotated_ = false;
+  source_ = std::move(source);
+  reparsed_ = starts.size();
+  return absl::OkStatus();
+}
+
+absl::Status IncrementalParser::ParseAll(std::unique_ptr<SourceBuffer> source) {
+  absl::StatusOr<SourceFile> file = Parser::Parse(*source, options_);
+  if (!file.ok())
+    return KeepUnparsed(std::move(source), file.status());
+  size_t end;
+  std::vector<uint32_t> starts = DeclarationStarts(
+      source->contents(), 0, [](size_t) { return false; }, &end);
+  if (starts.size() != file->functions().size()) {
+    return KeepUnparsed(
+        std::move(source),
+        absl::InternalError(absl::StrCat(
+            "found ", starts.size(), " declarations in ", file_.filename(),
+            ", but parsed ", file->functions().size())));
+  }
+  // Releases the previous functions before the arenas of their regions (and
+  // the buffer they refer to).
+  file_ = *std::move(file);
+  regions_.clear();
+  parsed_source_.reset();
+  function_regions_.assign(file_.functions().size(), nullptr);
+  declarations_ = std::move(starts);
+  source_ = std::move(source);
+  reparsed_ = declarations_.size();
+  return absl::OkStatus();
+}
+
+absl::Status
+IncrementalParser::KeepUnparsed(std::unique_ptr<SourceBuffer> source,
+                                absl::Status status) {
+  // `file_` keeps referring to the buffer of the last version that parsed.
+  if (up_to_date())
+    parsed_source_ = std::move(source_);
+  source_ = std::move(source);
+  reparsed_ = 0;
+  return status;
+}
+
+size_t IncrementalParser::bytes_allocated() const {
+  size_t bytes =
+      file_.arena() != nullptr ? file_.arena()->bytes_allocated() : 0;
+  for (const std::unique_ptr<Region> &region : regions_)
+    bytes += region->arena->bytes_allocated();
+  return bytes;
+}
+// `IncrementalParser` ==================================================
+} // namespace Cobold
@@ -0,0 +1,100 @@
+#ifndef COBOLD_PARSER_INCREMENTAL_PARSER
+#define COBOLD_PARSER_INCREMENTAL_PARSER
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "core/ast_arena.h"
+#include "parser/internal/options.h"
+#include "parser/source_file.h"
+#include "parser/source_manager.h"
+
+namespace Cobold {
+// Keeps a parsed file around for a long-lived session (e.g., an editor) and
+// applies edits to it. Only the top-level function declarations touched by
+// an edit are re-lexed and re-parsed, the `Function`s of all other
+// declarations are reused as they are (except for their source locations,
+// which are moved to the edited buffer).
+//
+// Edits before the first function declaration (i.e., of the imports) are
+// rare and simply re-parse the entire file.
+//
+// An edit is applied to `source()` even if the result does not parse (as
+// most intermediate states of an editor buffer do not), such that the offsets
+// of later edits refer to the same text as for the caller. `file()` then
+// stays the last version that parsed (see `up_to_date`), and the next edit
+// re-parses the entire file instead of the affected declarations.
+//
+// With `ParserOptions::ast_arena`, the declarations re-parsed by an edit are
+// allocated from an arena of their own, which is released as soon as all of
+// them were replaced by later edits, such that replaced declarations do not
+// accumulate. The arena of `file()` only holds the declarations of the last
+// full parse (and nodes added to the AST later on, e.g., by type inference).
+class IncrementalParser {
+public:
+  // Parses `filename` (loaded through `sources`) entirely. The contents are
+  // copied, i.e., `sources` does not need to outlive the parser.
+  static absl::StatusOr<std::unique_ptr<IncrementalParser>>
+  Create(SourceManager *sources, const std::string &filename,
+         const ParserOptions &options = ParserOptions());
+
+  // Replaces the bytes [begin, end) of the current contents with `text` and
+  // re-parses the affected declarations. The edit is kept even if this fails,
+  // only an invalid range is rejected.
+  absl::Status Edit(size_t begin, size_t end, std::string_view text);
+
+  // The last version of the file that parsed, its locations refer to
+  // `source()` only if `up_to_date()`.
+  const SourceFile &file() const { return file_; }
+  // The current contents, including all edits.
+  const SourceBuffer &source() const { return *source_; }
+  // Whether `file()` reflects all edits, i.e., the last edit parsed.
+  bool up_to_date() const { return parsed_source_ == nullptr; }
+  // Number of declarations (re-)parsed by the last edit.
+  int reparsed() const { return reparsed_; }
+  // Bytes held by the arenas of the AST of `file()`.
+  size_t bytes_allocated() const;
+
+private:
+  IncrementalParser(const std::string &filename, const ParserOptions &options)
+      : options_(options), file_(filename) {}
+
+  // Parses `source` entirely and makes it the current version.
+  absl::Status ParseAll(std::unique_ptr<SourceBuffer> source);
+  // Makes `source` the current contents without updating `file_`.
+  absl::Status KeepUnparsed(std::unique_ptr<SourceBuffer> source,
+                            absl::Status status);
+
+  // The arena of the declarations re-parsed by one `Edit`.
+  struct Region {
+    std::unique_ptr<AstArena> arena;
+    // Number of functions of `file_` allocated from `arena`.
+    int live = 0;
+  };
+
+  ParserOptions options_;
+  std::unique_ptr<SourceBuffer> source_;
+  // The buffer `file_` refers to if it is not `source_` (i.e., after an edit
+  // that did not parse), `nullptr` otherwise.
+  std::unique_ptr<SourceBuffer> parsed_source_;
+  // Declared before (i.e., destroyed after) `file_`.
+  std::vector<std::unique_ptr<Region>> regions_;
+  SourceFile file_;
+  // Parallel to `file_.functions()`, the region each function was allocated
+  // from (`nullptr` for the arena of `file_` or the heap).
+  std::vector<Region *> function_regions_;
+  // A declaration extends from its `fn` up to the next one (or EOF), i.e.,
+  // the declarations cover everything after the imports. Parallel to
+  // `file_.functions()` (i.e., only valid while `up_to_date()`).
+  std::vector<uint32_t> declarations_;
+  int reparsed_ = 0;
+};
+} // namespace Cobold
+
+#endif /* COBOLD_PARSER_INCREMENTAL_PARSER */
@@ -0,0 +1,123 @@
+#include "parser/incremental_parser.h"
+
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "core/function.h"
+#include "core/statement.h"
+#include "core/type.h"
+#include "gtest/gtest.h"
+#include "parser/source_location.h"
+#include "parser/source_manager.h"
+#include "util/casting.h"
+
+namespace Cobold {
+namespace {
+constexpr char kSource[] = R"(import "io";
+
+fn A() #extern("__a");
+
+fn B() -> i32 {
+    return 1;
+}
+
+fn C() #extern("__c");
+
+fn D() -> i32 {
+    return 2;
+}
+)";
+
+class IncrementalParserTest : public ::testing::Test {
+protected:
+  IncrementalParserTest() : scope_(&types_) {}
+
+  std::unique_ptr<IncrementalParser> Create(const std::string &contents) {
+    const std::string filename = ::testing::TempDir() + "/incremental.cb";
+    std::ofstream(filename) << contents;
+    absl::StatusOr<std::unique_ptr<IncrementalParser>> parser =
+        IncrementalParser::Create(&sources_, filename);
+    EXPECT_TRUE(parser.ok()) << parser.status();
+    return parser.ok() ? *std::move(parser) : nullptr;
+  }
+
+  // The location of the expression returned by the first statement of `fn`.
+  static SourceLocation::Position ReturnLocation(const Function *fn) {
+    const Statement *stmt =
+        cast<DefinedFunction>(fn)->body().statements()[0].get();
+    return cast<ReturnStatement>(stmt)->expression()->location().Resolve();
+  }
+
+  TypeTable types_;
+  TypeTable::Scope scope_;
+  SourceManager sources_;
+};
+
+TEST_F(IncrementalParserTest, RebasesAroundExternDeclarations) {
+  std::unique_ptr<IncrementalParser> parser = Create(kSource);
+  ASSERT_NE(parser, nullptr);
+  const std::string contents(parser->source().contents());
+  const size_t begin = contents.find("return 1;");
+
+  // Extern declarations before and after the edit are reused as well.
+  ASSERT_TRUE(parser->Edit(begin, begin, "\n    B();\n    ").ok());
+  EXPECT_EQ(parser->reparsed(), 1);
+  ASSERT_EQ(parser->file().functions().size(), 4);
+  EXPECT_TRUE(isa<ExternFunction>(parser->file().functions()[0].get()));
+  EXPECT_TRUE(isa<ExternFunction>(parser->file().functions()[2].get()));
+
+  const SourceLocation::Position location =
+      ReturnLocation(parser->file().functions()[3].get());
+  EXPECT_EQ(location.buffer, &parser->source());
+  EXPECT_EQ(location.line, 14);
+  EXPECT_EQ(location.column, 11);
+}
+
+TEST_F(IncrementalParserTest, ReleasesReplacedDeclarations) {
+  std::unique_ptr<IncrementalParser> parser = Create(kSource);
+  ASSERT_NE(parser, nullptr);
+  const size_t begin =
+      std::string(parser->source().contents()).find("return 1;") + 7;
+  ASSERT_TRUE(parser->Edit(begin, begin + 1, "2").ok());
+  const size_t bytes_allocated = parser->bytes_allocated();
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(parser->Edit(begin, begin + 1, std::to_string(i % 10)).ok());
+    EXPECT_EQ(parser->reparsed(), 1);
+  }
+  EXPECT_EQ(parser->bytes_allocated(), bytes_allocated);
+}
+
+TEST_F(IncrementalParserTest, KeepsEditsThatDoNotParse) {
+  std::unique_ptr<IncrementalParser> parser = Create(kSource);
+  ASSERT_NE(parser, nullptr);
+  const size_t begin =
+      std::string(parser->source().contents()).find("return 1;");
+
+  ASSERT_FALSE(parser->Edit(begin, begin, "return ").ok());
+  EXPECT_FALSE(parser->up_to_date());
+  EXPECT_EQ(parser->file().functions().size(), 4);
+  // The offsets of the next edit refer to the contents including the first.
+  ASSERT_TRUE(parser->Edit(begin, begin + 16, "return 3;").ok());
+  EXPECT_TRUE(parser->up_to_date());
+
+  const std::string contents(parser->source().contents());
+  std::unique_ptr<IncrementalParser> expected = Create(contents);
+  ASSERT_NE(expected, nullptr);
+  ASSERT_EQ(parser->file().functions().size(),
+            expected->file().functions().size());
+  for (int i = 0; i < expected->file().functions().size(); ++i) {
+    const Function *actual_fn = parser->file().functions()[i].get();
+    const Function *expected_fn = expected->file().functions()[i].get();
+    EXPECT_EQ(actual_fn->DebugString(), expected_fn->DebugString());
+    if (!isa<DefinedFunction>(expected_fn))
+      continue;
+    EXPECT_EQ(ReturnLocation(actual_fn).line,
+              ReturnLocation(expected_fn).line);
+    EXPECT_EQ(ReturnLocation(actual_fn).column,
+              ReturnLocation(expected_fn).column);
+  }
+}
+} // namespace
+} // namespace Cobold
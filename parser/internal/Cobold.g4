@@ -15,7 +15,6 @@ blockItem: statement | declaration;
 statement:
 	returnStatement
 	| deinitStatement
-	| assignmentStatement
 	| compoundStatement
 	| expressionStatement
 	| ifStatement
@@ -24,24 +23,23 @@ statement:
 
 returnStatement: RETURN expression ';';
 deinitStatement: DEINIT expression ';';
-expressionStatement: expression ';';
+// Assignments share their (arbitrarily long) prefix with expression
+// statements, so only the operator decides between the two.
+expressionStatement: expression (assignmentOperator expression)? ';';
 
+// A parenthesized condition is just a parenthesized expression.
 ifStatement:
-	IF (expression | '(' expression ')') compoundStatement (
-		ELSE IF (expression | '(' expression ')') compoundStatement
+	IF expression compoundStatement (
+		ELSE IF expression compoundStatement
 	)* (ELSE compoundStatement)?;
 
 loopFlowInstruction: (BREAK | CONTINUE) ';';
 
 iterationStatement: forStatement | whileStatement;
 forStatement:
-	FOR Identifier (':' typeSpecifier)? IN (
-		expression
-		| '(' expression ')'
-	) compoundStatement;
+	FOR Identifier (':' typeSpecifier)? IN expression compoundStatement;
 
-whileStatement:
-	WHILE (expression | '(' expression ')') compoundStatement;
+whileStatement: WHILE expression compoundStatement;
 
 declaration:
 	(VAR | LET) Identifier (':' typeSpecifier)? (
@@ -66,8 +64,9 @@ postfixOperations: (
 		| ('++' | '--')
 	) postfixOperations?;
 
-argumentExpressionList:
-	conditionalExpression (',' conditionalExpression)*;
+// Any expression, i.e., also ranges and arrays (which the grammar did not
+// accept as arguments before calls were folded into postfixOperations).
+argumentExpressionList: expression (',' expression)*;
 
 unaryExpression:
 	prefixOperator* (
@@ -127,20 +126,17 @@ conditionalExpression:
 		'?' expression ':' conditionalExpression
 	)?;
 
-expression:
-	conditionalExpression
-	| callExpression
-	| rangeExpression
-	| arrayExpression;
+// Calls are postfix operations (see `postfixOperations`). Ranges and arrays
+// both start with '[' and are only told apart after their first element.
+expression: conditionalExpression | bracketExpression;
 
-callExpression:
-	Identifier '(' (expression (',' expression)*)? ')';
-rangeExpression:
-	LBRACKET leftExpression? '..' rightExpression? RBRACKET;
+bracketExpression:
+	LBRACKET (
+		RANGE rightExpression?
+		| leftExpression (RANGE rightExpression? | (',' expression)*)
+	)? RBRACKET;
 leftExpression: expression;
 rightExpression: expression;
-arrayExpression:
-	LBRACKET (expression (',' expression)*)? RBRACKET;
 
 FUNCTION: 'fn';
 RETURN: 'return';
@@ -160,6 +156,7 @@ LET: 'let';
 POINTER: '*';
 LBRACKET: '[';
 RBRACKET: ']';
+RANGE: '..';
 DASH_INIT: '--';
 
 // Types
@@ -189,8 +186,6 @@ F256: 'f256';
 MALLOC: 'malloc';
 SIZEOF: 'sizeof';
 
-assignmentStatement:
-	expression assignmentOperator expression ';';
 assignmentOperator:
 	'='
 	| '*='
@@ -205,9 +200,15 @@ assignmentOperator:
 	| '|=';
 
 typeSpecifier:
-	(IntegralType | FloatingType | STRING | CHAR | BOOL | NIL)
-	| LBRACKET typeSpecifier RBRACKET
-	| typeSpecifier POINTER;
+	(
+		IntegralType
+		| FloatingType
+		| STRING
+		| CHAR
+		| BOOL
+		| NIL
+		| LBRACKET typeSpecifier RBRACKET
+	) POINTER*;
 
 BoolConstant: 'true' | 'false';
 
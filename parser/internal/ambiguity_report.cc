@@ -0,0 +1,138 @@
+// Checks that `Cobold.g4` stays SLL-clean on the given (valid) inputs:
+//
+//   bazel run //parser/internal:ambiguity_report -- test/*.cb std/*.cb
+//
+// Every file is parsed in SLL mode (which must succeed) and again in full LL
+// mode with exact ambiguity detection. Each ambiguity, full-context attempt
+// and context sensitivity is reported with its grammar decision. Exits with a
+// non-zero status if anything was reported. `ambiguity_report_test` runs it
+// on all sources of the repository.
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "antlr4-runtime.h"
+#include "parser/internal/CoboldLexer.h"
+#include "parser/internal/CoboldParser.h"
+#include "parser/internal/source_char_stream.h"
+#include "parser/source_manager.h"
+
+namespace Cobold {
+namespace {
+class AmbiguityListener : public antlr4::BaseErrorListener {
+public:
+  AmbiguityListener(const std::string &filename) : filename_(filename) {}
+
+  void syntaxError(antlr4::Recognizer *recognizer,
+                   antlr4::Token *offendingSymbol, size_t line,
+                   size_t charPositionInLine, const std::string &msg,
+                   std::exception_ptr e) override {
+    Report(line, charPositionInLine, "syntax error: " + msg);
+  }
+
+  void reportAmbiguity(antlr4::Parser *recognizer, const antlr4::dfa::DFA &dfa,
+                       size_t startIndex, size_t stopIndex, bool exact,
+                       const antlrcpp::BitSet &ambigAlts,
+                       antlr4::atn::ATNConfigSet *configs) override {
+    Report(recognizer, dfa, startIndex,
+           std::string(exact ? "exact" : "inexact") + " ambiguity between " +
+               ambigAlts.toString());
+  }
+
+  void reportAttemptingFullContext(antlr4::Parser *recognizer,
+                                   const antlr4::dfa::DFA &dfa,
+                                   size_t startIndex, size_t stopIndex,
+                                   const antlrcpp::BitSet &conflictingAlts,
+                                   antlr4::atn::ATNConfigSet *configs) override {
+    Report(recognizer, dfa, startIndex,
+           "full-context prediction for " + conflictingAlts.toString());
+  }
+
+  void reportContextSensitivity(antlr4::Parser *recognizer,
+                                const antlr4::dfa::DFA &dfa, size_t startIndex,
+                                size_t stopIndex, size_t prediction,
+                                antlr4::atn::ATNConfigSet *configs) override {
+    Report(recognizer, dfa, startIndex,
+           "context sensitivity (predicted " + std::to_string(prediction) +
+               ")");
+  }
+
+  int reports() const { return reports_; }
+
+private:
+  void Report(antlr4::Parser *recognizer, const antlr4::dfa::DFA &dfa,
+              size_t startIndex, const std::string &message) {
+    const size_t rule =
+        recognizer->getATN().decisionToState[dfa.decision]->ruleIndex;
+    antlr4::Token *token = recognizer->getTokenStream()->get(startIndex);
+    Report(token->getLine(), token->getCharPositionInLine(),
+           recognizer->getRuleNames()[rule] + "#" +
+               std::to_string(dfa.decision) + ": " + message);
+  }
+
+  void Report(size_t line, size_t column, const std::string &message) {
+    std::cout << filename_ << ":" << line << ":" << column << ": " << message
+              << std::endl;
+    ++reports_;
+  }
+
+  const std::string &filename_;
+  int reports_ = 0;
+};
+
+// Returns the number of reported problems in `source`.
+int Check(const SourceBuffer &source) {
+  SourceCharStream input(source);
+  CoboldLexer lexer(&input);
+  AmbiguityListener listener(source.filename());
+  lexer.removeErrorListeners();
+  lexer.addErrorListener(&listener);
+  antlr4::CommonTokenStream tokens(&lexer);
+  CoboldParser parser(&tokens);
+
+  // Valid inputs need to parse without falling back to full LL.
+  parser.getInterpreter<antlr4::atn::ParserATNSimulator>()->setPredictionMode(
+      antlr4::atn::PredictionMode::SLL);
+  parser.removeErrorListeners();
+  parser.setErrorHandler(std::make_shared<antlr4::BailErrorStrategy>());
+  int reports = 0;
+  try {
+    parser.file();
+  } catch (const antlr4::ParseCancellationException &) {
+    std::cout << source.filename() << ": SLL parse failed" << std::endl;
+    ++reports;
+  }
+
+  tokens.seek(0);
+  parser.reset();
+  parser.getInterpreter<antlr4::atn::ParserATNSimulator>()->setPredictionMode(
+      antlr4::atn::PredictionMode::LL_EXACT_AMBIG_DETECTION);
+  parser.setErrorHandler(std::make_shared<antlr4::DefaultErrorStrategy>());
+  parser.addErrorListener(&listener);
+  parser.file();
+  return reports + listener.reports();
+}
+} // namespace
+} // namespace Cobold
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <file.cb>..." << std::endl;
+    return 2;
+  }
+  Cobold::SourceManager sources;
+  int reports = 0;
+  for (int i = 1; i < argc; ++i) {
+    absl::StatusOr<const Cobold::SourceBuffer *> source = sources.Load(argv[i]);
+    if (!source.ok()) {
+      std::cerr << argv[i] << ": " << source.status().message() << std::endl;
+      return 2;
+    }
+    reports += Cobold::Check(**source);
+  }
+  std::cout << reports << " problem(s) in " << argc - 1 << " file(s)"
+            << std::endl;
+  return reports == 0 ? 0 : 1;
+}
@@ -0,0 +1,7 @@
+#!/bin/bash
+# Fails if `Cobold.g4` is ambiguous or needs full-context prediction on any
+# of the sources, see ambiguity_report.cc.
+#
+#   ambiguity_report_test.sh <ambiguity_report> <file.cb>...
+set -euo pipefail
+exec "$1" "${@:2}"
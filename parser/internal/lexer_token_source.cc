@@ -0,0 +1,111 @@
+#include "parser/internal/lexer_token_source.h"
+
+#include <array>
+#include <cstring>
+
+#include "absl/strings/str_cat.h"
+#include "parser/internal/CoboldLexer.h"
+
+namespace Cobold {
+namespace {
+// Maps every `TokenKind` to the corresponding token type of the generated
+// lexer. The types are looked up by name in the vocabulary (instead of being
+// hard-coded), so that they stay correct when the grammar changes.
+const std::array<size_t, kNumTokenKinds> &TokenTypes() {
+  static const std::array<size_t, kNumTokenKinds> types = [] {
+    std::array<size_t, kNumTokenKinds> types;
+    types.fill(antlr4::Token::INVALID_TYPE);
+    antlr4::ANTLRInputStream empty;
+    CoboldLexer lexer(&empty);
+    const antlr4::dfa::Vocabulary &vocabulary = lexer.getVocabulary();
+    for (int kind = 0; kind < kNumTokenKinds; ++kind) {
+      const std::string_view spelling =
+          TokenKindSpelling(static_cast<TokenKind>(kind));
+      for (size_t type = 1; type <= vocabulary.getMaxTokenType(); ++type) {
+        if (vocabulary.getLiteralName(type) == spelling ||
+            vocabulary.getSymbolicName(type) == spelling) {
+          types[kind] = type;
+          break;
+        }
+      }
+    }
+    types[static_cast<int>(TokenKind::EndOfFile)] = antlr4::Token::EOF;
+    return types;
+  }();
+  return types;
+}
+
+// Escapes the text of an unrecognized token like `Lexer::getErrorDisplay`.
+std::string ErrorDisplay(std::string_view text) {
+  std::string display;
+  for (const char c : text) {
+    switch (c) {
+    case '\n':
+      display += "\\n";
+      break;
+    case '\r':
+      display += "\\r";
+      break;
+    case '\t':
+      display += "\\t";
+      break;
+    default:
+      display += c;
+    }
+  }
+  return display;
+}
+} // namespace
+
+// `LexerTokenSource` ===================================================
+LexerTokenSource::LexerTokenSource(const SourceBuffer &source,
+                                   SourceCharStream *input,
+                                   antlr4::ANTLRErrorListener *listener,
+                                   size_t begin)
+    : source_(source), input_(input), listener_(listener),
+      lexer_(source.contents(), begin), offset_(begin) {
+  if (begin != 0) {
+    const auto [line, column] = source.Position(begin);
+    line_ = line;
+    line_start_ = begin - column;
+  }
+}
+
+std::unique_ptr<antlr4::Token> LexerTokenSource::nextToken() {
+  const std::array<size_t, kNumTokenKinds> &types = TokenTypes();
+  while (true) {
+    const Token token = lexer_.Next();
+    AdvanceTo(token.offset);
+    if (token.kind == TokenKind::Error) {
+      // Like the generated lexer: report, skip the text and try again.
+      listener_->syntaxError(
+          nullptr, nullptr, line_, offset_ - line_start_,
+          absl::StrCat("token recognition error at: '",
+                       ErrorDisplay(token.Text(source_.contents())), "'"),
+          nullptr);
+      continue;
+    }
+    const size_t type = types[static_cast<int>(token.kind)];
+    return getTokenFactory()->create(
+        {this, input_}, type,
+        std::string(token.Text(source_.contents())),
+        antlr4::Token::DEFAULT_CHANNEL, token.offset,
+        token.kind == TokenKind::EndOfFile ? token.offset - 1 : token.end() - 1,
+        line_, offset_ - line_start_);
+  }
+}
+
+void LexerTokenSource::AdvanceTo(size_t offset) {
+  // Only '\n' starts a new line (matching `LexerATNSimulator`).
+  const char *data = source_.data();
+  const char *newline;
+  while ((newline = static_cast<const char *>(std::memchr(
+              data + offset_, '\n', offset - offset_))) != nullptr) {
+    ++line_;
+    line_start_ = newline - data + 1;
+    offset_ = line_start_;
+  }
+  offset_ = offset;
+}
+// `LexerTokenSource` ===================================================
+} // namespace Cobold
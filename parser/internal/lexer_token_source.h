@@ -0,0 +1,50 @@
+#ifndef COBOLD_PARSER_INTERNAL_LEXER_TOKEN_SOURCE
+#define COBOLD_PARSER_INTERNAL_LEXER_TOKEN_SOURCE
+
+#include <memory>
+#include <string>
+
+#include "antlr4-runtime.h"
+#include "parser/internal/source_char_stream.h"
+#include "parser/lexer.h"
+#include "parser/source_manager.h"
+
+namespace Cobold {
+// `antlr4::TokenSource` backed by the hand-written `Lexer`, i.e., a drop-in
+// replacement for `CoboldLexer` in front of a `CoboldParser`. Token types,
+// positions and recognition errors match the ones of the generated lexer.
+class LexerTokenSource : public antlr4::TokenSource {
+public:
+  // `input` is only used as the (reported) input stream of created tokens,
+  // `listener` receives token recognition errors. Lexing starts at offset
+  // `begin` of `source`.
+  LexerTokenSource(const SourceBuffer &source, SourceCharStream *input,
+                   antlr4::ANTLRErrorListener *listener, size_t begin = 0);
+
+  std::unique_ptr<antlr4::Token> nextToken() override;
+
+  size_t getLine() const override { return line_; }
+  size_t getCharPositionInLine() override { return offset_ - line_start_; }
+  antlr4::CharStream *getInputStream() override { return input_; }
+  std::string getSourceName() override { return source_.filename(); }
+  antlr4::TokenFactory<antlr4::CommonToken> *getTokenFactory() override {
+    return antlr4::CommonTokenFactory::DEFAULT.get();
+  }
+
+private:
+  // Advances the line/column bookkeeping to `offset`.
+  void AdvanceTo(size_t offset);
+
+  const SourceBuffer &source_;
+  SourceCharStream *input_;
+  antlr4::ANTLRErrorListener *listener_;
+  Lexer lexer_;
+
+  // Position of the last token returned (1-based line as in ANTLR).
+  size_t offset_ = 0;
+  size_t line_ = 1;
+  size_t line_start_ = 0;
+};
+} // namespace Cobold
+
+#endif /* COBOLD_PARSER_INTERNAL_LEXER_TOKEN_SOURCE */
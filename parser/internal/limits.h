@@ -0,0 +1,31 @@
+#ifndef COBOLD_PARSER_INTERNAL_LIMITS
+#define COBOLD_PARSER_INTERNAL_LIMITS
+
+#include <string_view>
+
+namespace Cobold {
+// Number of codepoints of the UTF-8 encoded `text`.
+inline int CountCodepoints(std::string_view text) {
+  int count = 0;
+  for (const char c : text) {
+    count += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+  }
+  return count;
+}
+
+// Increments `*depth` for the lifetime of the scope, i.e., tracks the nesting
+// of recursive calls.
+class NestingScope {
+public:
+  explicit NestingScope(int *depth) : depth_(depth) { ++*depth_; }
+  ~NestingScope() { --*depth_; }
+
+  NestingScope(const NestingScope &) = delete;
+  NestingScope &operator=(const NestingScope &) = delete;
+
+private:
+  int *depth_;
+};
+} // namespace Cobold
+
+#endif /* COBOLD_PARSER_INTERNAL_LIMITS */
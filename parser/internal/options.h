@@ -1,6 +1,9 @@
 #ifndef COBOLD_PARSER_INTERNAL_OPTIONS
 #define COBOLD_PARSER_INTERNAL_OPTIONS
 
+#include <atomic>
+#include <cstddef>
+
 namespace Cobold {
 
 inline constexpr int kDefaultErrorRecoveryLimit = 30;
@@ -8,6 +11,84 @@ inline constexpr int kDefaultMaxRecursionDepth = 250;
 inline constexpr int kExpressionSizeCodepointLimit = 100'000;
 inline constexpr int kDefaultErrorRecoveryTokenLookaheadLimit = 512;
 inline constexpr bool kDefaultAddMacroCalls = false;
+inline constexpr size_t kDefaultParallelChunkSize = 256 * 1024;
+
+// High-water marks of the resources limited by `ParserOptions` over all files
+// parsed with the same options, i.e., how close parsing came to each limit.
+// Thread-safe.
+struct ParserLimitCounters {
+  std::atomic<int> recursion_depth = 0;
+  std::atomic<int> expression_size = 0;
+  std::atomic<int> errors = 0;
+  std::atomic<int> error_recovery_lookahead = 0;
+
+  static void Record(std::atomic<int> &counter, int value) {
+    int current = counter.load(std::memory_order_relaxed);
+    while (current < value &&
+           !counter.compare_exchange_weak(current, value,
+                                          std::memory_order_relaxed)) {
+    }
+  }
+};
+
+struct ParserOptions {
+  // Parse with ANTLR's profiling ATN simulator (always in full LL mode) and
+  // print the most expensive grammar decisions.
+  bool profile = false;
+
+  // Parse (and convert) one top-level declaration at a time through an
+  // unbuffered token stream, such that the parse tree and tokens of a function
+  // are released before the next one is parsed. Peak memory then scales with
+  // the largest function instead of the whole file. Ignored if `profile` is
+  // set.
+  bool streaming = false;
+
+  // Only parse the signatures of defined functions up front and skip their
+  // bodies (by matching braces). Bodies are parsed on demand, see
+  // `BodyLoader`, such that functions that are never reachable from `Main`
+  // are never parsed at all. Takes precedence over `streaming`, ignored if
+  // `profile` is set.
+  bool lazy_bodies = false;
+
+  // Split files at top-level declarations (see `DeclarationScanner`) into
+  // chunks of at least `parallel_chunk_size` bytes and parse the chunks
+  // concurrently on up to `parallel_threads` threads (`<= 0` uses one per
+  // hardware thread). Diagnostics are reported in source order, but the
+  // `error_recovery_limit` applies to every chunk. `0` parses on the calling
+  // thread. Ignored if `profile` or `lazy_bodies` is set.
+  size_t parallel_chunk_size = 0;
+  int parallel_threads = 0;
+
+  // Parse with the hand-written `Lexer` and `ExpressionParser` (which folds
+  // binary operators by precedence instead of descending through one parse
+  // tree context per level) instead of the generated parser. Produces the same
+  // AST, but stops at the first syntax error instead of recovering. Applies to
+  // `Parser::ParseBody` and `Parser::ParseDeclarations` as well. Takes
+  // precedence over `streaming` and `parallel_chunk_size`, ignored if
+  // `profile` is set.
+  bool hand_written = false;
+
+  // Allocate the AST nodes of a file from an `AstArena` owned by its
+  // `SourceFile` instead of one heap allocation per node.
+  bool ast_arena = true;
+
+  // Resource limits for pathological (e.g., generated) inputs. Exceeding any
+  // of them stops parsing with a `ResourceExhaustedError`.
+  //
+  // Nesting depth of recursive constructs (statements, expressions, casts,
+  // postfix operations, types and argument lists).
+  int max_recursion_depth = kDefaultMaxRecursionDepth;
+  // Size (in codepoints) of a single expression.
+  int expression_size_codepoint_limit = kExpressionSizeCodepointLimit;
+  // Number of syntax (and token recognition) errors reported per file.
+  int error_recovery_limit = kDefaultErrorRecoveryLimit;
+  // Number of tokens skipped by a single error recovery.
+  int error_recovery_token_lookahead_limit =
+      kDefaultErrorRecoveryTokenLookaheadLimit;
+
+  // Receives how close parsing came to the above limits (unless `nullptr`).
+  ParserLimitCounters *limit_counters = nullptr;
+};
 
 }  // namespace Cobold
 
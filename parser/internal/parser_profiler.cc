@@ -0,0 +1,86 @@
+#include "parser/internal/parser_profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace Cobold {
+namespace {
+std::string DecisionName(antlr4::Parser *parser, size_t decision) {
+  const antlr4::atn::ATN &atn = parser->getATN();
+  size_t rule_index = atn.decisionToState[decision]->ruleIndex;
+  return parser->getRuleNames()[rule_index] + "#" + std::to_string(decision);
+}
+
+void PrintDecision(std::ostream &out, antlr4::Parser *parser,
+                   const antlr4::atn::DecisionInfo &info) {
+  out << "  " << std::left << std::setw(36)
+      << DecisionName(parser, info.decision) << std::right << std::setw(10)
+      << info.invocations << std::setw(12) << info.timeInPrediction / 1000
+      << std::setw(10) << info.SLL_TotalLook << std::setw(8)
+      << info.SLL_MaxLook << std::setw(10) << info.LL_TotalLook << std::setw(8)
+      << info.LL_MaxLook << std::setw(10) << info.LL_Fallback << std::setw(8)
+      << info.contextSensitivities.size() << std::setw(8)
+      << info.ambiguities.size() << std::endl;
+}
+
+void PrintHeader(std::ostream &out) {
+  out << "  " << std::left << std::setw(36) << "decision" << std::right
+      << std::setw(10) << "invoked" << std::setw(12) << "time (us)"
+      << std::setw(10) << "SLL look" << std::setw(8) << "max" << std::setw(10)
+      << "LL look" << std::setw(8) << "max" << std::setw(10) << "fallback"
+      << std::setw(8) << "ctxsen" << std::setw(8) << "ambig" << std::endl;
+}
+} // namespace
+
+// `ParserProfiler` =====================================================
+ParserProfiler::ParserProfiler(antlr4::Parser *parser)
+    : parser_(parser),
+      interpreter_(parser->getInterpreter<antlr4::atn::ATNSimulator>()),
+      profiler_(std::make_unique<antlr4::atn::ProfilingATNSimulator>(parser)) {
+  parser_->setInterpreter(profiler_.get());
+}
+
+ParserProfiler::~ParserProfiler() {
+  // The generated parser deletes its interpreter, so hand back the original.
+  parser_->setInterpreter(interpreter_);
+}
+
+void ParserProfiler::Report(std::ostream &out, int max_decisions) const {
+  // `DecisionInfo` is not assignable, so rank pointers into the vector.
+  std::vector<antlr4::atn::DecisionInfo> decisions =
+      profiler_->getDecisionInfo();
+  std::vector<const antlr4::atn::DecisionInfo *> ranked;
+  for (const auto &info : decisions) {
+    if (info.invocations > 0)
+      ranked.push_back(&info);
+  }
+  std::sort(ranked.begin(), ranked.end(), [](const auto *a, const auto *b) {
+    return a->SLL_TotalLook + a->LL_TotalLook >
+           b->SLL_TotalLook + b->LL_TotalLook;
+  });
+
+  out << "parser profile: " << parser_->getInputStream()->getSourceName()
+      << std::endl;
+  out << " most expensive decisions (by total lookahead):" << std::endl;
+  PrintHeader(out);
+  for (int i = 0; i < ranked.size() && i < max_decisions; ++i) {
+    PrintDecision(out, parser_, *ranked[i]);
+  }
+
+  out << " decisions requiring full-context (LL) prediction:" << std::endl;
+  bool any_fallback = false;
+  for (const auto *info : ranked) {
+    if (info->LL_Fallback > 0) {
+      if (!any_fallback)
+        PrintHeader(out);
+      PrintDecision(out, parser_, *info);
+      any_fallback = true;
+    }
+  }
+  if (!any_fallback)
+    out << "  none" << std::endl;
+}
+// `ParserProfiler` =====================================================
+} // namespace Cobold
@@ -0,0 +1,32 @@
+#ifndef COBOLD_PARSER_INTERNAL_PARSER_PROFILER
+#define COBOLD_PARSER_INTERNAL_PARSER_PROFILER
+
+#include <memory>
+#include <ostream>
+
+#include "antlr4-runtime.h"
+
+namespace Cobold {
+// Swaps the parser's ATN simulator for ANTLR's `ProfilingATNSimulator` for
+// the lifetime of the profiler and reports which decisions of `Cobold.g4`
+// were the most expensive to predict.
+class ParserProfiler {
+public:
+  ParserProfiler(antlr4::Parser *parser);
+  ~ParserProfiler();
+
+  ParserProfiler(const ParserProfiler &) = delete;
+  ParserProfiler &operator=(const ParserProfiler &) = delete;
+
+  // Prints the `max_decisions` most expensive decisions (by total lookahead)
+  // followed by every decision that required a full-context (LL) fallback.
+  void Report(std::ostream &out, int max_decisions = 10) const;
+
+private:
+  antlr4::Parser *parser_;
+  antlr4::atn::ATNSimulator *interpreter_; // restored on destruction
+  std::unique_ptr<antlr4::atn::ProfilingATNSimulator> profiler_;
+};
+} // namespace Cobold
+
+#endif /* COBOLD_PARSER_INTERNAL_PARSER_PROFILER */
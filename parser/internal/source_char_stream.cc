@@ -0,0 +1,44 @@
+#include "parser/internal/source_char_stream.h"
+
+#include <algorithm>
+
+namespace Cobold {
+// `SourceCharStream` ===================================================
+void SourceCharStream::consume() {
+  if (position_ >= source_.size()) {
+    throw antlr4::IllegalStateException("cannot consume EOF");
+  }
+  ++position_;
+}
+
+size_t SourceCharStream::LA(ssize_t i) {
+  if (i == 0)
+    return 0; // undefined
+  ssize_t position = static_cast<ssize_t>(position_);
+  if (i < 0) {
+    ++i; // e.g., translate LA(-1) to use offset i=0; then data[p+0-1]
+    if (position + i - 1 < 0)
+      return antlr4::IntStream::EOF;
+  }
+  if (position + i - 1 >= static_cast<ssize_t>(source_.size()))
+    return antlr4::IntStream::EOF;
+  return static_cast<unsigned char>(source_.data()[position + i - 1]);
+}
+
+void SourceCharStream::seek(size_t index) {
+  position_ = std::min(index, source_.size());
+}
+
+std::string SourceCharStream::getText(const antlr4::misc::Interval &interval) {
+  if (interval.a < 0 || interval.b < 0)
+    return "";
+  size_t start = static_cast<size_t>(interval.a);
+  size_t stop = static_cast<size_t>(interval.b);
+  if (stop >= source_.size())
+    stop = source_.size() - 1;
+  if (start >= source_.size() || start > stop)
+    return "";
+  return std::string(source_.data() + start, stop - start + 1);
+}
+// `SourceCharStream` ===================================================
+} // namespace Cobold
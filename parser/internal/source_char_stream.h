@@ -0,0 +1,38 @@
+#ifndef COBOLD_PARSER_INTERNAL_SOURCE_CHAR_STREAM
+#define COBOLD_PARSER_INTERNAL_SOURCE_CHAR_STREAM
+
+#include <string>
+
+#include "antlr4-runtime.h"
+#include "parser/source_manager.h"
+
+namespace Cobold {
+// `antlr4::CharStream` that reads directly from a (memory mapped)
+// `SourceBuffer` instead of copying the file into an `ANTLRInputStream`.
+// Symbols are the raw bytes of the file, i.e., the text of every token is
+// exactly the corresponding slice of the source.
+class SourceCharStream : public antlr4::CharStream {
+public:
+  SourceCharStream(const SourceBuffer &source) : source_(source) {}
+
+  void consume() override;
+  size_t LA(ssize_t i) override;
+  ssize_t mark() override { return -1; }
+  void release(ssize_t marker) override {}
+  size_t index() override { return position_; }
+  void seek(size_t index) override;
+  size_t size() override { return source_.size(); }
+  std::string getSourceName() const override { return source_.filename(); }
+
+  std::string getText(const antlr4::misc::Interval &interval) override;
+  std::string toString() const override {
+    return std::string(source_.contents());
+  }
+
+private:
+  const SourceBuffer &source_;
+  size_t position_ = 0;
+};
+} // namespace Cobold
+
+#endif /* COBOLD_PARSER_INTERNAL_SOURCE_CHAR_STREAM */
@@ -0,0 +1,526 @@
+#include "parser/lexer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define COBOLD_LEXER_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define COBOLD_LEXER_NEON 1
+#endif
+
+namespace Cobold {
+namespace {
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+bool IsOctalDigit(char c) { return c >= '0' && c <= '7'; }
+bool IsHexDigit(char c) {
+  return IsDigit(c) || ((c | 0x20) >= 'a' && (c | 0x20) <= 'f');
+}
+bool IsIdentifierStart(char c) {
+  return ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') || c == '_';
+}
+bool IsIdentifierChar(char c) { return IsIdentifierStart(c) || IsDigit(c); }
+bool IsWhitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+bool IsLineEnd(char c) { return c == '\r' || c == '\n'; }
+bool IsEscapeChar(char c) {
+  switch (c) {
+  case '\'':
+  case '"':
+  case '?':
+  case 'a':
+  case 'b':
+  case 'f':
+  case 'n':
+  case 'r':
+  case 't':
+  case 'v':
+  case '\\':
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Each of the `*Mask` functions classifies 16 bytes starting at `p`. Bit `i`
+// of the result is set iff byte `i` belongs to the class.
+constexpr size_t kBlockSize = 16;
+constexpr uint32_t kFullMask = 0xFFFF;
+
+#if defined(COBOLD_LEXER_SSE2)
+__m128i InRange(__m128i v, char lo, char hi) {
+  // Bytes >= 0x80 are negative, i.e., never in range (all classes are ASCII).
+  return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)),
+                       _mm_cmplt_epi8(v, _mm_set1_epi8(hi + 1)));
+}
+
+uint32_t IdentifierMask(const char *p) {
+  const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+  const __m128i alpha = InRange(lower, 'a', 'z');
+  const __m128i digit = InRange(v, '0', '9');
+  const __m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+  return _mm_movemask_epi8(
+      _mm_or_si128(_mm_or_si128(alpha, digit), underscore));
+}
+
+uint32_t WhitespaceMask(const char *p) {
+  const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  const __m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                     _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+  const __m128i line = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')),
+                                    _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+  return _mm_movemask_epi8(_mm_or_si128(space, line));
+}
+
+uint32_t LineEndMask(const char *p) {
+  const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  return _mm_movemask_epi8(
+      _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')),
+                   _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+}
+#elif defined(COBOLD_LEXER_NEON)
+uint32_t MoveMask(uint8x16_t v) {
+  // NEON has no movemask, weigh each lane with its bit and add up halves.
+  static const uint8_t kWeights[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                       1, 2, 4, 8, 16, 32, 64, 128};
+  const uint8x16_t bits = vandq_u8(v, vld1q_u8(kWeights));
+  return vaddv_u8(vget_low_u8(bits)) |
+         (static_cast<uint32_t>(vaddv_u8(vget_high_u8(bits))) << 8);
+}
+
+uint8x16_t InRange(uint8x16_t v, uint8_t lo, uint8_t hi) {
+  return vcleq_u8(vsubq_u8(v, vdupq_n_u8(lo)), vdupq_n_u8(hi - lo));
+}
+
+uint32_t IdentifierMask(const char *p) {
+  const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+  const uint8x16_t lower = vorrq_u8(v, vdupq_n_u8(0x20));
+  const uint8x16_t alpha = InRange(lower, 'a', 'z');
+  const uint8x16_t digit = InRange(v, '0', '9');
+  return MoveMask(
+      vorrq_u8(vorrq_u8(alpha, digit), vceqq_u8(v, vdupq_n_u8('_'))));
+}
+
+uint32_t WhitespaceMask(const char *p) {
+  const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+  return MoveMask(vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')),
+                                    vceqq_u8(v, vdupq_n_u8('\t'))),
+                           vorrq_u8(vceqq_u8(v, vdupq_n_u8('\r')),
+                                    vceqq_u8(v, vdupq_n_u8('\n')))));
+}
+
+uint32_t LineEndMask(const char *p) {
+  const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+  return MoveMask(vorrq_u8(vceqq_u8(v, vdupq_n_u8('\r')),
+                           vceqq_u8(v, vdupq_n_u8('\n'))));
+}
+#endif
+
+// Returns the first position >= `position` whose byte is not in the class,
+// i.e., for which `Predicate` does not hold (`source.size()` if there is none).
+template <uint32_t (*Mask)(const char *), bool (*Predicate)(char)>
+size_t SkipWhile(std::string_view source, size_t position) {
+#if defined(COBOLD_LEXER_SSE2) || defined(COBOLD_LEXER_NEON)
+  while (position + kBlockSize <= source.size()) {
+    const uint32_t mask = Mask(source.data() + position);
+    if (mask != kFullMask)
+      return position + __builtin_ctz(~mask);
+    position += kBlockSize;
+  }
+#endif
+  while (position < source.size() && Predicate(source[position]))
+    ++position;
+  return position;
+}
+
+// Returns the first position >= `position` holding a byte of the class.
+template <uint32_t (*Mask)(const char *), bool (*Predicate)(char)>
+size_t SkipUntil(std::string_view source, size_t position) {
+#if defined(COBOLD_LEXER_SSE2) || defined(COBOLD_LEXER_NEON)
+  while (position + kBlockSize <= source.size()) {
+    const uint32_t mask = Mask(source.data() + position);
+    if (mask != 0)
+      return position + __builtin_ctz(mask);
+    position += kBlockSize;
+  }
+#endif
+  while (position < source.size() && !Predicate(source[position]))
+    ++position;
+  return position;
+}
+
+#if !defined(COBOLD_LEXER_SSE2) && !defined(COBOLD_LEXER_NEON)
+// Never called, the scalar loops above are used instead.
+uint32_t IdentifierMask(const char *p) { return 0; }
+uint32_t WhitespaceMask(const char *p) { return 0; }
+uint32_t LineEndMask(const char *p) { return 0; }
+#endif
+
+TokenKind KeywordKind(std::string_view text) {
+  // `IntegralType`/`FloatingType` are defined before their `I8`, ..., `F256`
+  // alternatives in the grammar, hence always win.
+  if (text.size() >= 2 && (text[0] == 'i' || text[0] == 'f')) {
+    std::string_view size = text.substr(1);
+    if (size == "8" || size == "16" || size == "32" || size == "64" ||
+        size == "128" || size == "256") {
+      return text[0] == 'i' ? TokenKind::IntegralType : TokenKind::FloatingType;
+    }
+  }
+  switch (text.size()) {
+  case 2:
+    if (text == "fn")
+      return TokenKind::Function;
+    if (text == "if")
+      return TokenKind::If;
+    if (text == "in")
+      return TokenKind::In;
+    break;
+  case 3:
+    if (text == "for")
+      return TokenKind::For;
+    if (text == "var")
+      return TokenKind::Var;
+    if (text == "let")
+      return TokenKind::Let;
+    if (text == "nil")
+      return TokenKind::Nil;
+    break;
+  case 4:
+    if (text == "else")
+      return TokenKind::Else;
+    if (text == "bool")
+      return TokenKind::Bool;
+    if (text == "char")
+      return TokenKind::Char;
+    if (text == "true")
+      return TokenKind::BoolConstant;
+    break;
+  case 5:
+    if (text == "while")
+      return TokenKind::While;
+    if (text == "break")
+      return TokenKind::Break;
+    if (text == "false")
+      return TokenKind::BoolConstant;
+    break;
+  case 6:
+    if (text == "import")
+      return TokenKind::Import;
+    if (text == "extern")
+      return TokenKind::Extern;
+    if (text == "return")
+      return TokenKind::Return;
+    if (text == "deinit")
+      return TokenKind::Deinit;
+    if (text == "string")
+      return TokenKind::String;
+    if (text == "malloc")
+      return TokenKind::Malloc;
+    if (text == "sizeof")
+      return TokenKind::Sizeof;
+    break;
+  case 8:
+    if (text == "continue")
+      return TokenKind::Continue;
+    break;
+  }
+  return TokenKind::Identifier;
+}
+} // namespace
+
+// `Lexer` ==============================================================
+Token Lexer::Next() {
+  SkipWhitespaceAndComments();
+  if (position_ >= source_.size())
+    return MakeToken(TokenKind::EndOfFile, source_.size(), source_.size());
+
+  const char c = source_[position_];
+  if (IsIdentifierStart(c))
+    return LexIdentifierOrKeyword();
+  if (IsDigit(c))
+    return LexNumber(position_);
+  if (c == '.' && position_ + 1 < source_.size() &&
+      IsDigit(source_[position_ + 1]))
+    return LexNumber(position_);
+  if (c == '\'')
+    return LexQuoted('\'', TokenKind::CharConstant);
+  if (c == '"')
+    return LexQuoted('"', TokenKind::StringConstant);
+  if (c == '+' || c == '-') {
+    // The (optional) sign is part of `IntegerConstant`, which is longer than
+    // any operator starting with '+'/'-' that could apply instead.
+    const size_t end = ScanInteger(position_ + 1);
+    if (end > position_ + 1)
+      return MakeToken(TokenKind::IntegerConstant, position_, end);
+  }
+  return LexPunctuation();
+}
+
+std::vector<Token> Lexer::Tokenize(std::string_view source) {
+  Lexer lexer(source);
+  std::vector<Token> tokens;
+  // Rough estimate to avoid most reallocations.
+  tokens.reserve(source.size() / 4 + 1);
+  do {
+    tokens.push_back(lexer.Next());
+  } while (tokens.back().kind != TokenKind::EndOfFile);
+  return tokens;
+}
+
+void Lexer::SkipWhitespaceAndComments() {
+  while (true) {
+    position_ = SkipWhile<WhitespaceMask, IsWhitespace>(source_, position_);
+    if (position_ + 1 >= source_.size() || source_[position_] != '/')
+      return;
+    if (source_[position_ + 1] == '/') {
+      position_ = SkipUntil<LineEndMask, IsLineEnd>(source_, position_ + 2);
+    } else if (source_[position_ + 1] == '*') {
+      const size_t end = source_.find("*/", position_ + 2);
+      // An unterminated comment is lexed as '/' followed by '*'.
+      if (end == std::string_view::npos)
+        return;
+      position_ = end + 2;
+    } else {
+      return;
+    }
+  }
+}
+
+Token Lexer::LexIdentifierOrKeyword() {
+  const size_t start = position_;
+  const size_t end =
+      SkipWhile<IdentifierMask, IsIdentifierChar>(source_, start + 1);
+  return MakeToken(KeywordKind(source_.substr(start, end - start)), start,
+                   end);
+}
+
+Token Lexer::LexNumber(size_t start) {
+  const size_t integer_end = ScanInteger(start);
+  const size_t floating_end = ScanFloating(start);
+  if (floating_end > integer_end)
+    return MakeToken(TokenKind::FloatingConstant, start, floating_end);
+  return MakeToken(TokenKind::IntegerConstant, start, integer_end);
+}
+
+Token Lexer::LexQuoted(char quote, TokenKind kind) {
+  // The content is `(~[\r\n<quote>] | '\\' <escape>)*`, so a backslash may be
+  // either a plain character or start an escape sequence. Like the generated
+  // lexer, follow both interpretations and take the longest literal.
+  const size_t start = position_;
+  size_t end = start; // end of the longest literal found so far
+  size_t position = start + 1;
+  bool reachable = true, reachable_next = false, reachable_after = false;
+  while (position < source_.size() && (reachable || reachable_next)) {
+    if (reachable) {
+      const char c = source_[position];
+      if (c == quote) {
+        end = position + 1;
+      } else if (!IsLineEnd(c)) {
+        reachable_next = true;
+        if (c == '\\' && position + 1 < source_.size() &&
+            IsEscapeChar(source_[position + 1]))
+          reachable_after = true;
+      } else if (!reachable_next) {
+        break; // every interpretation ends at this line break
+      }
+    }
+    ++position;
+    reachable = reachable_next;
+    reachable_next = reachable_after;
+    reachable_after = false;
+  }
+  if (end > start)
+    return MakeToken(kind, start, end);
+  // No literal: the generated lexer skips everything it tried to match,
+  // including the character it failed on.
+  return MakeToken(TokenKind::Error, start,
+                   std::min(position + 1, source_.size()));
+}
+
+Token Lexer::LexPunctuation() {
+  const size_t start = position_;
+  auto next_is = [&](size_t offset, char c) {
+    return start + offset < source_.size() && source_[start + offset] == c;
+  };
+  auto token = [&](TokenKind kind, size_t length) {
+    return MakeToken(kind, start, start + length);
+  };
+  switch (source_[start]) {
+  case ';':
+    return token(TokenKind::Semicolon, 1);
+  case '(':
+    return token(TokenKind::LeftParen, 1);
+  case ')':
+    return token(TokenKind::RightParen, 1);
+  case '{':
+    return token(TokenKind::LeftBrace, 1);
+  case '}':
+    return token(TokenKind::RightBrace, 1);
+  case '[':
+    return token(TokenKind::LeftBracket, 1);
+  case ']':
+    return token(TokenKind::RightBracket, 1);
+  case '#':
+    return token(TokenKind::Hash, 1);
+  case ',':
+    return token(TokenKind::Comma, 1);
+  case ':':
+    return token(TokenKind::Colon, 1);
+  case '?':
+    return token(TokenKind::Question, 1);
+  case '~':
+    return token(TokenKind::Tilde, 1);
+  case '.':
+    if (next_is(1, '.'))
+      return token(TokenKind::DotDot, 2);
+    return token(TokenKind::Dot, 1);
+  case '-':
+    if (next_is(1, '>'))
+      return token(TokenKind::Arrow, 2);
+    if (next_is(1, '-'))
+      return token(TokenKind::DashDash, 2);
+    if (next_is(1, '='))
+      return token(TokenKind::MinusAssign, 2);
+    return token(TokenKind::Minus, 1);
+  case '+':
+    if (next_is(1, '+'))
+      return token(TokenKind::PlusPlus, 2);
+    if (next_is(1, '='))
+      return token(TokenKind::PlusAssign, 2);
+    return token(TokenKind::Plus, 1);
+  case '*':
+    if (next_is(1, '='))
+      return token(TokenKind::StarAssign, 2);
+    return token(TokenKind::Star, 1);
+  case '/':
+    if (next_is(1, '='))
+      return token(TokenKind::SlashAssign, 2);
+    return token(TokenKind::Slash, 1);
+  case '%':
+    if (next_is(1, '='))
+      return token(TokenKind::PercentAssign, 2);
+    return token(TokenKind::Percent, 1);
+  case '&':
+    if (next_is(1, '&'))
+      return token(TokenKind::AmpAmp, 2);
+    if (next_is(1, '='))
+      return token(TokenKind::AmpAssign, 2);
+    return token(TokenKind::Amp, 1);
+  case '|':
+    if (next_is(1, '|'))
+      return token(TokenKind::PipePipe, 2);
+    if (next_is(1, '='))
+      return token(TokenKind::PipeAssign, 2);
+    return token(TokenKind::Pipe, 1);
+  case '^':
+    if (next_is(1, '='))
+      return token(TokenKind::CaretAssign, 2);
+    return token(TokenKind::Caret, 1);
+  case '!':
+    if (next_is(1, '='))
+      return token(TokenKind::NotEqual, 2);
+    return token(TokenKind::Bang, 1);
+  case '=':
+    if (next_is(1, '='))
+      return token(TokenKind::EqualEqual, 2);
+    return token(TokenKind::Assign, 1);
+  case '<':
+    if (next_is(1, '<'))
+      return next_is(2, '=') ? token(TokenKind::ShiftLeftAssign, 3)
+                             : token(TokenKind::ShiftLeft, 2);
+    if (next_is(1, '='))
+      return token(TokenKind::LessEqual, 2);
+    return token(TokenKind::Less, 1);
+  case '>':
+    if (next_is(1, '>'))
+      return next_is(2, '=') ? token(TokenKind::ShiftRightAssign, 3)
+                             : token(TokenKind::ShiftRight, 2);
+    if (next_is(1, '='))
+      return token(TokenKind::GreaterEqual, 2);
+    return token(TokenKind::Greater, 1);
+  default:
+    return token(TokenKind::Error, 1);
+  }
+}
+
+Token Lexer::MakeToken(TokenKind kind, size_t start, size_t end) {
+  position_ = end;
+  return Token{kind, static_cast<uint32_t>(start),
+               static_cast<uint32_t>(end - start)};
+}
+
+size_t Lexer::ScanInteger(size_t start) const {
+  if (start >= source_.size() || !IsDigit(source_[start]))
+    return start;
+  size_t position = start + 1;
+  if (source_[start] != '0') {
+    // DecimalConstant: NonzeroDigit Digit*
+    while (position < source_.size() && IsDigit(source_[position]))
+      ++position;
+    return position;
+  }
+  // OctalConstant: '0' OctalDigit*
+  while (position < source_.size() && IsOctalDigit(source_[position]))
+    ++position;
+  size_t end = position;
+  if (start + 1 < source_.size()) {
+    const char prefix = source_[start + 1] | 0x20;
+    if (prefix == 'x' || prefix == 'b') {
+      // HexadecimalConstant/BinaryConstant: '0' [xXbB] Digits+
+      position = start + 2;
+      while (position < source_.size() &&
+             (prefix == 'x' ? IsHexDigit(source_[position])
+                            : source_[position] == '0' ||
+                                  source_[position] == '1'))
+        ++position;
+      if (position > start + 2)
+        end = std::max(end, position);
+    }
+  }
+  return end;
+}
+
+size_t Lexer::ScanFloating(size_t start) const {
+  // FloatingConstant: Digit* '.' Digit+
+  size_t position = start;
+  while (position < source_.size() && IsDigit(source_[position]))
+    ++position;
+  if (position >= source_.size() || source_[position] != '.')
+    return start;
+  const size_t fraction = position + 1;
+  position = fraction;
+  while (position < source_.size() && IsDigit(source_[position]))
+    ++position;
+  return position > fraction ? position : start;
+}
+// `Lexer` ==============================================================
+
+// `DeclarationScanner` =================================================
+std::optional<uint32_t> DeclarationScanner::Next() {
+  while (true) {
+    const Token token = lexer_.Next();
+    switch (token.kind) {
+    case TokenKind::EndOfFile:
+      return std::nullopt;
+    case TokenKind::LeftBrace:
+      ++depth_;
+      break;
+    case TokenKind::RightBrace:
+      depth_ = std::max(depth_ - 1, 0);
+      break;
+    case TokenKind::Function:
+      if (depth_ == 0)
+        return token.offset;
+      break;
+    default:
+      break;
+    }
+  }
+}
+// `DeclarationScanner` =================================================
+} // namespace Cobold
@@ -0,0 +1,77 @@
+#ifndef COBOLD_PARSER_LEXER
+#define COBOLD_PARSER_LEXER
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "parser/token.h"
+
+namespace Cobold {
+// Hand-written lexer for `Cobold.g4`, producing exactly the token sequence of
+// the generated `CoboldLexer` (including its quirks, e.g., `a-1` is lexed as
+// `Identifier IntegerConstant`, since the sign is part of the constant).
+// Whitespace, comments and identifiers are scanned 16 bytes at a time where
+// SSE2/NEON is available.
+class Lexer {
+public:
+  explicit Lexer(std::string_view source) : source_(source) {}
+  // Starts lexing at `position` (which must not be inside of a token).
+  Lexer(std::string_view source, size_t position)
+      : source_(source), position_(position) {}
+
+  // Returns the next token, skipping whitespace and comments. Input that does
+  // not start any token is returned as a single `TokenKind::Error` token
+  // (spanning the same text the generated lexer would skip). Once the end of
+  // the input is reached, `TokenKind::EndOfFile` is returned repeatedly.
+  Token Next();
+
+  // Lexes the entire `source` (including the trailing `EndOfFile`).
+  static std::vector<Token> Tokenize(std::string_view source);
+
+  size_t position() const { return position_; }
+
+private:
+  void SkipWhitespaceAndComments();
+
+  Token LexIdentifierOrKeyword();
+  Token LexNumber(size_t start);
+  Token LexQuoted(char quote, TokenKind kind);
+  Token LexPunctuation();
+
+  Token MakeToken(TokenKind kind, size_t start, size_t end);
+
+  // Returns the end of the longest integer constant (without sign) starting
+  // at `start` or `start` if there is none.
+  size_t ScanInteger(size_t start) const;
+  // Returns the end of the longest floating constant starting at `start` or
+  // `start` if there is none.
+  size_t ScanFloating(size_t start) const;
+
+  std::string_view source_;
+  size_t position_ = 0;
+};
+
+// Finds the top-level declarations of a file without parsing it, i.e., the
+// `fn` tokens outside of braces. Unbalanced braces (in erroneous input) only
+// hide declarations, such that the declarations found always start at the
+// same tokens as the ones a parser would find.
+class DeclarationScanner {
+public:
+  // Starts scanning at `position` (which must be at brace depth 0).
+  explicit DeclarationScanner(std::string_view source, size_t position = 0)
+      : lexer_(source, position) {}
+
+  // Returns the offset of the next top-level `fn` or `std::nullopt` at the
+  // end of the input.
+  std::optional<uint32_t> Next();
+
+private:
+  Lexer lexer_;
+  int depth_ = 0;
+};
+} // namespace Cobold
+
+#endif /* COBOLD_PARSER_LEXER */
@@ -0,0 +1,150 @@
+// Differential test of the hand-written `Lexer` (through `LexerTokenSource`)
+// against the generated `CoboldLexer`: both need to produce the same tokens
+// (type, text and position) and the same recognition errors.
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "antlr4-runtime.h"
+#include "gtest/gtest.h"
+#include "parser/internal/CoboldLexer.h"
+#include "parser/internal/lexer_token_source.h"
+#include "parser/internal/source_char_stream.h"
+#include "parser/lexer.h"
+#include "parser/source_manager.h"
+#include "parser/token.h"
+
+namespace Cobold {
+namespace {
+class RecordingErrorListener : public antlr4::BaseErrorListener {
+public:
+  void syntaxError(antlr4::Recognizer *recognizer,
+                   antlr4::Token *offendingSymbol, size_t line,
+                   size_t charPositionInLine, const std::string &msg,
+                   std::exception_ptr e) override {
+    errors.push_back(absl::StrCat(line, ":", charPositionInLine, " ", msg));
+  }
+
+  std::vector<std::string> errors;
+};
+
+struct Lexed {
+  std::vector<std::string> tokens;
+  std::vector<std::string> errors;
+};
+
+std::string Describe(antlr4::Token *token) {
+  return absl::StrCat(token->getType(), " '", token->getText(), "' [",
+                      token->getStartIndex(), ",", token->getStopIndex(),
+                      "] ", token->getLine(), ":",
+                      token->getCharPositionInLine());
+}
+
+Lexed LexAll(antlr4::TokenSource *lexer, RecordingErrorListener *listener) {
+  Lexed lexed;
+  while (true) {
+    std::unique_ptr<antlr4::Token> token = lexer->nextToken();
+    lexed.tokens.push_back(Describe(token.get()));
+    if (token->getType() == antlr4::Token::EOF)
+      break;
+  }
+  lexed.errors = std::move(listener->errors);
+  return lexed;
+}
+
+Lexed LexWithCoboldLexer(const SourceBuffer &source) {
+  SourceCharStream input(source);
+  CoboldLexer lexer(&input);
+  RecordingErrorListener listener;
+  lexer.removeErrorListeners();
+  lexer.addErrorListener(&listener);
+  return LexAll(&lexer, &listener);
+}
+
+Lexed LexWithLexer(const SourceBuffer &source) {
+  SourceCharStream input(source);
+  RecordingErrorListener listener;
+  LexerTokenSource lexer(source, &input, &listener);
+  return LexAll(&lexer, &listener);
+}
+
+void ExpectSameTokens(const SourceBuffer &source) {
+  SCOPED_TRACE(source.filename());
+  const Lexed expected = LexWithCoboldLexer(source);
+  const Lexed actual = LexWithLexer(source);
+  EXPECT_EQ(actual.tokens, expected.tokens);
+  EXPECT_EQ(actual.errors, expected.errors);
+}
+
+std::vector<TokenKind> Kinds(std::string_view source) {
+  std::vector<TokenKind> kinds;
+  for (const Token &token : Lexer::Tokenize(source))
+    kinds.push_back(token.kind);
+  return kinds;
+}
+
+TEST(LexerTest, MatchesCoboldLexerOnSources) {
+  SourceManager sources;
+  int files = 0;
+  for (const char *directory : {"test", "std"}) {
+    for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+      if (entry.path().extension() != ".cb")
+        continue;
+      absl::StatusOr<const SourceBuffer *> source =
+          sources.Load(entry.path().string());
+      ASSERT_TRUE(source.ok()) << source.status();
+      ExpectSameTokens(**source);
+      ++files;
+    }
+  }
+  EXPECT_GT(files, 0);
+}
+
+TEST(LexerTest, MatchesCoboldLexerOnEdgeCases) {
+  const std::vector<std::string> cases = {
+      "",
+      "fn Main() -> i32 { return 0; }",
+      // The sign is part of `IntegerConstant`.
+      "a-1 a - 1 a+1 --1 ++1 -0x1F +017 -0b101 - 1",
+      "1.5 .5 1. 1..2 0x 0b2 09 0xg i8 i16 i7 f256 f512 true false",
+      // Unterminated block comments are lexed as '/' '*'.
+      "a /* b", "/* a */ b /* c", "/*/ a", "a // b\nc // d",
+      // Recognition errors (skipped text is reported).
+      "a @ b", "'ab", "\"a\nb\"", "'\\'", "\"\\q\"", "\"a\\\"b\"", "$$$ `",
+      "'\\\\'", "\"unterminated",
+      // Blocks of whitespace and identifiers longer than a SIMD register.
+      std::string(40, ' ') + std::string(40, 'a') + "\t\r\n" +
+          std::string(33, '_') + "1",
+      "<<= >>= << >> <= >= == != && || &= |= ^= %= *= /= -> .. ...",
+  };
+  for (int i = 0; i < cases.size(); ++i) {
+    std::unique_ptr<SourceBuffer> source =
+        SourceBuffer::FromString(absl::StrCat("case", i), cases[i]);
+    ExpectSameTokens(*source);
+  }
+}
+
+TEST(LexerTest, SignIsPartOfIntegerConstant) {
+  EXPECT_EQ(Kinds("a-1"),
+            (std::vector<TokenKind>{TokenKind::Identifier,
+                                    TokenKind::IntegerConstant,
+                                    TokenKind::EndOfFile}));
+}
+
+TEST(LexerTest, UnterminatedBlockComment) {
+  EXPECT_EQ(Kinds("/* a"),
+            (std::vector<TokenKind>{TokenKind::Slash, TokenKind::Star,
+                                    TokenKind::Identifier,
+                                    TokenKind::EndOfFile}));
+}
+
+TEST(LexerTest, RecognitionError) {
+  EXPECT_EQ(Kinds("a @ b"),
+            (std::vector<TokenKind>{TokenKind::Identifier, TokenKind::Error,
+                                    TokenKind::Identifier,
+                                    TokenKind::EndOfFile}));
+}
+} // namespace
+} // namespace Cobold
@@ -0,0 +1,177 @@
+#include "parser/module_loader.h"
+
+#include <deque>
+#include <filesystem>
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "parser/body_loader.h"
+#include "parser/parser.h"
+
+namespace Cobold {
+namespace {
+std::string CanonicalPath(const std::string &filename) {
+  std::error_code error;
+  std::filesystem::path path =
+      std::filesystem::weakly_canonical(filename, error);
+  if (error)
+    return std::filesystem::path(filename).lexically_normal().string();
+  return path.string();
+}
+} // namespace
+
+// `ModuleLoader` =======================================================
+absl::StatusOr<std::vector<SourceFile>>
+ModuleLoader::Load(SourceManager *sources, const std::string &filename,
+                   const ModuleLoaderOptions &options) {
+  ModuleLoader loader(sources, options);
+  {
+    absl::MutexLock lock(&loader.mutex_);
+    loader.Schedule(filename);
+  }
+  loader.pool_.Wait();
+
+  // Collect the modules in a deterministic (breadth-first) order.
+  absl::MutexLock lock(&loader.mutex_);
+  std::vector<SourceFile> modules;
+  modules.reserve(loader.modules_.size());
+  std::vector<std::optional<uint64_t>> fingerprints;
+  fingerprints.reserve(loader.modules_.size());
+  absl::flat_hash_set<std::string> visited = {CanonicalPath(filename)};
+  std::deque<std::string> queue = {CanonicalPath(filename)};
+  while (!queue.empty()) {
+    Module *module = loader.modules_[queue.front()].get();
+    queue.pop_front();
+    if (!module->file.ok())
+      return module->file.status();
+    modules.push_back(*std::move(module->file));
+    fingerprints.push_back(module->cached_fingerprint);
+    for (const std::string &import : module->imports) {
+      if (visited.insert(import).second)
+        queue.push_back(import);
+    }
+  }
+  if (options.cache != nullptr) {
+    absl::Status status = loader.ReparseStaleModules(modules, fingerprints);
+    if (!status.ok())
+      return status;
+  }
+  if (options.parser_options.lazy_bodies) {
+    absl::Status status =
+        BodyLoader::LoadReachable(modules, options.parser_options);
+    if (!status.ok())
+      return status;
+  }
+  return modules;
+}
+
+void ModuleLoader::Schedule(const std::string &filename) {
+  std::string path = CanonicalPath(filename);
+  if (modules_.contains(path))
+    return;
+  auto module = absl::make_unique<Module>();
+  module->filename = filename;
+  Module *scheduled = module.get();
+  modules_[path] = std::move(module);
+  pool_.Schedule([this, scheduled]() {
+    TypeTable::Scope scope(types_);
+    LoadModule(scheduled);
+  });
+}
+
+void ModuleLoader::LoadModule(Module *module) {
+  // Parsing happens outside of the lock, `module` is not shared until then.
+  absl::StatusOr<SourceFile> file = absl::UnknownError("not loaded");
+  std::optional<uint64_t> cached_fingerprint;
+  if (options_.cache != nullptr) {
+    absl::StatusOr<const SourceBuffer *> source =
+        sources_->Load(module->filename);
+    if (source.ok()) {
+      std::optional<CachedModule> cached = options_.cache->Lookup(**source);
+      if (cached.has_value()) {
+        file = std::move(cached->file);
+        cached_fingerprint = cached->fingerprint;
+      }
+    }
+  }
+  if (!cached_fingerprint.has_value()) {
+    file = Parser::Parse(sources_, module->filename, options_.parser_options);
+  }
+  std::vector<std::string> imports;
+  if (file.ok()) {
+    imports.reserve(file->imports().size());
+    for (const std::string &import : file->imports()) {
+      absl::StatusOr<std::string> resolved =
+          ResolveImport(module->filename, import);
+      if (!resolved.ok()) {
+        file = resolved.status();
+        break;
+      }
+      imports.push_back(*std::move(resolved));
+    }
+  }
+
+  absl::MutexLock lock(&mutex_);
+  module->file = std::move(file);
+  module->cached_fingerprint = cached_fingerprint;
+  module->imports.reserve(imports.size());
+  for (const std::string &import : imports) {
+    module->imports.push_back(CanonicalPath(import));
+    Schedule(import);
+  }
+}
+
+absl::Status ModuleLoader::ReparseStaleModules(
+    std::vector<SourceFile> &modules,
+    const std::vector<std::optional<uint64_t>> &fingerprints) {
+  const uint64_t fingerprint = ModuleCache::SignatureFingerprint(modules);
+  std::vector<absl::Status> statuses(modules.size());
+  for (int i = 0; i < modules.size(); ++i) {
+    if (!fingerprints[i].has_value() || *fingerprints[i] == fingerprint)
+      continue;
+    pool_.Schedule([this, &modules, &statuses, i]() {
+      TypeTable::Scope scope(types_);
+      absl::StatusOr<SourceFile> file = Parser::Parse(
+          sources_, modules[i].filename(), options_.parser_options);
+      if (file.ok()) {
+        modules[i] = *std::move(file);
+      } else {
+        statuses[i] = file.status();
+      }
+    });
+  }
+  pool_.Wait();
+  for (const absl::Status &status : statuses) {
+    if (!status.ok())
+      return status;
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::string>
+ModuleLoader::ResolveImport(const std::string &importing_file,
+                            const std::string &import) const {
+  std::filesystem::path import_path(import);
+  if (!import_path.has_extension())
+    import_path.replace_extension(".cb");
+
+  std::vector<std::filesystem::path> candidates;
+  candidates.reserve(options_.import_paths.size() + 1);
+  candidates.push_back(
+      std::filesystem::path(importing_file).parent_path() / import_path);
+  for (const std::string &directory : options_.import_paths) {
+    candidates.push_back(std::filesystem::path(directory) / import_path);
+  }
+
+  for (const auto &candidate : candidates) {
+    std::error_code error;
+    if (std::filesystem::is_regular_file(candidate, error))
+      return candidate.lexically_normal().string();
+  }
+  return absl::NotFoundError(absl::StrCat("Could not resolve import \"",
+                                          import, "\" in ", importing_file));
+}
+// `ModuleLoader` =======================================================
+} // namespace Cobold
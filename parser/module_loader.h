@@ -0,0 +1,95 @@
+#ifndef COBOLD_PARSER_MODULE_LOADER
+#define COBOLD_PARSER_MODULE_LOADER
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "cache/module_cache.h"
+#include "core/type.h"
+#include "parser/internal/options.h"
+#include "parser/source_file.h"
+#include "parser/source_manager.h"
+#include "util/thread_pool.h"
+
+namespace Cobold {
+struct ModuleLoaderOptions {
+  // Directories searched (in order) for imports that cannot be resolved
+  // relative to the importing file.
+  std::vector<std::string> import_paths = {".", "std"};
+
+  // Number of modules parsed concurrently (`<= 0` uses all hardware threads).
+  // `CompilationSession` annotates the functions on as many threads.
+  int num_threads = 0;
+
+  ParserOptions parser_options;
+
+  // Optional cache of annotated modules. Modules found in the cache are not
+  // parsed at all (unless the signatures of the program changed).
+  ModuleCache *cache = nullptr;
+};
+
+// Loads a module together with its transitive imports. Every module is parsed
+// as soon as it is discovered, i.e., independent modules are parsed in
+// parallel. Modules are only parsed once, even if imported multiple times.
+class ModuleLoader {
+public:
+  // Returns the modules in breadth-first import order, starting with
+  // `filename` itself (independent of the order they finished parsing in).
+  // `sources` needs to outlive the returned modules.
+  static absl::StatusOr<std::vector<SourceFile>>
+  Load(SourceManager *sources, const std::string &filename,
+       const ModuleLoaderOptions &options = ModuleLoaderOptions());
+
+private:
+  struct Module {
+    std::string filename;
+    absl::StatusOr<SourceFile> file = absl::UnknownError("not loaded");
+    std::vector<std::string> imports; // canonical paths of the imports
+    // Set if the module was loaded from the cache.
+    std::optional<uint64_t> cached_fingerprint;
+  };
+
+  ModuleLoader(SourceManager *sources, const ModuleLoaderOptions &options)
+      : sources_(sources), options_(options), types_(TypeTable::Current()),
+        pool_(options.num_threads) {}
+
+  // Schedules parsing of `filename` unless it was already scheduled.
+  void Schedule(const std::string &filename)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void LoadModule(Module *module);
+
+  // Re-parses the modules loaded from the cache that were annotated in a
+  // program with different signatures.
+  absl::Status ReparseStaleModules(
+      std::vector<SourceFile> &modules,
+      const std::vector<std::optional<uint64_t>> &fingerprints);
+
+  // Resolves `import` (as written in `importing_file`) to the path of the
+  // imported file. A missing extension defaults to ".cb".
+  absl::StatusOr<std::string> ResolveImport(const std::string &importing_file,
+                                            const std::string &import) const;
+
+  SourceManager *sources_;
+  const ModuleLoaderOptions &options_;
+  // The modules are parsed into the types of the calling thread.
+  TypeTable *types_;
+
+  absl::Mutex mutex_;
+  // Keyed by canonical path, such that different spellings of the same
+  // import resolve to the same module.
+  absl::flat_hash_map<std::string, std::unique_ptr<Module>>
+      modules_ ABSL_GUARDED_BY(mutex_);
+
+  // Declared last, such that it is destroyed (i.e., joined) first.
+  ThreadPool pool_;
+};
+} // namespace Cobold
+
+#endif /* COBOLD_PARSER_MODULE_LOADER */
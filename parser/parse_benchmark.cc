@@ -0,0 +1,108 @@
+// Compares parsing a file with the AST allocated from an `AstArena` (see
+// `ParserOptions::ast_arena`) against one heap allocation per node:
+//
+//   bazel run -c opt //parser:parse_benchmark -- test/example.cb [iterations]
+//
+// Reports the heap allocations and the time per parse and per destruction of
+// the parsed `SourceFile`.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "core/type.h"
+#include "parser/internal/options.h"
+#include "parser/parser.h"
+#include "parser/source_file.h"
+#include "parser/source_manager.h"
+
+namespace {
+std::atomic<int64_t> heap_allocations = 0;
+} // namespace
+
+void *operator new(size_t size) {
+  heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size == 0 ? 1 : size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+namespace Cobold {
+namespace {
+struct Measurement {
+  int64_t allocations = 0;
+  double parse_us = 0;
+  double free_us = 0;
+};
+
+std::optional<Measurement> Measure(const SourceBuffer &source, bool ast_arena,
+                                   int iterations) {
+  ParserOptions options;
+  options.ast_arena = ast_arena;
+  Measurement total;
+  for (int i = 0; i < iterations; ++i) {
+    const int64_t allocations = heap_allocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    std::optional<absl::StatusOr<SourceFile>> file =
+        Parser::Parse(source, options);
+    const auto parsed = std::chrono::steady_clock::now();
+    total.allocations += heap_allocations.load() - allocations;
+    if (!file->ok()) {
+      std::cerr << file->status().message() << std::endl;
+      return std::nullopt;
+    }
+    file.reset();
+    const auto freed = std::chrono::steady_clock::now();
+    total.parse_us +=
+        std::chrono::duration<double, std::micro>(parsed - start).count();
+    total.free_us +=
+        std::chrono::duration<double, std::micro>(freed - parsed).count();
+  }
+  return Measurement{total.allocations / iterations,
+                     total.parse_us / iterations, total.free_us / iterations};
+}
+
+void Print(const char *name, const Measurement &measurement) {
+  std::cout << name << ": " << measurement.allocations
+            << " heap allocations, parse " << measurement.parse_us
+            << " us, free " << measurement.free_us << " us" << std::endl;
+}
+} // namespace
+} // namespace Cobold
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <file.cb> [iterations]" << std::endl;
+    return 2;
+  }
+  const int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 100;
+  Cobold::TypeTable types;
+  Cobold::TypeTable::Scope scope(&types);
+  Cobold::SourceManager sources;
+  absl::StatusOr<const Cobold::SourceBuffer *> source = sources.Load(argv[1]);
+  if (!source.ok()) {
+    std::cerr << source.status().message() << std::endl;
+    return 2;
+  }
+  // Warm up (e.g., the interned types and ANTLR's DFA cache).
+  Cobold::Measure(**source, /*ast_arena=*/true, 1);
+  std::optional<Cobold::Measurement> heap =
+      Cobold::Measure(**source, /*ast_arena=*/false, iterations);
+  std::optional<Cobold::Measurement> arena =
+      Cobold::Measure(**source, /*ast_arena=*/true, iterations);
+  if (!heap.has_value() || !arena.has_value())
+    return 1;
+  std::cout << argv[1] << " (" << iterations << " iterations)" << std::endl;
+  Cobold::Print("heap ", *heap);
+  Cobold::Print("arena", *arena);
+  return 0;
+}
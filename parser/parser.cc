@@ -1,19 +1,32 @@
 #include "parser/parser.h"
 
+#include <algorithm>
 #include <any>
-#include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "core/ast_arena.h"
 #include "core/expression.h"
 #include "core/function.h"
-#include "inference/type_inference_visitor.h"
-#include "source_location.h"
+#include "core/symbol.h"
+#include "core/type.h"
+#include "parser/expression_parser.h"
+#include "parser/internal/lexer_token_source.h"
+#include "parser/internal/limits.h"
+#include "parser/internal/parser_profiler.h"
+#include "parser/internal/source_char_stream.h"
+#include "parser/lexer.h"
+#include "parser/source_location.h"
+#include "util/thread_pool.h"
 
 namespace Cobold {
 namespace {
@@ -22,40 +35,6 @@ template <typename T> absl::Status InvalidArgument(std::string type, T *t) {
       absl::StrCat("Invalid ", type, ": ",
                    t != nullptr ? "\"" + t->getText() + "\"" : "null"));
 }
-
-std::vector<std::string> ReadFileToBuffer(const std::string &filename) {
-  std::string str;
-  std::vector<std::string> file_contents;
-
-  std::fstream file;
-  file.open(filename, std::ios::in);
-
-  while (getline(file, str)) {
-    file_contents.push_back(str);
-  }
-  return file_contents;
-}
-
-std::unique_ptr<Expression>
-RewriteMalloc(std::unique_ptr<MallocExpression> &&malloc) {
-  // malloc(type)(count) => (type*) __lib_malloc(sizeof(type) * count)
-  std::unique_ptr<Expression> lib_malloc =
-      std::make_unique<IdentifierExpression>(SourceLocation::Generated(),
-                                             "__lib_malloc");
-  std::unique_ptr<Expression> type_size = std::make_unique<SizeofExpression>(
-      SourceLocation::Generated(), malloc->decl_type());
-  std::unique_ptr<Expression> alloc_size = std::make_unique<BinaryExpression>(
-      SourceLocation::Generated(), std::move(type_size),
-      BinaryExpressionType::MULTIPLY, malloc->expression()->Clone());
-  std::vector<std::unique_ptr<Expression>> args;
-  args.push_back(std::move(alloc_size));
-
-  std::unique_ptr<Expression> lib_call = std::make_unique<CallOpExpression>(
-      SourceLocation::Generated(), std::move(lib_malloc), std::move(args));
-  return std::make_unique<CastExpression>(SourceLocation::Generated(),
-                                          Type::PointerTo(malloc->decl_type()),
-                                          std::move(lib_call));
-}
 } // namespace
   // `ParserErrorListener` ================================================
 void ParserErrorListener::syntaxError(antlr4::Recognizer *recognizer,
@@ -63,10 +42,18 @@ void ParserErrorListener::syntaxError(antlr4::Recognizer *recognizer,
                                       size_t line, size_t charPositionInLine,
                                       const std::string &msg,
                                       std::exception_ptr e) {
-  parser_->error_context_ << MakeError(SourceLocation(parser_->filename_, line,
-                                                      charPositionInLine,
-                                                      parser_->buffer_),
-                                       msg, true);
+  // The lexer reports unrecognized input without a token.
+  const SourceSpan span =
+      offendingSymbol != nullptr
+          ? parser_->SpanOf(offendingSymbol)
+          : SourceSpan(SourceLocation::AtOffset(
+                *parser_->source_,
+                parser_->source_->Offset(line, charPositionInLine)));
+  const SourceLocation location = span.begin;
+  parser_->error_context_ << MakeError(span, msg, true);
+  // Stop error cascades (e.g., of a binary file) early, see `AbortParse`.
+  if (!parser_->CountError(location).ok())
+    throw antlr4::ParseCancellationException();
 }
 
 void ParserErrorListener::reportAmbiguity(antlr4::Parser *recognizer,
@@ -83,44 +70,215 @@ void ParserErrorListener::reportAttemptingFullContext(
     antlr4::Parser *recognizer, const antlr4::dfa::DFA &dfa, size_t startIndex,
     size_t stopIndex, const antlrcpp::BitSet &conflictingAlts,
     antlr4::atn::ATNConfigSet *configs) {
-  // assert(false);
+  ++parser_->full_context_attempts_;
 }
 
 void ParserErrorListener::reportContextSensitivity(
     antlr4::Parser *recognizer, const antlr4::dfa::DFA &dfa, size_t startIndex,
     size_t stopIndex, size_t prediction, antlr4::atn::ATNConfigSet *configs) {
-  // assert(false);
+  ++parser_->context_sensitivities_;
 }
 // `ParserErrorListener` ================================================
 
+// `ParserErrorStrategy` ================================================
+void ParserErrorStrategy::consumeUntil(antlr4::Parser *recognizer,
+                                       const antlr4::misc::IntervalSet &set) {
+  const int limit = parser_->options_.error_recovery_token_lookahead_limit;
+  int consumed = 0;
+  for (size_t type = recognizer->getInputStream()->LA(1);
+       type != antlr4::Token::EOF && !set.contains(type);
+       type = recognizer->getInputStream()->LA(1)) {
+    if (++consumed > limit) {
+      antlr4::Token *token = recognizer->getCurrentToken();
+      parser_->AbortParse(
+          parser_->LocationOf(token),
+          absl::StrCat("error recovery skipped more than ", limit,
+                       " tokens, stopping now"));
+    }
+    recognizer->consume();
+  }
+  parser_->RecordLimit(&ParserLimitCounters::error_recovery_lookahead,
+                       consumed);
+}
+// `ParserErrorStrategy` ================================================
+
+// `ParserDepthListener` ================================================
+void ParserDepthListener::enterEveryRule(antlr4::ParserRuleContext *ctx) {
+  if (!Nests(ctx))
+    return;
+  parser_->RecordLimit(&ParserLimitCounters::recursion_depth, ++depth_);
+  if (depth_ > parser_->options_.max_recursion_depth) {
+    parser_->AbortParse(
+        parser_->LocationOf(ctx->getStart()),
+        absl::StrCat("nesting exceeds the maximum depth of ",
+                     parser_->options_.max_recursion_depth));
+  }
+}
+
+void ParserDepthListener::exitEveryRule(antlr4::ParserRuleContext *ctx) {
+  if (Nests(ctx))
+    --depth_;
+}
+
+bool ParserDepthListener::Nests(antlr4::ParserRuleContext *ctx) {
+  const size_t parent =
+      ctx->parent != nullptr
+          ? static_cast<antlr4::RuleContext *>(ctx->parent)->getRuleIndex()
+          : antlr4::INVALID_INDEX;
+  switch (ctx->getRuleIndex()) {
+  // Nested blocks, parentheses, brackets and arguments.
+  case CoboldParser::RuleCompoundStatement:
+  case CoboldParser::RuleExpression:
+  // `a.b[c]->d`, `f(a: i32, ...)` and `[[i32]]*`.
+  case CoboldParser::RulePostfixOperations:
+  case CoboldParser::RuleArgumentList:
+  case CoboldParser::RuleTypeSpecifier:
+    return true;
+  // Chains of casts and unary operators (as opposed to the operands of
+  // multiplicative expressions).
+  case CoboldParser::RuleCastExpression:
+    return parent != CoboldParser::RuleMultiplicativeExpression;
+  // `a ? b : c ? d : e`
+  case CoboldParser::RuleConditionalExpression:
+    return parent == CoboldParser::RuleConditionalExpression;
+  default:
+    return false;
+  }
+}
+// `ParserDepthListener` ================================================
+
 // `Parser` =============================================================
-absl::StatusOr<SourceFile> Parser::Parse(const std::string &filename) {
-  std::ifstream source_file(filename);
-  if (!source_file.is_open()) {
-    return absl::InvalidArgumentError("Could not open source file.");
+absl::StatusOr<SourceFile> Parser::Parse(SourceManager *sources,
+                                         const std::string &filename,
+                                         const ParserOptions &options) {
+  absl::StatusOr<const SourceBuffer *> source = sources->Load(filename);
+  if (!source.ok())
+    return source.status();
+  return Parse(**source, options);
+}
+
+absl::StatusOr<SourceFile> Parser::Parse(const SourceBuffer &source,
+                                         const ParserOptions &options) {
+  if (!options.ast_arena)
+    return ParseSource(source, options);
+  auto arena = std::make_unique<AstArena>();
+  absl::StatusOr<SourceFile> file;
+  {
+    AstArena::Scope scope(arena.get());
+    file = ParseSource(source, options);
   }
+  if (file.ok())
+    file->arena_ = std::move(arena);
+  return file;
+}
 
-  Parser parser(filename, ReadFileToBuffer(filename));
+absl::StatusOr<SourceFile>
+Parser::ParseSource(const SourceBuffer &source, const ParserOptions &options) {
+  const std::string &filename = source.filename();
+  Parser parser(&source, options);
+  if ((options.lazy_bodies || options.hand_written) && !options.profile)
+    return parser.ParseTokens(filename);
+  if (options.parallel_chunk_size > 0 && !options.profile &&
+      source.size() > options.parallel_chunk_size) {
+    return ParseParallel(source, options);
+  }
 
-  antlr4::ANTLRInputStream input(source_file);
-  CoboldLexer lexer(&input);
+  // The lexer reads directly from the mapped file (no copy).
+  SourceCharStream input(source);
+  std::unique_ptr<antlr4::TokenSource> lexer = parser.CreateLexer(&input);
+  if (absl::Status status = parser.error_context_.ToStatus(); !status.ok())
+    return status;
 
-  // lexer.removeErrorListeners();
-  lexer.addErrorListener(&parser.listener_);
-  *parser.error_context_;
+  if (options.streaming && !options.profile)
+    return parser.ParseStreaming(filename, lexer.get());
 
-  antlr4::CommonTokenStream tokens(&lexer);
+  antlr4::CommonTokenStream tokens(lexer.get());
   CoboldParser _parser(&tokens);
 
-  // _parser.removeErrorListeners();
-  _parser.addErrorListener(&parser.listener_);
-
-  CoboldParser::FileContext *file = _parser.file();
-  *parser.error_context_;
+  absl::StatusOr<CoboldParser::FileContext *> file;
+  if (options.profile) {
+    // Profile the full LL parse, otherwise the SLL stage hides the decisions
+    // that would require full-context prediction.
+    ParserProfiler profiler(&_parser);
+    parser.PrepareFullParse(&_parser);
+    try {
+      file = _parser.file();
+    } catch (const antlr4::ParseCancellationException &) {
+      file = parser.limit_status_;
+    }
+    profiler.Report(std::cout);
+    std::cout << " full-context attempts: " << parser.full_context_attempts_
+              << ", context sensitivities: " << parser.context_sensitivities_
+              << std::endl;
+  } else {
+    file = parser.ParseTree(&tokens, &_parser);
+  }
+  if (absl::Status status = parser.error_context_.ToStatus(file.status());
+      !status.ok())
+    return status;
 
-  source_file.close();
   tokens.fill();
-  return parser.ParseFile(filename, file);
+  return parser.ParseFile(filename, *file);
+}
+
+std::unique_ptr<antlr4::TokenSource>
+Parser::CreateLexer(SourceCharStream *input, size_t begin) {
+#ifdef COBOLD_FAST_LEXER
+  return std::make_unique<LexerTokenSource>(*source_, input, &listener_, begin);
+#else
+  auto lexer = std::make_unique<CoboldLexer>(input);
+  if (begin != 0) {
+    input->seek(begin);
+    // Keep the reported positions relative to the start of the file.
+    const auto [line, column] = source_->Position(begin);
+    lexer->setLine(line);
+    lexer->setCharPositionInLine(column);
+  }
+  // lexer->removeErrorListeners();
+  lexer->addErrorListener(&listener_);
+  return lexer;
+#endif
+}
+
+absl::StatusOr<CoboldParser::FileContext *>
+Parser::ParseTree(antlr4::CommonTokenStream *tokens, CoboldParser *parser) {
+  // Stage 1: SLL prediction is sufficient (and much cheaper) for virtually
+  // all valid inputs. Bail out on the first error without reporting it.
+  parser->getInterpreter<antlr4::atn::ParserATNSimulator>()->setPredictionMode(
+      antlr4::atn::PredictionMode::SLL);
+  parser->removeErrorListeners();
+  parser->setErrorHandler(std::make_shared<antlr4::BailErrorStrategy>());
+  parser->addParseListener(&depth_listener_);
+  try {
+    return parser->file();
+  } catch (const antlr4::ParseCancellationException &) {
+    // Either a syntax error, an input that requires full context or an
+    // exceeded limit (which would be exceeded again).
+    if (!limit_status_.ok())
+      return limit_status_;
+  }
+
+  // Stage 2: Re-parse the (already buffered) tokens in full LL mode with the
+  // default error strategy, such that errors are reported as usual.
+  tokens->seek(0);
+  parser->reset();
+  PrepareFullParse(parser);
+  try {
+    return parser->file();
+  } catch (const antlr4::ParseCancellationException &) {
+    return limit_status_;
+  }
+}
+
+void Parser::PrepareFullParse(CoboldParser *parser) {
+  parser->getInterpreter<antlr4::atn::ParserATNSimulator>()->setPredictionMode(
+      antlr4::atn::PredictionMode::LL);
+  parser->setErrorHandler(std::make_shared<ParserErrorStrategy>(this));
+  parser->removeErrorListeners();
+  parser->addErrorListener(&listener_);
+  parser->removeParseListener(&depth_listener_);
+  parser->addParseListener(&depth_listener_);
+  depth_listener_.Reset();
 }
 
 absl::StatusOr<SourceFile> Parser::ParseFile(const std::string &filename,
@@ -137,19 +295,742 @@ absl::StatusOr<SourceFile> Parser::ParseFile(const std::string &filename,
   for (const auto &function : ctx->functionDeclaration()) {
     absl::StatusOr<std::unique_ptr<Function>> parsed_fn =
         ParseFunction(function);
-    if (!parsed_fn.ok())
-      return parsed_fn.status();
+    if (!parsed_fn.ok()) {
+      // E.g., an expression exceeding the size limit.
+      return error_context_.ToStatus(parsed_fn.status());
+    }
     file.functions_.push_back(*std::move(parsed_fn));
   }
-  *error_context_;
+  if (absl::Status status = error_context_.ToStatus(); !status.ok())
+    return status;
+  return file;
+}
 
-  // TODO(jlscheerer) Do type checking once we loaded the "entire" collection of
-  // modules (i.e., all transitive imports)
+absl::StatusOr<SourceFile>
+Parser::ParseStreaming(const std::string &filename,
+                       antlr4::TokenSource *lexer) {
+  SourceFile file(filename);
+  absl::Status status =
+      ParseChunk(lexer, std::numeric_limits<size_t>::max(), &file);
+  status = error_context_.ToStatus(status);
+  if (!status.ok())
+    return status;
+  return file;
+}
+
+absl::StatusOr<SourceFile>
+Parser::ParseParallel(const SourceBuffer &source,
+                      const ParserOptions &options) {
+  // Pre-pass: Split at top-level declarations (i.e., without parsing), the
+  // first chunk also contains the imports.
+  std::vector<size_t> boundaries = {0};
+  DeclarationScanner scanner(source.contents());
+  while (std::optional<uint32_t> start = scanner.Next()) {
+    if (*start - boundaries.back() >= options.parallel_chunk_size)
+      boundaries.push_back(*start);
+  }
+  boundaries.push_back(std::numeric_limits<size_t>::max());
+
+  struct Chunk {
+    size_t begin;
+    size_t end;
+    std::unique_ptr<Parser> parser;
+    SourceFile file;
+    absl::Status status;
+    // Merged into the arena of the calling thread (if any) once done.
+    std::unique_ptr<AstArena> arena;
+  };
+  AstArena *arena = AstArena::Current();
+  std::vector<Chunk> chunks;
+  chunks.reserve(boundaries.size() - 1);
+  for (int i = 0; i + 1 < boundaries.size(); ++i) {
+    chunks.push_back(
+        Chunk{boundaries[i], boundaries[i + 1],
+              absl::WrapUnique(new Parser(&source, options)),
+              SourceFile(source.filename()), absl::OkStatus(),
+              arena != nullptr ? std::make_unique<AstArena>() : nullptr});
+  }
+  {
+    const int num_threads =
+        options.parallel_threads > 0
+            ? options.parallel_threads
+            : static_cast<int>(std::thread::hardware_concurrency());
+    ThreadPool pool(std::min<int>(num_threads, chunks.size()));
+    TypeTable *types = TypeTable::Current();
+    for (Chunk &chunk : chunks) {
+      pool.Schedule([&source, &chunk, types]() {
+        TypeTable::Scope types_scope(types);
+        AstArena::Scope scope(chunk.arena.get());
+        SourceCharStream input(source);
+        std::unique_ptr<antlr4::TokenSource> lexer =
+            chunk.parser->CreateLexer(&input, chunk.begin);
+        chunk.status =
+            chunk.parser->ParseChunk(lexer.get(), chunk.end, &chunk.file);
+      });
+    }
+    pool.Wait();
+  }
 
-  TypeInferenceVisitor::Annotate(file);
+  // Merge in source order, such that neither the diagnostics nor the returned
+  // status depend on the order the chunks finished in.
+  Parser parser(&source, options);
+  SourceFile file(source.filename());
+  absl::Status status;
+  for (Chunk &chunk : chunks) {
+    parser.error_context_ << chunk.parser->error_context_;
+    if (status.ok())
+      status = chunk.status;
+    for (std::string &import : chunk.file.imports_) {
+      file.imports_.push_back(std::move(import));
+    }
+    for (std::unique_ptr<Function> &function : chunk.file.functions_) {
+      file.functions_.push_back(std::move(function));
+    }
+    if (arena != nullptr)
+      arena->Merge(chunk.arena.get());
+  }
+  status = parser.error_context_.ToStatus(status);
+  if (!status.ok())
+    return status;
   return file;
 }
 
+absl::Status Parser::ParseChunk(antlr4::TokenSource *lexer, size_t end,
+                                SourceFile *file) {
+  try {
+    // Only buffers the tokens between the oldest mark and the lookahead.
+    antlr4::UnbufferedTokenStream tokens(lexer);
+    // file: importDeclaration* functionDeclaration* EOF;
+    while (tokens.LT(1)->getText() == "import") {
+      absl::Status status = ParseRule(
+          &tokens, &CoboldParser::importDeclaration,
+          [&](CoboldParser::ImportDeclarationContext *ctx) -> absl::Status {
+            absl::StatusOr<std::string> parsed_import = ParseImport(ctx);
+            if (!parsed_import.ok())
+              return parsed_import.status();
+            file->imports_.push_back(*parsed_import);
+            return absl::OkStatus();
+          });
+      if (!status.ok())
+        return status;
+    }
+    return ParseFunctionDeclarations(&tokens, end, &file->functions_);
+  } catch (const antlr4::ParseCancellationException &) {
+    // Too many token recognition errors while looking ahead.
+    return limit_status_;
+  }
+}
+
+absl::Status Parser::ParseFunctionDeclarations(
+    antlr4::UnbufferedTokenStream *tokens, size_t end,
+    std::vector<std::unique_ptr<Function>> *functions) {
+  while (tokens->LA(1) != antlr4::Token::EOF &&
+         tokens->LT(1)->getStartIndex() < end) {
+    absl::Status status = ParseRule(
+        tokens, &CoboldParser::functionDeclaration,
+        [&](CoboldParser::FunctionDeclarationContext *ctx) -> absl::Status {
+          absl::StatusOr<std::unique_ptr<Function>> parsed_fn =
+              ParseFunction(ctx);
+          if (!parsed_fn.ok())
+            return parsed_fn.status();
+          functions->push_back(*std::move(parsed_fn));
+          return absl::OkStatus();
+        });
+    if (!status.ok())
+      return status;
+  }
+  return absl::OkStatus();
+}
+
+template <typename Context, typename Convert>
+absl::Status Parser::ParseRule(antlr4::UnbufferedTokenStream *tokens,
+                               Context *(CoboldParser::*rule)(),
+                               Convert convert) {
+  // Keep the tokens of this declaration around in case we need to re-parse.
+  const ssize_t marker = tokens->mark();
+  const size_t start = tokens->index();
+  {
+    CoboldParser parser(tokens);
+    parser.getInterpreter<antlr4::atn::ParserATNSimulator>()
+        ->setPredictionMode(antlr4::atn::PredictionMode::SLL);
+    parser.removeErrorListeners();
+    parser.setErrorHandler(std::make_shared<antlr4::BailErrorStrategy>());
+    depth_listener_.Reset();
+    parser.addParseListener(&depth_listener_);
+    try {
+      Context *ctx = (parser.*rule)();
+      // The parse tree refers to the buffered tokens, convert first.
+      absl::Status status = convert(ctx);
+      tokens->release(marker);
+      return status;
+    } catch (const antlr4::ParseCancellationException &) {
+      // Either a syntax error, an input that requires full context or an
+      // exceeded limit.
+      if (!limit_status_.ok())
+        return limit_status_;
+    }
+  }
+
+  tokens->seek(start);
+  CoboldParser parser(tokens);
+  PrepareFullParse(&parser);
+  Context *ctx;
+  try {
+    ctx = (parser.*rule)();
+  } catch (const antlr4::ParseCancellationException &) {
+    return limit_status_;
+  }
+  // Syntax errors are reported (together with all others) once we are done.
+  absl::Status status = error_context_.ok() ? convert(ctx) : absl::OkStatus();
+  tokens->release(marker);
+  // Always make progress, even if error recovery did not consume anything.
+  if (tokens->index() == start)
+    tokens->consume();
+  return status;
+}
+
+absl::Status Parser::ParseBody(DefinedFunction *function,
+                               const ParserOptions &options) {
+  assert(!function->parsed());
+  const LazyBody lazy = *function->lazy_body();
+  Parser parser(lazy.source, options);
+  if (options.hand_written) {
+    absl::StatusOr<std::vector<Token>> tokens =
+        parser.Tokenize(lazy.begin, lazy.end);
+    if (!tokens.ok())
+      return parser.error_context_.ToStatus(tokens.status());
+    ExpressionParser expressions(*lazy.source, *tokens, &parser.error_context_,
+                                 options);
+    absl::StatusOr<std::unique_ptr<CompoundStatement>> body =
+        parser.ParseCompoundStatement(&expressions);
+    parser.RecordLimit(&ParserLimitCounters::recursion_depth,
+                       expressions.max_depth());
+    parser.RecordLimit(&ParserLimitCounters::expression_size,
+                       expressions.max_expression_size());
+    if (absl::Status status = parser.error_context_.ToStatus(body.status());
+        !status.ok())
+      return status;
+    function->SetBody(std::move(**body));
+    return absl::OkStatus();
+  }
+
+  SourceCharStream input(*lazy.source);
+  std::unique_ptr<antlr4::TokenSource> lexer =
+      parser.CreateLexer(&input, lazy.begin);
+  CompoundStatement body;
+  absl::Status status;
+  try {
+    // Only the tokens up to the closing '}' are ever requested.
+    antlr4::UnbufferedTokenStream tokens(lexer.get());
+    status = parser.ParseRule(
+        &tokens, &CoboldParser::compoundStatement,
+        [&](CoboldParser::CompoundStatementContext *ctx) -> absl::Status {
+          absl::StatusOr<CompoundStatement> parsed_body =
+              parser.ParseFunctionBody(ctx);
+          if (!parsed_body.ok())
+            return parsed_body.status();
+          body = *std::move(parsed_body);
+          return absl::OkStatus();
+        });
+  } catch (const antlr4::ParseCancellationException &) {
+    // Too many token recognition errors while looking ahead.
+    status = parser.limit_status_;
+  }
+  status = parser.error_context_.ToStatus(status);
+  if (!status.ok())
+    return status;
+  function->SetBody(std::move(body));
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<std::unique_ptr<Function>>>
+Parser::ParseDeclarations(const SourceBuffer &source, size_t begin,
+                          size_t end, const ParserOptions &options) {
+  Parser parser(&source, options);
+  std::vector<std::unique_ptr<Function>> functions;
+  if (options.hand_written) {
+    absl::StatusOr<std::vector<Token>> tokens = parser.Tokenize(begin, end);
+    if (!tokens.ok())
+      return parser.error_context_.ToStatus(tokens.status());
+    ExpressionParser expressions(source, *tokens, &parser.error_context_,
+                                 options);
+    while (expressions.Peek().kind != TokenKind::EndOfFile &&
+           expressions.Peek().offset < end) {
+      absl::StatusOr<std::unique_ptr<Function>> parsed_fn =
+          parser.ParseFunction(&expressions, /*skip_body=*/false);
+      if (!parsed_fn.ok())
+        return parser.error_context_.ToStatus(parsed_fn.status());
+      functions.push_back(*std::move(parsed_fn));
+    }
+    parser.RecordLimit(&ParserLimitCounters::recursion_depth,
+                       expressions.max_depth());
+    parser.RecordLimit(&ParserLimitCounters::expression_size,
+                       expressions.max_expression_size());
+    if (absl::Status status = parser.error_context_.ToStatus(); !status.ok())
+      return status;
+    return functions;
+  }
+
+  SourceCharStream input(source);
+  std::unique_ptr<antlr4::TokenSource> lexer =
+      parser.CreateLexer(&input, begin);
+  absl::Status status;
+  try {
+    antlr4::UnbufferedTokenStream tokens(lexer.get());
+    status = parser.ParseFunctionDeclarations(&tokens, end, &functions);
+  } catch (const antlr4::ParseCancellationException &) {
+    // Too many token recognition errors while looking ahead.
+    status = parser.limit_status_;
+  }
+  status = parser.error_context_.ToStatus(status);
+  if (!status.ok())
+    return status;
+  return functions;
+}
+
+absl::StatusOr<std::vector<Token>> Parser::Tokenize(size_t begin,
+                                                    size_t end) {
+  std::vector<Token> tokens;
+  Lexer lexer(source_->contents(), begin);
+  int depth = 0;
+  for (Token token = lexer.Next();; token = lexer.Next()) {
+    switch (token.kind) {
+    case TokenKind::LeftBrace:
+      ++depth;
+      break;
+    case TokenKind::RightBrace:
+      --depth;
+      break;
+    case TokenKind::Function:
+      if (depth <= 0 && token.offset >= end)
+        token.kind = TokenKind::EndOfFile;
+      break;
+    case TokenKind::Error: {
+      // Report unrecognized input like the generated lexer and skip it.
+      const SourceLocation location =
+          SourceLocation::AtOffset(*source_, token.offset);
+      error_context_ << MakeError(
+          SourceSpan(location, location.AdvancedBy(token.length)),
+          absl::StrCat("token recognition error at: '",
+                       token.Text(source_->contents()), "'"),
+          true);
+      if (absl::Status status = CountError(location); !status.ok())
+        return status;
+      continue;
+    }
+    default:
+      break;
+    }
+    tokens.push_back(token);
+    if (token.kind == TokenKind::EndOfFile)
+      return tokens;
+  }
+}
+
+absl::StatusOr<SourceFile> Parser::ParseTokens(const std::string &filename) {
+  absl::StatusOr<std::vector<Token>> tokens =
+      Tokenize(0, std::numeric_limits<size_t>::max());
+  if (!tokens.ok())
+    return error_context_.ToStatus(tokens.status());
+
+  ExpressionParser parser(*source_, *tokens, &error_context_, options_);
+  SourceFile file(filename);
+  // file: importDeclaration* functionDeclaration* EOF;
+  while (parser.Accept(TokenKind::Import)) {
+    const Token &import = parser.Peek();
+    absl::Status status = parser.Expect(TokenKind::StringConstant);
+    if (status.ok())
+      status = parser.Expect(TokenKind::Semicolon);
+    if (!status.ok())
+      return error_context_.ToStatus(status);
+    // Empty Import ("") is not allowed!
+    if (import.length < 3) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Invalid Import: \"", import.Text(source_->contents()), "\""));
+    }
+    file.imports_.push_back(std::string(
+        source_->contents().substr(import.offset + 1, import.length - 2)));
+  }
+  while (parser.Peek().kind != TokenKind::EndOfFile) {
+    absl::StatusOr<std::unique_ptr<Function>> parsed_fn =
+        ParseFunction(&parser, /*skip_body=*/options_.lazy_bodies);
+    if (!parsed_fn.ok())
+      return error_context_.ToStatus(parsed_fn.status());
+    file.functions_.push_back(*std::move(parsed_fn));
+  }
+  RecordLimit(&ParserLimitCounters::recursion_depth, parser.max_depth());
+  RecordLimit(&ParserLimitCounters::expression_size,
+              parser.max_expression_size());
+  if (absl::Status status = error_context_.ToStatus(); !status.ok())
+    return status;
+  return file;
+}
+
+absl::StatusOr<std::unique_ptr<Function>>
+Parser::ParseFunction(ExpressionParser *parser, bool skip_body) {
+  // functionDeclaration: FUNCTION Identifier '(' argumentList? ')'
+  //                      ('->' typeSpecifier)?
+  //                      (compoundStatement | externSpecifier ';');
+  absl::Status status = parser->Expect(TokenKind::Function);
+  if (!status.ok())
+    return status;
+  const Token &identifier = parser->Peek();
+  status = parser->Expect(TokenKind::Identifier);
+  if (!status.ok())
+    return status;
+  const Symbol name = Symbol::Intern(identifier.Text(source_->contents()));
+  const SourceLocation location =
+      SourceLocation::AtOffset(*source_, identifier.offset);
+  status = parser->Expect(TokenKind::LeftParen);
+  if (!status.ok())
+    return status;
+  // argumentList: Identifier ':' typeSpecifier (',' argumentList)?;
+  std::vector<FunctionArgument> arguments;
+  if (parser->Peek().kind != TokenKind::RightParen) {
+    do {
+      const Token &argument = parser->Peek();
+      status = parser->Expect(TokenKind::Identifier);
+      if (status.ok())
+        status = parser->Expect(TokenKind::Colon);
+      if (!status.ok())
+        return status;
+      absl::StatusOr<const Type *> status_or_type = parser->ParseType();
+      if (!status_or_type.ok())
+        return status_or_type.status();
+      arguments.push_back(
+          {Symbol::Intern(argument.Text(source_->contents())), *status_or_type});
+    } while (parser->Accept(TokenKind::Comma));
+  }
+  status = parser->Expect(TokenKind::RightParen);
+  if (!status.ok())
+    return status;
+  const Type *return_type = NilType::Get();
+  if (parser->Accept(TokenKind::Arrow)) {
+    absl::StatusOr<const Type *> status_or_type = parser->ParseType();
+    if (!status_or_type.ok())
+      return status_or_type.status();
+    return_type = *status_or_type;
+  }
+
+  // externSpecifier: '#' 'extern' '(' StringConstant ')';
+  if (parser->Accept(TokenKind::Hash)) {
+    status = parser->Expect(TokenKind::Extern);
+    if (status.ok())
+      status = parser->Expect(TokenKind::LeftParen);
+    if (!status.ok())
+      return status;
+    const Token &specifier = parser->Peek();
+    status = parser->Expect(TokenKind::StringConstant);
+    if (status.ok())
+      status = parser->Expect(TokenKind::RightParen);
+    if (status.ok())
+      status = parser->Expect(TokenKind::Semicolon);
+    if (!status.ok())
+      return status;
+    // Empty Specifier ("") is not allowed!
+    if (specifier.length < 3) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid ExternSpecifier: \"",
+                       specifier.Text(source_->contents()), "\""));
+    }
+    return std::make_unique<ExternFunction>(
+        name, std::move(arguments), return_type,
+        std::string(source_->contents().substr(specifier.offset + 1,
+                                               specifier.length - 2)),
+        location);
+  }
+
+  if (!skip_body) {
+    absl::StatusOr<std::unique_ptr<CompoundStatement>> body =
+        ParseCompoundStatement(parser);
+    if (!body.ok())
+      return body.status();
+    return std::make_unique<DefinedFunction>(
+        name, std::move(arguments), return_type, std::move(**body), location);
+  }
+
+  // Skip the body, its syntax is only checked once it is parsed.
+  const Token &open = parser->Peek();
+  status = parser->Expect(TokenKind::LeftBrace);
+  if (!status.ok())
+    return status;
+  for (int depth = 1; depth > 0;) {
+    const Token &token = parser->Next();
+    switch (token.kind) {
+    case TokenKind::LeftBrace:
+      ++depth;
+      break;
+    case TokenKind::RightBrace:
+      if (--depth == 0) {
+        return std::make_unique<DefinedFunction>(
+            name, std::move(arguments), return_type,
+            LazyBody{source_, open.offset, token.end()}, location);
+      }
+      break;
+    case TokenKind::EndOfFile:
+      error_context_ << MakeError(
+          SourceLocation::AtOffset(*source_, token.offset),
+          "missing '}' at '<EOF>'", true);
+      return absl::InvalidArgumentError("missing '}' at '<EOF>'");
+    default:
+      break;
+    }
+  }
+  assert(false);
+  return absl::InternalError("unreachable");
+}
+
+absl::StatusOr<std::unique_ptr<Statement>>
+Parser::ParseBlockListItem(ExpressionParser *parser) {
+  // blockItem: statement | declaration;
+  switch (parser->Peek().kind) {
+  case TokenKind::Var:
+  case TokenKind::Let:
+    return ParseDeclaration(parser);
+  case TokenKind::Return: {
+    parser->Next();
+    absl::StatusOr<std::unique_ptr<Expression>> status_or_expr =
+        ParseTerminatedExpression(parser);
+    if (!status_or_expr.ok())
+      return status_or_expr.status();
+    return std::make_unique<ReturnStatement>(*std::move(status_or_expr));
+  }
+  case TokenKind::Deinit: {
+    parser->Next();
+    absl::StatusOr<std::unique_ptr<Expression>> status_or_expr =
+        ParseTerminatedExpression(parser);
+    if (!status_or_expr.ok())
+      return status_or_expr.status();
+    return std::make_unique<DeinitStatement>(*std::move(status_or_expr));
+  }
+  case TokenKind::LeftBrace:
+    return ParseCompoundStatement(parser);
+  case TokenKind::If:
+    return ParseIfStatement(parser);
+  case TokenKind::For:
+    return ParseForStatement(parser);
+  case TokenKind::While:
+    return ParseWhileStatement(parser);
+  case TokenKind::Break:
+  case TokenKind::Continue: {
+    // loopFlowInstruction: (BREAK | CONTINUE) ';';
+    const bool is_break = parser->Next().kind == TokenKind::Break;
+    if (absl::Status status = parser->Expect(TokenKind::Semicolon);
+        !status.ok())
+      return status;
+    if (is_break)
+      return std::make_unique<BreakStatement>();
+    return std::make_unique<ContinueStatement>();
+  }
+  default:
+    return ParseExpressionStatement(parser);
+  }
+}
+
+absl::StatusOr<std::unique_ptr<CompoundStatement>>
+Parser::ParseCompoundStatement(ExpressionParser *parser) {
+  // compoundStatement: '{' blockItemList? '}';
+  const Token &open = parser->Peek();
+  NestingScope nesting(&statement_depth_);
+  RecordLimit(&ParserLimitCounters::recursion_depth, statement_depth_);
+  if (statement_depth_ > options_.max_recursion_depth) {
+    return LimitExceeded(
+        SourceLocation::AtOffset(*source_, open.offset),
+        absl::StrCat("nesting exceeds the maximum depth of ",
+                     options_.max_recursion_depth));
+  }
+  if (absl::Status status = parser->Expect(TokenKind::LeftBrace);
+      !status.ok())
+    return status;
+  std::vector<std::unique_ptr<Statement>> statements;
+  while (parser->Peek().kind != TokenKind::RightBrace &&
+         parser->Peek().kind != TokenKind::EndOfFile) {
+    absl::StatusOr<std::unique_ptr<Statement>> status_or_stmt =
+        ParseBlockListItem(parser);
+    if (!status_or_stmt.ok())
+      return status_or_stmt.status();
+    statements.push_back(*std::move(status_or_stmt));
+  }
+  if (absl::Status status = parser->Expect(TokenKind::RightBrace);
+      !status.ok())
+    return status;
+  return std::make_unique<CompoundStatement>(std::move(statements));
+}
+
+absl::StatusOr<std::unique_ptr<Statement>>
+Parser::ParseExpressionStatement(ExpressionParser *parser) {
+  // expressionStatement: expression (assignmentOperator expression)? ';';
+  absl::StatusOr<std::unique_ptr<Expression>> status_or_lhs =
+      parser->ParseExpression();
+  if (!status_or_lhs.ok())
+    return status_or_lhs.status();
+  switch (parser->Peek().kind) {
+  case TokenKind::Assign:
+  case TokenKind::StarAssign:
+  case TokenKind::SlashAssign:
+  case TokenKind::PercentAssign:
+  case TokenKind::PlusAssign:
+  case TokenKind::MinusAssign:
+  case TokenKind::ShiftLeftAssign:
+  case TokenKind::ShiftRightAssign:
+  case TokenKind::AmpAssign:
+  case TokenKind::CaretAssign:
+  case TokenKind::PipeAssign: {
+    const std::string op(parser->Next().Text(source_->contents()));
+    absl::StatusOr<std::unique_ptr<Expression>> status_or_rhs =
+        ParseTerminatedExpression(parser);
+    if (!status_or_rhs.ok())
+      return status_or_rhs.status();
+    return std::make_unique<AssignmentStatement>(
+        *std::move(status_or_lhs), op, *std::move(status_or_rhs));
+  }
+  default:
+    break;
+  }
+  if (absl::Status status = parser->Expect(TokenKind::Semicolon);
+      !status.ok())
+    return status;
+  return std::make_unique<ExpressionStatement>(*std::move(status_or_lhs));
+}
+
+absl::StatusOr<std::unique_ptr<IfStatement>>
+Parser::ParseIfStatement(ExpressionParser *parser) {
+  // ifStatement: IF expression compoundStatement
+  //              (ELSE IF expression compoundStatement)*
+  //              (ELSE compoundStatement)?;
+  std::vector<IfBranch> branches;
+  std::unique_ptr<CompoundStatement> otherwise;
+  parser->Next();
+  while (true) {
+    absl::StatusOr<std::unique_ptr<Expression>> status_or_cond =
+        parser->ParseExpression();
+    if (!status_or_cond.ok())
+      return status_or_cond.status();
+    absl::StatusOr<std::unique_ptr<CompoundStatement>> status_or_body =
+        ParseCompoundStatement(parser);
+    if (!status_or_body.ok())
+      return status_or_body.status();
+    branches.push_back(
+        {*std::move(status_or_cond), *std::move(status_or_body)});
+    if (!parser->Accept(TokenKind::Else))
+      break;
+    if (!parser->Accept(TokenKind::If)) {
+      absl::StatusOr<std::unique_ptr<CompoundStatement>> status_or_else =
+          ParseCompoundStatement(parser);
+      if (!status_or_else.ok())
+        return status_or_else.status();
+      otherwise = *std::move(status_or_else);
+      break;
+    }
+  }
+  // Same shape as `ParseIfStatementStatement`: always have an "else" branch.
+  branches.push_back({ConstantExpression::True(SourceLocation::Generated()),
+                      otherwise != nullptr
+                          ? std::move(otherwise)
+                          : std::make_unique<CompoundStatement>()});
+  return std::make_unique<IfStatement>(std::move(branches));
+}
+
+absl::StatusOr<std::unique_ptr<ForStatement>>
+Parser::ParseForStatement(ExpressionParser *parser) {
+  // forStatement: FOR Identifier (':' typeSpecifier)? IN expression
+  //               compoundStatement;
+  parser->Next();
+  const Token &identifier = parser->Peek();
+  if (absl::Status status = parser->Expect(TokenKind::Identifier);
+      !status.ok())
+    return status;
+  const Type *decl_type = nullptr;
+  if (parser->Accept(TokenKind::Colon)) {
+    absl::StatusOr<const Type *> status_or_type = parser->ParseType();
+    if (!status_or_type.ok())
+      return status_or_type.status();
+    decl_type = *status_or_type;
+  }
+  if (absl::Status status = parser->Expect(TokenKind::In); !status.ok())
+    return status;
+  absl::StatusOr<std::unique_ptr<Expression>> status_or_expr =
+      parser->ParseExpression();
+  if (!status_or_expr.ok())
+    return status_or_expr.status();
+  absl::StatusOr<std::unique_ptr<CompoundStatement>> status_or_body =
+      ParseCompoundStatement(parser);
+  if (!status_or_body.ok())
+    return status_or_body.status();
+  return std::make_unique<ForStatement>(
+      Symbol::Intern(identifier.Text(source_->contents())), decl_type,
+      *std::move(status_or_expr), *std::move(status_or_body));
+}
+
+absl::StatusOr<std::unique_ptr<WhileStatement>>
+Parser::ParseWhileStatement(ExpressionParser *parser) {
+  // whileStatement: WHILE expression compoundStatement;
+  parser->Next();
+  absl::StatusOr<std::unique_ptr<Expression>> status_or_cond =
+      parser->ParseExpression();
+  if (!status_or_cond.ok())
+    return status_or_cond.status();
+  absl::StatusOr<std::unique_ptr<CompoundStatement>> status_or_body =
+      ParseCompoundStatement(parser);
+  if (!status_or_body.ok())
+    return status_or_body.status();
+  return std::make_unique<WhileStatement>(*std::move(status_or_cond),
+                                          *std::move(status_or_body));
+}
+
+absl::StatusOr<std::unique_ptr<DeclarationStatement>>
+Parser::ParseDeclaration(ExpressionParser *parser) {
+  // declaration: (VAR | LET) Identifier (':' typeSpecifier)?
+  //              ('=' (DASH_INIT | expression))? ';';
+  const bool is_const = parser->Next().kind == TokenKind::Let;
+  const Token &identifier = parser->Peek();
+  if (absl::Status status = parser->Expect(TokenKind::Identifier);
+      !status.ok())
+    return status;
+  const Type *decl_type = nullptr;
+  if (parser->Accept(TokenKind::Colon)) {
+    absl::StatusOr<const Type *> status_or_type = parser->ParseType();
+    if (!status_or_type.ok())
+      return status_or_type.status();
+    decl_type = *status_or_type;
+  }
+  std::unique_ptr<Expression> expression;
+  if (!parser->Accept(TokenKind::Assign)) {
+    // var example: i32; <=> var example: i32 = --;
+    expression = ConstantExpression::DashInit(SourceLocation::Generated());
+    if (absl::Status status = parser->Expect(TokenKind::Semicolon);
+        !status.ok())
+      return status;
+  } else if (parser->Peek().kind == TokenKind::DashDash &&
+             parser->Peek(1).kind == TokenKind::Semicolon) {
+    // A `--` directly followed by ';' can only be a `DASH_INIT`.
+    expression = ConstantExpression::DashInit(
+        SourceLocation::AtOffset(*source_, parser->Next().offset));
+    parser->Next();
+  } else {
+    absl::StatusOr<std::unique_ptr<Expression>> status_or_expr =
+        ParseTerminatedExpression(parser);
+    if (!status_or_expr.ok())
+      return status_or_expr.status();
+    expression = *std::move(status_or_expr);
+  }
+  return std::make_unique<DeclarationStatement>(
+      is_const, Symbol::Intern(identifier.Text(source_->contents())),
+      decl_type, std::move(expression));
+}
+
+absl::StatusOr<std::unique_ptr<Expression>>
+Parser::ParseTerminatedExpression(ExpressionParser *parser) {
+  absl::StatusOr<std::unique_ptr<Expression>> status_or_expr =
+      parser->ParseExpression();
+  if (!status_or_expr.ok())
+    return status_or_expr.status();
+  if (absl::Status status = parser->Expect(TokenKind::Semicolon);
+      !status.ok())
+    return status;
+  return status_or_expr;
+}
+
 absl::StatusOr<std::string>
 Parser::ParseImport(CoboldParser::ImportDeclarationContext *ctx) {
   if (ctx == nullptr || ctx->StringConstant() == nullptr)
@@ -165,7 +1046,7 @@ Parser::ParseImport(CoboldParser::ImportDeclarationContext *ctx) {
 
 absl::StatusOr<std::unique_ptr<Function>>
 Parser::ParseFunction(CoboldParser::FunctionDeclarationContext *ctx) {
-  std::string name = ctx->Identifier()->getText();
+  const Symbol name = Symbol::Intern(ctx->Identifier()->getText());
   const Type *return_type;
   {
     absl::StatusOr<const Type *> status_or_type =
@@ -181,24 +1062,25 @@ Parser::ParseFunction(CoboldParser::FunctionDeclarationContext *ctx) {
         ParseType(args->typeSpecifier(), /*allow_void*/ false);
     if (!status_or_type.ok())
       return status_or_type.status();
-    arguments.push_back({args->Identifier()->toString(), *status_or_type});
+    arguments.push_back(
+        {Symbol::Intern(args->Identifier()->toString()), *status_or_type});
   }
   if (ctx->externSpecifier()) {
     absl::StatusOr<std::string> status_or_specifier =
         ParseExternSpecifier(ctx->externSpecifier());
     if (!status_or_specifier.ok())
       return status_or_specifier.status();
-    return std::make_unique<ExternFunction>(std::move(name),
-                                            std::move(arguments), return_type,
-                                            std::move(*status_or_specifier));
+    return std::make_unique<ExternFunction>(
+        name, std::move(arguments), return_type,
+        std::move(*status_or_specifier), LocationOf(ctx->Identifier()));
   }
   absl::StatusOr<CompoundStatement> status_or_body =
       ParseFunctionBody(ctx->compoundStatement());
   if (!status_or_body.ok())
     return status_or_body.status();
-  return std::make_unique<DefinedFunction>(std::move(name),
-                                           std::move(arguments), return_type,
-                                           std::move(*status_or_body));
+  return std::make_unique<DefinedFunction>(
+      name, std::move(arguments), return_type, std::move(*status_or_body),
+      LocationOf(ctx->Identifier()));
 }
 
 absl::StatusOr<CompoundStatement>
@@ -231,37 +1113,37 @@ Parser::ParseType(CoboldParser::TypeSpecifierContext *ctx, bool allow_void) {
     return InvalidArgument("Type", ctx);
   }
 
+  const Type *type;
   if (ctx->IntegralType()) {
     assert(ctx->IntegralType()->getText().size() > 1 &&
            ctx->IntegralType()->getText()[0] == 'i');
-    return IntegralType::OfSize(
+    type = IntegralType::OfSize(
         std::atoi(ctx->IntegralType()->getText().substr(1).c_str()));
-  }
-
-  if (ctx->FloatingType()) {
+  } else if (ctx->FloatingType()) {
     assert(ctx->FloatingType()->getText().size() > 1 &&
            ctx->FloatingType()->getText()[0] == 'f');
-    return FloatingType::OfSize(
+    type = FloatingType::OfSize(
         std::atoi(ctx->FloatingType()->getText().substr(1).c_str()));
+  } else if (ctx->NIL()) {
+    type = NilType::Get();
+  } else if (ctx->BOOL()) {
+    type = BoolType::Get();
+  } else if (ctx->CHAR()) {
+    type = CharType::Get();
+  } else if (ctx->STRING()) {
+    type = StringType::Get();
+  } else {
+    assert(ctx->LBRACKET() && ctx->RBRACKET());
+    absl::StatusOr<const Type *> status_or_type =
+        ParseType(ctx->typeSpecifier(), /*allow_void*/ false);
+    if (!status_or_type.ok())
+      return status_or_type.status();
+    type = Type::ArrayOf(*status_or_type);
   }
-  if (ctx->NIL())
-    return NilType::Get();
-  if (ctx->BOOL())
-    return BoolType::Get();
-  if (ctx->CHAR())
-    return CharType::Get();
-  if (ctx->STRING())
-    return StringType::Get();
-  absl::StatusOr<const Type *> status_or_type =
-      ParseType(ctx->typeSpecifier(), /*allow_void*/ false);
-  if (!status_or_type.ok())
-    return status_or_type.value();
-  if (ctx->LBRACKET()) {
-    assert(ctx->RBRACKET());
-    return Type::ArrayOf(*status_or_type);
+  for (int i = 0; i < ctx->POINTER().size(); ++i) {
+    type = Type::PointerTo(type);
   }
-  assert(ctx->POINTER());
-  return Type::PointerTo(*status_or_type);
+  return type;
 }
 
 absl::StatusOr<std::unique_ptr<Statement>>
@@ -279,12 +1161,13 @@ Parser::ParseStatement(CoboldParser::StatementContext *ctx) {
     return ParseReturnStatement(ctx->returnStatement());
   if (ctx->deinitStatement())
     return ParseDeinitStatement(ctx->deinitStatement());
-  if (ctx->assignmentStatement())
-    return ParseAssignmentStatement(ctx->assignmentStatement());
   if (ctx->compoundStatement())
     return ParseCompoundStatement(ctx->compoundStatement());
-  if (ctx->expressionStatement())
+  if (ctx->expressionStatement()) {
+    if (ctx->expressionStatement()->assignmentOperator())
+      return ParseAssignmentStatement(ctx->expressionStatement());
     return ParseExpressionStatement(ctx->expressionStatement());
+  }
   if (ctx->ifStatement())
     return ParseIfStatementStatement(ctx->ifStatement());
   if (ctx->iterationStatement()) {
@@ -323,7 +1206,7 @@ Parser::ParseDeinitStatement(CoboldParser::DeinitStatementContext *ctx) {
 
 absl::StatusOr<std::unique_ptr<AssignmentStatement>>
 Parser::ParseAssignmentStatement(
-    CoboldParser::AssignmentStatementContext *ctx) {
+    CoboldParser::ExpressionStatementContext *ctx) {
   absl::StatusOr<std::unique_ptr<Expression>> status_or_lhs =
       ParseExpression(ctx->expression(0));
   if (!status_or_lhs.ok())
@@ -357,7 +1240,7 @@ absl::StatusOr<std::unique_ptr<ExpressionStatement>>
 Parser::ParseExpressionStatement(
     CoboldParser::ExpressionStatementContext *ctx) {
   absl::StatusOr<std::unique_ptr<Expression>> status_or_expr =
-      ParseExpression(ctx->expression());
+      ParseExpression(ctx->expression(0));
   if (!status_or_expr.ok())
     return status_or_expr.status();
   return std::make_unique<ExpressionStatement>(std::move(*status_or_expr));
@@ -398,7 +1281,7 @@ Parser::ParseIfStatementStatement(CoboldParser::IfStatementContext *ctx) {
 
 absl::StatusOr<std::unique_ptr<ForStatement>>
 Parser::ParseForStatement(CoboldParser::ForStatementContext *ctx) {
-  std::string identifier = ctx->Identifier()->toString();
+  const Symbol identifier = Symbol::Intern(ctx->Identifier()->toString());
   const Type *decl_type = nullptr;
   if (ctx->typeSpecifier()) {
     absl::StatusOr<const Type *> status_or_type =
@@ -438,7 +1321,7 @@ absl::StatusOr<std::unique_ptr<DeclarationStatement>>
 Parser::ParseDeclaration(CoboldParser::DeclarationContext *ctx) {
   assert(ctx->LET() != nullptr || ctx->VAR() != nullptr);
   bool is_const = ctx->LET() != nullptr;
-  std::string identifier = ctx->Identifier()->toString();
+  const Symbol identifier = Symbol::Intern(ctx->Identifier()->toString());
   const Type *decl_type = nullptr;
   if (ctx->typeSpecifier()) {
     absl::StatusOr<const Type *> status_or_type =
@@ -462,24 +1345,21 @@ Parser::ParseDeclaration(CoboldParser::DeclarationContext *ctx) {
                          : SourceLocation::Generated());
   }
   return std::make_unique<DeclarationStatement>(
-      is_const, std::move(identifier), decl_type, std::move(expression));
+      is_const, identifier, decl_type, std::move(expression));
 }
 
 absl::StatusOr<std::unique_ptr<Expression>>
 Parser::ParseExpression(CoboldParser::ExpressionContext *ctx) {
+  if (expression_depth_ == 0) {
+    if (absl::Status status = CheckExpressionSize(ctx); !status.ok())
+      return status;
+  }
+  NestingScope nesting(&expression_depth_);
   if (ctx->conditionalExpression()) {
     return ParseConditionalExpression(ctx->conditionalExpression());
   }
-  if (ctx->callExpression()) {
-    return ParseCallExpression(ctx->callExpression());
-  }
-  if (ctx->rangeExpression()) {
-    return ParseRangeExpression(ctx->rangeExpression());
-  }
-  if (ctx->arrayExpression()) {
-    return ParseArrayExpression(ctx->arrayExpression());
-  }
-  assert(false);
+  assert(ctx->bracketExpression());
+  return ParseBracketExpression(ctx->bracketExpression());
 }
 
 absl::StatusOr<std::unique_ptr<Expression>> Parser::ParseConditionalExpression(
@@ -503,24 +1383,7 @@ absl::StatusOr<std::unique_ptr<Expression>> Parser::ParseConditionalExpression(
 }
 
 absl::StatusOr<std::unique_ptr<Expression>>
-Parser::ParseCallExpression(CoboldParser::CallExpressionContext *ctx) {
-  std::string identifier = ctx->Identifier()->getText();
-  std::vector<std::unique_ptr<Expression>> args;
-  args.reserve(ctx->expression().size());
-  for (const auto &expr : ctx->expression()) {
-    absl::StatusOr<std::unique_ptr<Expression>> status_or_arg =
-        ParseExpression(expr);
-    if (!status_or_arg.ok())
-      return status_or_arg.status();
-    args.push_back(std::move(*status_or_arg));
-  }
-  // TODO(jlscheerer) Maybe we want some more location data here?
-  return std::make_unique<CallExpression>(
-      LocationOf(ctx->Identifier()), std::move(identifier), std::move(args));
-}
-
-absl::StatusOr<std::unique_ptr<Expression>>
-Parser::ParseRangeExpression(CoboldParser::RangeExpressionContext *ctx) {
+Parser::ParseBracketExpression(CoboldParser::BracketExpressionContext *ctx) {
   std::unique_ptr<Expression> left;
   if (ctx->leftExpression()) {
     assert(ctx->leftExpression()->expression());
@@ -530,6 +1393,23 @@ Parser::ParseRangeExpression(CoboldParser::RangeExpressionContext *ctx) {
       return status_or_expr.status();
     left = std::move(*status_or_expr);
   }
+  if (ctx->RANGE() == nullptr) {
+    // array: '[' (expression (',' expression)*)? ']'
+    std::vector<std::unique_ptr<Expression>> elements;
+    elements.reserve(ctx->expression().size() + 1);
+    if (left != nullptr)
+      elements.push_back(std::move(left));
+    for (const auto &expr : ctx->expression()) {
+      absl::StatusOr<std::unique_ptr<Expression>> status_or_elem =
+          ParseExpression(expr);
+      if (!status_or_elem.ok())
+        return status_or_elem.status();
+      elements.push_back(std::move(*status_or_elem));
+    }
+    return std::make_unique<ArrayExpression>(SourceLocation::Complex(),
+                                             std::move(elements));
+  }
+  // range: '[' leftExpression? '..' rightExpression? ']'
   std::unique_ptr<Expression> right;
   if (ctx->rightExpression()) {
     assert(ctx->rightExpression()->expression());
@@ -543,21 +1423,6 @@ Parser::ParseRangeExpression(CoboldParser::RangeExpressionContext *ctx) {
                                            std::move(left), std::move(right));
 }
 
-absl::StatusOr<std::unique_ptr<Expression>>
-Parser::ParseArrayExpression(CoboldParser::ArrayExpressionContext *ctx) {
-  std::vector<std::unique_ptr<Expression>> elements;
-  elements.reserve(ctx->expression().size());
-  for (const auto &expr : ctx->expression()) {
-    absl::StatusOr<std::unique_ptr<Expression>> status_or_elem =
-        ParseExpression(expr);
-    if (!status_or_elem.ok())
-      return status_or_elem.status();
-    elements.push_back(std::move(*status_or_elem));
-  }
-  return std::make_unique<ArrayExpression>(SourceLocation::Complex(),
-                                           std::move(elements));
-}
-
 #define EXPAND_EXPRESSION(FN_NAME)
 
 #define EXPAND_BINARY_EXPRESSION(FN_NAME, FN_CTX, UNDERLYING_EXPR_PARSER,      \
@@ -726,10 +1591,10 @@ Parser::ParsePostfixExpression(CoboldParser::PostfixExpressionContext *ctx) {
       // call operation a(...)
       std::vector<std::unique_ptr<Expression>> args;
       if (op->argumentExpressionList()) {
-        for (const auto &cond_expr :
-             op->argumentExpressionList()->conditionalExpression()) {
+        for (const auto &arg_expr :
+             op->argumentExpressionList()->expression()) {
           absl::StatusOr<std::unique_ptr<Expression>> status_or_arg =
-              ParseConditionalExpression(cond_expr);
+              ParseExpression(arg_expr);
           if (!status_or_arg.ok())
             return status_or_arg.status();
           args.push_back(std::move(*status_or_arg));
@@ -742,7 +1607,7 @@ Parser::ParsePostfixExpression(CoboldParser::PostfixExpressionContext *ctx) {
       assert(op->Identifier());
       expr = std::make_unique<MemberAccessExpression>(
           SourceLocation::Complex(), std::move(expr), op_type == '.',
-          op->Identifier()->getText());
+          Symbol::Intern(op->Identifier()->getText()));
     } else if (op_type == '+' || (op_type == '-' && !op->Identifier())) {
       // post increment/decrement
       UnaryExpressionType post_type = (op_type == '+')
@@ -775,13 +1640,76 @@ Parser::ParsePrimaryExpression(CoboldParser::PrimaryExpressionContext *ctx) {
     return ConstantExpression::Floating(LocationOf(ctx->FloatingConstant()),
                                         ctx->FloatingConstant()->getText());
   }
-  return std::make_unique<IdentifierExpression>(LocationOf(ctx->Identifier()),
-                                                ctx->Identifier()->getText());
+  return std::make_unique<IdentifierExpression>(
+      LocationOf(ctx->Identifier()),
+      Symbol::Intern(ctx->Identifier()->getText()));
 }
 
 SourceLocation Parser::LocationOf(antlr4::tree::TerminalNode *node) {
-  return SourceLocation(filename_, node->getSymbol()->getLine(),
-                        node->getSymbol()->getCharPositionInLine(), buffer_);
+  return LocationOf(node->getSymbol());
+}
+
+SourceLocation Parser::LocationOf(antlr4::Token *token) {
+  // Token indices are byte offsets into the source (see `SourceCharStream`).
+  return SourceLocation::AtOffset(*source_, token->getStartIndex());
+}
+
+SourceSpan Parser::SpanOf(antlr4::Token *token) {
+  const SourceLocation begin = LocationOf(token);
+  // The stop index is inclusive (and before the start for <EOF>).
+  return token->getStopIndex() < token->getStartIndex()
+             ? SourceSpan(begin, begin)
+             : SourceSpan(begin,
+                          begin.AdvancedBy(token->getStopIndex() + 1 -
+                                           token->getStartIndex()));
+}
+
+absl::Status Parser::LimitExceeded(SourceSpan span, std::string message) {
+  error_context_ << MakeError(span, message, true);
+  limit_status_ = absl::ResourceExhaustedError(std::move(message));
+  return limit_status_;
+}
+
+absl::Status Parser::CountError(SourceLocation location) {
+  RecordLimit(&ParserLimitCounters::errors, ++errors_);
+  if (errors_ < options_.error_recovery_limit)
+    return absl::OkStatus();
+  return LimitExceeded(location,
+                       absl::StrCat("too many errors emitted (limit is ",
+                                    options_.error_recovery_limit,
+                                    "), stopping now"));
+}
+
+void Parser::AbortParse(SourceLocation location, std::string message) {
+  LimitExceeded(location, std::move(message));
+  // Unwinds through the generated parser (which only handles
+  // `RecognitionException`s) up to the callers of `ParseTree`/`ParseRule`.
+  throw antlr4::ParseCancellationException();
+}
+
+void Parser::RecordLimit(std::atomic<int> ParserLimitCounters::*counter,
+                         int value) {
+  if (options_.limit_counters != nullptr)
+    ParserLimitCounters::Record(options_.limit_counters->*counter, value);
+}
+
+absl::Status Parser::CheckExpressionSize(antlr4::ParserRuleContext *ctx) {
+  antlr4::Token *start = ctx->getStart(), *stop = ctx->getStop();
+  if (start == nullptr || stop == nullptr ||
+      stop->getStopIndex() < start->getStartIndex())
+    return absl::OkStatus();
+  // Token indices are byte offsets into the source (see `SourceCharStream`).
+  const int size = CountCodepoints(source_->contents().substr(
+      start->getStartIndex(),
+      stop->getStopIndex() + 1 - start->getStartIndex()));
+  RecordLimit(&ParserLimitCounters::expression_size, size);
+  if (size <= options_.expression_size_codepoint_limit)
+    return absl::OkStatus();
+  return LimitExceeded(
+      SourceSpan(LocationOf(start), SourceLocation::AtOffset(
+                                        *source_, stop->getStopIndex() + 1)),
+      absl::StrCat("expression exceeds the maximum size of ",
+                   options_.expression_size_codepoint_limit, " codepoints"));
 }
 // `Parser` =============================================================
 } // namespace Cobold
\ No newline at end of file
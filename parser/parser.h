@@ -1,19 +1,25 @@
 #ifndef COBOLD_PARSER_PARSER
 #define COBOLD_PARSER_PARSER
 
+#include <atomic>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "core/expression.h"
 #include "core/function.h"
+#include "parser/expression_parser.h"
 #include "parser/internal/CoboldBaseVisitor.h"
 #include "parser/internal/CoboldLexer.h"
 #include "parser/internal/CoboldParser.h"
 #include "parser/internal/options.h"
+#include "parser/internal/source_char_stream.h"
 #include "parser/source_file.h"
+#include "parser/source_location.h"
+#include "parser/source_manager.h"
+#include "parser/token.h"
 #include "reporting/error_context.h"
-#include "source_location.h"
 
 namespace Cobold {
 class Parser;
@@ -46,17 +52,149 @@ private:
   Parser *parser_;
 };
 
+// Default error recovery, but skipping at most
+// `ParserOptions::error_recovery_token_lookahead_limit` tokens at once.
+class ParserErrorStrategy : public antlr4::DefaultErrorStrategy {
+public:
+  ParserErrorStrategy(Parser *parser) : parser_(parser) {}
+
+protected:
+  void consumeUntil(antlr4::Parser *recognizer,
+                    const antlr4::misc::IntervalSet &set) override;
+
+private:
+  Parser *parser_;
+};
+
+// Tracks the nesting of the recursive rules of `Cobold.g4` while parsing and
+// aborts once it exceeds `ParserOptions::max_recursion_depth`.
+class ParserDepthListener : public antlr4::tree::ParseTreeListener {
+public:
+  ParserDepthListener(Parser *parser) : parser_(parser) {}
+
+  void enterEveryRule(antlr4::ParserRuleContext *ctx) override;
+  void exitEveryRule(antlr4::ParserRuleContext *ctx) override;
+  void visitTerminal(antlr4::tree::TerminalNode *node) override {}
+  void visitErrorNode(antlr4::tree::ErrorNode *node) override {}
+
+  void Reset() { depth_ = 0; }
+
+private:
+  // Whether entering `ctx` increases the nesting (i.e., if it is a recursive
+  // occurrence of a rule).
+  static bool Nests(antlr4::ParserRuleContext *ctx);
+
+  Parser *parser_;
+  int depth_ = 0;
+};
+
 class Parser {
 public:
-  static absl::StatusOr<SourceFile> Parse(const std::string &filename);
+  // Parses `filename`, which is loaded (exactly once) through `sources`.
+  // `sources` needs to outlive the returned `SourceFile`.
+  static absl::StatusOr<SourceFile>
+  Parse(SourceManager *sources, const std::string &filename,
+        const ParserOptions &options = ParserOptions());
+  // Parses the (already loaded) `source`, which needs to outlive the returned
+  // `SourceFile`.
+  static absl::StatusOr<SourceFile>
+  Parse(const SourceBuffer &source,
+        const ParserOptions &options = ParserOptions());
+
+  // Parses the skipped body of `function` (see `ParserOptions::lazy_bodies`).
+  // Syntax errors are reported like the ones of `Parse`.
+  static absl::Status
+  ParseBody(DefinedFunction *function,
+            const ParserOptions &options = ParserOptions());
+
+  // Parses the function declarations of `source` starting at offset `begin`
+  // (which needs to start a declaration) up to the first one starting at or
+  // after `end`.
+  static absl::StatusOr<std::vector<std::unique_ptr<Function>>>
+  ParseDeclarations(const SourceBuffer &source, size_t begin, size_t end,
+                    const ParserOptions &options = ParserOptions());
 
 private:
-  Parser(const std::string &filename, std::vector<std::string> &&buffer)
-      : filename_(filename), buffer_(std::move(buffer)), listener_(this) {}
+  // `Parse` without setting up the `AstArena` of the returned file.
+  static absl::StatusOr<SourceFile> ParseSource(const SourceBuffer &source,
+                                                const ParserOptions &options);
+
+  Parser(const SourceBuffer *source, const ParserOptions &options)
+      : source_(source), options_(options), listener_(this),
+        depth_listener_(this) {}
+
+  // Parses in SLL mode with a bail-out error strategy first and only falls
+  // back to full LL (with error reporting) if that fails. Fails if a resource
+  // limit of `options_` is exceeded.
+  absl::StatusOr<CoboldParser::FileContext *>
+  ParseTree(antlr4::CommonTokenStream *tokens, CoboldParser *parser);
+  // Creates the lexer (see `COBOLD_FAST_LEXER`) reading `input` from offset
+  // `begin` on and reporting errors to `listener_`.
+  std::unique_ptr<antlr4::TokenSource> CreateLexer(SourceCharStream *input,
+                                                   size_t begin = 0);
+  // Installs the error strategy and listeners of the full LL stage.
+  void PrepareFullParse(CoboldParser *parser);
 
   absl::StatusOr<SourceFile> ParseFile(const std::string &filename,
                                        CoboldParser::FileContext *ctx);
 
+  // Parses the file declaration by declaration (see
+  // `ParserOptions::streaming`).
+  absl::StatusOr<SourceFile> ParseStreaming(const std::string &filename,
+                                            antlr4::TokenSource *lexer);
+  // Splits `source` into chunks of declarations and parses them concurrently
+  // (see `ParserOptions::parallel_chunk_size`), with one `Parser` per chunk.
+  static absl::StatusOr<SourceFile>
+  ParseParallel(const SourceBuffer &source, const ParserOptions &options);
+  // Parses the imports and function declarations read from `lexer` (like
+  // `ParseStreaming`) into `file`, up to the first declaration starting at or
+  // after offset `end`. Reported errors are kept in `error_context_`.
+  absl::Status ParseChunk(antlr4::TokenSource *lexer, size_t end,
+                          SourceFile *file);
+  // Parses `functionDeclaration`s (see `ParseRule`) until EOF or the first
+  // one starting at or after offset `end`.
+  absl::Status
+  ParseFunctionDeclarations(antlr4::UnbufferedTokenStream *tokens, size_t end,
+                            std::vector<std::unique_ptr<Function>> *functions);
+  // Parses a single `rule` at the current position of `tokens` with a parser
+  // of its own (SLL first, then LL like `ParseTree`) and passes the context to
+  // `convert` unless a syntax error was reported. The parse tree is destroyed
+  // and the buffered tokens are released right after.
+  template <typename Context, typename Convert>
+  absl::Status ParseRule(antlr4::UnbufferedTokenStream *tokens,
+                         Context *(CoboldParser::*rule)(), Convert convert);
+
+  // Parses the file with the hand-written `Lexer` and `ExpressionParser`
+  // (see `ParserOptions::hand_written`). With `ParserOptions::lazy_bodies`,
+  // the bodies of defined functions are skipped by matching braces.
+  absl::StatusOr<SourceFile> ParseTokens(const std::string &filename);
+  // Lexes `source_` from offset `begin` up to the first top-level `fn` at or
+  // after offset `end` (or EOF). Unrecognized input is reported (like the
+  // generated lexer does) and skipped.
+  absl::StatusOr<std::vector<Token>> Tokenize(size_t begin, size_t end);
+
+  // Counterparts of the conversions below for `ParserOptions::hand_written`,
+  // parsing directly from the tokens of `parser`.
+  absl::StatusOr<std::unique_ptr<Function>>
+  ParseFunction(ExpressionParser *parser, bool skip_body);
+  absl::StatusOr<std::unique_ptr<Statement>>
+  ParseBlockListItem(ExpressionParser *parser);
+  absl::StatusOr<std::unique_ptr<CompoundStatement>>
+  ParseCompoundStatement(ExpressionParser *parser);
+  absl::StatusOr<std::unique_ptr<Statement>>
+  ParseExpressionStatement(ExpressionParser *parser);
+  absl::StatusOr<std::unique_ptr<IfStatement>>
+  ParseIfStatement(ExpressionParser *parser);
+  absl::StatusOr<std::unique_ptr<ForStatement>>
+  ParseForStatement(ExpressionParser *parser);
+  absl::StatusOr<std::unique_ptr<WhileStatement>>
+  ParseWhileStatement(ExpressionParser *parser);
+  absl::StatusOr<std::unique_ptr<DeclarationStatement>>
+  ParseDeclaration(ExpressionParser *parser);
+  // Expression followed by a ';'.
+  absl::StatusOr<std::unique_ptr<Expression>>
+  ParseTerminatedExpression(ExpressionParser *parser);
+
   absl::StatusOr<std::string>
   ParseImport(CoboldParser::ImportDeclarationContext *ctx);
   absl::StatusOr<std::unique_ptr<Function>>
@@ -80,7 +218,7 @@ private:
   absl::StatusOr<std::unique_ptr<DeinitStatement>>
   ParseDeinitStatement(CoboldParser::DeinitStatementContext *ctx);
   absl::StatusOr<std::unique_ptr<AssignmentStatement>>
-  ParseAssignmentStatement(CoboldParser::AssignmentStatementContext *ctx);
+  ParseAssignmentStatement(CoboldParser::ExpressionStatementContext *ctx);
   absl::StatusOr<std::unique_ptr<CompoundStatement>>
   ParseCompoundStatement(CoboldParser::CompoundStatementContext *ctx);
   absl::StatusOr<std::unique_ptr<ExpressionStatement>>
@@ -100,11 +238,7 @@ private:
   absl::StatusOr<std::unique_ptr<Expression>>
   ParseConditionalExpression(CoboldParser::ConditionalExpressionContext *ctx);
   absl::StatusOr<std::unique_ptr<Expression>>
-  ParseCallExpression(CoboldParser::CallExpressionContext *ctx);
-  absl::StatusOr<std::unique_ptr<Expression>>
-  ParseRangeExpression(CoboldParser::RangeExpressionContext *ctx);
-  absl::StatusOr<std::unique_ptr<Expression>>
-  ParseArrayExpression(CoboldParser::ArrayExpressionContext *ctx);
+  ParseBracketExpression(CoboldParser::BracketExpressionContext *ctx);
   absl::StatusOr<std::unique_ptr<Expression>>
   ParseLogicalOrExpression(CoboldParser::LogicalOrExpressionContext *ctx);
   absl::StatusOr<std::unique_ptr<Expression>>
@@ -139,14 +273,42 @@ private:
   ParsePrimaryExpression(CoboldParser::PrimaryExpressionContext *ctx);
 
   SourceLocation LocationOf(antlr4::tree::TerminalNode *node);
+  SourceLocation LocationOf(antlr4::Token *token);
+  SourceSpan SpanOf(antlr4::Token *token);
+
+  // Resource limits (see `ParserOptions`). `LimitExceeded` reports the error
+  // (at `span`) and returns the corresponding `ResourceExhaustedError`,
+  // which is also kept in `limit_status_`. `AbortParse` does the same, but
+  // additionally unwinds the running ANTLR parse.
+  absl::Status LimitExceeded(SourceSpan span, std::string message);
+  [[noreturn]] void AbortParse(SourceLocation location, std::string message);
+  // Counts a reported error against `ParserOptions::error_recovery_limit`.
+  absl::Status CountError(SourceLocation location);
+  void RecordLimit(std::atomic<int> ParserLimitCounters::*counter, int value);
+  absl::Status CheckExpressionSize(antlr4::ParserRuleContext *ctx);
 
-  std::string filename_;
-  std::vector<std::string> buffer_;
+  const SourceBuffer *source_;
+  ParserOptions options_;
+
+  // Number of times the full LL stage needed full-context prediction (and
+  // found the SLL prediction insufficient), reported with `profile`.
+  int full_context_attempts_ = 0;
+  int context_sensitivities_ = 0;
 
   ParserErrorListener listener_;
+  ParserDepthListener depth_listener_;
   ErrorContext error_context_;
 
+  int errors_ = 0;
+  // Nesting of `ParseExpression` (only top-level expressions are measured).
+  int expression_depth_ = 0;
+  // Nesting of compound statements (see `ParserOptions::hand_written`).
+  int statement_depth_ = 0;
+  absl::Status limit_status_;
+
   friend class ParserErrorListener;
+  friend class ParserErrorStrategy;
+  friend class ParserDepthListener;
 };
 } // namespace Cobold
 
@@ -0,0 +1,244 @@
+// Differential test of `ParserOptions::hand_written` (the hand-written
+// `Lexer` and `ExpressionParser`), of streaming and of parsing in parallel
+// chunks against the generated parser's default path: all need to accept the
+// same inputs and produce the same AST.
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "core/function.h"
+#include "core/type.h"
+#include "gtest/gtest.h"
+#include "parser/internal/options.h"
+#include "parser/parser.h"
+#include "parser/source_file.h"
+#include "parser/source_manager.h"
+#include "util/casting.h"
+
+namespace Cobold {
+namespace {
+constexpr char kEdgeCases[] = R"(import "io";
+import "std";
+
+fn F(a: i32, b: i64*) -> bool #extern("__f");
+
+fn G(a: i32, b: [i64]) -> i32 {
+    var x: i32;
+    let y = a + 1 * 2 - -3 << 1 | 4 ^ 5 & 6;
+    var z: i8 = --;
+    var w = --a;
+    x = a; x += 1; x <<= 2; x |= 3; x >>= 1; x %= 2;
+    if x < 1 { return 1; } else if x == 2 { x++; } else if (x) { } else { deinit b; }
+    if a { }
+    for i: i32 in [0 .. 10] { continue; }
+    for j in b { break; }
+    while x > 0 && !(x == 3) || F(x, &b[0]) { x -= 1; { } }
+    G(a, b)[0] = a ? 1 : a < 2 ? 3 : 4;
+    return (i32) sizeof(i64) + (i32) malloc(i32)(4);
+}
+
+fn Main() -> i32 {
+    return G(1, [1, 2, 3]);
+}
+)";
+
+class ParserTest : public ::testing::Test {
+protected:
+  ParserTest() : scope_(&types_) {}
+
+  static ParserOptions HandWritten(ParserOptions options = ParserOptions()) {
+    options.hand_written = true;
+    return options;
+  }
+
+  static std::vector<std::string>
+  Describe(const absl::StatusOr<SourceFile> &file) {
+    if (!file.ok())
+      return {absl::StrCat("error: ", absl::StatusCodeToString(
+                                          file.status().code()))};
+    std::vector<std::string> described = file->imports();
+    for (const std::unique_ptr<Function> &function : file->functions())
+      described.push_back(function->DebugString());
+    return described;
+  }
+
+  static ParserOptions Streaming() {
+    ParserOptions options;
+    options.streaming = true;
+    return options;
+  }
+
+  static ParserOptions Parallel() {
+    ParserOptions options;
+    options.parallel_chunk_size = 1; // one chunk per declaration
+    options.parallel_threads = 4;
+    return options;
+  }
+
+  // Expects the same AST with `options` as with the default options.
+  void ExpectSameAst(const SourceBuffer &source,
+                     const ParserOptions &options = HandWritten()) {
+    SCOPED_TRACE(source.filename());
+    EXPECT_EQ(Describe(Parser::Parse(source, options)),
+              Describe(Parser::Parse(source)));
+  }
+
+  // The sources of //test:sources and //std:sources.
+  std::vector<const SourceBuffer *> LoadSources() {
+    std::vector<const SourceBuffer *> loaded;
+    for (const char *directory : {"test", "std"}) {
+      for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+        if (entry.path().extension() != ".cb")
+          continue;
+        absl::StatusOr<const SourceBuffer *> source =
+            sources_.Load(entry.path().string());
+        EXPECT_TRUE(source.ok()) << source.status();
+        if (source.ok())
+          loaded.push_back(*source);
+      }
+    }
+    EXPECT_FALSE(loaded.empty());
+    return loaded;
+  }
+
+  TypeTable types_;
+  TypeTable::Scope scope_;
+  SourceManager sources_;
+};
+
+TEST_F(ParserTest, MatchesGeneratedParserOnSources) {
+  for (const SourceBuffer *source : LoadSources())
+    ExpectSameAst(*source);
+}
+
+TEST_F(ParserTest, MatchesGeneratedParserOnEdgeCases) {
+  ExpectSameAst(*SourceBuffer::FromString("edge_cases.cb", kEdgeCases));
+}
+
+TEST_F(ParserTest, MatchesGeneratedParserOnLongExpressions) {
+  std::string expression = "a";
+  for (int i = 0; i < 2000; ++i)
+    absl::StrAppend(&expression, " ", std::string(1, "+-*/%&|^"[i % 8]),
+                    " (a", i, " < b)");
+  ExpectSameAst(*SourceBuffer::FromString(
+      "long.cb", absl::StrCat("fn Main() -> i32 { return ", expression,
+                              "; }\n")));
+}
+
+TEST_F(ParserTest, BodiesMatchGeneratedParser) {
+  ParserOptions lazy;
+  lazy.lazy_bodies = true;
+  const std::unique_ptr<SourceBuffer> source =
+      SourceBuffer::FromString("edge_cases.cb", kEdgeCases);
+  absl::StatusOr<SourceFile> expected = Parser::Parse(*source, lazy);
+  absl::StatusOr<SourceFile> actual = Parser::Parse(*source, lazy);
+  ASSERT_TRUE(expected.ok()) << expected.status();
+  ASSERT_TRUE(actual.ok()) << actual.status();
+  for (int i = 0; i < expected->functions().size(); ++i) {
+    auto *expected_fn =
+        dyn_cast<DefinedFunction>(expected->functions()[i].get());
+    auto *actual_fn = dyn_cast<DefinedFunction>(actual->functions()[i].get());
+    if (expected_fn == nullptr)
+      continue;
+    ASSERT_TRUE(Parser::ParseBody(expected_fn).ok());
+    ASSERT_TRUE(Parser::ParseBody(actual_fn, HandWritten()).ok());
+    EXPECT_EQ(actual_fn->DebugString(), expected_fn->DebugString());
+  }
+}
+
+TEST_F(ParserTest, DeclarationsMatchGeneratedParser) {
+  const std::unique_ptr<SourceBuffer> source =
+      SourceBuffer::FromString("edge_cases.cb", kEdgeCases);
+  const size_t begin = source->contents().find("fn G");
+  const size_t end = source->contents().find("fn Main");
+  for (size_t last : {end, std::numeric_limits<size_t>::max()}) {
+    absl::StatusOr<std::vector<std::unique_ptr<Function>>> expected =
+        Parser::ParseDeclarations(*source, begin, last);
+    absl::StatusOr<std::vector<std::unique_ptr<Function>>> actual =
+        Parser::ParseDeclarations(*source, begin, last, HandWritten());
+    ASSERT_TRUE(expected.ok()) << expected.status();
+    ASSERT_TRUE(actual.ok()) << actual.status();
+    ASSERT_EQ(actual->size(), expected->size());
+    for (int i = 0; i < expected->size(); ++i)
+      EXPECT_EQ((*actual)[i]->DebugString(), (*expected)[i]->DebugString());
+  }
+}
+
+TEST_F(ParserTest, StreamingMatchesBufferedOnSources) {
+  for (const SourceBuffer *source : LoadSources())
+    ExpectSameAst(*source, Streaming());
+  ExpectSameAst(*SourceBuffer::FromString("edge_cases.cb", kEdgeCases),
+                Streaming());
+}
+
+TEST_F(ParserTest, StreamingFallsBackToFullContext) {
+  // The grammar parses SLL-clean (see //parser/internal:ambiguity_report),
+  // i.e., only a declaration with a syntax error fails the SLL stage. It is
+  // re-parsed (from the marked tokens) in LL mode with error recovery, which
+  // reports the same diagnostics as the buffered path, and the declarations
+  // after it are parsed as usual.
+  const std::unique_ptr<SourceBuffer> source = SourceBuffer::FromString(
+      "invalid.cb", "fn A() -> i32 { return 1; }\n"
+                    "fn B() -> i32 { var x: i32 = 2 return x; }\n"
+                    "fn C() -> i32 { return 3 }\n");
+  const absl::Status expected = Parser::Parse(*source).status();
+  ASSERT_FALSE(expected.ok());
+  EXPECT_EQ(Parser::Parse(*source, Streaming()).status(), expected);
+}
+
+TEST_F(ParserTest, ParallelMatchesSequentialOnSources) {
+  for (const SourceBuffer *source : LoadSources())
+    ExpectSameAst(*source, Parallel());
+  ExpectSameAst(*SourceBuffer::FromString("edge_cases.cb", kEdgeCases),
+                Parallel());
+}
+
+TEST_F(ParserTest, ParallelReportsErrorsInSourceOrder) {
+  // Syntax errors in the first and the last of three chunks.
+  const std::unique_ptr<SourceBuffer> source = SourceBuffer::FromString(
+      "invalid.cb", "fn A() -> i32 { return 1 }\n"
+                    "fn B() -> i32 { return 2; }\n"
+                    "fn C() -> i32 { return 3 }\n");
+  const absl::Status expected = Parser::Parse(*source, Parallel()).status();
+  ASSERT_FALSE(expected.ok());
+  const std::string message(expected.message());
+  EXPECT_LT(message.find("return 1 }"), message.find("return 3 }"));
+  EXPECT_NE(message.find("return 3 }"), std::string::npos);
+  // Independent of the order the chunks finish in.
+  for (int i = 0; i < 20; ++i)
+    EXPECT_EQ(Parser::Parse(*source, Parallel()).status(), expected);
+}
+
+TEST_F(ParserTest, RejectsSyntaxErrors) {
+  for (const char *input :
+       {"fn Main() -> i32 { return 1 }", "fn Main() -> i32 { var; }",
+        "fn Main() { if { } }", "fn Main() { for in x { } }",
+        "fn Main() { x = ; }", "fn Main() {", "fn Main() # { }"}) {
+    SCOPED_TRACE(input);
+    const std::unique_ptr<SourceBuffer> source =
+        SourceBuffer::FromString("invalid.cb", input);
+    EXPECT_EQ(Parser::Parse(*source, HandWritten()).status().code(),
+              absl::StatusCode::kInvalidArgument);
+    EXPECT_FALSE(Parser::Parse(*source).ok());
+  }
+}
+
+TEST_F(ParserTest, LimitsNestedStatements) {
+  const std::string input = absl::StrCat(
+      "fn Main() ", std::string(kDefaultMaxRecursionDepth + 1, '{'),
+      std::string(kDefaultMaxRecursionDepth + 1, '}'), "\n");
+  const std::unique_ptr<SourceBuffer> source =
+      SourceBuffer::FromString("nested.cb", input);
+  absl::StatusOr<SourceFile> file = Parser::Parse(*source, HandWritten());
+  ASSERT_FALSE(file.ok());
+  EXPECT_TRUE(absl::StrContains(file.status().message(),
+                                "nesting exceeds the maximum depth"));
+}
+} // namespace
+} // namespace Cobold
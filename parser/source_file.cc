@@ -3,6 +3,23 @@
 #include "absl/strings/str_join.h"
 
 namespace Cobold {
+SourceFile &SourceFile::operator=(SourceFile &&other) {
+  filename_ = std::move(other.filename_);
+  imports_ = std::move(other.imports_);
+  functions_ = std::move(other.functions_);
+  arena_ = std::move(other.arena_);
+  annotated_ = other.annotated_;
+  return *this;
+}
+
+bool SourceFile::parsed() const {
+  for (const auto &function : functions_) {
+    if (!function->external() && !function->As<DefinedFunction>()->parsed())
+      return false;
+  }
+  return true;
+}
+
 std::string SourceFile::DebugString() const {
   std::vector<std::string> functions;
   functions.reserve(functions_.size());
@@ -5,25 +5,45 @@
 #include <string>
 #include <vector>
 
+#include "core/ast_arena.h"
 #include "core/function.h"
 
 namespace Cobold {
 class SourceFile {
 public:
   SourceFile(const std::string &filename) : filename_(filename) {}
-  const std::string &filename() { return filename_; }
+  SourceFile(SourceFile &&) = default;
+  // Releases the current functions before the arena they were allocated from.
+  SourceFile &operator=(SourceFile &&other);
+
+  const std::string &filename() const { return filename_; }
   const std::vector<std::string> &imports() const { return imports_; }
   const std::vector<std::unique_ptr<Function>> &functions() const {
     return functions_;
   }
+  // Whether type inference already ran on this module.
+  bool annotated() const { return annotated_; }
+  // Whether the bodies of all defined functions were parsed (see
+  // `ParserOptions::lazy_bodies`).
+  bool parsed() const;
   std::string DebugString() const;
 
+  // Arena holding the AST nodes of `functions()` (see
+  // `ParserOptions::ast_arena`), or `nullptr` if they live on the heap.
+  AstArena *arena() const { return arena_.get(); }
+
 private:
   std::string filename_;
   std::vector<std::string> imports_;
+  // Declared before (i.e., destroyed after) `functions_`.
+  std::unique_ptr<AstArena> arena_;
   std::vector<std::unique_ptr<Function>> functions_;
+  bool annotated_ = false;
 
+  friend class IncrementalParser;
   friend class Parser;
+  friend class ModuleReader;
+  friend class TypeInferenceVisitor;
 };
 } // namespace Cobold
 
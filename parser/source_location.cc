@@ -0,0 +1,28 @@
+#include "parser/source_location.h"
+
+namespace Cobold {
+// `SourceLocation` =====================================================
+const SourceBuffer *SourceLocation::buffer() const {
+  return HasSource() ? SourceManager::BufferContaining(offset_) : nullptr;
+}
+
+uint32_t SourceLocation::offset() const {
+  const SourceBuffer *source = buffer();
+  return source != nullptr ? offset_ - source->base() : 0;
+}
+
+SourceLocation::Position SourceLocation::Resolve() const {
+  const SourceBuffer *source = buffer();
+  if (source == nullptr)
+    return Position{nullptr, 0, 0};
+  const auto [line, column] = source->Position(offset_ - source->base());
+  return Position{source, line, column};
+}
+
+const std::string &SourceLocation::filename() const {
+  static const std::string *no_filename = new std::string();
+  const SourceBuffer *source = buffer();
+  return source != nullptr ? source->filename() : *no_filename;
+}
+// `SourceLocation` =====================================================
+} // namespace Cobold
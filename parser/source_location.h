@@ -1,42 +1,111 @@
 #ifndef COBOLD_PARSER_SOURCE_LOCATION
 #define COBOLD_PARSER_SOURCE_LOCATION
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <vector>
+#include <string_view>
+
+#include "parser/source_manager.h"
+
 namespace Cobold {
+// A location is a single 32-bit offset into the ranges reserved by the live
+// `SourceBuffer`s (see `SourceManager::BufferContaining`), i.e., it is cheap
+// to copy into every AST node. The buffer, line and column are only looked up
+// when asked for (usually by a diagnostic).
 class SourceLocation {
 public:
-  SourceLocation(const std::string &filename, int line, int column,
-                 const std::vector<std::string> &buffer)
-      : filename_(&filename), line_(line), column_(column), buffer_(&buffer) {}
-
-  const std::string &filename() const { return *filename_; }
-  const int line() const { return line_; }
-  const int column() const { return column_; }
-  const std::vector<std::string> &buffer() const { return *buffer_; }
+  // Location of the byte at `offset` of `source`.
+  static SourceLocation AtOffset(const SourceBuffer &source, size_t offset) {
+    if (source.base() == SourceBuffer::kNoBase)
+      return Generated();
+    return SourceLocation(source.base() + static_cast<uint32_t>(offset));
+  }
 
   static const SourceLocation Generated() {
     return SourceLocation(SOURCE_LOCATION_GENERATED);
   }
 
+  // Represents a complex object without a direct location (e.g., a binary
+  // expression). Storing a `SourceSpan` per node instead would double the
+  // size of every location for the sake of diagnostics only.
   static const SourceLocation Complex() {
     return SourceLocation(SOURCE_LOCATION_COMPLEX);
   }
 
+  // Whether the location refers to a `SourceBuffer` (i.e., is neither
+  // generated nor complex).
+  bool HasSource() const { return offset_ >= SOURCE_LOCATION_FIRST; }
+  bool IsGenerated() const { return offset_ == SOURCE_LOCATION_GENERATED; }
+  bool IsComplex() const { return offset_ == SOURCE_LOCATION_COMPLEX; }
+
+  // The buffer containing the location (nullptr unless `HasSource()`).
+  const SourceBuffer *buffer() const;
+  // Offset of the location within `buffer()`.
+  uint32_t offset() const;
+
+  // Resolves the buffer, (1-based) line and column at once.
+  struct Position {
+    const SourceBuffer *buffer;
+    int line, column;
+  };
+  Position Resolve() const;
+
+  // Prefer `Resolve()` for more than one of these, every call looks up the
+  // buffer again. Locations without a source are at line 0.
+  const std::string &filename() const;
+  int line() const { return Resolve().line; }
+  int column() const { return Resolve().column; }
+  const SourceBuffer &source() const { return *buffer(); }
+
+  // Returns the (1-based) line of the underlying source file.
+  std::string_view SourceLine(int line) const { return buffer()->Line(line); }
+
+  // The location `bytes` further into the same buffer.
+  SourceLocation AdvancedBy(uint32_t bytes) const {
+    return HasSource() ? SourceLocation(offset_ + bytes) : *this;
+  }
+
+  // The raw encoding, i.e., the offset into the ranges of all buffers.
+  uint32_t raw() const { return offset_; }
+
+  friend bool operator==(SourceLocation lhs, SourceLocation rhs) {
+    return lhs.offset_ == rhs.offset_;
+  }
+  friend bool operator!=(SourceLocation lhs, SourceLocation rhs) {
+    return lhs.offset_ != rhs.offset_;
+  }
+
 private:
   // Generated code by the parser/type_checker
-  static constexpr int SOURCE_LOCATION_GENERATED = -1;
+  static constexpr uint32_t SOURCE_LOCATION_GENERATED = 0;
+  static constexpr uint32_t SOURCE_LOCATION_COMPLEX = 1;
+  // The first offset that can be reserved by a `SourceBuffer`.
+  static constexpr uint32_t SOURCE_LOCATION_FIRST = SourceBuffer::kFirstBase;
 
-  // Represents a complex object without a direct location
-  // TODO(jlscheerer) Use a SourceSpan here instead
-  static constexpr int SOURCE_LOCATION_COMPLEX = -2;
+  explicit SourceLocation(uint32_t offset) : offset_(offset) {}
 
-  SourceLocation(int code)
-      : filename_(nullptr), line_(0), column_(code), buffer_(nullptr) {}
+  uint32_t offset_;
+};
+static_assert(sizeof(SourceLocation) == sizeof(uint32_t));
+
+// The half-open range [begin, end) of one buffer, e.g., of a token or of the
+// expression a diagnostic refers to.
+struct SourceSpan {
+  SourceSpan(SourceLocation begin, SourceLocation end)
+      : begin(begin), end(end) {}
+  // Span of the single character at `location`.
+  SourceSpan(SourceLocation location)
+      : begin(location), end(location.AdvancedBy(1)) {}
+
+  // Length in bytes (0 unless both ends refer to the same buffer).
+  size_t size() const {
+    return begin.HasSource() && end.raw() > begin.raw()
+               ? end.raw() - begin.raw()
+               : 0;
+  }
 
-  const std::string *filename_;
-  int line_, column_;
-  const std::vector<std::string> *buffer_;
+  SourceLocation begin, end;
 };
 } // namespace Cobold
 
@@ -0,0 +1,181 @@
+#include "parser/source_manager.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+
+namespace Cobold {
+namespace {
+// The offset ranges reserved by the live buffers, keyed by their base. Ranges
+// of destroyed buffers are reused (first fit), such that long-running
+// sessions (see `IncrementalParser`) do not run out of offsets.
+class SourceRanges {
+public:
+  static SourceRanges &Get() {
+    static SourceRanges *ranges = new SourceRanges();
+    return *ranges;
+  }
+
+  // Returns `SourceBuffer::kNoBase` if there is no gap of `size` offsets.
+  uint32_t Reserve(const SourceBuffer *buffer, uint64_t size) {
+    absl::MutexLock lock(&mutex_);
+    uint64_t base = SourceBuffer::kFirstBase;
+    for (const auto &[begin, other] : buffers_) {
+      if (begin - base >= size)
+        break;
+      base = begin + Size(other);
+    }
+    if (base + size > std::numeric_limits<uint32_t>::max())
+      return SourceBuffer::kNoBase;
+    buffers_.emplace(base, buffer);
+    return base;
+  }
+
+  void Release(uint32_t base) {
+    absl::MutexLock lock(&mutex_);
+    buffers_.erase(base);
+  }
+
+  const SourceBuffer *Find(uint32_t offset) {
+    absl::ReaderMutexLock lock(&mutex_);
+    auto it = buffers_.upper_bound(offset);
+    if (it == buffers_.begin())
+      return nullptr;
+    --it;
+    return offset - it->first < Size(it->second) ? it->second : nullptr;
+  }
+
+  // The number of reserved offsets, one past the end is still a location
+  // (e.g., of the end of file).
+  static uint64_t Size(const SourceBuffer *buffer) {
+    return buffer->size() + 1;
+  }
+
+private:
+  absl::Mutex mutex_;
+  std::map<uint32_t, const SourceBuffer *> buffers_ ABSL_GUARDED_BY(mutex_);
+};
+} // namespace
+
+// `SourceBuffer` =======================================================
+SourceBuffer::~SourceBuffer() {
+  if (base_ != kNoBase) {
+    SourceRanges::Get().Release(base_);
+  }
+  if (mapping_ != nullptr) {
+    munmap(mapping_, size_);
+  }
+}
+
+std::unique_ptr<SourceBuffer> SourceBuffer::FromString(std::string filename,
+                                                       std::string contents) {
+  auto buffer = absl::WrapUnique(
+      new SourceBuffer(std::move(filename), nullptr, 0, nullptr));
+  buffer->contents_ = std::move(contents);
+  buffer->data_ = buffer->contents_.data();
+  buffer->size_ = buffer->contents_.size();
+  buffer->Register();
+  return buffer;
+}
+
+std::string_view SourceBuffer::Line(int line) const {
+  absl::call_once(line_index_once_, &SourceBuffer::BuildLineIndex, this);
+  assert(line >= 1 && line <= line_offsets_.size());
+  const size_t begin = line_offsets_[line - 1];
+  size_t end = line < line_offsets_.size() ? line_offsets_[line] - 1 : size_;
+  if (end > begin && data_[end - 1] == '\n')
+    --end;
+  return std::string_view(data_ + begin, end - begin);
+}
+
+int SourceBuffer::line_count() const {
+  absl::call_once(line_index_once_, &SourceBuffer::BuildLineIndex, this);
+  return line_offsets_.size();
+}
+
+std::pair<int, int> SourceBuffer::Position(size_t offset) const {
+  absl::call_once(line_index_once_, &SourceBuffer::BuildLineIndex, this);
+  auto it = std::upper_bound(line_offsets_.begin(), line_offsets_.end(),
+                             static_cast<uint32_t>(offset));
+  const int line = it - line_offsets_.begin();
+  return {line, static_cast<int>(offset - line_offsets_[line - 1])};
+}
+
+size_t SourceBuffer::Offset(int line, int column) const {
+  absl::call_once(line_index_once_, &SourceBuffer::BuildLineIndex, this);
+  assert(line >= 1 && line <= line_offsets_.size());
+  return line_offsets_[line - 1] + column;
+}
+
+void SourceBuffer::BuildLineIndex() const {
+  line_offsets_.push_back(0);
+  const char *begin = data_, *end = data_ + size_;
+  for (const char *it = begin;
+       (it = static_cast<const char *>(std::memchr(it, '\n', end - it)));) {
+    ++it;
+    // A trailing newline does not start another line (cf. `std::getline`).
+    if (it == end)
+      break;
+    line_offsets_.push_back(it - begin);
+  }
+}
+
+void SourceBuffer::Register() {
+  base_ = SourceRanges::Get().Reserve(this, SourceRanges::Size(this));
+}
+// `SourceBuffer` =======================================================
+
+// `SourceManager` ======================================================
+absl::StatusOr<const SourceBuffer *>
+SourceManager::Load(const std::string &filename) {
+  absl::MutexLock lock(&mutex_);
+  if (buffers_.contains(filename))
+    return buffers_[filename].get();
+
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Could not open source file: ", filename));
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    return absl::InternalError(
+        absl::StrCat("Could not stat source file: ", filename));
+  }
+  const size_t size = file_stat.st_size;
+  void *mapping = nullptr;
+  if (size > 0) {
+    mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      close(fd);
+      return absl::InternalError(
+          absl::StrCat("Could not map source file: ", filename));
+    }
+  }
+  // The mapping stays valid after the file descriptor is closed.
+  close(fd);
+
+  const char *data = mapping ? static_cast<const char *>(mapping) : "";
+  auto buffer = absl::WrapUnique(new SourceBuffer(filename, data, size, mapping));
+  buffer->Register();
+  const SourceBuffer *result = buffer.get();
+  buffers_[filename] = std::move(buffer);
+  return result;
+}
+
+const SourceBuffer *SourceManager::BufferContaining(uint32_t offset) {
+  return SourceRanges::Get().Find(offset);
+}
+// `SourceManager` ======================================================
+} // namespace Cobold
@@ -0,0 +1,99 @@
+#ifndef COBOLD_PARSER_SOURCE_MANAGER
+#define COBOLD_PARSER_SOURCE_MANAGER
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/call_once.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Cobold {
+// Read-only view of a source file that is mapped into memory exactly once.
+// The line index is only built when a diagnostic first asks for a line.
+//
+// Every live buffer reserves the range [base, base + size] of the 32-bit
+// offsets that `SourceLocation`s are made of.
+class SourceBuffer {
+public:
+  // The buffer did not fit into the offsets (its locations are generated).
+  static constexpr uint32_t kNoBase = 0;
+  // The smaller offsets encode generated and complex locations.
+  static constexpr uint32_t kFirstBase = 2;
+
+  ~SourceBuffer();
+
+  // Buffer owning `contents` instead of mapping a file, e.g., for the edited
+  // (unsaved) contents of `filename`.
+  static std::unique_ptr<SourceBuffer> FromString(std::string filename,
+                                                  std::string contents);
+
+  const std::string &filename() const { return filename_; }
+  std::string_view contents() const { return std::string_view(data_, size_); }
+  const char *data() const { return data_; }
+  size_t size() const { return size_; }
+  // The offset of the location of the first byte.
+  uint32_t base() const { return base_; }
+
+  // Returns the (1-based) line without its trailing newline.
+  std::string_view Line(int line) const;
+  int line_count() const;
+
+  // Returns the (1-based) line containing the byte at `offset` and the offset
+  // of that byte within the line (i.e., the column as reported by ANTLR).
+  std::pair<int, int> Position(size_t offset) const;
+  // The inverse of `Position`.
+  size_t Offset(int line, int column) const;
+
+private:
+  SourceBuffer(std::string filename, const char *data, size_t size,
+               void *mapping)
+      : filename_(std::move(filename)), data_(data), size_(size),
+        mapping_(mapping) {}
+  void BuildLineIndex() const;
+  // Reserves the offsets of the (then immutable) buffer.
+  void Register();
+
+  std::string filename_;
+  const char *data_;
+  size_t size_;
+  void *mapping_; // nullptr if the file is empty (i.e., nothing is mapped)
+  std::string contents_; // only used by `FromString`
+  uint32_t base_ = kNoBase;
+
+  mutable absl::once_flag line_index_once_;
+  mutable std::vector<uint32_t> line_offsets_;
+
+  friend class SourceManager;
+};
+
+class SourceManager {
+public:
+  SourceManager() = default;
+  SourceManager(const SourceManager &) = delete;
+  SourceManager &operator=(const SourceManager &) = delete;
+
+  // Maps `filename` into memory (or returns the already mapped buffer).
+  // The returned buffer lives as long as the `SourceManager`. Thread-safe.
+  absl::StatusOr<const SourceBuffer *> Load(const std::string &filename);
+
+  // Returns the live buffer (of any `SourceManager`, or created by
+  // `SourceBuffer::FromString`) whose range contains `offset`, or nullptr.
+  // Thread-safe.
+  static const SourceBuffer *BufferContaining(uint32_t offset);
+
+private:
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::unique_ptr<SourceBuffer>>
+      buffers_ ABSL_GUARDED_BY(mutex_);
+};
+} // namespace Cobold
+
+#endif /* COBOLD_PARSER_SOURCE_MANAGER */
@@ -0,0 +1,163 @@
+#include "parser/token.h"
+
+namespace Cobold {
+std::string_view TokenKindSpelling(TokenKind kind) {
+  switch (kind) {
+  case TokenKind::Import:
+    return "'import'";
+  case TokenKind::Extern:
+    return "'extern'";
+  case TokenKind::Function:
+    return "FUNCTION";
+  case TokenKind::Return:
+    return "RETURN";
+  case TokenKind::Deinit:
+    return "DEINIT";
+  case TokenKind::If:
+    return "IF";
+  case TokenKind::Else:
+    return "ELSE";
+  case TokenKind::For:
+    return "FOR";
+  case TokenKind::While:
+    return "WHILE";
+  case TokenKind::Break:
+    return "BREAK";
+  case TokenKind::Continue:
+    return "CONTINUE";
+  case TokenKind::In:
+    return "IN";
+  case TokenKind::Var:
+    return "VAR";
+  case TokenKind::Let:
+    return "LET";
+  case TokenKind::String:
+    return "STRING";
+  case TokenKind::Bool:
+    return "BOOL";
+  case TokenKind::Char:
+    return "CHAR";
+  case TokenKind::Nil:
+    return "NIL";
+  case TokenKind::Malloc:
+    return "MALLOC";
+  case TokenKind::Sizeof:
+    return "SIZEOF";
+  case TokenKind::Semicolon:
+    return "';'";
+  case TokenKind::LeftParen:
+    return "'('";
+  case TokenKind::RightParen:
+    return "')'";
+  case TokenKind::LeftBrace:
+    return "'{'";
+  case TokenKind::RightBrace:
+    return "'}'";
+  case TokenKind::LeftBracket:
+    return "LBRACKET";
+  case TokenKind::RightBracket:
+    return "RBRACKET";
+  case TokenKind::Arrow:
+    return "'->'";
+  case TokenKind::Hash:
+    return "'#'";
+  case TokenKind::Comma:
+    return "','";
+  case TokenKind::Colon:
+    return "':'";
+  case TokenKind::Dot:
+    return "'.'";
+  case TokenKind::DotDot:
+    return "'..'";
+  case TokenKind::Question:
+    return "'?'";
+  case TokenKind::Assign:
+    return "'='";
+  case TokenKind::PlusPlus:
+    return "'++'";
+  case TokenKind::DashDash:
+    return "DASH_INIT";
+  case TokenKind::Plus:
+    return "'+'";
+  case TokenKind::Minus:
+    return "'-'";
+  case TokenKind::Star:
+    return "POINTER";
+  case TokenKind::Slash:
+    return "'/'";
+  case TokenKind::Percent:
+    return "'%'";
+  case TokenKind::Amp:
+    return "'&'";
+  case TokenKind::AmpAmp:
+    return "'&&'";
+  case TokenKind::Pipe:
+    return "'|'";
+  case TokenKind::PipePipe:
+    return "'||'";
+  case TokenKind::Caret:
+    return "'^'";
+  case TokenKind::Tilde:
+    return "'~'";
+  case TokenKind::Bang:
+    return "'!'";
+  case TokenKind::ShiftLeft:
+    return "'<<'";
+  case TokenKind::ShiftRight:
+    return "'>>'";
+  case TokenKind::Less:
+    return "'<'";
+  case TokenKind::Greater:
+    return "'>'";
+  case TokenKind::LessEqual:
+    return "'<='";
+  case TokenKind::GreaterEqual:
+    return "'>='";
+  case TokenKind::EqualEqual:
+    return "'=='";
+  case TokenKind::NotEqual:
+    return "'!='";
+  case TokenKind::StarAssign:
+    return "'*='";
+  case TokenKind::SlashAssign:
+    return "'/='";
+  case TokenKind::PercentAssign:
+    return "'%='";
+  case TokenKind::PlusAssign:
+    return "'+='";
+  case TokenKind::MinusAssign:
+    return "'-='";
+  case TokenKind::ShiftLeftAssign:
+    return "'<<='";
+  case TokenKind::ShiftRightAssign:
+    return "'>>='";
+  case TokenKind::AmpAssign:
+    return "'&='";
+  case TokenKind::CaretAssign:
+    return "'^='";
+  case TokenKind::PipeAssign:
+    return "'|='";
+  case TokenKind::IntegralType:
+    return "IntegralType";
+  case TokenKind::FloatingType:
+    return "FloatingType";
+  case TokenKind::BoolConstant:
+    return "BoolConstant";
+  case TokenKind::Identifier:
+    return "Identifier";
+  case TokenKind::CharConstant:
+    return "CharConstant";
+  case TokenKind::StringConstant:
+    return "StringConstant";
+  case TokenKind::IntegerConstant:
+    return "IntegerConstant";
+  case TokenKind::FloatingConstant:
+    return "FloatingConstant";
+  case TokenKind::Error:
+    return "<error>";
+  case TokenKind::EndOfFile:
+    return "EOF";
+  }
+  return "<invalid>";
+}
+} // namespace Cobold
@@ -0,0 +1,118 @@
+#ifndef COBOLD_PARSER_TOKEN
+#define COBOLD_PARSER_TOKEN
+
+#include <cstdint>
+#include <string_view>
+
+namespace Cobold {
+// Tokens of `Cobold.g4`. Tokens the generated lexer can never produce (e.g.,
+// `I32`, which always loses against `IntegralType`) are omitted.
+enum class TokenKind : uint8_t {
+  // Keywords
+  Import,   // import
+  Extern,   // extern
+  Function, // fn
+  Return,   // return
+  Deinit,   // deinit
+  If,       // if
+  Else,     // else
+  For,      // for
+  While,    // while
+  Break,    // break
+  Continue, // continue
+  In,       // in
+  Var,      // var
+  Let,      // let
+  String,   // string
+  Bool,     // bool
+  Char,     // char
+  Nil,      // nil
+  Malloc,   // malloc
+  Sizeof,   // sizeof
+
+  // Punctuation and operators
+  Semicolon,        // ;
+  LeftParen,        // (
+  RightParen,       // )
+  LeftBrace,        // {
+  RightBrace,       // }
+  LeftBracket,      // [
+  RightBracket,     // ]
+  Arrow,            // ->
+  Hash,             // #
+  Comma,            // ,
+  Colon,            // :
+  Dot,              // .
+  DotDot,           // ..
+  Question,         // ?
+  Assign,           // =
+  PlusPlus,         // ++
+  DashDash,         // -- (also `DASH_INIT`)
+  Plus,             // +
+  Minus,            // -
+  Star,             // * (also `POINTER`)
+  Slash,            // /
+  Percent,          // %
+  Amp,              // &
+  AmpAmp,           // &&
+  Pipe,             // |
+  PipePipe,         // ||
+  Caret,            // ^
+  Tilde,            // ~
+  Bang,             // !
+  ShiftLeft,        // <<
+  ShiftRight,       // >>
+  Less,             // <
+  Greater,          // >
+  LessEqual,        // <=
+  GreaterEqual,     // >=
+  EqualEqual,       // ==
+  NotEqual,         // !=
+  StarAssign,       // *=
+  SlashAssign,      // /=
+  PercentAssign,    // %=
+  PlusAssign,       // +=
+  MinusAssign,      // -=
+  ShiftLeftAssign,  // <<=
+  ShiftRightAssign, // >>=
+  AmpAssign,        // &=
+  CaretAssign,      // ^=
+  PipeAssign,       // |=
+
+  // Literals and names
+  IntegralType,     // i8, ..., i256
+  FloatingType,     // f8, ..., f256
+  BoolConstant,     // true, false
+  Identifier,       // a
+  CharConstant,     // 'a'
+  StringConstant,   // "a"
+  IntegerConstant,  // -1, 0x1F, 017, 0b101
+  FloatingConstant, // 1.5, .5
+
+  // Input that does not match any token (reported as a recognition error).
+  Error,
+  EndOfFile,
+};
+
+inline constexpr int kNumTokenKinds =
+    static_cast<int>(TokenKind::EndOfFile) + 1;
+
+// Returns the spelling used for `kind` in `Cobold.g4`, i.e., the quoted
+// literal (e.g., "'import'") or the name of the lexer rule ("Identifier").
+std::string_view TokenKindSpelling(TokenKind kind);
+
+// A token only refers to its text in the source buffer, line and column are
+// recovered lazily (e.g., when reporting an error).
+struct Token {
+  TokenKind kind;
+  uint32_t offset;
+  uint32_t length;
+
+  std::string_view Text(std::string_view source) const {
+    return source.substr(offset, length);
+  }
+  uint32_t end() const { return offset + length; }
+};
+} // namespace Cobold
+
+#endif /* COBOLD_PARSER_TOKEN */
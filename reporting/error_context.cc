@@ -1,13 +1,14 @@
 #include "reporting/error_context.h"
 
 #include "absl/strings/ascii.h"
-#include <iostream>
+#include <algorithm>
+#include <sstream>
 
 namespace Cobold {
-ReportedError MakeError(SourceLocation location, std::string message,
+ReportedError MakeError(SourceSpan span, std::string message,
                         bool addl_context) {
   return ReportedError{
-      .location = location, .message = message, .addl_context = addl_context};
+      .span = span, .message = message, .addl_context = addl_context};
 }
 // `ErrorContext` =======================================================
 ErrorContext &ErrorContext::operator<<(ReportedError error) {
@@ -15,30 +16,46 @@ ErrorContext &ErrorContext::operator<<(ReportedError error) {
   return *this;
 }
 
-void ErrorContext::operator*() const {
-  if (!ok()) {
-    for (const auto &error : errors_) {
-      const auto &location = error.location;
-      bool context = error.addl_context;
-      std::cout << "\x1B[1;37m" << location.filename() << ":" << location.line()
-                << ":" << location.column() << ": "
-                << "\x1B[1;31merror: \x1B[1;37m" << error.message << "\033[0m"
-                << std::endl;
-      if (context && location.line() >= 2) {
-        std::string context = location.buffer()[location.line() - 2];
-        std::string_view stripped_context = absl::StripTrailingAsciiWhitespace(
-            absl::StripLeadingAsciiWhitespace(context));
-        if (stripped_context.size() > 0) {
-          std::cout << location.buffer()[location.line() - 2] << std::endl;
-        }
+ErrorContext &ErrorContext::operator<<(const ErrorContext &errors) {
+  errors_.insert(errors_.end(), errors.errors_.begin(), errors.errors_.end());
+  return *this;
+}
+
+absl::Status ErrorContext::ToStatus(absl::Status otherwise) const {
+  if (ok())
+    return otherwise;
+  std::ostringstream out;
+  for (const auto &error : errors_) {
+    // Looks up the buffer and line only once per error.
+    const SourceLocation::Position location = error.span.begin.Resolve();
+    if (location.buffer == nullptr) {
+      out << "\x1B[1;31merror: \x1B[1;37m" << error.message << "\033[0m\n";
+      continue;
+    }
+    bool context = error.addl_context;
+    out << "\x1B[1;37m" << location.buffer->filename() << ":" << location.line
+        << ":" << location.column << ": "
+        << "\x1B[1;31merror: \x1B[1;37m" << error.message << "\033[0m\n";
+    if (context && location.line >= 2) {
+      std::string_view context = location.buffer->Line(location.line - 1);
+      std::string_view stripped_context = absl::StripTrailingAsciiWhitespace(
+          absl::StripLeadingAsciiWhitespace(context));
+      if (stripped_context.size() > 0) {
+        out << context << "\n";
       }
-      std::cout << location.buffer()[location.line() - 1] << std::endl;
-      std::cout << std::string(location.column(), ' ') << "\x1B[32m^\033[0m"
-                << std::endl;
     }
-    std::cout << errors_.size() << " error(s) generated." << std::endl;
-    std::exit(-1);
+    const std::string_view line = location.buffer->Line(location.line);
+    out << line << "\n";
+    // Underline the span up to the end of its first line.
+    const size_t column = location.column;
+    const size_t length = std::max<size_t>(
+        1, std::min(error.span.size(),
+                    line.size() > column ? line.size() - column : 0));
+    out << std::string(column, ' ') << "\x1B[32m^"
+        << std::string(length - 1, '~') << "\033[0m\n";
   }
+  out << errors_.size() << " error(s) generated.";
+  return absl::InvalidArgumentError(out.str());
 }
 // `ErrorContext` =======================================================
 } // namespace Cobold
\ No newline at end of file
@@ -4,22 +4,28 @@
 #include <string>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "parser/source_location.h"
 
 namespace Cobold {
 struct ReportedError {
-  SourceLocation location;
+  // The error is reported at `span.begin`, the rest of the span is underlined.
+  SourceSpan span;
   std::string message;
   bool addl_context;
 };
-ReportedError MakeError(SourceLocation location, std::string message,
+ReportedError MakeError(SourceSpan span, std::string message,
                         bool addl_context = false);
 
 class ErrorContext {
 public:
   ErrorContext &operator<<(ReportedError error);
+  // Appends all errors of `errors` (e.g., of a part parsed separately).
+  ErrorContext &operator<<(const ErrorContext &errors);
   bool ok() const { return errors_.size() == 0; }
-  void operator*() const;
+  // Renders the reported errors (with their source lines) into the message
+  // of an `InvalidArgumentError`. Returns `otherwise` if there are none.
+  absl::Status ToStatus(absl::Status otherwise = absl::OkStatus()) const;
 
 private:
   std::vector<ReportedError> errors_;
@@ -0,0 +1,50 @@
+#include "session/compilation_session.h"
+
+#include <utility>
+
+#include "codegen/llvm_codegen.h"
+#include "inference/name_resolver.h"
+#include "inference/type_inference_visitor.h"
+
+namespace Cobold {
+// `CompilationSession` =================================================
+CompilationSession::CompilationSession(CompilationOptions options)
+    : options_(std::move(options)),
+      llvm_context_(std::make_unique<llvm::LLVMContext>()),
+      database_(&types_, llvm_context_.get()) {
+  if (!options_.cache_directory.empty()) {
+    cache_ = std::make_unique<ModuleCache>(options_.cache_directory);
+    options_.loader_options.cache = cache_.get();
+  }
+}
+
+CompilationSession::~CompilationSession() = default;
+
+absl::StatusOr<std::vector<SourceFile>>
+CompilationSession::Load(const std::string &filename) {
+  TypeTable::Scope scope(&types_);
+  return ModuleLoader::Load(&sources_, filename, options_.loader_options);
+}
+
+absl::Status CompilationSession::Analyze(std::vector<SourceFile> &modules) {
+  TypeTable::Scope scope(&types_);
+  if (absl::Status status = NameResolver::Resolve(modules); !status.ok())
+    return status;
+  TypeInferenceVisitor::Annotate(modules,
+                                 options_.loader_options.num_threads);
+  if (cache_ != nullptr) {
+    absl::Status status = cache_->Update(&sources_, modules);
+    if (!status.ok())
+      warnings_.push_back(std::string(status.message()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status
+CompilationSession::Generate(const std::vector<SourceFile> &modules) {
+  TypeTable::Scope scope(&types_);
+  return LLVMCodeGen::Generate(llvm_context_.get(), modules, options_.output,
+                               options_.optimization_level);
+}
+// `CompilationSession` =================================================
+} // namespace Cobold
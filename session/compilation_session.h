@@ -0,0 +1,76 @@
+#ifndef COBOLD_SESSION_COMPILATION_SESSION
+#define COBOLD_SESSION_COMPILATION_SESSION
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "cache/module_cache.h"
+#include "codegen/optimization_level.h"
+#include "core/type.h"
+#include "parser/module_loader.h"
+#include "parser/source_file.h"
+#include "parser/source_manager.h"
+#include "session/program_database.h"
+
+#include "llvm/IR/LLVMContext.h"
+
+namespace Cobold {
+struct CompilationOptions {
+  ModuleLoaderOptions loader_options;
+  // Directory of the module cache (see `ModuleCache`), disabled if empty.
+  std::string cache_directory;
+  // Path of the generated executable.
+  std::string output = "output";
+  // `-O`, by default about as much as the per-function passes run before.
+  OptimizationLevel optimization_level = OptimizationLevel::O1;
+};
+
+// Owns the state of compiling a single program: its sources, the interned
+// types, the module cache and the LLVM context. Sessions share no mutable
+// state apart from the (synchronized) `SymbolTable` and `SourceBuffer`
+// ranges, i.e., several programs can be compiled concurrently in one process.
+// Each phase installs the session's `TypeTable` on the calling thread (and on
+// the threads it starts). Errors are returned, never printed.
+class CompilationSession {
+public:
+  explicit CompilationSession(CompilationOptions options);
+  ~CompilationSession();
+
+  CompilationSession(const CompilationSession &) = delete;
+  CompilationSession &operator=(const CompilationSession &) = delete;
+
+  // Loads `filename` and its transitive imports (see `ModuleLoader::Load`).
+  // The session needs to outlive the returned modules.
+  absl::StatusOr<std::vector<SourceFile>> Load(const std::string &filename);
+  // Resolves the names and infers the types of `modules`, then stores them in
+  // the cache (if any).
+  absl::Status Analyze(std::vector<SourceFile> &modules);
+  // Generates the executable `options().output`. At most once per session.
+  absl::Status Generate(const std::vector<SourceFile> &modules);
+
+  const CompilationOptions &options() const { return options_; }
+  SourceManager *sources() { return &sources_; }
+  TypeTable *types() { return &types_; }
+  llvm::LLVMContext *llvm_context() { return llvm_context_.get(); }
+  // Memoized per-function queries for incremental rebuilds, independent of
+  // `Analyze` and `Generate` (see `ProgramDatabase`). Takes modules that were
+  // not passed to `Analyze`, which annotates them in place.
+  ProgramDatabase *database() { return &database_; }
+  // Problems that did not fail a phase (e.g., an unwritable cache).
+  const std::vector<std::string> &warnings() const { return warnings_; }
+
+private:
+  CompilationOptions options_;
+  SourceManager sources_;
+  TypeTable types_;
+  std::unique_ptr<ModuleCache> cache_;
+  std::unique_ptr<llvm::LLVMContext> llvm_context_;
+  ProgramDatabase database_;
+  std::vector<std::string> warnings_;
+};
+} // namespace Cobold
+
+#endif /* COBOLD_SESSION_COMPILATION_SESSION */
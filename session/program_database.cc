@@ -0,0 +1,204 @@
+#include "session/program_database.h"
+
+#include <cassert>
+#include <string_view>
+#include <utility>
+
+#include "absl/hash/hash.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "codegen/llvm_codegen.h"
+#include "inference/name_resolver.h"
+#include "inference/type_inference_visitor.h"
+#include "util/call_collector.h"
+
+namespace Cobold {
+namespace {
+// Fingerprints are never 0, which stands for "no such function".
+uint64_t Fingerprint(std::string_view data) {
+  const uint64_t hash = absl::Hash<std::string_view>()(data);
+  return hash == 0 ? 1 : hash;
+}
+
+std::string SignatureOf(const Function *function) {
+  std::vector<std::string> arg_types;
+  arg_types.reserve(function->arguments().size());
+  for (const FunctionArgument &argument : function->arguments())
+    arg_types.push_back(argument.type->DebugString());
+  return absl::StrCat(function->name().str(), "(",
+                      absl::StrJoin(arg_types, ","), ")->",
+                      function->return_type()->DebugString());
+}
+} // namespace
+
+// `ProgramDatabase` ====================================================
+ProgramDatabase::ProgramDatabase(TypeTable *types, llvm::LLVMContext *context)
+    : types_(types), context_(context),
+      engine_([this](const QueryKey &key) { return Execute(key); }) {}
+
+ProgramDatabase::~ProgramDatabase() = default;
+
+void ProgramDatabase::SetModules(const std::vector<SourceFile> &modules) {
+  TypeTable::Scope scope(types_);
+  absl::flat_hash_map<Symbol, const Function *> declarations;
+  for (const SourceFile &file : modules) {
+    // Annotated bodies are bound (and their calls rewritten) already.
+    assert(!file.annotated());
+    for (const auto &fn : file.functions())
+      declarations[fn->name()] = fn.get();
+  }
+  for (const auto &[name, function] : declarations_) {
+    if (declarations.contains(name))
+      continue;
+    engine_.SetInput({QueryKind::Input, name}, 0);
+    // The queries of `name` run again (if at all) as its input changed.
+    if (auto it = annotated_.find(name); it != annotated_.end()) {
+      Release(it->second);
+      annotated_.erase(it);
+    }
+    if (auto it = signatures_.find(name); it != signatures_.end()) {
+      Retire(std::move(it->second.function));
+      signatures_.erase(it);
+    }
+    ir_.erase(name);
+  }
+  for (const auto &[name, function] : declarations)
+    engine_.SetInput({QueryKind::Input, name},
+                     Fingerprint(function->DebugString()));
+  declarations_ = std::move(declarations);
+}
+
+uint64_t ProgramDatabase::Signature(Symbol name) {
+  TypeTable::Scope scope(types_);
+  return engine_.Get({QueryKind::Signature, name});
+}
+
+absl::StatusOr<const DefinedFunction *>
+ProgramDatabase::AnnotatedFunction(Symbol name) {
+  TypeTable::Scope scope(types_);
+  engine_.Get({QueryKind::AnnotatedFunction, name});
+  const Annotated &annotated = annotated_[name];
+  if (!annotated.status.ok())
+    return annotated.status;
+  return annotated.function.get();
+}
+
+absl::StatusOr<std::string> ProgramDatabase::FunctionIR(Symbol name) {
+  TypeTable::Scope scope(types_);
+  engine_.Get({QueryKind::FunctionIR, name});
+  return ir_.at(name);
+}
+
+uint64_t ProgramDatabase::Execute(const QueryKey &key) {
+  switch (key.kind) {
+  case QueryKind::Input:
+    break;
+  case QueryKind::Signature:
+    return ExecuteSignature(key.name);
+  case QueryKind::AnnotatedFunction:
+    return ExecuteAnnotatedFunction(key.name);
+  case QueryKind::FunctionIR:
+    return ExecuteFunctionIR(key.name);
+  }
+  assert(false); // Inputs are set, never run.
+}
+
+uint64_t ProgramDatabase::ExecuteSignature(Symbol name) {
+  engine_.Get({QueryKind::Input, name});
+  auto it = declarations_.find(name);
+  if (it == declarations_.end()) {
+    auto signature = signatures_.find(name);
+    if (signature != signatures_.end()) {
+      Retire(std::move(signature->second.function));
+      signatures_.erase(signature);
+    }
+    return 0;
+  }
+  const Function *declaration = it->second;
+  const uint64_t fingerprint = Fingerprint(SignatureOf(declaration));
+  Signed &signature = signatures_[name];
+  if (signature.function == nullptr || signature.fingerprint != fingerprint) {
+    if (signature.function != nullptr)
+      Retire(std::move(signature.function));
+    signature.function = std::make_unique<ExternFunction>(
+        name, declaration->arguments(), declaration->return_type(),
+        /*specifier=*/"", declaration->location());
+    signature.fingerprint = fingerprint;
+  }
+  return fingerprint;
+}
+
+uint64_t ProgramDatabase::ExecuteAnnotatedFunction(Symbol name) {
+  engine_.Get({QueryKind::Input, name});
+  Annotated &annotated = annotated_[name];
+  Release(annotated);
+  auto it = declarations_.find(name);
+  const DefinedFunction *declaration =
+      it == declarations_.end() ? nullptr
+                                : dyn_cast<DefinedFunction>(it->second);
+  if (declaration == nullptr || !declaration->parsed()) {
+    annotated.status = absl::NotFoundError(
+        absl::StrCat("no parsed definition of '", name.str(), "'"));
+    return Fingerprint(annotated.status.ToString());
+  }
+
+  // Calls are bound to the signatures only, i.e., the annotated body stays
+  // valid as long as they do not change (independent of the bodies).
+  absl::flat_hash_map<Symbol, const Function *> callees;
+  for (Symbol callee : CallCollector::Collect(&declaration->body())) {
+    if (engine_.Get({QueryKind::Signature, callee}) != 0)
+      callees[callee] = signatures_.at(callee).function.get();
+  }
+
+  auto function = std::make_unique<DefinedFunction>(
+      name, declaration->arguments(), declaration->return_type(),
+      CompoundStatement(declaration->body().CloneStatements()),
+      declaration->location());
+  annotated.status = NameResolver::Resolve(function.get(), callees);
+  if (!annotated.status.ok())
+    return Fingerprint(annotated.status.ToString());
+  TypeInferenceVisitor::Annotate(function.get());
+  annotated.function = std::move(function);
+  for (const auto &[callee, signature] : callees) {
+    annotated.callees.push_back(signature);
+    ++bound_[signature];
+  }
+  return Fingerprint(annotated.function->DebugString());
+}
+
+uint64_t ProgramDatabase::ExecuteFunctionIR(Symbol name) {
+  engine_.Get({QueryKind::AnnotatedFunction, name});
+  const Annotated &annotated = annotated_.at(name);
+  absl::StatusOr<std::string> &ir = ir_[name];
+  if (!annotated.status.ok()) {
+    ir = annotated.status;
+    return Fingerprint(annotated.status.ToString());
+  }
+  std::vector<const Function *> callees;
+  for (Symbol callee : CallCollector::Collect(&annotated.function->body())) {
+    if (engine_.Get({QueryKind::Signature, callee}) != 0)
+      callees.push_back(signatures_.at(callee).function.get());
+  }
+  ir = LLVMCodeGen::GenerateFunctionIR(context_, annotated.function.get(),
+                                       callees);
+  return Fingerprint(*ir);
+}
+
+void ProgramDatabase::Retire(std::unique_ptr<Function> signature) {
+  if (bound_.contains(signature.get()))
+    retired_[signature.get()] = std::move(signature);
+}
+
+void ProgramDatabase::Release(Annotated &annotated) {
+  annotated.function.reset();
+  for (const Function *signature : annotated.callees) {
+    auto it = bound_.find(signature);
+    if (--it->second == 0) {
+      bound_.erase(it);
+      retired_.erase(signature);
+    }
+  }
+  annotated.callees.clear();
+}
+// `ProgramDatabase` ====================================================
+} // namespace Cobold
@@ -0,0 +1,94 @@
+#ifndef COBOLD_SESSION_PROGRAM_DATABASE
+#define COBOLD_SESSION_PROGRAM_DATABASE
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "core/function.h"
+#include "core/symbol.h"
+#include "core/type.h"
+#include "parser/source_file.h"
+#include "session/query_engine.h"
+
+#include "llvm/IR/LLVMContext.h"
+
+namespace Cobold {
+// The front end of a long-lived compiler (e.g., of an editor) as memoized
+// queries per function: its signature, its annotated body and its IR (see
+// `QueryKind`). The declarations of the program are the only inputs. After
+// an edit, only the edited functions are annotated (and translated) again,
+// plus the callers of functions whose signature changed.
+//
+// The declarations are never modified, every annotated body is a copy (see
+// `Statement::Clone`), i.e., they need to be unresolved and unannotated
+// (e.g., the functions of an `IncrementalParser`).
+class ProgramDatabase {
+public:
+  // `types` and `context` need to outlive the database.
+  ProgramDatabase(TypeTable *types, llvm::LLVMContext *context);
+  ~ProgramDatabase();
+
+  // Replaces the declarations of the program, which need to outlive the
+  // database (or the next call) and must not be annotated. Functions are
+  // compared by their contents, i.e., re-parsed but unchanged ones are not an
+  // edit.
+  void SetModules(const std::vector<SourceFile> &modules);
+
+  // Fingerprint of the signature of `name` (0 if there is no such function).
+  uint64_t Signature(Symbol name);
+  // Copy of the body of `name`, resolved against the signatures of the
+  // program and annotated. Valid until the next `SetModules`.
+  absl::StatusOr<const DefinedFunction *> AnnotatedFunction(Symbol name);
+  // IR of `name`, which needs to be a defined function (see
+  // `LLVMCodeGen::GenerateFunctionIR`).
+  absl::StatusOr<std::string> FunctionIR(Symbol name);
+
+  // Number of queries run so far (see `QueryEngine::executions`).
+  int64_t executions() const { return engine_.executions(); }
+
+private:
+  // The callees of annotated bodies are bound to these signatures (rather
+  // than to the declarations, which are replaced by every edit).
+  struct Signed {
+    std::unique_ptr<Function> function;
+    uint64_t fingerprint = 0;
+  };
+  struct Annotated {
+    std::unique_ptr<DefinedFunction> function;
+    absl::Status status;
+    // The signatures `function` is bound to.
+    std::vector<const Function *> callees;
+  };
+
+  uint64_t Execute(const QueryKey &key);
+  uint64_t ExecuteSignature(Symbol name);
+  uint64_t ExecuteAnnotatedFunction(Symbol name);
+  uint64_t ExecuteFunctionIR(Symbol name);
+
+  // Frees a replaced signature, unless an annotated body is still bound to it.
+  void Retire(std::unique_ptr<Function> signature);
+  // Frees the body of `annotated` and the retired signatures only it was bound
+  // to.
+  void Release(Annotated &annotated);
+
+  TypeTable *types_;
+  llvm::LLVMContext *context_;
+  QueryEngine engine_;
+
+  absl::flat_hash_map<Symbol, const Function *> declarations_;
+  absl::flat_hash_map<Symbol, Signed> signatures_;
+  // Number of annotated bodies bound to each signature.
+  absl::flat_hash_map<const Function *, int> bound_;
+  // Replaced signatures that annotated bodies are still bound to.
+  absl::flat_hash_map<const Function *, std::unique_ptr<Function>> retired_;
+  absl::flat_hash_map<Symbol, Annotated> annotated_;
+  absl::flat_hash_map<Symbol, absl::StatusOr<std::string>> ir_;
+};
+} // namespace Cobold
+
+#endif /* COBOLD_SESSION_PROGRAM_DATABASE */
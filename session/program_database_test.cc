@@ -0,0 +1,116 @@
+#include "session/program_database.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "core/function.h"
+#include "core/symbol.h"
+#include "core/type.h"
+#include "gtest/gtest.h"
+#include "parser/parser.h"
+#include "parser/source_file.h"
+#include "parser/source_manager.h"
+
+#include "llvm/IR/LLVMContext.h"
+
+namespace Cobold {
+namespace {
+constexpr char kCaller[] = "fn Caller(x: i32) -> i32 {\n"
+                           "    return Callee(x) + 1;\n"
+                           "}\n";
+constexpr char kCallee[] = "fn Callee(x: i32) -> i32 {\n"
+                           "    return x;\n"
+                           "}\n";
+constexpr char kOther[] = "fn Other() -> i32 {\n"
+                          "    return 2;\n"
+                          "}\n";
+
+class ProgramDatabaseTest : public ::testing::Test {
+protected:
+  ProgramDatabaseTest() : scope_(&types_), database_(&types_, &context_) {}
+
+  // Replaces the program by `source` (kept alive until the next call).
+  void SetSource(const std::string &source) {
+    sources_.push_back(SourceBuffer::FromString("program.cb", source));
+    absl::StatusOr<SourceFile> file = Parser::Parse(*sources_.back());
+    ASSERT_TRUE(file.ok()) << file.status();
+    modules_.clear();
+    modules_.push_back(*std::move(file));
+    database_.SetModules(modules_);
+  }
+
+  // Annotates all of `names` and returns the number of queries this ran.
+  int64_t Annotate(const std::vector<std::string> &names) {
+    const int64_t executions = database_.executions();
+    for (const std::string &name : names)
+      database_.AnnotatedFunction(Symbol::Intern(name)).IgnoreError();
+    return database_.executions() - executions;
+  }
+
+  bool Annotated(const std::string &name) {
+    return database_.AnnotatedFunction(Symbol::Intern(name)).ok();
+  }
+
+  TypeTable types_;
+  TypeTable::Scope scope_;
+  llvm::LLVMContext context_;
+  std::vector<std::unique_ptr<SourceBuffer>> sources_;
+  std::vector<SourceFile> modules_;
+  ProgramDatabase database_;
+};
+
+TEST_F(ProgramDatabaseTest, UnchangedProgramRunsNothing) {
+  SetSource(absl::StrCat(kCaller, kCallee, kOther));
+  EXPECT_GT(Annotate({"Caller", "Callee", "Other"}), 0);
+  // Re-parsed, but equal functions are not an edit.
+  SetSource(absl::StrCat(kCaller, "\n\n", kCallee, kOther));
+  EXPECT_EQ(Annotate({"Caller", "Callee", "Other"}), 0);
+}
+
+TEST_F(ProgramDatabaseTest, BodyEditReannotatesOnlyThatFunction) {
+  SetSource(absl::StrCat(kCaller, kCallee, kOther));
+  Annotate({"Caller", "Callee", "Other"});
+  SetSource(absl::StrCat(kCaller,
+                         "fn Callee(x: i32) -> i32 {\n"
+                         "    return x + 2;\n"
+                         "}\n",
+                         kOther));
+  // The signature of `Callee` is checked again, but is unchanged (early
+  // cutoff), i.e., `Caller` is not annotated again.
+  EXPECT_EQ(Annotate({"Caller", "Other"}), 1);
+  EXPECT_EQ(Annotate({"Callee"}), 1);
+}
+
+TEST_F(ProgramDatabaseTest, SignatureChangeReannotatesCallers) {
+  SetSource(absl::StrCat(kCaller, kCallee, kOther));
+  Annotate({"Caller", "Callee", "Other"});
+  SetSource(absl::StrCat(kCaller,
+                         "fn Callee(x: i32) -> i64 {\n"
+                         "    return (i64) x;\n"
+                         "}\n",
+                         kOther));
+  // The signature of `Callee` and `Caller`, but not `Other`.
+  EXPECT_EQ(Annotate({"Caller", "Other"}), 2);
+  EXPECT_TRUE(Annotated("Caller"));
+}
+
+TEST_F(ProgramDatabaseTest, AddingAndRemovingCallee) {
+  SetSource(absl::StrCat(kCaller, kOther));
+  Annotate({"Caller", "Other"});
+  EXPECT_FALSE(Annotated("Caller"));
+
+  // The signature of `Callee` and `Caller`, but not `Other`.
+  SetSource(absl::StrCat(kCaller, kCallee, kOther));
+  EXPECT_EQ(Annotate({"Caller", "Other"}), 2);
+  EXPECT_TRUE(Annotated("Caller"));
+
+  SetSource(absl::StrCat(kCaller, kOther));
+  EXPECT_EQ(Annotate({"Caller", "Other"}), 2);
+  EXPECT_FALSE(Annotated("Caller"));
+  EXPECT_FALSE(Annotated("Callee"));
+}
+} // namespace
+} // namespace Cobold
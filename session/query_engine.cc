@@ -0,0 +1,76 @@
+#include "session/query_engine.h"
+
+#include <cassert>
+
+namespace Cobold {
+// `QueryEngine` ========================================================
+void QueryEngine::SetInput(const QueryKey &key, uint64_t fingerprint) {
+  assert(key.kind == QueryKind::Input && running_.empty());
+  auto it = memos_.find(key);
+  if (it != memos_.end() && it->second.fingerprint == fingerprint)
+    return;
+  // Inputs never set are 0, i.e., setting one to 0 is no change either.
+  if (it == memos_.end() && fingerprint == 0)
+    return;
+  ++revision_;
+  Memo &memo = memos_[key];
+  memo.fingerprint = fingerprint;
+  memo.changed_at = memo.verified_at = revision_;
+  memo.input = true;
+}
+
+uint64_t QueryEngine::Get(const QueryKey &key) {
+  if (!running_.empty())
+    running_.back().push_back(key);
+  auto it = memos_.find(key);
+  if (it == memos_.end()) {
+    if (key.kind == QueryKind::Input)
+      return 0;
+    return Run(key);
+  }
+  if (it->second.input || it->second.verified_at == revision_)
+    return it->second.fingerprint;
+  if (DependenciesChanged(key))
+    return Run(key);
+  Memo &memo = memos_[key];
+  memo.verified_at = revision_;
+  return memo.fingerprint;
+}
+
+bool QueryEngine::DependenciesChanged(const QueryKey &key) {
+  // Copied, the memos move while the dependencies are brought up to date.
+  const Memo memo = memos_[key];
+  for (const QueryKey &dependency : memo.dependencies) {
+    // Not a dependency of the running query (if any), only of `key`.
+    running_.emplace_back();
+    Get(dependency);
+    running_.pop_back();
+    auto it = memos_.find(dependency);
+    const uint64_t changed_at = it == memos_.end() ? 0 : it->second.changed_at;
+    if (changed_at > memo.verified_at)
+      return true;
+  }
+  return false;
+}
+
+uint64_t QueryEngine::Run(const QueryKey &key) {
+  const bool inserted = active_.insert(key).second;
+  assert(inserted && "cyclic query");
+  running_.emplace_back();
+  const uint64_t fingerprint = execute_(key);
+  std::vector<QueryKey> dependencies = std::move(running_.back());
+  running_.pop_back();
+  active_.erase(key);
+  ++executions_;
+
+  auto [it, first_run] = memos_.try_emplace(key);
+  Memo &memo = it->second;
+  if (first_run || memo.fingerprint != fingerprint)
+    memo.changed_at = revision_;
+  memo.fingerprint = fingerprint;
+  memo.verified_at = revision_;
+  memo.dependencies = std::move(dependencies);
+  return fingerprint;
+}
+// `QueryEngine` ========================================================
+} // namespace Cobold
@@ -0,0 +1,81 @@
+#ifndef COBOLD_SESSION_QUERY_ENGINE
+#define COBOLD_SESSION_QUERY_ENGINE
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "core/symbol.h"
+
+namespace Cobold {
+enum class QueryKind {
+  Input,             // the declaration of a function (set by the client)
+  Signature,         // the argument and return types of a function
+  AnnotatedFunction, // the resolved and annotated body of a function
+  FunctionIR,        // the LLVM IR of a function
+};
+
+struct QueryKey {
+  QueryKind kind;
+  Symbol name;
+
+  friend bool operator==(const QueryKey &lhs, const QueryKey &rhs) {
+    return lhs.kind == rhs.kind && lhs.name == rhs.name;
+  }
+  template <typename H> friend H AbslHashValue(H h, const QueryKey &key) {
+    return H::combine(std::move(h), key.kind, key.name);
+  }
+};
+
+// Memoizes queries by their `QueryKey` and records which queries each one
+// reads while it runs. Every `SetInput` that changes an input starts a new
+// revision. A query is only re-run if one of the queries it read last time
+// changed since (checked recursively, inputs first), and a re-run whose
+// fingerprint did not change does not invalidate the queries reading it
+// (early cutoff). The values themselves are stored by the caller, the engine
+// only sees their fingerprints. Not thread-safe.
+class QueryEngine {
+public:
+  // Runs `key` and returns the fingerprint of its value.
+  using Execute = std::function<uint64_t(const QueryKey &key)>;
+
+  explicit QueryEngine(Execute execute) : execute_(std::move(execute)) {}
+
+  // Sets the fingerprint of the input `key`, inputs never set are 0.
+  void SetInput(const QueryKey &key, uint64_t fingerprint);
+
+  // Brings `key` up to date and returns its fingerprint. Called from within a
+  // running query, `key` becomes one of its dependencies.
+  uint64_t Get(const QueryKey &key);
+
+  uint64_t revision() const { return revision_; }
+  // Number of queries that were (re-)run.
+  int64_t executions() const { return executions_; }
+
+private:
+  struct Memo {
+    uint64_t fingerprint = 0;
+    uint64_t changed_at = 0;  // revision the fingerprint last changed in
+    uint64_t verified_at = 0; // revision the memo was last up to date in
+    std::vector<QueryKey> dependencies;
+    bool input = false;
+  };
+
+  // Whether a dependency of `key` (recorded at `verified_at`) changed since.
+  bool DependenciesChanged(const QueryKey &key);
+  uint64_t Run(const QueryKey &key);
+
+  Execute execute_;
+  absl::flat_hash_map<QueryKey, Memo> memos_;
+  // Dependencies of the running queries, innermost last.
+  std::vector<std::vector<QueryKey>> running_;
+  absl::flat_hash_set<QueryKey> active_; // to detect cycles
+  uint64_t revision_ = 1;
+  int64_t executions_ = 0;
+};
+} // namespace Cobold
+
+#endif /* COBOLD_SESSION_QUERY_ENGINE */
@@ -0,0 +1,127 @@
+#include "util/call_collector.h"
+
+namespace Cobold {
+// `CallCollector` ======================================================
+absl::flat_hash_set<Symbol> CallCollector::Collect(const Statement *stmt) {
+  CallCollector collector;
+  collector.StatementVisitor::Visit(stmt);
+  return std::move(collector.calls_);
+}
+
+void CallCollector::DispatchReturn(const ReturnStatement *stmt) {
+  ExpressionVisitor::Visit(stmt->expression());
+}
+
+void CallCollector::DispatchDeinit(const DeinitStatement *stmt) {
+  ExpressionVisitor::Visit(stmt->expression());
+}
+
+void CallCollector::DispatchAssignment(const AssignmentStatement *stmt) {
+  ExpressionVisitor::Visit(stmt->lhs());
+  ExpressionVisitor::Visit(stmt->rhs());
+}
+
+void CallCollector::DispatchCompound(const CompoundStatement *stmt) {
+  for (const auto &statement : stmt->statements()) {
+    StatementVisitor::Visit(statement.get());
+  }
+}
+
+void CallCollector::DispatchExpression(const ExpressionStatement *stmt) {
+  ExpressionVisitor::Visit(stmt->expression());
+}
+
+void CallCollector::DispatchIf(const IfStatement *stmt) {
+  for (const IfBranch &branch : stmt->branches()) {
+    ExpressionVisitor::Visit(branch.condition.get());
+    StatementVisitor::Visit(branch.body.get());
+  }
+}
+
+void CallCollector::DispatchFor(const ForStatement *stmt) {
+  ExpressionVisitor::Visit(stmt->expression());
+  StatementVisitor::Visit(stmt->body().get());
+}
+
+void CallCollector::DispatchWhile(const WhileStatement *stmt) {
+  ExpressionVisitor::Visit(stmt->condition());
+  StatementVisitor::Visit(stmt->body().get());
+}
+
+void CallCollector::DispatchDeclaration(const DeclarationStatement *stmt) {
+  ExpressionVisitor::Visit(stmt->expression());
+}
+
+void CallCollector::DispatchBreak(const BreakStatement *stmt) {}
+
+void CallCollector::DispatchContinue(const ContinueStatement *stmt) {}
+
+// The condition of an `else` branch (and the bounds of a range) are optional.
+void CallCollector::DispatchEmpty() {}
+
+void CallCollector::DispatchTernary(const TernaryExpression *expr) {
+  ExpressionVisitor::Visit(expr->condition());
+  ExpressionVisitor::Visit(expr->true_case());
+  ExpressionVisitor::Visit(expr->false_case());
+}
+
+void CallCollector::DispatchBinary(const BinaryExpression *expr) {
+  ExpressionVisitor::Visit(expr->lhs());
+  ExpressionVisitor::Visit(expr->rhs());
+}
+
+void CallCollector::DispatchUnary(const UnaryExpression *expr) {
+  ExpressionVisitor::Visit(expr->expression());
+}
+
+void CallCollector::DispatchCall(const CallExpression *expr) {
+  calls_.insert(expr->identifier());
+  for (const auto &arg : expr->args()) {
+    ExpressionVisitor::Visit(arg.get());
+  }
+}
+
+void CallCollector::DispatchRange(const RangeExpression *expr) {
+  ExpressionVisitor::Visit(expr->lhs());
+  ExpressionVisitor::Visit(expr->rhs());
+}
+
+void CallCollector::DispatchArray(const ArrayExpression *expr) {
+  for (const auto &element : expr->elements()) {
+    ExpressionVisitor::Visit(element.get());
+  }
+}
+
+void CallCollector::DispatchCast(const CastExpression *expr) {
+  ExpressionVisitor::Visit(expr->expression());
+}
+
+void CallCollector::DispatchConstant(const ConstantExpression *expr) {}
+
+void CallCollector::DispatchIdentifier(const IdentifierExpression *expr) {
+  calls_.insert(expr->identifier());
+}
+
+void CallCollector::DispatchMemberAccess(const MemberAccessExpression *expr) {
+  ExpressionVisitor::Visit(expr->expression());
+}
+
+void CallCollector::DispatchArrayAccess(const ArrayAccessExpression *expr) {
+  ExpressionVisitor::Visit(expr->expression());
+  ExpressionVisitor::Visit(expr->index());
+}
+
+void CallCollector::DispatchCallOp(const CallOpExpression *expr) {
+  ExpressionVisitor::Visit(expr->expression());
+  for (const auto &arg : expr->args()) {
+    ExpressionVisitor::Visit(arg.get());
+  }
+}
+
+void CallCollector::DispatchMalloc(const MallocExpression *expr) {
+  ExpressionVisitor::Visit(expr->expression());
+}
+
+void CallCollector::DispatchSizeof(const SizeofExpression *expr) {}
+// `CallCollector` ======================================================
+} // namespace Cobold
@@ -0,0 +1,54 @@
+#ifndef COBOLD_UTIL_CALL_COLLECTOR
+#define COBOLD_UTIL_CALL_COLLECTOR
+
+#include "absl/container/flat_hash_set.h"
+#include "core/symbol.h"
+#include "visitor/expression_visitor.h"
+#include "visitor/statement_visitor.h"
+
+namespace Cobold {
+// Collects the names of all functions (possibly) called in a statement, i.e.,
+// the callees of all calls and every identifier, since call operators (e.g.,
+// the `__lib_malloc` of a rewritten `malloc`) call through one. Variables are
+// thus over-approximated as functions of the same name.
+class CallCollector : private StatementVisitor<true>,
+                      private ExpressionVisitor<true, void> {
+public:
+  static absl::flat_hash_set<Symbol> Collect(const Statement *stmt);
+
+private:
+  // Statements
+  void DispatchReturn(const ReturnStatement *stmt) override;
+  void DispatchDeinit(const DeinitStatement *stmt) override;
+  void DispatchAssignment(const AssignmentStatement *stmt) override;
+  void DispatchCompound(const CompoundStatement *stmt) override;
+  void DispatchExpression(const ExpressionStatement *stmt) override;
+  void DispatchIf(const IfStatement *stmt) override;
+  void DispatchFor(const ForStatement *stmt) override;
+  void DispatchWhile(const WhileStatement *stmt) override;
+  void DispatchDeclaration(const DeclarationStatement *stmt) override;
+  void DispatchBreak(const BreakStatement *stmt) override;
+  void DispatchContinue(const ContinueStatement *stmt) override;
+
+  // Expressions
+  void DispatchEmpty() override;
+  void DispatchTernary(const TernaryExpression *expr) override;
+  void DispatchBinary(const BinaryExpression *expr) override;
+  void DispatchUnary(const UnaryExpression *expr) override;
+  void DispatchCall(const CallExpression *expr) override;
+  void DispatchRange(const RangeExpression *expr) override;
+  void DispatchArray(const ArrayExpression *expr) override;
+  void DispatchCast(const CastExpression *expr) override;
+  void DispatchConstant(const ConstantExpression *expr) override;
+  void DispatchIdentifier(const IdentifierExpression *expr) override;
+  void DispatchMemberAccess(const MemberAccessExpression *expr) override;
+  void DispatchArrayAccess(const ArrayAccessExpression *expr) override;
+  void DispatchCallOp(const CallOpExpression *expr) override;
+  void DispatchMalloc(const MallocExpression *expr) override;
+  void DispatchSizeof(const SizeofExpression *expr) override;
+
+  absl::flat_hash_set<Symbol> calls_;
+};
+} // namespace Cobold
+
+#endif /* COBOLD_UTIL_CALL_COLLECTOR */
@@ -0,0 +1,45 @@
+#ifndef COBOLD_UTIL_CASTING
+#define COBOLD_UTIL_CASTING
+
+#include <cassert>
+#include <type_traits>
+
+namespace Cobold {
+// LLVM-style RTTI based on the kind tags stored in the roots of the class
+// hierarchies (e.g., `Expression::type()`) instead of `dynamic_cast`. `To`
+// needs a `static bool classof(const Base *)` checking the tag.
+template <typename To, typename From> bool isa(const From *from) {
+  assert(from != nullptr);
+  return To::classof(from);
+}
+
+// Downcast that is only checked in debug builds.
+template <typename To, typename From> const To *cast(const From *from) {
+  static_assert(std::is_base_of_v<From, To>,
+                "Attempting to cast to non-derived class.");
+  assert(isa<To>(from));
+  return static_cast<const To *>(from);
+}
+
+template <typename To, typename From> To *cast(From *from) {
+  static_assert(std::is_base_of_v<From, To>,
+                "Attempting to cast to non-derived class.");
+  assert(isa<To>(from));
+  return static_cast<To *>(from);
+}
+
+// Returns `nullptr` unless `from` is a `To`.
+template <typename To, typename From> const To *dyn_cast(const From *from) {
+  static_assert(std::is_base_of_v<From, To>,
+                "Attempting to cast to non-derived class.");
+  return isa<To>(from) ? static_cast<const To *>(from) : nullptr;
+}
+
+template <typename To, typename From> To *dyn_cast(From *from) {
+  static_assert(std::is_base_of_v<From, To>,
+                "Attempting to cast to non-derived class.");
+  return isa<To>(from) ? static_cast<To *>(from) : nullptr;
+}
+} // namespace Cobold
+
+#endif /* COBOLD_UTIL_CASTING */
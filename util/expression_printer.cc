@@ -126,7 +126,7 @@ void ExpressionPrinter::DispatchUnary(const UnaryExpression *expr) {
 
 // TODO(jlscheerer) Call is probably redundant at this point...
 void ExpressionPrinter::DispatchCall(const CallExpression *expr) {
-  Append(expr->identifier(), "(");
+  Append(expr->identifier().str(), "(");
   const int num_args = expr->args().size();
   for (int i = 0; i < num_args; ++i) {
     Visit(expr->args()[i].get());
@@ -174,21 +174,21 @@ void ExpressionPrinter::DispatchConstant(const ConstantExpression *expr) {
     Append(std::to_string(*value));
   } else if (const char *value = std::get_if<char>(&data)) {
     Append("'", absl::CEscape(std::string(1, *value)), "'");
-  } else if (const std::string *value = std::get_if<std::string>(&data)) {
-    Append("\"", absl::CEscape(*value), "\"");
+  } else if (const Symbol *value = std::get_if<Symbol>(&data)) {
+    Append("\"", absl::CEscape(value->str()), "\"");
   } else {
     assert(false);
   }
 }
 
 void ExpressionPrinter::DispatchIdentifier(const IdentifierExpression *expr) {
-  Append(expr->identifier());
+  Append(expr->identifier().str());
 }
 
 void ExpressionPrinter::DispatchMemberAccess(
     const MemberAccessExpression *expr) {
   Visit(expr->expression());
-  Append(expr->direct() ? "." : "->", expr->identifier());
+  Append(expr->direct() ? "." : "->", expr->identifier().str());
 }
 
 void ExpressionPrinter::DispatchArrayAccess(const ArrayAccessExpression *expr) {
@@ -1,74 +1,82 @@
-#ifndef COBOLD_UTIL_SCOPE
-#define COBOLD_UTIL_SCOPE
+#ifndef COBOLD_UTIL_SCOPED_MAP
+#define COBOLD_UTIL_SCOPED_MAP
 
+#include <cassert>
+#include <cstddef>
+#include <limits>
 #include <optional>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 
 namespace Cobold {
-template <typename KeyType, typename ValueType> struct Scope {
-public:
-  bool contains(const KeyType &key) { return insert_order_.contains(key); }
-  void put(const KeyType &key, const ValueType &value) {
-    insert_order_[key] = data_.size();
-    data_.push_back(value);
-  }
-  ValueType &operator[](const KeyType &key) {
-    return data_[insert_order_[key]];
-  }
-  auto begin() const { return data_.rbegin(); }
-  auto end() const { return data_.rend(); }
-
-private:
-  absl::flat_hash_map<KeyType, int> insert_order_;
-  std::vector<ValueType> data_;
-};
-
+// Map of nested scopes, in which the definitions of inner scopes shadow those
+// of outer ones. A single hash table maps every key to its innermost
+// definition, which links to the definition it shadows. The definitions are
+// kept in the order they were made, which doubles as the undo log of
+// `PopScope`. Lookups and definitions are O(1) independent of the nesting
+// depth, popping a scope is O(1) per definition it made.
 template <typename KeyType, typename ValueType> class ScopedMap {
 public:
-  void PushScope() { scopes_.push_back({}); }
-  Scope<KeyType, ValueType> PopScope() {
-    Scope<KeyType, ValueType> scope = std::move(scopes_.back());
-    scopes_.pop_back();
-    return scope;
-  }
-  bool put(const KeyType &key, const ValueType &value) {
-    if (!Defines(key)) {
-      scopes_.back().put(key, value);
-      return true;
+  void PushScope() { scope_begins_.push_back(definitions_.size()); }
+  void PopScope() {
+    assert(!scope_begins_.empty());
+    const size_t begin = scope_begins_.back();
+    scope_begins_.pop_back();
+    while (definitions_.size() > begin) {
+      const Definition &definition = definitions_.back();
+      if (definition.shadowed == kNone) {
+        innermost_.erase(definition.key);
+      } else {
+        innermost_.find(definition.key)->second = definition.shadowed;
+      }
+      definitions_.pop_back();
     }
-    return false;
   }
-  bool contains(const KeyType &key) {
-    for (int i = scopes_.size() - 1; i >= 0; --i) {
-      if (scopes_[i].contains(key))
-        return true;
-    }
-    return false;
+
+  // Whether `key` is defined in any scope.
+  bool contains(const KeyType &key) const { return innermost_.contains(key); }
+  // Whether `key` is defined in the innermost scope.
+  bool defines(const KeyType &key) const {
+    assert(!scope_begins_.empty()); // this is a strong logical error!
+    auto it = innermost_.find(key);
+    return it != innermost_.end() && it->second >= scope_begins_.back();
   }
-  bool defines(const KeyType &key) {
-    assert(scopes_.size() > 0); // this is a strong logical error!
-    return scopes_.back().contains(key);
-  }
-  std::optional<ValueType> lookup(const KeyType &key) {
-    for (int i = scopes_.size() - 1; i >= 0; --i) {
-      if (scopes_[i].contains(key))
-        return scopes_[i][key];
-    }
-    return std::nullopt;
+  std::optional<ValueType> lookup(const KeyType &key) const {
+    auto it = innermost_.find(key);
+    if (it == innermost_.end())
+      return std::nullopt;
+    return definitions_[it->second].value;
   }
+  // Defines `key` in the innermost scope, fails if it already defines `key`.
   bool store(const KeyType &key, const ValueType &value) {
-    if (!defines(key)) {
-      scopes_.back().put(key, value);
-      return true;
+    assert(!scope_begins_.empty());
+    auto [it, inserted] = innermost_.try_emplace(key, definitions_.size());
+    size_t shadowed = kNone;
+    if (!inserted) {
+      if (it->second >= scope_begins_.back())
+        return false;
+      shadowed = it->second;
+      it->second = definitions_.size();
     }
-    return false;
+    definitions_.push_back({key, value, shadowed});
+    return true;
   }
 
 private:
-  std::vector<Scope<KeyType, ValueType>> scopes_;
+  static constexpr size_t kNone = std::numeric_limits<size_t>::max();
+
+  struct Definition {
+    KeyType key;
+    ValueType value;
+    size_t shadowed; // index of the shadowed definition (or `kNone`)
+  };
+
+  absl::flat_hash_map<KeyType, size_t> innermost_;
+  std::vector<Definition> definitions_;
+  // Index of the first definition of each scope.
+  std::vector<size_t> scope_begins_;
 };
 } // namespace Cobold
 
-#endif /* COBOLD_UTIL_SCOPE */
+#endif /* COBOLD_UTIL_SCOPED_MAP */
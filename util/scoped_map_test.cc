@@ -0,0 +1,79 @@
+#include "util/scoped_map.h"
+
+#include <optional>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace Cobold {
+namespace {
+TEST(ScopedMapTest, ShadowsAcrossNestedScopes) {
+  ScopedMap<std::string, int> map;
+  map.PushScope();
+  EXPECT_TRUE(map.store("x", 1));
+  map.PushScope();
+  EXPECT_TRUE(map.store("x", 2));
+  map.PushScope();
+  EXPECT_TRUE(map.store("x", 3));
+  EXPECT_EQ(map.lookup("x"), 3);
+
+  map.PopScope();
+  EXPECT_EQ(map.lookup("x"), 2);
+  EXPECT_TRUE(map.defines("x"));
+  EXPECT_TRUE(map.contains("x"));
+
+  map.PopScope();
+  EXPECT_EQ(map.lookup("x"), 1);
+  EXPECT_TRUE(map.defines("x"));
+
+  map.PopScope();
+  EXPECT_FALSE(map.contains("x"));
+  EXPECT_EQ(map.lookup("x"), std::nullopt);
+}
+
+TEST(ScopedMapTest, StoreFailsOnRedefinitionInSameScope) {
+  ScopedMap<std::string, int> map;
+  map.PushScope();
+  EXPECT_TRUE(map.store("x", 1));
+  EXPECT_FALSE(map.store("x", 2));
+  EXPECT_EQ(map.lookup("x"), 1);
+
+  map.PushScope();
+  EXPECT_TRUE(map.store("x", 3));
+  EXPECT_FALSE(map.store("x", 4));
+  EXPECT_EQ(map.lookup("x"), 3);
+}
+
+TEST(ScopedMapTest, PopScopeRestoresShadowedAndErasesNewKeys) {
+  ScopedMap<std::string, int> map;
+  map.PushScope();
+  EXPECT_TRUE(map.store("outer", 1));
+  EXPECT_TRUE(map.store("shadowed", 2));
+
+  map.PushScope();
+  EXPECT_FALSE(map.defines("outer"));
+  EXPECT_TRUE(map.contains("outer"));
+  EXPECT_TRUE(map.store("shadowed", 3));
+  EXPECT_TRUE(map.store("inner", 4));
+  EXPECT_TRUE(map.defines("shadowed"));
+  EXPECT_TRUE(map.defines("inner"));
+
+  map.PopScope();
+  EXPECT_EQ(map.lookup("shadowed"), 2);
+  EXPECT_TRUE(map.defines("shadowed"));
+  EXPECT_TRUE(map.defines("outer"));
+  EXPECT_FALSE(map.defines("inner"));
+  EXPECT_FALSE(map.contains("inner"));
+  EXPECT_EQ(map.lookup("inner"), std::nullopt);
+
+  // A popped key can be defined again, also in the same (outer) scope.
+  EXPECT_TRUE(map.store("inner", 5));
+  EXPECT_EQ(map.lookup("inner"), 5);
+
+  map.PopScope();
+  EXPECT_FALSE(map.contains("outer"));
+  EXPECT_FALSE(map.contains("shadowed"));
+  EXPECT_FALSE(map.contains("inner"));
+}
+} // namespace
+} // namespace Cobold
@@ -51,7 +51,7 @@ void StatementPrinter::DispatchIf(const IfStatement *stmt) {
 }
 
 void StatementPrinter::DispatchFor(const ForStatement *stmt) {
-  AppendIndented("for ", stmt->identifier(), ": ",
+  AppendIndented("for ", stmt->identifier().str(), ": ",
                  stmt->decl_type() ? stmt->decl_type()->DebugString() : "<?>",
                  " in ", ExpressionPrinter::Print(stmt->expression()));
   Visit(stmt->body().get());
@@ -63,8 +63,8 @@ void StatementPrinter::DispatchWhile(const WhileStatement *stmt) {
 }
 
 void StatementPrinter::DispatchDeclaration(const DeclarationStatement *stmt) {
-  AppendIndented(stmt->is_const() ? "let" : "var", " ", stmt->identifier(),
-                 ": ",
+  AppendIndented(stmt->is_const() ? "let" : "var", " ",
+                 stmt->identifier().str(), ": ",
                  stmt->decl_type() ? stmt->decl_type()->DebugString() : "<?>",
                  " = ", ExpressionPrinter::Print(stmt->expression()), ";");
 }
@@ -0,0 +1,62 @@
+#include "util/thread_pool.h"
+
+#include <utility>
+
+namespace Cobold {
+// `ThreadPool` =========================================================
+ThreadPool::ThreadPool(int num_threads) {
+  if (num_threads <= 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threads_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    threads_.emplace_back(&ThreadPool::WorkLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stopping_ = true;
+  }
+  for (auto &thread : threads_)
+    thread.join();
+}
+
+void ThreadPool::Schedule(std::function<void()> work) {
+  absl::MutexLock lock(&mutex_);
+  queue_.push(std::move(work));
+}
+
+void ThreadPool::Wait() {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(
+      +[](ThreadPool *pool) ABSL_EXCLUSIVE_LOCKS_REQUIRED(pool->mutex_) {
+        return pool->queue_.empty() && pool->active_ == 0;
+      },
+      this));
+}
+
+void ThreadPool::WorkLoop() {
+  while (true) {
+    std::function<void()> work;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(
+          +[](ThreadPool *pool) ABSL_EXCLUSIVE_LOCKS_REQUIRED(pool->mutex_) {
+            return !pool->queue_.empty() || pool->stopping_;
+          },
+          this));
+      if (queue_.empty())
+        return; // stopping_ and nothing left to do.
+      work = std::move(queue_.front());
+      queue_.pop();
+      ++active_;
+    }
+    work();
+    absl::MutexLock lock(&mutex_);
+    --active_;
+  }
+}
+// `ThreadPool` =========================================================
+} // namespace Cobold
@@ -0,0 +1,43 @@
+#ifndef COBOLD_UTIL_THREAD_POOL
+#define COBOLD_UTIL_THREAD_POOL
+
+#include <functional>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Cobold {
+// Fixed-size pool of worker threads. Work may be scheduled from within
+// running work (e.g., to schedule the imports of a freshly parsed module).
+class ThreadPool {
+public:
+  // `num_threads <= 0` uses one thread per hardware thread.
+  explicit ThreadPool(int num_threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  void Schedule(std::function<void()> work);
+
+  // Blocks until all scheduled (and transitively scheduled) work is done.
+  void Wait();
+
+  int num_threads() const { return threads_.size(); }
+
+private:
+  void WorkLoop();
+
+  absl::Mutex mutex_;
+  std::queue<std::function<void()>> queue_ ABSL_GUARDED_BY(mutex_);
+  int active_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool stopping_ ABSL_GUARDED_BY(mutex_) = false;
+
+  std::vector<std::thread> threads_;
+};
+} // namespace Cobold
+
+#endif /* COBOLD_UTIL_THREAD_POOL */
@@ -0,0 +1,6 @@
+#include "visitor/flat_ast_visitor.h"
+
+namespace Cobold {
+// `FlatExpressionVisitor` ==============================================
+// `FlatExpressionVisitor` ==============================================
+} // namespace Cobold
@@ -0,0 +1,128 @@
+#ifndef COBOLD_VISITOR_FLAT_AST_VISITOR
+#define COBOLD_VISITOR_FLAT_AST_VISITOR
+
+#include <cassert>
+
+#include "core/flat_ast.h"
+
+namespace Cobold {
+// Counterpart of `ExpressionVisitor` for a `FlatAst`: every `Dispatch*` gets
+// the index of the expression (for `FlatAst::expr_type` and
+// `FlatAst::location`) and its payload.
+template <typename RetType = void> class FlatExpressionVisitor {
+public:
+  explicit FlatExpressionVisitor(const FlatAst *ast) : ast_(ast) {}
+
+  RetType Visit(NodeIndex expr) {
+    if (expr == kNoNode)
+      return DispatchEmpty();
+    const FlatAst::Node<ExpressionType> &node = ast_->expression(expr);
+    switch (node.type) {
+    case ExpressionType::Ternary:
+      return DispatchTernary(expr, ast_->Get<Flat::Ternary>(node));
+    case ExpressionType::Binary:
+      return DispatchBinary(expr, ast_->Get<Flat::Binary>(node));
+    case ExpressionType::Unary:
+      return DispatchUnary(expr, ast_->Get<Flat::Unary>(node));
+    case ExpressionType::Call:
+      return DispatchCall(expr, ast_->Get<Flat::Call>(node));
+    case ExpressionType::Range:
+      return DispatchRange(expr, ast_->Get<Flat::Range>(node));
+    case ExpressionType::Array:
+      return DispatchArray(expr, ast_->Get<Flat::Array>(node));
+    case ExpressionType::Cast:
+      return DispatchCast(expr, ast_->Get<Flat::Cast>(node));
+    case ExpressionType::Constant:
+      return DispatchConstant(expr, ast_->Get<Flat::Constant>(node));
+    case ExpressionType::Identifier:
+      return DispatchIdentifier(expr, ast_->Get<Flat::Identifier>(node));
+    case ExpressionType::MemberAccess:
+      return DispatchMemberAccess(expr, ast_->Get<Flat::MemberAccess>(node));
+    case ExpressionType::ArrayAccess:
+      return DispatchArrayAccess(expr, ast_->Get<Flat::ArrayAccess>(node));
+    case ExpressionType::CallOp:
+      return DispatchCallOp(expr, ast_->Get<Flat::CallOp>(node));
+    case ExpressionType::Malloc:
+      return DispatchMalloc(expr, ast_->Get<Flat::Malloc>(node));
+    case ExpressionType::Sizeof:
+      return DispatchSizeof(expr, ast_->Get<Flat::Sizeof>(node));
+    }
+  }
+
+protected:
+  virtual RetType DispatchEmpty() { assert(false); };
+  virtual RetType DispatchTernary(NodeIndex expr, const Flat::Ternary &) = 0;
+  virtual RetType DispatchBinary(NodeIndex expr, const Flat::Binary &) = 0;
+  virtual RetType DispatchUnary(NodeIndex expr, const Flat::Unary &) = 0;
+  virtual RetType DispatchCall(NodeIndex expr, const Flat::Call &) = 0;
+  virtual RetType DispatchRange(NodeIndex expr, const Flat::Range &) = 0;
+  virtual RetType DispatchArray(NodeIndex expr, const Flat::Array &) = 0;
+  virtual RetType DispatchCast(NodeIndex expr, const Flat::Cast &) = 0;
+  virtual RetType DispatchConstant(NodeIndex expr, const Flat::Constant &) = 0;
+  virtual RetType DispatchIdentifier(NodeIndex expr,
+                                     const Flat::Identifier &) = 0;
+  virtual RetType DispatchMemberAccess(NodeIndex expr,
+                                       const Flat::MemberAccess &) = 0;
+  virtual RetType DispatchArrayAccess(NodeIndex expr,
+                                      const Flat::ArrayAccess &) = 0;
+  virtual RetType DispatchCallOp(NodeIndex expr, const Flat::CallOp &) = 0;
+  virtual RetType DispatchMalloc(NodeIndex expr, const Flat::Malloc &) = 0;
+  virtual RetType DispatchSizeof(NodeIndex expr, const Flat::Sizeof &) = 0;
+
+  const FlatAst *ast_;
+};
+
+// Counterpart of `StatementVisitor` for a `FlatAst`. `Return`, `Deinit` and
+// `Expression` statements share `Flat::ExpressionStmt`, `Declaration` and
+// `For` share `Flat::Declaration`.
+class FlatStatementVisitor {
+public:
+  explicit FlatStatementVisitor(const FlatAst *ast) : ast_(ast) {}
+
+  void Visit(NodeIndex stmt) {
+    assert(stmt != kNoNode);
+    const FlatAst::Node<StatementType> &node = ast_->statement(stmt);
+    switch (node.type) {
+    case StatementType::Return:
+      return DispatchReturn(ast_->Get<Flat::ExpressionStmt>(node));
+    case StatementType::Deinit:
+      return DispatchDeinit(ast_->Get<Flat::ExpressionStmt>(node));
+    case StatementType::Assignment:
+      return DispatchAssignment(ast_->Get<Flat::Assignment>(node));
+    case StatementType::Compound:
+      return DispatchCompound(ast_->Get<Flat::Compound>(node));
+    case StatementType::Expression:
+      return DispatchExpression(ast_->Get<Flat::ExpressionStmt>(node));
+    case StatementType::If:
+      return DispatchIf(ast_->Get<Flat::If>(node));
+    case StatementType::For:
+      return DispatchFor(ast_->Get<Flat::Declaration>(node));
+    case StatementType::While:
+      return DispatchWhile(ast_->Get<Flat::While>(node));
+    case StatementType::Declaration:
+      return DispatchDeclaration(ast_->Get<Flat::Declaration>(node));
+    case StatementType::Break:
+      return DispatchBreak();
+    case StatementType::Continue:
+      return DispatchContinue();
+    }
+  }
+
+protected:
+  virtual void DispatchReturn(const Flat::ExpressionStmt &stmt) {}
+  virtual void DispatchDeinit(const Flat::ExpressionStmt &stmt) {}
+  virtual void DispatchAssignment(const Flat::Assignment &stmt) {}
+  virtual void DispatchCompound(const Flat::Compound &stmt) {}
+  virtual void DispatchExpression(const Flat::ExpressionStmt &stmt) {}
+  virtual void DispatchIf(const Flat::If &stmt) {}
+  virtual void DispatchFor(const Flat::Declaration &stmt) {}
+  virtual void DispatchWhile(const Flat::While &stmt) {}
+  virtual void DispatchDeclaration(const Flat::Declaration &stmt) {}
+  virtual void DispatchBreak() {}
+  virtual void DispatchContinue() {}
+
+  const FlatAst *ast_;
+};
+} // namespace Cobold
+
+#endif /* COBOLD_VISITOR_FLAT_AST_VISITOR */